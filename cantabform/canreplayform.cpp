@@ -1,5 +1,7 @@
 #include <QFileDialog>
 #include <QDir>
+#include <QSignalBlocker>
+#include "cmddef.h"
 #include "canreplayform.h"
 #include "ui_canreplayform.h"
 
@@ -26,6 +28,25 @@ void CanReplayForm::onConfigLoaded(const ConfigReplay &configReplayRef)
 	this->config.setMap(configReplayRef.getMap());
 
 	ui->filePathLineEdit->setText(this->config.getDev());
+	const QSignalBlocker blocker(ui->loopCheckBox);
+	ui->loopCheckBox->setChecked(this->config.getLoop() == "on");
+}
+
+void CanReplayForm::setConnected(bool isConnected, bool isReplay)
+{
+	ui->filePathLineEdit->setEnabled(!isConnected);
+	ui->filePathPushButton->setEnabled(!isConnected);
+	ui->transportGroupBox->setEnabled(isConnected && isReplay);
+	// every replay starts playing
+	showPaused(false);
+}
+
+void CanReplayForm::showPaused(bool isPaused)
+{
+	const QSignalBlocker blocker(ui->pausePushButton);
+
+	ui->pausePushButton->setChecked(isPaused);
+	ui->pausePushButton->setText(isPaused ? "Resume" : "Pause");
 }
 
 void CanReplayForm::on_filePathLineEdit_editingFinished()
@@ -37,7 +58,8 @@ void CanReplayForm::on_filePathLineEdit_editingFinished()
 
 void CanReplayForm::on_filePathPushButton_clicked()
 {
-	QString replayFilePath = QFileDialog::getOpenFileName(this, "Select CAN Log to Play", this->config.getDev(), "All files (*)");
+	QString replayFilePath = QFileDialog::getOpenFileName(this, "Select CAN Log to Play", this->config.getDev(),
+		"CAN logs (*.cobs *.manifest *.trc *.log *.asc);;All files (*)");
 	if (!replayFilePath.isEmpty())
 	{
 		this->config.setDev(replayFilePath);
@@ -46,3 +68,32 @@ void CanReplayForm::on_filePathPushButton_clicked()
 	}
 }
 
+void CanReplayForm::on_loopCheckBox_toggled(bool checked)
+{
+	// loop may change during replay, config is only taken while disconnected
+	this->config.setLoop(checked ? "on" : "off");
+	emit transportReq({{CmdDef::loop.name, this->config.getLoop()}});
+}
+
+void CanReplayForm::on_pausePushButton_toggled(bool checked)
+{
+	showPaused(checked);
+	emit transportReq({{CmdDef::replay.name, checked ? "pause" : "resume"}});
+}
+
+void CanReplayForm::on_stepFramePushButton_clicked()
+{
+	showPaused(true);
+	emit transportReq({{CmdDef::replay.name, "stepFrame"}});
+}
+
+void CanReplayForm::on_stepPacketPushButton_clicked()
+{
+	showPaused(true);
+	emit transportReq({{CmdDef::replay.name, "stepPacket"}});
+}
+
+void CanReplayForm::on_seekPushButton_clicked()
+{
+	emit transportReq({{CmdDef::seekMs.name, ui->seekLineEdit->text()}});
+}
@@ -1,6 +1,7 @@
 #ifndef CANREPLAYFORM_H
 #define CANREPLAYFORM_H
 
+#include <QMap>
 #include <QWidget>
 #include "config.h"
 
@@ -16,20 +17,37 @@ public:
 	explicit CanReplayForm(QWidget *parent = nullptr);
 	~CanReplayForm();
 	const ConfigReplay &getConfig(void);
+	/// @brief File is fixed while connected, transport works only while the connection is a replay.
+	void setConnected(bool isConnected, bool isReplay);
 public slots:
 	void onConfigLoaded(const ConfigReplay &configReplayRef);
 
 signals:
 	void cfgChanged(const ConfigReplay &configRef);
+	/// @brief Commands that work while a replay runs, see CmdDef::replay.
+	void transportReq(const QMap<QString, QString> &cmdMapRef);
 
 private slots:
 	void on_filePathLineEdit_editingFinished();
 
 	void on_filePathPushButton_clicked();
 
+	void on_loopCheckBox_toggled(bool checked);
+
+	void on_pausePushButton_toggled(bool checked);
+
+	void on_stepFramePushButton_clicked();
+
+	void on_stepPacketPushButton_clicked();
+
+	void on_seekPushButton_clicked();
+
 private:
 	Ui::CanReplayForm *ui;
 	ConfigReplay config;
+
+	/// @brief Shows replay as paused without asking for it again.
+	void showPaused(bool isPaused);
 };
 
 #endif // CANREPLAYFORM_H
@@ -25,6 +25,7 @@ CanTabForm::CanTabForm(QWidget *parent) :
 	connect(this->canFdFormPtr, &CanFdForm::cfgChanged, this, &CanTabForm::onFdCfgChanged);
 	connect(this->canStdFormPtr, &CanStdForm::cfgChanged, this, &CanTabForm::onStdCfgChanged);
 	connect(this->canReplayFormPtr, &CanReplayForm::cfgChanged, this, &CanTabForm::onReplayCfgChanged);
+	connect(this->canReplayFormPtr, &CanReplayForm::transportReq, this, &CanTabForm::cfgChanged);
 
 	connect(this, &CanTabForm::configFdLoaded, this->canFdFormPtr, &CanFdForm::onConfigLoaded);
 	connect(this, &CanTabForm::configStdLoaded, this->canStdFormPtr, &CanStdForm::onConfigLoaded);
@@ -65,6 +66,17 @@ const QMap<QString, QString> &CanTabForm::getCurrentConfig(void)
 	return this->currentConfig;
 }
 
+void CanTabForm::setConnected(bool isConnected)
+{
+	ui->stdCheckBox->setEnabled(!isConnected);
+	ui->fdCheckBox->setEnabled(!isConnected);
+	ui->replayCheckBox->setEnabled(!isConnected);
+	this->canStdFormPtr->setEnabled(!isConnected);
+	this->canFdFormPtr->setEnabled(!isConnected);
+	// interface checkboxes are locked while connected, the checked one is what got connected
+	this->canReplayFormPtr->setConnected(isConnected, ui->replayCheckBox->isChecked());
+}
+
 void CanTabForm::onStdCfgChanged(const ConfigStd &config)
 {
 	this->currentConfig = config.getMap();
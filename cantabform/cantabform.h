@@ -20,6 +20,8 @@ public:
 	~CanTabForm();
 
 	const QMap<QString, QString> &getCurrentConfig(void);
+	/// @brief Interface and its config are fixed while connected, replay transport is usable while a replay runs.
+	void setConnected(bool isConnected);
 public slots:
 	void onConfigAllLoaded(const ConfigAll &cfgAllRef);
 
@@ -0,0 +1,233 @@
+#include <cstring>
+#include "bufferedwriter.h"
+#include "util.h"
+
+BufferedWriter::BufferedWriter(void) :
+	file(),
+	threadPtr(nullptr),
+	frontBfr(),
+	backBfr(),
+	encodedBfr(),
+	blockEncoder(nullptr),
+	flushBytes(256 * 1024),
+	flushMs(200),
+	syncMs(0),
+	isRunning(false),
+	isWriteFailed(false),
+	isSyncPending(false),
+	isSyncFailed(false)
+{
+}
+
+BufferedWriter::~BufferedWriter()
+{
+	close();
+}
+
+void BufferedWriter::setFlush(size_t flushBytes, int flushMs)
+{
+	this->flushBytes = flushBytes > 0 ? flushBytes : 1;
+	this->flushMs = flushMs > 0 ? flushMs : 1;
+}
+
+void BufferedWriter::setSync(int syncMs)
+{
+	this->syncMs = syncMs > 0 ? syncMs : 0;
+}
+
+void BufferedWriter::setBlockEncoder(BlockEncoder blockEncoder)
+{
+	this->blockEncoder = blockEncoder;
+}
+
+bool BufferedWriter::open(const QString &filePathRef, const QByteArray &headerRef)
+{
+	close();
+
+	this->file.setFileName(filePathRef);
+	if(!this->file.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+	if(this->file.write(headerRef) != headerRef.size()) {
+		this->file.close();
+		return false;
+	}
+	this->frontBfr.reserve(this->flushBytes * maxBfrFactor);
+	this->backBfr.reserve(this->flushBytes * maxBfrFactor);
+	this->isRunning = true;
+	this->isWriteFailed = false;
+	// header counts as written data, a capture cut short still has it on disk
+	this->isSyncPending = true;
+	this->isSyncFailed = false;
+	this->syncTimer.start();
+	this->stats.bytesIn.add(headerRef.size());
+	this->stats.bytesWritten.add(headerRef.size());
+	this->threadPtr = QThread::create([this]() {
+		run();
+	});
+	this->threadPtr->start();
+	return true;
+}
+
+void BufferedWriter::close(void)
+{
+	if(this->threadPtr == nullptr) {
+		return;
+	}
+
+	this->mutex.lock();
+	this->isRunning = false;
+	this->writerCond.wakeAll();
+	this->mutex.unlock();
+
+	this->threadPtr->wait();
+	delete this->threadPtr;
+	this->threadPtr = nullptr;
+	this->file.close();
+}
+
+bool BufferedWriter::isOpen(void) const
+{
+	return this->threadPtr != nullptr;
+}
+
+QString BufferedWriter::errorString(void) const
+{
+	return this->file.errorString();
+}
+
+void BufferedWriter::write(const char *dataPtr, size_t size)
+{
+	QMutexLocker locker(&this->mutex);
+
+	// lossless, caller waits for disk when writer is far behind
+	while(this->isRunning && (size_t)this->frontBfr.size() >= this->flushBytes * maxBfrFactor) {
+		this->spaceCond.wait(&this->mutex);
+	}
+	if(this->frontBfr.isEmpty()) {
+		this->frontTimer.start();
+		// writer may be waiting without timeout, flushMs counts from now
+		this->writerCond.wakeOne();
+	}
+	if(this->blockEncoder != nullptr) {
+		// block boundaries have to survive until writer thread encodes them
+		const uint32_t blockSize = size;
+		this->frontBfr.append(reinterpret_cast<const char *>(&blockSize), sizeof(blockSize));
+	}
+	this->frontBfr.append(dataPtr, size);
+	if((size_t)this->frontBfr.size() >= this->flushBytes) {
+		this->writerCond.wakeOne();
+	}
+}
+
+/// Writer thread. File is only touched here while it runs.
+void BufferedWriter::run(void)
+{
+	QMutexLocker locker(&this->mutex);
+
+	while(true) {
+		if(this->frontBfr.isEmpty()) {
+			if(!this->isRunning) {
+				break;
+			}
+			if(this->syncMs == 0 || !this->isSyncPending) {
+				this->writerCond.wait(&this->mutex);
+				continue;
+			}
+			// quiet stretch, what was written last must not wait for the next write to get synced
+			const qint64 syncAgeMs = this->syncTimer.elapsed();
+			if(syncAgeMs < this->syncMs) {
+				this->writerCond.wait(&this->mutex, (unsigned long)(this->syncMs - syncAgeMs));
+				continue;
+			}
+			locker.unlock();
+			sync();
+			locker.relock();
+			continue;
+		}
+
+		const qint64 ageMs = this->frontTimer.elapsed();
+		const bool isDue =
+			(size_t)this->frontBfr.size() >= this->flushBytes ||
+			ageMs >= this->flushMs ||
+			!this->isRunning;
+		if(!isDue) {
+			this->writerCond.wait(&this->mutex, (unsigned long)(this->flushMs - ageMs));
+			continue;
+		}
+
+		this->frontBfr.swap(this->backBfr);
+		this->spaceCond.wakeOne();
+		locker.unlock();
+
+		QElapsedTimer busyTimer;
+		busyTimer.start();
+		if(this->blockEncoder == nullptr) {
+			this->stats.bytesIn.add(this->backBfr.size());
+			writeOut(this->backBfr);
+		} else {
+			const char *blockPtr = this->backBfr.constData();
+			const char *endPtr = blockPtr + this->backBfr.size();
+			uint32_t blockSize = 0;
+			while(blockPtr < endPtr) {
+				memcpy(&blockSize, blockPtr, sizeof(blockSize));
+				blockPtr += sizeof(blockSize);
+				this->blockEncoder(blockPtr, blockSize, this->encodedBfr);
+				this->stats.bytesIn.add(blockSize);
+				blockPtr += blockSize;
+			}
+			writeOut(this->encodedBfr);
+			this->encodedBfr.resize(0);
+		}
+		this->stats.busyNs.add(busyTimer.nsecsElapsed());
+		// keeps capacity, buffers are allocated once per open
+		this->backBfr.resize(0);
+		if(this->syncMs != 0) {
+			this->isSyncPending = true;
+			if(this->syncTimer.elapsed() >= this->syncMs) {
+				sync();
+			}
+		}
+
+		locker.relock();
+	}
+	locker.unlock();
+	if(this->syncMs != 0 && this->isSyncPending) {
+		sync();
+	}
+}
+
+void BufferedWriter::sync(void)
+{
+	QElapsedTimer busyTimer;
+
+	this->isSyncPending = false;
+	this->syncTimer.start();
+	if(this->isWriteFailed || this->isSyncFailed) {
+		return;
+	}
+	busyTimer.start();
+	if(Util::syncFile(this->file)) {
+		this->stats.syncs.add();
+	} else {
+		this->isSyncFailed = true;
+		Util::log(LogType::Generic, LogSt::Warn, "Failed to sync " + this->file.fileName() + " to disk: " + this->file.errorString());
+	}
+	this->stats.busyNs.add(busyTimer.nsecsElapsed());
+}
+
+void BufferedWriter::writeOut(const QByteArray &bfrRef)
+{
+	qint64 written = 0;
+
+	if(this->isWriteFailed) {
+		return;
+	}
+	written = this->file.write(bfrRef);
+	this->file.flush();
+	if(written != bfrRef.size()) {
+		this->isWriteFailed = true;
+		Util::log(LogType::Generic, LogSt::Nok, "Failed to write " + this->file.fileName() + ": " + this->file.errorString());
+	}
+	this->stats.bytesWritten.add(written > 0 ? written : 0);
+}
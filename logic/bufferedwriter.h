@@ -0,0 +1,81 @@
+/**
+ * @defgroup bufferedwriter_h
+ * @{
+ * @file bufferedwriter.h
+ * @brief Double-buffered file writer with its own thread.
+ * The caller appends to a front buffer, the writer thread swaps it with the back buffer and
+ * writes that one out, so the caller never waits on a syscall. A buffer is written once it
+ * holds flushBytes or its oldest byte is flushMs old, whichever comes first.
+ * With a block encoder set, every write() is one block that the writer thread encodes,
+ * for example compresses, before it goes to the file.
+ * With sync on, written data is also synced to disk at most syncMs after the previous sync,
+ * and on close. A power loss or OS crash then loses what came in during the last flushMs + syncMs,
+ * plus the time one write and sync take.
+ */
+#ifndef BUFFEREDWRITER_H
+#define BUFFEREDWRITER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <cstddef>
+#include <cstdint>
+#include "stats.h"
+
+/// @brief Turns one block into what is written to the file, appends to outRef.
+typedef void (*BlockEncoder)(const char *blockPtr, size_t blockSize, QByteArray &outRef);
+
+class BufferedWriter
+{
+public:
+	BufferedWriter(void);
+	~BufferedWriter();
+
+	/// @brief Only while closed.
+	void setFlush(size_t flushBytes, int flushMs);
+	/// @brief Only while closed, 0 leaves it to the OS when data reaches the disk.
+	void setSync(int syncMs);
+	/// @brief Only while closed, nullptr writes bytes as they are.
+	void setBlockEncoder(BlockEncoder blockEncoder);
+	/// @brief Header is written as is, before anything else and without the block encoder.
+	bool open(const QString &filePathRef, const QByteArray &headerRef = QByteArray());
+	/// @brief Writes out whatever is buffered and stops writer thread.
+	void close(void);
+	bool isOpen(void) const;
+	QString errorString(void) const;
+	/// @brief Single caller thread. Blocks only when writer falls behind by more than maxBfrFactor buffers.
+	void write(const char *dataPtr, size_t size);
+	/// @brief Adds up over opens, owner resets it.
+	WriterStats stats;
+private:
+	static const size_t maxBfrFactor = 4;
+	QFile file;
+	QThread *threadPtr;
+	QMutex mutex;
+	QWaitCondition writerCond;  //!< data arrived or close requested
+	QWaitCondition spaceCond;   //!< front buffer has room again
+	QByteArray frontBfr;        //!< caller appends here, guarded by mutex
+	QByteArray backBfr;         //!< writer thread only
+	QByteArray encodedBfr;      //!< writer thread only, back buffer after block encoder
+	BlockEncoder blockEncoder;
+	QElapsedTimer frontTimer;   //!< started when first byte lands in empty front buffer
+	QElapsedTimer syncTimer;    //!< writer thread only, time since last sync
+	size_t flushBytes;
+	int flushMs;
+	int syncMs;
+	bool isRunning;
+	bool isWriteFailed;
+	bool isSyncPending;         //!< writer thread only, written data not synced yet
+	bool isSyncFailed;          //!< writer thread only, failure is logged once
+	void run(void);
+	void writeOut(const QByteArray &bfrRef);
+	void sync(void);
+};
+
+#endif // BUFFEREDWRITER_H
+
+/// @}
@@ -4,17 +4,108 @@
 
 Can::Can(QObject *parent)
 	: QObject{parent}
+	, rxQueue(rxQueueCapacity)
 	, rxThread(nullptr)
+	, isRxRunning(false)
+	, isRxThreadActive(false)
 	, canMsg({
 		.id = 0,
 		.dataLength = 0,
 		.data = {0},
-		.timestamp = 0
+		.timestamp = 0,
+		.flags = 0,
+		.channel = 0
 	})
+	, rxTimestampBits(64)
+	, rxQueuePolicy(RxQueuePolicy::Block)
+	, rxQueueLimit(rxQueueCapacity)
+	, rxOverflowHead(0)
+	, rxOverflowCnt(0)
+	, rxSpillPos(0)
+	, rxSpillCnt(0)
+	, isTimestampMonotonic(false)
+	, rxNotify(RxNotify::Edge)
+	, rxNotifyNs(1000000)
+	, isRxNotifyPending(false)
+	, lastRxNotifyNs(0)
 {
 	qRegisterMetaType<CanEvent>("CanEvent");
 }
 
+void Can::configure(const ConfigGeneric &configRef)
+{
+	QString rxNotifyStr = configRef.getRxNotify();
+	QString rxQueuePolicyStr = configRef.getRxQueuePolicy();
+	size_t rxQueueSize = configRef.getRxQueueSize().toULongLong();
+
+	if(rxNotifyStr == RxNotifyType::Frame) {
+		this->rxNotify = RxNotify::Frame;
+	} else if(rxNotifyStr == RxNotifyType::Rate) {
+		this->rxNotify = RxNotify::Rate;
+	} else {
+		this->rxNotify = RxNotify::Edge;
+	}
+	this->rxNotifyNs = configRef.getRxNotifyUs().toLongLong() * 1000;
+	this->isTimestampMonotonic = configRef.getTimestampBase() == TimestampBaseType::Monotonic;
+
+	if(rxQueuePolicyStr == RxQueuePolicyType::DropOldest) {
+		this->rxQueuePolicy = RxQueuePolicy::DropOldest;
+	} else if(rxQueuePolicyStr == RxQueuePolicyType::DropNewest) {
+		this->rxQueuePolicy = RxQueuePolicy::DropNewest;
+	} else if(rxQueuePolicyStr == RxQueuePolicyType::Spill) {
+		this->rxQueuePolicy = RxQueuePolicy::Spill;
+	} else {
+		this->rxQueuePolicy = RxQueuePolicy::Block;
+	}
+	// ring is allocated once, the limit can only shrink it
+	if(rxQueueSize == 0 || rxQueueSize > this->rxQueue.capacity()) {
+		rxQueueSize = this->rxQueue.capacity();
+	}
+	this->rxQueueLimit = rxQueueSize;
+	// only while disconnected, rx thread owns it while running
+	this->rxOverflowArr.resize(this->rxQueuePolicy == RxQueuePolicy::DropOldest ? (int)rxQueueSize : 0);
+	this->rxOverflowHead = 0;
+	this->rxOverflowCnt.store(0);
+}
+
+/// Consumer calls this before draining rx queue. Anything pushed after
+/// this point raises a new MessageReceived, so no frame is left behind.
+void Can::ackRx(void)
+{
+	this->isRxNotifyPending.store(false);
+}
+
+/// Only the rx queue consumer may call this. With DropOldest policy the rx
+/// thread cannot pop itself. While frames wait in overflow, queued frames are
+/// older than all of them, so as many are thrown away here as it takes for
+/// queue and overflow together to hold no more than rxQueueLimit.
+size_t Can::popRx(CanMsg *canMsgPtr, size_t maxNumOfMsg)
+{
+	if(this->rxOverflowCnt.load() == 0) {
+		return this->rxQueue.tryPopN(canMsgPtr, maxNumOfMsg);
+	}
+
+	QMutexLocker locker(&this->rxOverflowMutex);
+	const size_t numOfBacklog = this->rxQueue.size() + this->rxOverflowCnt.load();
+	size_t numOfDrop = numOfBacklog > this->rxQueueLimit ? numOfBacklog - this->rxQueueLimit : 0;
+
+	while(numOfDrop != 0) {
+		size_t numOfPopped = this->rxQueue.tryPopN(canMsgPtr, numOfDrop < maxNumOfMsg ? numOfDrop : maxNumOfMsg);
+		if(numOfPopped == 0) {
+			break;
+		}
+		numOfDrop -= numOfPopped;
+		this->rxStats.framesDropped.add(numOfPopped);
+	}
+	locker.unlock();
+	return this->rxQueue.tryPopN(canMsgPtr, maxNumOfMsg);
+}
+
+size_t Can::getRxQueueLimit(void) const
+{
+	return this->rxQueueLimit;
+}
+
 bool Can::isConnected(void) const
 {
 	return this->rxThread != nullptr;
@@ -22,73 +113,322 @@ bool Can::isConnected(void) const
 
 void Can::stopRxThread(void)
 {
-	if(this->rxThread != nullptr) {
-		this->rxThread->exit();
-		this->rxThread = nullptr;
+	QThread *threadPtr = this->rxThread;
+
+	if(threadPtr == nullptr) {
+		// may have stopped itself and still be on its way out, the backend goes away next
+		waitRxThreadExit();
+		return;
+	}
+	this->rxThread = nullptr;
+	this->isRxRunning.store(false);
+	wakeRx();
+	// backend may disconnect itself from rx thread, it cannot wait on itself
+	if(QThread::currentThread() != threadPtr) {
+		threadPtr->wait();
+	}
+	clearRxSpill();
+	clearRxOverflow();
+}
+
+void Can::waitRxThreadExit(void)
+{
+	while(this->isRxThreadActive.load()) {
+		QThread::yieldCurrentThread();
 	}
 }
 
 void Can::startRxThread(void)
 {
+	waitRxThreadExit();
+	this->isRxNotifyPending.store(false);
+	this->lastRxNotifyNs = 0;
+	this->rxNotifyTimer.start();
+	this->rxTimestamp.reset(this->isTimestampMonotonic, this->rxTimestampBits);
+	clearRxSpill();
+	clearRxOverflow();
+	this->rxStats.reset();
+	this->isRxRunning.store(true);
+	this->isRxThreadActive.store(true);
 	this->rxThread = QThread::create([this]() {
-		while(isConnected()) {
+		while(this->isRxRunning.load()) {
 			rx();
+			if(refillRxFromSpill() + refillRxFromOverflow() != 0) {
+				notifyRx();
+			}
+			flushRxNotify();
 		}
+		// last access to this
+		this->isRxThreadActive.store(false);
 	});
+	QObject::connect(this->rxThread, &QThread::finished, this->rxThread, &QObject::deleteLater);
 	this->rxThread->start();
 }
 
-QString Can::getMsgStr(const CanMsg &canMsgRef)
+/// Only the rx thread may call this, the queue has a single producer.
+/// What happens when the queue is full depends on rxQueuePolicy.
+void Can::pushRx(const CanMsg &canMsgRef)
 {
-	QString s = QString("ID: %1, DL: %2, ")
-		.arg(canMsgRef.id, 0, 16)
-		.arg(canMsgRef.dataLength, 2, 16, QChar('0'));
-	for(int i = 0; i < canMsgRef.dataLength; ++i) {
-		s += QString("%1 ").arg(canMsgRef.data[i], 2, 16, QChar('0'));
-	}
-	return s;
+	pushRx(&canMsgRef, 1);
 }
 
-bool Can::getCanMsgFromRaw(const uint8_t *rawCanMsgPtr, size_t rawCanMsgSize, CanMsg &canMsgRef)
+void Can::pushRx(const CanMsg *canMsgPtr, size_t numOfMsg)
 {
-	if(rawCanMsgSize > sizeof(CanMsg)) {
-		return false;
+	size_t numOfPushed = 0;
+
+	this->rxStats.framesRead.add(numOfMsg);
+	if(this->rxQueuePolicy == RxQueuePolicy::Spill) {
+		pushRxSpill(canMsgPtr, numOfMsg);
+		return;
+	}
+	if(this->rxQueuePolicy == RxQueuePolicy::DropOldest) {
+		pushRxOverflow(canMsgPtr, numOfMsg);
+		return;
 	}
+	while(true) {
+		numOfPushed += pushRxQueue(canMsgPtr + numOfPushed, numOfMsg - numOfPushed);
+		if(numOfPushed == numOfMsg || !this->isRxRunning.load()) {
+			break;
+		}
+		if(this->rxQueuePolicy == RxQueuePolicy::DropNewest) {
+			break;
+		}
+		QThread::yieldCurrentThread();
+	}
+	this->rxStats.framesDropped.add(numOfMsg - numOfPushed);
+}
 
-	uint64_t offset = 0;
+/// Never waits for decoder. Frames go to overflow while anything older still waits there, so
+/// order is kept. Overflow holds the newest rxQueueLimit frames, consumer drops the queued ones
+/// they replace, see popRx.
+void Can::pushRxOverflow(const CanMsg *canMsgPtr, size_t numOfMsg)
+{
+	size_t numOfPushed = 0;
 
-	memcpy((void *)&canMsgRef.id, (void *)rawCanMsgPtr, sizeof(CanMsg::id));
-	offset += sizeof(CanMsg::id);
-	memcpy((void *)&canMsgRef.dataLength, (void *)(rawCanMsgPtr + offset), sizeof(CanMsg::dataLength));
-	offset += sizeof(CanMsg::dataLength);
-	memcpy(canMsgRef.data, (void *)(rawCanMsgPtr + offset), canMsgRef.dataLength);
-	offset += canMsgRef.dataLength;
-	memcpy((void *)&canMsgRef.timestamp, (void *)(rawCanMsgPtr + offset), sizeof(CanMsg::timestamp));
-	offset += sizeof(CanMsg::timestamp);
+	refillRxFromOverflow();
+	if(this->rxOverflowCnt.load() == 0) {
+		numOfPushed = pushRxQueue(canMsgPtr, numOfMsg);
+	}
+	if(numOfPushed == numOfMsg) {
+		return;
+	}
 
-	if(offset != rawCanMsgSize) {
-		return false;
+	QMutexLocker locker(&this->rxOverflowMutex);
+	const size_t capacity = this->rxOverflowArr.size();
+	size_t cnt = this->rxOverflowCnt.load();
+
+	for(size_t i = numOfPushed; i < numOfMsg; ++i) {
+		if(cnt == capacity) {
+			// full overflow means everything queued is dropped on next pop, its oldest goes now
+			this->rxOverflowHead = this->rxOverflowHead + 1 == capacity ? 0 : this->rxOverflowHead + 1;
+			--cnt;
+			this->rxStats.framesDropped.add();
+		}
+		const size_t pos = this->rxOverflowHead + cnt;
+		this->rxOverflowArr[(int)(pos < capacity ? pos : pos - capacity)] = canMsgPtr[i];
+		++cnt;
 	}
-	return true;
+	this->rxOverflowCnt.store(cnt);
 }
 
-size_t Can::getRawCanMsg(const CanMsg &canMsgRef, uint8_t *rawCanMsgPtr, size_t rawCanMsgSize)
+/// Rx thread only. Moves overflow into rx queue as far as it has room, returns number moved.
+size_t Can::refillRxFromOverflow(void)
 {
-	if(rawCanMsgSize < sizeof(CanMsg)) {
+	size_t numOfRefilled = 0;
+
+	if(this->rxOverflowCnt.load() == 0) {
 		return 0;
 	}
 
-	uint64_t offset = 0;
+	QMutexLocker locker(&this->rxOverflowMutex);
+	const size_t capacity = this->rxOverflowArr.size();
+	size_t cnt = this->rxOverflowCnt.load();
+
+	while(cnt != 0) {
+		// ring wraps, push what is contiguous
+		const size_t numOfChunk = cnt < capacity - this->rxOverflowHead ? cnt : capacity - this->rxOverflowHead;
+		const size_t numOfPushed = pushRxQueue(this->rxOverflowArr.constData() + this->rxOverflowHead, numOfChunk);
+		this->rxOverflowHead += numOfPushed;
+		if(this->rxOverflowHead == capacity) {
+			this->rxOverflowHead = 0;
+		}
+		cnt -= numOfPushed;
+		numOfRefilled += numOfPushed;
+		if(numOfPushed != numOfChunk) {
+			break;
+		}
+	}
+	this->rxOverflowCnt.store(cnt);
+	return numOfRefilled;
+}
+
+/// Only while rx thread is not running, whatever is still in overflow is lost.
+void Can::clearRxOverflow(void)
+{
+	QMutexLocker locker(&this->rxOverflowMutex);
+
+	this->rxStats.framesDropped.add(this->rxOverflowCnt.exchange(0));
+	this->rxOverflowHead = 0;
+}
+
+/// Pushes as many frames as fit below rxQueueLimit, returns number pushed.
+size_t Can::pushRxQueue(const CanMsg *canMsgPtr, size_t numOfMsg)
+{
+	size_t size = this->rxQueue.size();
+	size_t room = size < this->rxQueueLimit ? this->rxQueueLimit - size : 0;
+	size_t numOfPushed = 0;
+
+	if(numOfMsg > room) {
+		numOfMsg = room;
+	}
+	if(numOfMsg != 0) {
+		numOfPushed = this->rxQueue.pushN(canMsgPtr, numOfMsg);
+	}
+	this->rxStats.framesQueued.add(numOfPushed);
+	this->rxStats.queueHighWater.update(this->rxQueue.size());
+	return numOfPushed;
+}
+
+/// Frames go to spill file while anything older still waits there, so order is kept.
+void Can::pushRxSpill(const CanMsg *canMsgPtr, size_t numOfMsg)
+{
+	size_t numOfPushed = 0;
+	size_t numOfSpilled = 0;
+
+	refillRxFromSpill();
+	if(isRxSpillEmpty()) {
+		numOfPushed = pushRxQueue(canMsgPtr, numOfMsg);
+	}
+	if(numOfPushed != numOfMsg) {
+		numOfSpilled = this->rxSpill.write(canMsgPtr + numOfPushed, numOfMsg - numOfPushed);
+		this->rxStats.framesSpilled.add(numOfSpilled);
+	}
+	this->rxStats.framesDropped.add(numOfMsg - numOfPushed - numOfSpilled);
+}
+
+/// Moves spilled frames back into rx queue as far as it has room, returns number moved.
+size_t Can::refillRxFromSpill(void)
+{
+	size_t numOfRefilled = 0;
+
+	while(true) {
+		if(this->rxSpillPos == this->rxSpillCnt) {
+			this->rxSpillPos = 0;
+			this->rxSpillCnt = this->rxSpill.isEmpty() ? 0 : this->rxSpill.read(this->rxSpillArr, rxBurstSize);
+			if(this->rxSpillCnt == 0) {
+				break;
+			}
+		}
+		size_t numOfPushed = pushRxQueue(this->rxSpillArr + this->rxSpillPos, this->rxSpillCnt - this->rxSpillPos);
+		this->rxSpillPos += numOfPushed;
+		numOfRefilled += numOfPushed;
+		if(this->rxSpillPos != this->rxSpillCnt) {
+			break;
+		}
+	}
+	return numOfRefilled;
+}
+
+bool Can::isRxSpillEmpty(void) const
+{
+	return this->rxSpillPos == this->rxSpillCnt && this->rxSpill.isEmpty();
+}
 
-	memcpy((void *)rawCanMsgPtr, (void *)&canMsgRef.id, sizeof(CanMsg::id));
-	offset += sizeof(CanMsg::id);
-	memcpy((void *)(rawCanMsgPtr + offset), (void *)&canMsgRef.dataLength, sizeof(CanMsg::dataLength));
-	offset += sizeof(CanMsg::dataLength);
-	memcpy((void *)(rawCanMsgPtr + offset), canMsgRef.data, canMsgRef.dataLength);
-	offset += canMsgRef.dataLength;
-	memcpy((void *)(rawCanMsgPtr + offset), &canMsgRef.timestamp, sizeof(CanMsg::timestamp));
-	offset += sizeof(CanMsg::timestamp);
-	return offset;
+/// End of input is not a disconnect by the user, spilled and overflowed frames are still owed to the decoder.
+/// A disconnect meanwhile stops waiting, the rest is dropped as on any disconnect.
+void Can::drainRxSpill(void)
+{
+	while(this->isRxRunning.load() && !(isRxSpillEmpty() && this->rxOverflowCnt.load() == 0)) {
+		if(refillRxFromSpill() + refillRxFromOverflow() != 0) {
+			notifyRx();
+		}
+		QThread::usleep(getRxWaitUs());
+	}
+	flushRxNotify();
+}
+
+/// Only while rx thread is not running, whatever is still spilled is lost.
+void Can::clearRxSpill(void)
+{
+	size_t numOfDropped = (this->rxSpillCnt - this->rxSpillPos) + this->rxSpill.clear();
+
+	this->rxSpillPos = 0;
+	this->rxSpillCnt = 0;
+	this->rxStats.framesDropped.add(numOfDropped);
+}
+
+void Can::emitRxNotify(void)
+{
+	this->lastRxNotifyNs = this->rxNotifyTimer.nsecsElapsed();
+	emit eventOccured(CanEvent::MessageReceived);
+}
+
+/// Called by rx thread after frames are pushed. Event loop load follows
+/// the number of wake ups instead of the number of frames.
+void Can::notifyRx(void)
+{
+	switch(this->rxNotify) {
+	case RxNotify::Frame:
+		emitRxNotify();
+		break;
+	case RxNotify::Edge:
+		if(!this->isRxNotifyPending.exchange(true)) {
+			emitRxNotify();
+		}
+		break;
+	case RxNotify::Rate:
+		if(this->isRxNotifyPending.load()) {
+			break;
+		}
+		if((this->rxNotifyTimer.nsecsElapsed() - this->lastRxNotifyNs) < this->rxNotifyNs) {
+			// flushRxNotify picks it up once interval has passed
+			break;
+		}
+		if(!this->isRxNotifyPending.exchange(true)) {
+			emitRxNotify();
+		}
+		break;
+	}
+}
+
+/// How long rx may block waiting for frames. In rate mode this is what keeps
+/// a held back notification within its latency bound.
+int64_t Can::getRxWaitUs(void) const
+{
+	const int64_t idleWaitUs = 100000;
+	// decoder makes room without telling rx thread, spilled and overflowed frames are polled back in
+	const int64_t spillWaitUs = 1000;
+	int64_t maxWaitUs = isRxSpillEmpty() && this->rxOverflowCnt.load() == 0 ? idleWaitUs : spillWaitUs;
+
+	if(this->rxNotify == RxNotify::Rate) {
+		int64_t waitUs = this->rxNotifyNs / 1000;
+		return waitUs < maxWaitUs ? (waitUs > 0 ? waitUs : 1) : maxWaitUs;
+	}
+	return maxWaitUs;
+}
+
+/// Rate mode may hold back a notification, this releases it once the
+/// interval passes even if no new frame arrives.
+void Can::flushRxNotify(void)
+{
+	if(this->rxNotify != RxNotify::Rate) {
+		return;
+	}
+	if(this->rxQueue.isEmpty()) {
+		return;
+	}
+	notifyRx();
+}
+
+QString Can::getMsgStr(const CanMsg &canMsgRef)
+{
+	QString s = QString("ID: %1, DL: %2, ")
+		.arg(canMsgRef.id, 0, 16)
+		.arg(canMsgRef.dataLength, 2, 16, QChar('0'));
+	for(int i = 0; i < canMsgRef.dataLength; ++i) {
+		s += QString("%1 ").arg(canMsgRef.data[i], 2, 16, QChar('0'));
+	}
+	return s;
 }
 
 void Can::printMsg(const CanMsg &canMsgRef)
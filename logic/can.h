@@ -3,18 +3,20 @@
 
 #include <QThread>
 #include <QObject>
+#include <QElapsedTimer>
 #include <QMutex>
-#include <QQueue>
-#include <QMutexLocker>
+#include <QVector>
+#include <atomic>
 #include <cstdint>
+#include "canmsg.h"
+#include "framering.h"
+#include "config.h"
+#include "rxspill.h"
+#include "stats.h"
+#include "timestamp.h"
 
-typedef struct
-{
-	uint32_t id;
-	uint8_t dataLength;
-	uint8_t data[64];
-	uint64_t timestamp;
-} CanMsg;
+/// @brief Compact frame storage, CanMsg is only a view on push and pop.
+typedef FrameRing<CanMsg> CanFrameRing;
 
 enum class CanEvent
 {
@@ -25,32 +27,21 @@ enum class CanEvent
 
 Q_DECLARE_METATYPE(CanEvent)
 
-template <typename T>
-class ThreadSafeQueue {
-public:
-	void enqueue(const T& value) {
-		QMutexLocker locker(&mutex);
-		queue.enqueue(value);
-	}
-
-	T dequeue() {
-	QMutexLocker locker(&mutex);
-		if (queue.isEmpty()) {
-			throw std::runtime_error("Queue is empty");
-		}
-		return queue.dequeue();
-	}
-
-	bool isEmpty() const {
-		QMutexLocker locker(&mutex);
-		return queue.isEmpty();
-	}
-
-private:
-	QQueue<T> queue;
-	mutable QMutex mutex;
+enum class RxNotify
+{
+	Edge,
+	Rate,
+	Frame
 };
 
+/// @brief What rx thread does when rx queue is full.
+enum class RxQueuePolicy
+{
+	Block,      //!< wait for decoder, driver buffers meanwhile
+	DropOldest, //!< frames that do not fit wait in a side buffer, decoder throws away oldest to keep the newest rxQueueLimit
+	DropNewest, //!< frames that do not fit are thrown away
+	Spill       //!< frames that do not fit go to a temporary file and come back later
+};
 
 class Can : public QObject
 {
@@ -63,20 +54,69 @@ public:
 	virtual void disconnect(void) = 0;
 	virtual void rx(void) = 0;
 
+	void configure(const ConfigGeneric &configRef);
+	void ackRx(void);
+	/// @brief Consumer side of rx queue.
+	size_t popRx(CanMsg *canMsgPtr, size_t maxNumOfMsg);
+	size_t getRxQueueLimit(void) const;
 	bool isConnected(void) const;
 	static void printMsg(const CanMsg &canMsgRef);
 	static QString getMsgStr(const CanMsg &canMsgRef);
-	bool getCanMsgFromRaw(const uint8_t *rawCanMsgPtr, size_t rawCanMsgSize, CanMsg &canMsgRef);
-	static size_t getRawCanMsg(const CanMsg &canMsgRef, uint8_t *rawCanMsgPtr, size_t rawCanMsgSize);
 
-	ThreadSafeQueue<CanMsg> rxQueue;
+	static const size_t rxQueueCapacity = 16384;
+	CanFrameRing rxQueue;
+	RxStats rxStats;
 signals:
 	void eventOccured(CanEvent event);
 protected:
 	void stopRxThread(void);
 	void startRxThread(void);
+	void pushRx(const CanMsg &canMsgRef);
+	void pushRx(const CanMsg *canMsgPtr, size_t numOfMsg);
+	void notifyRx(void);
+	void flushRxNotify(void);
+	/// @brief Rx thread only, before a backend ends it itself. Waits until spilled and overflowed frames are queued.
+	void drainRxSpill(void);
+	int64_t getRxWaitUs(void) const;
+	/// @brief Backends that block in rx override this to unblock it on disconnect.
+	virtual void wakeRx(void) {}
+	/// @brief Waits until a rx thread that stopped itself has left, backend state is its own again.
+	/// Not from rx thread.
+	void waitRxThreadExit(void);
 	QThread *rxThread;
+	std::atomic<bool> isRxRunning;
+	std::atomic<bool> isRxThreadActive; //!< until rx thread left, stays true a little after isConnected when it stopped itself
 	CanMsg canMsg;
+	static const size_t rxBurstSize = 64;
+	CanMsg rxBurstArr[rxBurstSize]; //!< rx thread collects a driver burst here
+	TimestampNormalizer rxTimestamp; //!< rx thread only, reset on every start
+	unsigned rxTimestampBits; //!< width of device counter in microseconds
+private:
+	RxQueuePolicy rxQueuePolicy;
+	size_t rxQueueLimit;
+	QMutex rxOverflowMutex;           //!< guards rxOverflowArr while it is not empty, DropOldest only
+	QVector<CanMsg> rxOverflowArr;    //!< newest frames that did not fit, ring of rxQueueLimit
+	size_t rxOverflowHead;            //!< oldest frame in rxOverflowArr
+	std::atomic<size_t> rxOverflowCnt; //!< written by rx thread under mutex, consumer checks it lock free
+	RxSpill rxSpill;
+	CanMsg rxSpillArr[rxBurstSize]; //!< read back from spill, not yet in rx queue
+	size_t rxSpillPos;
+	size_t rxSpillCnt;
+	bool isTimestampMonotonic;
+	RxNotify rxNotify;
+	int64_t rxNotifyNs;
+	std::atomic<bool> isRxNotifyPending;
+	QElapsedTimer rxNotifyTimer;
+	int64_t lastRxNotifyNs;
+	void emitRxNotify(void);
+	size_t pushRxQueue(const CanMsg *canMsgPtr, size_t numOfMsg);
+	void pushRxOverflow(const CanMsg *canMsgPtr, size_t numOfMsg);
+	size_t refillRxFromOverflow(void);
+	void clearRxOverflow(void);
+	void pushRxSpill(const CanMsg *canMsgPtr, size_t numOfMsg);
+	size_t refillRxFromSpill(void);
+	bool isRxSpillEmpty(void) const;
+	void clearRxSpill(void);
 };
 
 #endif // CAN_H
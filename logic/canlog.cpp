@@ -0,0 +1,274 @@
+#include <QDateTime>
+#include "canlog.h"
+#include "util.h"
+
+CanLog::CanLog(StageQueue<CanMsg, CanFrameRing> *frameQueuePtr, QObject *parent) :
+	QObject(parent),
+	frameQueuePtr(frameQueuePtr),
+	writer(),
+	canLogFilePath(""),
+	encodedBfr(),
+	fileOffset(0),
+	blockIndex({}),
+	index(),
+	isCompressed(false),
+	flushMs(200),
+	blockBfr(),
+	blockTimer(),
+	idleTimer(this),
+	rotation(),
+	segmentList(),
+	segmentStartBytes(0)
+{
+	this->encodedBfr.reserve((batchSize + 1) * CaptureFormat::maxEncodedRecordSize);
+	connect(&this->idleTimer, &QTimer::timeout, this, &CanLog::onIdleTimer);
+}
+
+CanLog::~CanLog()
+{
+	close();
+}
+
+void CanLog::setFlush(size_t flushBytes, int flushMs)
+{
+	this->writer.setFlush(flushBytes, flushMs);
+	this->flushMs = flushMs;
+}
+
+void CanLog::setSync(int syncMs)
+{
+	this->writer.setSync(syncMs);
+}
+
+void CanLog::setCompress(bool isCompressed)
+{
+	this->isCompressed = isCompressed;
+}
+
+void CanLog::setRotation(uint64_t maxBytes, int maxMin, unsigned keep)
+{
+	this->rotation.configure(maxBytes, maxMin, keep);
+}
+
+const WriterStats &CanLog::getWriterStats(void) const
+{
+	return this->writer.stats;
+}
+
+void CanLog::open(const QString &logDirPathRef)
+{
+	if(this->writer.isOpen()) {
+		Util::log(LogType::Generic, LogSt::Warn, "Can log file closed: " + this->canLogFilePath);
+		closeSegment();
+	}
+
+	this->rotation.start(logDirPathRef + "/" + Util::getFileName());
+	this->segmentList.clear();
+	// stats cover all segments of a capture
+	this->writer.stats.reset();
+	openSegment();
+	// timer is a child, it lives on the thread the log was moved to, as open does
+	if(this->isCompressed || this->rotation.isEnabled()) {
+		this->idleTimer.start(this->flushMs);
+	}
+}
+
+void CanLog::openSegment(void)
+{
+	this->canLogFilePath = this->rotation.getPath(".cobs");
+	uint8_t header[CaptureFormat::fileHeaderSize];
+	CaptureFormat::writeFileHeader(
+		header,
+		QDateTime::currentMSecsSinceEpoch() * 1000ULL,
+		this->isCompressed ? CaptureFormat::fileFlagCompressed : 0
+	);
+	// compression runs on writer thread, block by block
+	this->writer.setBlockEncoder(this->isCompressed ? CaptureFormat::compressBlock : nullptr);
+	this->segmentStartBytes = this->writer.stats.bytesWritten.get();
+	if(this->writer.open(this->canLogFilePath, QByteArray(reinterpret_cast<const char *>(header), sizeof(header)))) {
+		this->fileOffset = sizeof(header);
+		this->blockIndex = {};
+		this->blockBfr.resize(0);
+		this->blockBfr.reserve(CaptureFormat::compressedHeaderSize + CaptureFormat::compressedBlockSize + CaptureFormat::maxRecordSize);
+		if(!this->isCompressed && !this->index.create(CaptureIndex::getPath(this->canLogFilePath))) {
+			Util::log(LogType::Generic, LogSt::Warn, "Failed to create index, replay builds it: " + CaptureIndex::getPath(this->canLogFilePath));
+		}
+		Util::log(LogType::Generic, LogSt::Ok, "CAN log file opened: " + this->canLogFilePath);
+		if(this->rotation.isEnabled()) {
+			updateManifest();
+		}
+	} else {
+		// running on sink thread, nobody to catch an exception here
+		Util::log(LogType::Generic, LogSt::Nok, "Failed to open CAN log file: " + this->canLogFilePath);
+		this->canLogFilePath = "";
+	}
+}
+
+void CanLog::close(void)
+{
+	this->idleTimer.stop();
+	drain();
+	closeSegment();
+}
+
+void CanLog::closeSegment(void)
+{
+	if(!this->writer.isOpen()) {
+		return;
+	}
+	if(this->blockIndex.numOfFrames != 0) {
+		if(this->isCompressed) {
+			writeCompressedBlock();
+		} else {
+			writeBlockIndex();
+			flushEncoded();
+		}
+	}
+	this->writer.close();
+	this->index.finish(this->fileOffset);
+	Util::log(
+		LogType::Generic,
+		LogSt::Ok,
+		QString("Can log file closed: %1, %2 bytes")
+			.arg(this->canLogFilePath)
+			.arg(this->writer.stats.bytesWritten.get() - this->segmentStartBytes)
+	);
+	this->canLogFilePath = "";
+}
+
+/// Segment goes into manifest as soon as it is opened, so a capture cut short still replays
+/// up to its last frame. Segments that fell out of keep leave it.
+void CanLog::updateManifest(void)
+{
+	const QString manifestPath = this->rotation.getBasePath() + CaptureStream::manifestExt;
+
+	this->segmentList.append(this->canLogFilePath);
+	for(const QString &removedRef : this->rotation.removeExpired({ ".cobs", CaptureIndex::getPath(".cobs") })) {
+		this->segmentList.removeAll(removedRef);
+	}
+	if(!CaptureStream::writeManifest(manifestPath, this->segmentList)) {
+		Util::log(LogType::Generic, LogSt::Nok, "Failed to write manifest: " + manifestPath);
+	}
+}
+
+void CanLog::onFramesReady(void)
+{
+	drain();
+}
+
+void CanLog::onIdleTimer(void)
+{
+	if(!this->writer.isOpen()) {
+		return;
+	}
+	writeOldBlock();
+	// segment of rotateMin ends on time without frames coming in
+	rotate();
+}
+
+void CanLog::drain(void)
+{
+	size_t numOfMsg = 0;
+
+	this->frameQueuePtr->ack();
+	while((numOfMsg = this->frameQueuePtr->tryPopN(this->batchArr, batchSize)) != 0) {
+		if(!this->writer.isOpen()) {
+			continue;
+		}
+		for(size_t i = 0; i < numOfMsg; ++i) {
+			write(this->batchArr[i]);
+		}
+		if(!this->isCompressed) {
+			flushEncoded();
+		}
+		rotate();
+	}
+	writeOldBlock();
+}
+
+void CanLog::rotate(void)
+{
+	if(this->rotation.isDue(this->writer.stats.bytesWritten.get() - this->segmentStartBytes)) {
+		closeSegment();
+		this->rotation.next();
+		openSegment();
+	}
+}
+
+/// A quiet bus must not hold a partial block back for long.
+void CanLog::writeOldBlock(void)
+{
+	if(this->isCompressed && this->blockIndex.numOfFrames != 0 && this->blockTimer.elapsed() >= this->flushMs) {
+		writeCompressedBlock();
+	}
+}
+
+void CanLog::flushEncoded(void)
+{
+	this->writer.write(this->encodedBfr.constData(), this->encodedBfr.size());
+	this->fileOffset += this->encodedBfr.size();
+	this->encodedBfr.resize(0);
+}
+
+/// Appends one encoded frame record to encodedBfr, closes the block when it is full.
+/// Compressed mode collects plain records in blockBfr instead.
+void CanLog::write(const CanMsg &canMsgRef)
+{
+	uint8_t record[CaptureFormat::maxRecordSize];
+	uint8_t encoded[CaptureFormat::maxEncodedRecordSize];
+
+	if(this->isCompressed) {
+		if(this->blockIndex.numOfFrames == 0) {
+			// header is filled in once block is complete
+			this->blockBfr.fill(0, CaptureFormat::compressedHeaderSize);
+			this->blockIndex.firstTimestamp = canMsgRef.timestamp;
+			this->blockTimer.start();
+		}
+		size_t recordSize = CaptureFormat::encodeFrame(canMsgRef, record);
+		this->blockBfr.append(reinterpret_cast<const char *>(record), recordSize);
+		this->blockIndex.lastTimestamp = canMsgRef.timestamp;
+		++this->blockIndex.numOfFrames;
+		if((size_t)this->blockBfr.size() >= CaptureFormat::compressedHeaderSize + CaptureFormat::compressedBlockSize) {
+			writeCompressedBlock();
+		}
+		return;
+	}
+
+	if(this->blockIndex.numOfFrames == 0) {
+		this->blockIndex.blockOffset = this->fileOffset + this->encodedBfr.size();
+		this->blockIndex.firstTimestamp = canMsgRef.timestamp;
+	}
+	size_t recordSize = CaptureFormat::encodeFrame(canMsgRef, record);
+	size_t encodedSize = CaptureFormat::encodeRecord(record, recordSize, encoded);
+	this->encodedBfr.append(reinterpret_cast<const char *>(encoded), encodedSize);
+	this->blockIndex.lastTimestamp = canMsgRef.timestamp;
+	++this->blockIndex.numOfFrames;
+
+	if(this->blockIndex.numOfFrames == CaptureFormat::blockFrames) {
+		writeBlockIndex();
+	}
+}
+
+void CanLog::writeCompressedBlock(void)
+{
+	const uint32_t uncompressedSize = this->blockBfr.size() - CaptureFormat::compressedHeaderSize;
+
+	CaptureFormat::encodeCompressedHeader(this->blockIndex, uncompressedSize, reinterpret_cast<uint8_t *>(this->blockBfr.data()));
+	this->writer.write(this->blockBfr.constData(), this->blockBfr.size());
+	this->blockBfr.resize(0);
+	this->blockIndex.firstFrame += this->blockIndex.numOfFrames;
+	this->blockIndex.numOfFrames = 0;
+}
+
+void CanLog::writeBlockIndex(void)
+{
+	uint8_t record[CaptureFormat::blockIndexSize];
+	uint8_t encoded[CaptureFormat::maxEncodedRecordSize];
+
+	size_t recordSize = CaptureFormat::encodeBlockIndex(this->blockIndex, record);
+	size_t encodedSize = CaptureFormat::encodeRecord(record, recordSize, encoded);
+	this->encodedBfr.append(reinterpret_cast<const char *>(encoded), encodedSize);
+	this->index.append(this->blockIndex);
+	this->blockIndex.firstFrame += this->blockIndex.numOfFrames;
+	this->blockIndex.numOfFrames = 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * @defgroup canlog_h
+ * @{
+ * @file canlog.h
+ * @brief Raw CAN log sink of the capture pipeline.
+ * Every received frame is written to a .cobs capture, see captureformat.h, which can be
+ * replayed later with ReplayCan. Frames are encoded on the sink thread, file writes happen
+ * on a BufferedWriter thread in large blocks. Plain captures get their .idx written along,
+ * see captureindex.h. With rotation on, the capture is split into segments that are complete
+ * captures each, a manifest lists them, see capturestream.h.
+ */
+#ifndef CANLOG_H
+#define CANLOG_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include "bufferedwriter.h"
+#include "can.h"
+#include "captureformat.h"
+#include "captureindex.h"
+#include "capturestream.h"
+#include "rotation.h"
+#include "spscqueue.h"
+
+class CanLog : public QObject
+{
+	Q_OBJECT
+public:
+	explicit CanLog(StageQueue<CanMsg, CanFrameRing> *frameQueuePtr, QObject *parent = nullptr);
+	~CanLog();
+	/// @brief Takes effect on next open.
+	void setFlush(size_t flushBytes, int flushMs);
+	/// @brief Takes effect on next open, see BufferedWriter::setSync.
+	void setSync(int syncMs);
+	/// @brief Takes effect on next open.
+	void setCompress(bool isCompressed);
+	/// @brief Takes effect on next open, see Rotation::configure.
+	void setRotation(uint64_t maxBytes, int maxMin, unsigned keep);
+	/// @brief Safe from any thread.
+	const WriterStats &getWriterStats(void) const;
+public slots:
+	void open(const QString &logDirPathRef);
+	/// @brief Drains what is left in the queue before closing.
+	void close(void);
+	void onFramesReady(void);
+private slots:
+	/// @brief Quiet bus, nothing calls drain.
+	void onIdleTimer(void);
+private:
+	StageQueue<CanMsg, CanFrameRing> *frameQueuePtr;
+	BufferedWriter writer;
+	QString canLogFilePath;
+	static const size_t batchSize = 64;
+	CanMsg batchArr[batchSize];
+	QByteArray encodedBfr; //!< one batch of encoded frames, handed to writer at once
+	uint64_t fileOffset;   //!< bytes handed to writer so far
+	CaptureBlockIndex blockIndex; //!< block being written
+	CaptureIndex index;           //!< plain mode only, compressed block offsets are known on writer thread only
+	bool isCompressed;
+	int flushMs;
+	QByteArray blockBfr;          //!< compressed mode, plain frame records of block being written
+	QElapsedTimer blockTimer;     //!< compressed mode, started with first frame of block
+	QTimer idleTimer;             //!< runs every flushMs while a compressed or rotated log is open
+	Rotation rotation;
+	QStringList segmentList;      //!< segments in manifest, oldest first
+	uint64_t segmentStartBytes;   //!< writer bytesWritten when segment was opened
+	void openSegment(void);
+	void closeSegment(void);
+	void updateManifest(void);
+	void drain(void);
+	void write(const CanMsg &canMsgRef);
+	void writeBlockIndex(void);
+	void writeCompressedBlock(void);
+	void writeOldBlock(void);
+	/// @brief Moves on to next segment when it is due.
+	void rotate(void);
+	void flushEncoded(void);
+};
+
+#endif // CANLOG_H
+
+/// @}
@@ -0,0 +1,35 @@
+/**
+ * @defgroup canmsg_h
+ * @{
+ * @file canmsg.h
+ * @brief CAN frame as seen by everything after the backend.
+ */
+#ifndef CANMSG_H
+#define CANMSG_H
+
+#include <cstdint>
+
+/// @brief Bits of CanMsg::flags.
+enum CanMsgFlag : uint8_t
+{
+	CanMsgFlagExtended = 0x01, //!< 29 bit identifier
+	CanMsgFlagFd = 0x02,       //!< CAN FD frame
+	CanMsgFlagBrs = 0x04,      //!< FD bit rate switch
+	CanMsgFlagEsi = 0x08,      //!< FD error state indicator
+	CanMsgFlagRtr = 0x10,      //!< remote request
+	CanMsgFlagTx = 0x20        //!< sent by this node, echoed back by the driver
+};
+
+typedef struct
+{
+	uint32_t id;
+	uint8_t dataLength;
+	uint8_t data[64];
+	uint64_t timestamp; //!< microseconds, see TimestampNormalizer
+	uint8_t flags;      //!< CanMsgFlag bits
+	uint8_t channel;    //!< capture channel, 0 for single channel backends
+} CanMsg;
+
+#endif // CANMSG_H
+
+/// @}
@@ -0,0 +1,290 @@
+#include <QDateTime>
+#include <QFileInfo>
+#include <cstring>
+#include "captureexport.h"
+
+CaptureExport::CaptureExport(void) :
+	writer(),
+	bfr(),
+	bfrPos(0),
+	format(CaptureExportFormat::Candump),
+	isStartSet(false),
+	startUs(0),
+	numOfFrames(0)
+{
+}
+
+CaptureExport::~CaptureExport()
+{
+	close();
+}
+
+CaptureExportFormat CaptureExport::getFormat(const QString &filePathRef)
+{
+	return QFileInfo(filePathRef).suffix().toLower() == "asc" ? CaptureExportFormat::Asc : CaptureExportFormat::Candump;
+}
+
+QByteArray CaptureExport::getAscHeader(void)
+{
+	// Qt formats day and month names in English whatever the locale
+	const QString date = QDateTime::currentDateTime().toString("ddd MMM d hh:mm:ss.zzz ap yyyy");
+
+	return QString(
+		"date %1\n"
+		"base hex  timestamps absolute\n"
+		"no internal events logged\n"
+		"Begin Triggerblock %1\n"
+		"   0.000000 Start of measurement\n"
+	).arg(date).toUtf8();
+}
+
+bool CaptureExport::open(const QString &filePathRef)
+{
+	close();
+
+	this->format = getFormat(filePathRef);
+	this->writer.stats.reset();
+	// full buffers only, nobody waits for these lines
+	this->writer.setFlush(bfrSize, 1000);
+	if(!this->writer.open(filePathRef, this->format == CaptureExportFormat::Asc ? getAscHeader() : QByteArray())) {
+		return false;
+	}
+	this->bfr.resize(bfrSize);
+	this->bfrPos = 0;
+	this->isStartSet = false;
+	this->startUs = 0;
+	this->numOfFrames = 0;
+	return true;
+}
+
+void CaptureExport::close(void)
+{
+	static const char ascTrailer[] = "End TriggerBlock\n";
+
+	if(!this->writer.isOpen()) {
+		return;
+	}
+	if(this->format == CaptureExportFormat::Asc) {
+		memcpy(this->bfr.data() + this->bfrPos, ascTrailer, sizeof(ascTrailer) - 1);
+		this->bfrPos += sizeof(ascTrailer) - 1;
+	}
+	flushBfr();
+	this->writer.close();
+}
+
+QString CaptureExport::errorString(void) const
+{
+	return this->writer.errorString();
+}
+
+uint64_t CaptureExport::getNumOfFrames(void) const
+{
+	return this->numOfFrames;
+}
+
+uint64_t CaptureExport::getNumOfBytes(void) const
+{
+	return this->writer.stats.bytesWritten.get();
+}
+
+void CaptureExport::flushBfr(void)
+{
+	if(this->bfrPos != 0) {
+		this->writer.write(this->bfr.constData(), this->bfrPos);
+		this->bfrPos = 0;
+	}
+}
+
+void CaptureExport::write(const CanMsg &canMsgRef)
+{
+	if(this->bfrPos + maxLineSize > bfrSize) {
+		flushBfr();
+	}
+	char *dstPtr = this->bfr.data() + this->bfrPos;
+	if(this->format == CaptureExportFormat::Asc) {
+		if(!this->isStartSet) {
+			this->startUs = canMsgRef.timestamp;
+			this->isStartSet = true;
+		}
+		this->bfrPos += formatAsc(canMsgRef, this->startUs, dstPtr);
+	} else {
+		this->bfrPos += formatCandump(canMsgRef, dstPtr);
+	}
+	++this->numOfFrames;
+}
+
+char *CaptureExport::putHex(char *dstPtr, uint32_t value, int digits)
+{
+	static const char hexArr[] = "0123456789ABCDEF";
+	char digitArr[8];
+	int numOfDigits = 0;
+
+	do {
+		digitArr[numOfDigits++] = hexArr[value & 0x0F];
+		value >>= 4;
+	} while(value != 0);
+	while(numOfDigits < digits) {
+		digitArr[numOfDigits++] = '0';
+	}
+	while(numOfDigits > 0) {
+		*dstPtr++ = digitArr[--numOfDigits];
+	}
+	return dstPtr;
+}
+
+char *CaptureExport::putDec(char *dstPtr, uint64_t value)
+{
+	char digitArr[20];
+	int numOfDigits = 0;
+
+	do {
+		digitArr[numOfDigits++] = '0' + value % 10;
+		value /= 10;
+	} while(value != 0);
+	while(numOfDigits > 0) {
+		*dstPtr++ = digitArr[--numOfDigits];
+	}
+	return dstPtr;
+}
+
+char *CaptureExport::putDecPadded(char *dstPtr, uint64_t value, int width)
+{
+	char digitArr[20];
+	int numOfDigits = 0;
+
+	do {
+		digitArr[numOfDigits++] = '0' + value % 10;
+		value /= 10;
+	} while(value != 0);
+	for(int i = numOfDigits; i < width; ++i) {
+		*dstPtr++ = ' ';
+	}
+	while(numOfDigits > 0) {
+		*dstPtr++ = digitArr[--numOfDigits];
+	}
+	return dstPtr;
+}
+
+/// `(1436509052.249713) can0 123#11223344 R`
+size_t CaptureExport::formatCandump(const CanMsg &canMsgRef, char *dstPtr)
+{
+	static const char hexArr[] = "0123456789ABCDEF";
+	char *ptr = dstPtr;
+	uint64_t fraction = canMsgRef.timestamp % 1000000;
+
+	*ptr++ = '(';
+	ptr = putDec(ptr, canMsgRef.timestamp / 1000000);
+	*ptr++ = '.';
+	for(int i = 5; i >= 0; --i) {
+		ptr[i] = '0' + fraction % 10;
+		fraction /= 10;
+	}
+	ptr += 6;
+	memcpy(ptr, ") can", 5);
+	ptr = putDec(ptr + 5, canMsgRef.channel);
+	*ptr++ = ' ';
+	ptr = putHex(ptr, canMsgRef.id, (canMsgRef.flags & CanMsgFlagExtended) ? 8 : 3);
+	*ptr++ = '#';
+	if(canMsgRef.flags & CanMsgFlagFd) {
+		*ptr++ = '#';
+		*ptr++ = hexArr[((canMsgRef.flags & CanMsgFlagBrs) ? 0x01 : 0) | ((canMsgRef.flags & CanMsgFlagEsi) ? 0x02 : 0)];
+	} else if(canMsgRef.flags & CanMsgFlagRtr) {
+		*ptr++ = 'R';
+	}
+	for(uint8_t i = 0; i < canMsgRef.dataLength; ++i) {
+		*ptr++ = hexArr[canMsgRef.data[i] >> 4];
+		*ptr++ = hexArr[canMsgRef.data[i] & 0x0F];
+	}
+	memcpy(ptr, (canMsgRef.flags & CanMsgFlagTx) ? " T\n" : " R\n", 3);
+	return ptr + 3 - dstPtr;
+}
+
+/// `   0.012345 1  123x            Rx   d 8 01 02 03 04 05 06 07 08`
+/// `   0.012345 CANFD   1 Rx        123 1 0 9 12 01 02 ... 0 0 3000 0 0 0 0 0`
+size_t CaptureExport::formatAsc(const CanMsg &canMsgRef, uint64_t startUs, char *dstPtr)
+{
+	static const char hexArr[] = "0123456789ABCDEF";
+	static const uint8_t lengthArr[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+	const bool isFd = canMsgRef.flags & CanMsgFlagFd;
+	const bool isExtended = canMsgRef.flags & CanMsgFlagExtended;
+	const uint64_t timeUs = canMsgRef.timestamp > startUs ? canMsgRef.timestamp - startUs : 0;
+	uint64_t fraction = timeUs % 1000000;
+	char *ptr = dstPtr;
+	char *idPtr = nullptr;
+
+	ptr = putDecPadded(ptr, timeUs / 1000000, 4);
+	*ptr++ = '.';
+	for(int i = 5; i >= 0; --i) {
+		ptr[i] = '0' + fraction % 10;
+		fraction /= 10;
+	}
+	ptr += 6;
+	if(!isFd) {
+		*ptr++ = ' ';
+		ptr = putDec(ptr, canMsgRef.channel + 1);
+		*ptr++ = ' ';
+		*ptr++ = ' ';
+		idPtr = ptr;
+		ptr = putHex(ptr, canMsgRef.id, 0);
+		if(isExtended) {
+			*ptr++ = 'x';
+		}
+		while(ptr - idPtr < 15) {
+			*ptr++ = ' ';
+		}
+		memcpy(ptr, (canMsgRef.flags & CanMsgFlagTx) ? " Tx   " : " Rx   ", 6);
+		ptr += 6;
+		if(canMsgRef.flags & CanMsgFlagRtr) {
+			memcpy(ptr, "r 0\n", 4);
+			return ptr + 4 - dstPtr;
+		}
+		*ptr++ = 'd';
+		*ptr++ = ' ';
+		*ptr++ = hexArr[canMsgRef.dataLength & 0x0F];
+	} else {
+		uint8_t dlc = 0;
+		while(dlc < 15 && lengthArr[dlc] < canMsgRef.dataLength) {
+			++dlc;
+		}
+		memcpy(ptr, " CANFD ", 7);
+		ptr = putDecPadded(ptr + 7, canMsgRef.channel + 1, 3);
+		memcpy(ptr, (canMsgRef.flags & CanMsgFlagTx) ? " Tx " : " Rx ", 4);
+		ptr += 4;
+		// id right aligned in 8 columns, x included
+		char idArr[9];
+		char *idEndPtr = putHex(idArr, canMsgRef.id, 0);
+		if(isExtended) {
+			*idEndPtr++ = 'x';
+		}
+		for(int i = idEndPtr - idArr; i < 8; ++i) {
+			*ptr++ = ' ';
+		}
+		memcpy(ptr, idArr, idEndPtr - idArr);
+		ptr += idEndPtr - idArr;
+		*ptr++ = ' ';
+		*ptr++ = (canMsgRef.flags & CanMsgFlagBrs) ? '1' : '0';
+		*ptr++ = ' ';
+		*ptr++ = (canMsgRef.flags & CanMsgFlagEsi) ? '1' : '0';
+		*ptr++ = ' ';
+		*ptr++ = hexArr[dlc];
+		*ptr++ = ' ';
+		ptr = putDecPadded(ptr, canMsgRef.dataLength, 2);
+	}
+	for(uint8_t i = 0; i < canMsgRef.dataLength; ++i) {
+		*ptr++ = ' ';
+		*ptr++ = hexArr[canMsgRef.data[i] >> 4];
+		*ptr++ = hexArr[canMsgRef.data[i] & 0x0F];
+	}
+	if(isFd) {
+		// message duration and length, flags, crc and bit timings; flags mark EDL, BRS, ESI
+		const uint32_t flags = 0x1000 |
+			((canMsgRef.flags & CanMsgFlagBrs) ? 0x2000 : 0) |
+			((canMsgRef.flags & CanMsgFlagEsi) ? 0x4000 : 0);
+		memcpy(ptr, " 0 0 ", 5);
+		ptr = putHex(ptr + 5, flags, 0);
+		memcpy(ptr, " 0 0 0 0 0", 10);
+		ptr += 10;
+	}
+	*ptr++ = '\n';
+	return ptr - dstPtr;
+}
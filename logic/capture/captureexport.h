@@ -0,0 +1,75 @@
+/**
+ * @defgroup captureexport_h
+ * @{
+ * @file captureexport.h
+ * @brief Writes frames as candump -l log or Vector ASC text, for tools that do not read .cobs.
+ *
+ * Lines are formatted by hand into a preallocated buffer, no QString and no printf per frame.
+ * Full buffers go to a BufferedWriter, so formatting and disk writes overlap.
+ *
+ * - candump: `(1436509052.249713) can0 123#11223344`, channel n is interface `can<n>`, ` T` or ` R`
+ *   gives direction as newer can-utils do. Timestamps are written as they are in the capture.
+ * - ASC: `base hex  timestamps absolute`, time in seconds since first frame, channels from 1,
+ *   classic lines as `d <dlc> <data>`, FD lines as `CANFD` lines.
+ */
+#ifndef CAPTUREEXPORT_H
+#define CAPTUREEXPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include "bufferedwriter.h"
+#include "canmsg.h"
+
+enum class CaptureExportFormat
+{
+	Candump,
+	Asc
+};
+
+class CaptureExport
+{
+public:
+	CaptureExport(void);
+	~CaptureExport();
+
+	/// @brief Format follows extension of filePathRef, see getFormat.
+	bool open(const QString &filePathRef);
+	/// @brief Writes out what is buffered and the ASC trailer.
+	void close(void);
+	QString errorString(void) const;
+	void write(const CanMsg &canMsgRef);
+	uint64_t getNumOfFrames(void) const;
+	/// @brief Bytes written to file.
+	uint64_t getNumOfBytes(void) const;
+
+	/// @brief Asc for a .asc file, Candump for any other.
+	static CaptureExportFormat getFormat(const QString &filePathRef);
+	/// @brief Line with its line end, dstPtr needs maxLineSize bytes. Returns line size.
+	static size_t formatCandump(const CanMsg &canMsgRef, char *dstPtr);
+	/// @brief As formatCandump, time is written relative to startUs.
+	static size_t formatAsc(const CanMsg &canMsgRef, uint64_t startUs, char *dstPtr);
+
+	/// @brief ASC FD line with 64 data bytes stays well below this.
+	static const size_t maxLineSize = 512;
+	static const size_t bfrSize = 1024 * 1024;
+private:
+	BufferedWriter writer;
+	QByteArray bfr;
+	size_t bfrPos;
+	CaptureExportFormat format;
+	bool isStartSet;
+	uint64_t startUs;
+	uint64_t numOfFrames;
+	void flushBfr(void);
+	static QByteArray getAscHeader(void);
+	static char *putHex(char *dstPtr, uint32_t value, int digits);
+	static char *putDec(char *dstPtr, uint64_t value);
+	/// @brief Right aligned in width characters.
+	static char *putDecPadded(char *dstPtr, uint64_t value, int width);
+};
+
+#endif // CAPTUREEXPORT_H
+
+/// @}
@@ -0,0 +1,159 @@
+#include "capturefile.h"
+
+CaptureFile::CaptureFile(void) :
+	file(),
+	windowPtr(nullptr),
+	windowOffset(0),
+	windowSize(0),
+	fileSize(0),
+	reader()
+{
+}
+
+CaptureFile::~CaptureFile()
+{
+	close();
+}
+
+bool CaptureFile::open(const QString &filePathRef)
+{
+	close();
+
+	this->file.setFileName(filePathRef);
+	if(!this->file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	this->fileSize = this->file.size();
+	if(!mapWindow(0)) {
+		this->file.close();
+		return false;
+	}
+	this->reader.open(this->windowPtr, this->windowSize, this->windowOffset + this->windowSize >= this->fileSize);
+	return true;
+}
+
+void CaptureFile::close(void)
+{
+	if(this->windowPtr != nullptr) {
+		this->file.unmap(this->windowPtr);
+		this->windowPtr = nullptr;
+	}
+	this->windowOffset = 0;
+	this->windowSize = 0;
+	this->fileSize = 0;
+	this->file.close();
+}
+
+bool CaptureFile::isOpen(void) const
+{
+	return this->file.isOpen();
+}
+
+QString CaptureFile::errorString(void) const
+{
+	return this->file.errorString();
+}
+
+QString CaptureFile::getFilePath(void) const
+{
+	return this->file.fileName();
+}
+
+CaptureVersion CaptureFile::getVersion(void) const
+{
+	return this->reader.getVersion();
+}
+
+uint64_t CaptureFile::getCreatedUs(void) const
+{
+	return this->reader.getCreatedUs();
+}
+
+bool CaptureFile::mapWindow(uint64_t offset)
+{
+	if(this->windowPtr != nullptr) {
+		this->file.unmap(this->windowPtr);
+		this->windowPtr = nullptr;
+	}
+	this->windowOffset = offset;
+	this->windowSize = qMin<qint64>(mapWindowSize, this->fileSize - offset);
+	if(this->windowSize <= 0) {
+		// nothing left to map, reader gets an empty last window
+		this->windowSize = 0;
+		return true;
+	}
+	this->windowPtr = this->file.map(offset, this->windowSize);
+	return this->windowPtr != nullptr;
+}
+
+bool CaptureFile::nextWindow(void)
+{
+	if(!this->reader.isWindowDone()) {
+		return false;
+	}
+	if(!mapWindow(this->reader.getPos())) {
+		// reader is left on an empty last window, it ends there
+		this->reader.setWindow(nullptr, 0, this->windowOffset, true);
+		return false;
+	}
+	this->reader.setWindow(this->windowPtr, this->windowSize, this->windowOffset, this->windowOffset + this->windowSize >= this->fileSize);
+	return true;
+}
+
+bool CaptureFile::next(CanMsg &canMsgRef)
+{
+	do {
+		if(this->reader.next(canMsgRef)) {
+			return true;
+		}
+	} while(nextWindow());
+	return false;
+}
+
+bool CaptureFile::nextBlockIndex(CaptureBlockIndex &indexRef)
+{
+	do {
+		if(this->reader.nextBlockIndex(indexRef)) {
+			return true;
+		}
+	} while(nextWindow());
+	return false;
+}
+
+bool CaptureFile::seek(uint64_t offset)
+{
+	if(!this->file.isOpen()) {
+		return false;
+	}
+	if(offset >= this->windowOffset && offset < this->windowOffset + this->windowSize) {
+		this->reader.seek(offset);
+		return true;
+	}
+	if(offset >= this->fileSize) {
+		offset = this->fileSize;
+	}
+	// one byte early, reader checks it for the delimiter in front of offset
+	const uint64_t mapOffset = offset > 0 ? offset - 1 : 0;
+	if(!mapWindow(mapOffset)) {
+		this->reader.setWindow(nullptr, 0, this->fileSize, true);
+		return false;
+	}
+	this->reader.setWindow(this->windowPtr, this->windowSize, this->windowOffset, this->windowOffset + this->windowSize >= this->fileSize);
+	this->reader.seek(offset);
+	return true;
+}
+
+uint64_t CaptureFile::getPos(void) const
+{
+	return this->reader.getPos();
+}
+
+uint64_t CaptureFile::getSize(void) const
+{
+	return this->fileSize;
+}
+
+uint64_t CaptureFile::getNumOfBadRecords(void) const
+{
+	return this->reader.getNumOfBadRecords();
+}
@@ -0,0 +1,58 @@
+/**
+ * @defgroup capturefile_h
+ * @{
+ * @file capturefile.h
+ * @brief .cobs capture read straight from disk through a sliding memory map.
+ * Only mapWindowSize bytes are mapped at a time, so opening is instant and memory stays
+ * bounded whatever the file size. Records are decoded by CaptureReader.
+ */
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include "capturereader.h"
+
+class CaptureFile
+{
+public:
+	CaptureFile(void);
+	~CaptureFile();
+
+	/// @brief False when file cannot be opened or mapped, see errorString.
+	bool open(const QString &filePathRef);
+	void close(void);
+	bool isOpen(void) const;
+	QString errorString(void) const;
+	QString getFilePath(void) const;
+	CaptureVersion getVersion(void) const;
+	/// @brief See CaptureFormat::getCreatedUs.
+	uint64_t getCreatedUs(void) const;
+	/// @brief Next frame, false at end of file.
+	bool next(CanMsg &canMsgRef);
+	/// @brief Next block index, see CaptureReader::nextBlockIndex.
+	bool nextBlockIndex(CaptureBlockIndex &indexRef);
+	/// @brief Continues at the first record that starts at or after offset.
+	bool seek(uint64_t offset);
+	uint64_t getPos(void) const;
+	uint64_t getSize(void) const;
+	uint64_t getNumOfBadRecords(void) const;
+
+	/// @brief Far more than the largest record.
+	static const qint64 mapWindowSize = 16 * 1024 * 1024;
+private:
+	QFile file;
+	uchar *windowPtr;
+	uint64_t windowOffset;
+	qint64 windowSize;
+	uint64_t fileSize;
+	CaptureReader reader;
+	bool mapWindow(uint64_t offset);
+	/// @brief Moves on to next window when reader used up current one, false at end of file.
+	bool nextWindow(void);
+};
+
+#endif // CAPTUREFILE_H
+
+/// @}
@@ -0,0 +1,258 @@
+#include <cstring>
+#include "captureformat.h"
+
+const char CaptureFormat::magic[8] = {'U', 'D', 'S', 'T', 'C', 'A', 'P', '\0'};
+
+size_t CaptureFormat::writeFileHeader(uint8_t *dstPtr, uint64_t createdUs, uint32_t fileFlags)
+{
+	const uint16_t fileVersion = version;
+	const uint16_t headerSize = fileHeaderSize;
+	const uint32_t frames = blockFrames;
+	const uint32_t zero = 0;
+
+	memcpy(dstPtr, magic, sizeof(magic));
+	memcpy(dstPtr + 8, &fileVersion, sizeof(fileVersion));
+	memcpy(dstPtr + 10, &headerSize, sizeof(headerSize));
+	memcpy(dstPtr + 12, &frames, sizeof(frames));
+	memcpy(dstPtr + 16, &createdUs, sizeof(createdUs));
+	memcpy(dstPtr + 24, &fileFlags, sizeof(fileFlags));
+	memcpy(dstPtr + 28, &zero, sizeof(zero));
+	return fileHeaderSize;
+}
+
+uint32_t CaptureFormat::getFileFlags(const uint8_t *srcPtr, size_t size)
+{
+	uint32_t fileFlags = 0;
+
+	if(detect(srcPtr, size) != CaptureVersion::V1) {
+		return 0;
+	}
+	memcpy(&fileFlags, srcPtr + 24, sizeof(fileFlags));
+	return fileFlags;
+}
+
+uint64_t CaptureFormat::getCreatedUs(const uint8_t *srcPtr, size_t size)
+{
+	uint64_t createdUs = 0;
+
+	if(detect(srcPtr, size) != CaptureVersion::V1) {
+		return 0;
+	}
+	memcpy(&createdUs, srcPtr + 16, sizeof(createdUs));
+	return createdUs;
+}
+
+CaptureVersion CaptureFormat::detect(const uint8_t *srcPtr, size_t size)
+{
+	uint16_t fileVersion = 0;
+
+	if(size == 0) {
+		return CaptureVersion::Invalid;
+	}
+	if(size < sizeof(magic) || memcmp(srcPtr, magic, sizeof(magic)) != 0) {
+		return CaptureVersion::Legacy;
+	}
+	if(size < fileHeaderSize) {
+		return CaptureVersion::Invalid;
+	}
+	memcpy(&fileVersion, srcPtr + 8, sizeof(fileVersion));
+	if(fileVersion != version) {
+		return CaptureVersion::Invalid;
+	}
+	return CaptureVersion::V1;
+}
+
+size_t CaptureFormat::getDataOffset(CaptureVersion version)
+{
+	return version == CaptureVersion::V1 ? fileHeaderSize : 0;
+}
+
+size_t CaptureFormat::encodeFrame(const CanMsg &canMsgRef, uint8_t *dstPtr)
+{
+	const uint8_t dataLength = canMsgRef.dataLength > sizeof(CanMsg::data) ? sizeof(CanMsg::data) : canMsgRef.dataLength;
+
+	dstPtr[0] = static_cast<uint8_t>(CaptureRecordType::Frame);
+	dstPtr[1] = canMsgRef.flags;
+	dstPtr[2] = canMsgRef.channel;
+	dstPtr[3] = dataLength;
+	memcpy(dstPtr + 4, &canMsgRef.id, sizeof(CanMsg::id));
+	memcpy(dstPtr + 8, &canMsgRef.timestamp, sizeof(CanMsg::timestamp));
+	memcpy(dstPtr + frameHeaderSize, canMsgRef.data, dataLength);
+	return frameHeaderSize + dataLength;
+}
+
+size_t CaptureFormat::encodeBlockIndex(const CaptureBlockIndex &indexRef, uint8_t *dstPtr)
+{
+	memset(dstPtr, 0, 4);
+	dstPtr[0] = static_cast<uint8_t>(CaptureRecordType::BlockIndex);
+	memcpy(dstPtr + 4, &indexRef.numOfFrames, sizeof(indexRef.numOfFrames));
+	memcpy(dstPtr + 8, &indexRef.blockOffset, sizeof(indexRef.blockOffset));
+	memcpy(dstPtr + 16, &indexRef.firstFrame, sizeof(indexRef.firstFrame));
+	memcpy(dstPtr + 24, &indexRef.firstTimestamp, sizeof(indexRef.firstTimestamp));
+	memcpy(dstPtr + 32, &indexRef.lastTimestamp, sizeof(indexRef.lastTimestamp));
+	return blockIndexSize;
+}
+
+bool CaptureFormat::decodeFrame(const uint8_t *srcPtr, size_t size, CanMsg &canMsgRef)
+{
+	if(size < frameHeaderSize || srcPtr[0] != static_cast<uint8_t>(CaptureRecordType::Frame)) {
+		return false;
+	}
+	if(srcPtr[3] > sizeof(CanMsg::data) || size != frameHeaderSize + srcPtr[3]) {
+		return false;
+	}
+	canMsgRef.flags = srcPtr[1];
+	canMsgRef.channel = srcPtr[2];
+	canMsgRef.dataLength = srcPtr[3];
+	memcpy(&canMsgRef.id, srcPtr + 4, sizeof(CanMsg::id));
+	memcpy(&canMsgRef.timestamp, srcPtr + 8, sizeof(CanMsg::timestamp));
+	memcpy(canMsgRef.data, srcPtr + frameHeaderSize, canMsgRef.dataLength);
+	return true;
+}
+
+bool CaptureFormat::decodeBlockIndex(const uint8_t *srcPtr, size_t size, CaptureBlockIndex &indexRef)
+{
+	if(size != blockIndexSize || srcPtr[0] != static_cast<uint8_t>(CaptureRecordType::BlockIndex)) {
+		return false;
+	}
+	memcpy(&indexRef.numOfFrames, srcPtr + 4, sizeof(indexRef.numOfFrames));
+	memcpy(&indexRef.blockOffset, srcPtr + 8, sizeof(indexRef.blockOffset));
+	memcpy(&indexRef.firstFrame, srcPtr + 16, sizeof(indexRef.firstFrame));
+	memcpy(&indexRef.firstTimestamp, srcPtr + 24, sizeof(indexRef.firstTimestamp));
+	memcpy(&indexRef.lastTimestamp, srcPtr + 32, sizeof(indexRef.lastTimestamp));
+	return true;
+}
+
+size_t CaptureFormat::getRecordSize(const uint8_t *srcPtr)
+{
+	switch(static_cast<CaptureRecordType>(srcPtr[0])) {
+	case CaptureRecordType::Frame:
+		return frameHeaderSize + srcPtr[3];
+	case CaptureRecordType::BlockIndex:
+		return blockIndexSize;
+	case CaptureRecordType::CompressedBlock:
+		break;
+	}
+	return 0;
+}
+
+size_t CaptureFormat::encodeRecord(const uint8_t *recordPtr, size_t recordSize, uint8_t *dstPtr)
+{
+	cobs_encode_result result = cobs_encode(dstPtr, maxEncodedRecordSize - 1, recordPtr, recordSize);
+
+	if(result.status != COBS_ENCODE_OK) {
+		return 0;
+	}
+	dstPtr[result.out_len] = 0;
+	return result.out_len + 1;
+}
+
+/// Same result as cobs_decode, bounds are checked once per run instead of once per byte.
+/// Runs of CAN records average under two bytes, a plain loop beats a memcpy call per run.
+size_t CaptureFormat::decodeRecord(const uint8_t *srcPtr, size_t srcSize, uint8_t *dstPtr, size_t dstSize)
+{
+	const uint8_t *srcEndPtr = srcPtr + srcSize;
+	uint8_t *dstStartPtr = dstPtr;
+	uint8_t *dstEndPtr = dstPtr + dstSize;
+
+	while(srcPtr < srcEndPtr) {
+		const uint8_t code = *srcPtr++;
+		const size_t runSize = code - 1u;
+
+		if(code == 0 || runSize > (size_t)(srcEndPtr - srcPtr) || runSize > (size_t)(dstEndPtr - dstPtr)) {
+			return 0;
+		}
+		for(size_t i = 0; i < runSize; ++i) {
+			dstPtr[i] = srcPtr[i];
+		}
+		dstPtr += runSize;
+		srcPtr += runSize;
+		// a run shorter than the longest one stood for a zero, unless it is the last
+		if(srcPtr < srcEndPtr && code != 0xFF) {
+			if(dstPtr == dstEndPtr) {
+				return 0;
+			}
+			*dstPtr++ = 0;
+		}
+	}
+	return dstPtr - dstStartPtr;
+}
+
+bool CaptureFormat::decodeLegacyFrame(const uint8_t *srcPtr, size_t size, CanMsg &canMsgRef)
+{
+	const size_t headerSize = sizeof(CanMsg::id) + sizeof(CanMsg::dataLength);
+
+	if(size < headerSize + sizeof(CanMsg::timestamp)) {
+		return false;
+	}
+	memcpy(&canMsgRef.id, srcPtr, sizeof(CanMsg::id));
+	canMsgRef.dataLength = srcPtr[sizeof(CanMsg::id)];
+	if(canMsgRef.dataLength > sizeof(CanMsg::data) || size != headerSize + canMsgRef.dataLength + sizeof(CanMsg::timestamp)) {
+		return false;
+	}
+	memcpy(canMsgRef.data, srcPtr + headerSize, canMsgRef.dataLength);
+	memcpy(&canMsgRef.timestamp, srcPtr + headerSize + canMsgRef.dataLength, sizeof(CanMsg::timestamp));
+	canMsgRef.flags = guessLegacyFlags(canMsgRef);
+	canMsgRef.channel = 0;
+	return true;
+}
+
+void CaptureFormat::encodeCompressedHeader(const CaptureBlockIndex &indexRef, uint32_t uncompressedSize, uint8_t *dstPtr)
+{
+	memset(dstPtr, 0, compressedHeaderSize);
+	dstPtr[0] = static_cast<uint8_t>(CaptureRecordType::CompressedBlock);
+	memcpy(dstPtr + 4, &indexRef.numOfFrames, sizeof(indexRef.numOfFrames));
+	memcpy(dstPtr + 8, &uncompressedSize, sizeof(uncompressedSize));
+	memcpy(dstPtr + 16, &indexRef.firstFrame, sizeof(indexRef.firstFrame));
+	memcpy(dstPtr + 24, &indexRef.firstTimestamp, sizeof(indexRef.firstTimestamp));
+	memcpy(dstPtr + 32, &indexRef.lastTimestamp, sizeof(indexRef.lastTimestamp));
+}
+
+void CaptureFormat::compressBlock(const char *blockPtr, size_t blockSize, QByteArray &outRef)
+{
+	if(blockSize < compressedHeaderSize) {
+		return;
+	}
+	QByteArray record(blockPtr, compressedHeaderSize);
+	record.append(qCompress(reinterpret_cast<const uchar *>(blockPtr + compressedHeaderSize), blockSize - compressedHeaderSize, compressLevel));
+
+	const qsizetype outPos = outRef.size();
+	outRef.resize(outPos + COBS_ENCODE_DST_BUF_LEN_MAX(record.size()) + 1);
+	cobs_encode_result result = cobs_encode(outRef.data() + outPos, outRef.size() - outPos - 1, record.constData(), record.size());
+	if(result.status != COBS_ENCODE_OK) {
+		outRef.resize(outPos);
+		return;
+	}
+	outRef[outPos + result.out_len] = 0;
+	outRef.resize(outPos + result.out_len + 1);
+}
+
+bool CaptureFormat::decompressBlock(const uint8_t *srcPtr, size_t size, CaptureBlockIndex &indexRef, QByteArray &framesRef)
+{
+	uint32_t uncompressedSize = 0;
+
+	if(size <= compressedHeaderSize || srcPtr[0] != static_cast<uint8_t>(CaptureRecordType::CompressedBlock)) {
+		return false;
+	}
+	memcpy(&indexRef.numOfFrames, srcPtr + 4, sizeof(indexRef.numOfFrames));
+	memcpy(&uncompressedSize, srcPtr + 8, sizeof(uncompressedSize));
+	memcpy(&indexRef.firstFrame, srcPtr + 16, sizeof(indexRef.firstFrame));
+	memcpy(&indexRef.firstTimestamp, srcPtr + 24, sizeof(indexRef.firstTimestamp));
+	memcpy(&indexRef.lastTimestamp, srcPtr + 32, sizeof(indexRef.lastTimestamp));
+	indexRef.blockOffset = 0;
+	framesRef = qUncompress(srcPtr + compressedHeaderSize, size - compressedHeaderSize);
+	return (size_t)framesRef.size() == uncompressedSize;
+}
+
+uint8_t CaptureFormat::guessLegacyFlags(const CanMsg &canMsgRef)
+{
+	uint8_t flags = 0;
+
+	if(canMsgRef.id > 0x7FF) {
+		flags |= CanMsgFlagExtended;
+	}
+	if(canMsgRef.dataLength > 8) {
+		flags |= CanMsgFlagFd;
+	}
+	return flags;
+}
@@ -0,0 +1,131 @@
+/**
+ * @defgroup captureformat_h
+ * @{
+ * @file captureformat.h
+ * @brief Versioned .cobs capture container.
+ *
+ * File starts with a 32 byte header, all fields little endian:
+ *
+ * | offset | size | field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 8    | magic "UDSTCAP\0"                        |
+ * | 8      | 2    | version                                  |
+ * | 10     | 2    | header size, records start here          |
+ * | 12     | 4    | frames per block                         |
+ * | 16     | 8    | creation time, microseconds since epoch  |
+ * | 24     | 4    | flags, bit 0 compressed blocks           |
+ * | 28     | 4    | reserved, 0                              |
+ *
+ * Records follow, each COBS encoded and zero delimited like the legacy format, so a reader
+ * can resync on any zero byte. First byte of a decoded record is its type.
+ *
+ * Frame record, 16 byte header followed by dataLength bytes of payload:
+ * type, flags (CanMsgFlag), channel, dataLength, id (4), timestamp in microseconds (8).
+ *
+ * Block index record, written after every blockFrames frames and on close. It describes the
+ * block that ends right before it, so a reader can jump from block to block:
+ * type, 3 reserved, numOfFrames (4), blockOffset (8), firstFrame (8), firstTimestamp (8),
+ * lastTimestamp (8).
+ *
+ * Compressed files hold compressed block records instead of frame and block index records.
+ * Each one packs about compressedBlockSize bytes of plain frame records with qCompress and can
+ * be decompressed on its own, its header doubles as the block index:
+ * type, 3 reserved, numOfFrames (4), uncompressed size (4), 4 reserved, firstFrame (8),
+ * firstTimestamp (8), lastTimestamp (8), then the qCompress output.
+ *
+ * Legacy files have no header. Their first zero byte is the delimiter of a frame that is at
+ * least 13 bytes long, so it can never sit at offset 7 where the magic has one.
+ */
+#ifndef CAPTUREFORMAT_H
+#define CAPTUREFORMAT_H
+
+#include <QByteArray>
+#include <cstddef>
+#include <cstdint>
+#include "canmsg.h"
+#include "cobs.h"
+
+enum class CaptureVersion
+{
+	Invalid,
+	Legacy,  //!< headerless id, dataLength, data, timestamp records
+	V1
+};
+
+enum class CaptureRecordType : uint8_t
+{
+	Frame = 1,
+	BlockIndex = 2,
+	CompressedBlock = 3
+};
+
+/// @brief Contents of a block index record.
+typedef struct
+{
+	uint32_t numOfFrames;
+	uint64_t blockOffset;     //!< file offset of first record of the block
+	uint64_t firstFrame;      //!< number of frames in file before the block
+	uint64_t firstTimestamp;
+	uint64_t lastTimestamp;
+} CaptureBlockIndex;
+
+class CaptureFormat
+{
+public:
+	static const uint16_t version = 1;
+	static const size_t fileHeaderSize = 32;
+	static const uint32_t blockFrames = 4096;
+	static const size_t frameHeaderSize = 16;
+	static const size_t blockIndexSize = 40;
+	static const uint32_t fileFlagCompressed = 0x01;
+	static const size_t compressedHeaderSize = 40;
+	/// @brief Plain frame records per compressed block, a block is closed once it reaches this.
+	static const size_t compressedBlockSize = 64 * 1024;
+	/// @brief zlib level, fastest one, higher levels cost far more time than they save space.
+	static const int compressLevel = 1;
+	static const size_t maxRecordSize = frameHeaderSize + sizeof(CanMsg::data);
+	/// @brief Worst case of one record after COBS encoding, delimiter included.
+	static const size_t maxEncodedRecordSize = COBS_ENCODE_DST_BUF_LEN_MAX(maxRecordSize) + 1;
+
+	static size_t writeFileHeader(uint8_t *dstPtr, uint64_t createdUs, uint32_t fileFlags = 0);
+	static uint32_t getFileFlags(const uint8_t *srcPtr, size_t size);
+	/// @brief Wall clock the file was created at, microseconds since epoch, 0 when header has none.
+	static uint64_t getCreatedUs(const uint8_t *srcPtr, size_t size);
+	/// @brief Looks at the first bytes of a file, needs at least fileHeaderSize of them for V1.
+	static CaptureVersion detect(const uint8_t *srcPtr, size_t size);
+	/// @brief Offset of first record.
+	static size_t getDataOffset(CaptureVersion version);
+
+	/// @brief Plain record, not COBS encoded. dstPtr needs maxRecordSize bytes.
+	static size_t encodeFrame(const CanMsg &canMsgRef, uint8_t *dstPtr);
+	static size_t encodeBlockIndex(const CaptureBlockIndex &indexRef, uint8_t *dstPtr);
+	static bool decodeFrame(const uint8_t *srcPtr, size_t size, CanMsg &canMsgRef);
+	static bool decodeBlockIndex(const uint8_t *srcPtr, size_t size, CaptureBlockIndex &indexRef);
+	/// @brief Record size from its first frameHeaderSize bytes, 0 if unknown.
+	static size_t getRecordSize(const uint8_t *srcPtr);
+
+	/// @brief COBS encodes a record and appends the delimiter. dstPtr needs maxEncodedRecordSize bytes.
+	static size_t encodeRecord(const uint8_t *recordPtr, size_t recordSize, uint8_t *dstPtr);
+	/// @brief COBS decodes one record without its delimiter, input must hold no zero byte.
+	/// Returns decoded size, 0 when record is malformed or does not fit.
+	static size_t decodeRecord(const uint8_t *srcPtr, size_t srcSize, uint8_t *dstPtr, size_t dstSize);
+
+	/// @brief Header of a compressed block record, dstPtr needs compressedHeaderSize bytes.
+	static void encodeCompressedHeader(const CaptureBlockIndex &indexRef, uint32_t uncompressedSize, uint8_t *dstPtr);
+	/// @brief BlockEncoder of BufferedWriter. Block is a compressed header followed by plain frame
+	/// records, output is the finished COBS encoded compressed block record.
+	static void compressBlock(const char *blockPtr, size_t blockSize, QByteArray &outRef);
+	/// @brief Decoded compressed block record to its index and plain frame records.
+	static bool decompressBlock(const uint8_t *srcPtr, size_t size, CaptureBlockIndex &indexRef, QByteArray &framesRef);
+
+	/// @brief Record of a headerless file: id, dataLength, data, timestamp.
+	static bool decodeLegacyFrame(const uint8_t *srcPtr, size_t size, CanMsg &canMsgRef);
+	/// @brief Legacy files cannot tell 11 from 29 bit ids or classic from FD, this guesses.
+	static uint8_t guessLegacyFlags(const CanMsg &canMsgRef);
+private:
+	static const char magic[8];
+};
+
+#endif // CAPTUREFORMAT_H
+
+/// @}
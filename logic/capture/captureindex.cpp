@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cstring>
+#include "captureindex.h"
+
+const char CaptureIndex::magic[8] = {'U', 'D', 'S', 'T', 'I', 'D', 'X', '\0'};
+
+CaptureIndex::CaptureIndex(void) :
+	file(),
+	numOfAppended(0),
+	entryVec()
+{
+}
+
+CaptureIndex::~CaptureIndex()
+{
+	this->file.close();
+}
+
+QString CaptureIndex::getPath(const QString &capturePathRef)
+{
+	return capturePathRef + ".idx";
+}
+
+void CaptureIndex::writeHeader(uint8_t *dstPtr, uint64_t captureSize, uint64_t numOfEntries)
+{
+	const uint16_t fileVersion = version;
+	const uint16_t fileHeaderSize = headerSize;
+	const uint16_t entrySize = CaptureFormat::blockIndexSize;
+
+	memset(dstPtr, 0, headerSize);
+	memcpy(dstPtr, magic, sizeof(magic));
+	memcpy(dstPtr + 8, &fileVersion, sizeof(fileVersion));
+	memcpy(dstPtr + 10, &fileHeaderSize, sizeof(fileHeaderSize));
+	memcpy(dstPtr + 12, &entrySize, sizeof(entrySize));
+	memcpy(dstPtr + 16, &captureSize, sizeof(captureSize));
+	memcpy(dstPtr + 24, &numOfEntries, sizeof(numOfEntries));
+}
+
+bool CaptureIndex::create(const QString &indexPathRef)
+{
+	uint8_t header[headerSize];
+
+	this->file.close();
+	this->file.setFileName(indexPathRef);
+	this->numOfAppended = 0;
+	if(!this->file.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+	// capture size stays 0 until finish, a crash leaves an index that gets rebuilt
+	writeHeader(header, 0, 0);
+	return this->file.write(reinterpret_cast<const char *>(header), sizeof(header)) == sizeof(header);
+}
+
+void CaptureIndex::append(const CaptureBlockIndex &indexRef)
+{
+	uint8_t entry[CaptureFormat::blockIndexSize];
+
+	if(!this->file.isOpen()) {
+		return;
+	}
+	CaptureFormat::encodeBlockIndex(indexRef, entry);
+	this->file.write(reinterpret_cast<const char *>(entry), sizeof(entry));
+	++this->numOfAppended;
+}
+
+void CaptureIndex::finish(uint64_t captureSize)
+{
+	uint8_t header[headerSize];
+
+	if(!this->file.isOpen()) {
+		return;
+	}
+	writeHeader(header, captureSize, this->numOfAppended);
+	if(this->file.seek(0)) {
+		this->file.write(reinterpret_cast<const char *>(header), sizeof(header));
+	}
+	this->file.close();
+}
+
+/// An index whose entries do not add up to the number its header names is stale as well.
+bool CaptureIndex::read(const QString &indexPathRef, uint64_t captureSize)
+{
+	static const size_t numOfEntriesOffset = 24;
+	QFile indexFile(indexPathRef);
+	uint8_t header[headerSize];
+	uint8_t expected[headerSize];
+	uint64_t numOfEntries = 0;
+	CaptureBlockIndex index;
+
+	if(!indexFile.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	writeHeader(expected, captureSize, 0);
+	if(indexFile.read(reinterpret_cast<char *>(header), sizeof(header)) != sizeof(header) ||
+		memcmp(header, expected, numOfEntriesOffset) != 0) {
+		return false;
+	}
+	memcpy(&numOfEntries, header + numOfEntriesOffset, sizeof(numOfEntries));
+	if(indexFile.size() != (qint64)(headerSize + numOfEntries * CaptureFormat::blockIndexSize)) {
+		return false;
+	}
+	const QByteArray entries = indexFile.readAll();
+	const uint8_t *entryPtr = reinterpret_cast<const uint8_t *>(entries.constData());
+	this->entryVec.clear();
+	this->entryVec.reserve(numOfEntries);
+	for(size_t i = 0; i < numOfEntries; ++i) {
+		if(!CaptureFormat::decodeBlockIndex(entryPtr + i * CaptureFormat::blockIndexSize, CaptureFormat::blockIndexSize, index)) {
+			this->entryVec.clear();
+			return false;
+		}
+		this->entryVec.push_back(index);
+	}
+	return true;
+}
+
+/// Moves read position of the capture, caller seeks afterwards.
+void CaptureIndex::build(CaptureFile &captureRef)
+{
+	CaptureBlockIndex index = {};
+	CanMsg canMsg;
+
+	this->entryVec.clear();
+	captureRef.seek(0);
+	if(captureRef.getVersion() == CaptureVersion::V1) {
+		while(captureRef.nextBlockIndex(index)) {
+			this->entryVec.push_back(index);
+		}
+		return;
+	}
+	// legacy files have no block index records, blocks are cut here
+	uint64_t offset = captureRef.getPos();
+	while(captureRef.next(canMsg)) {
+		if(index.numOfFrames == 0) {
+			index.blockOffset = offset;
+			index.firstTimestamp = canMsg.timestamp;
+		}
+		index.lastTimestamp = canMsg.timestamp;
+		if(++index.numOfFrames == CaptureFormat::blockFrames) {
+			this->entryVec.push_back(index);
+			index.firstFrame += index.numOfFrames;
+			index.numOfFrames = 0;
+		}
+		offset = captureRef.getPos();
+	}
+	if(index.numOfFrames != 0) {
+		this->entryVec.push_back(index);
+	}
+}
+
+bool CaptureIndex::store(const QString &indexPathRef, uint64_t captureSize)
+{
+	if(!create(indexPathRef)) {
+		return false;
+	}
+	for(const CaptureBlockIndex &indexRef : this->entryVec) {
+		append(indexRef);
+	}
+	finish(captureSize);
+	return true;
+}
+
+bool CaptureIndex::load(CaptureFile &captureRef)
+{
+	const QString indexPath = getPath(captureRef.getFilePath());
+
+	if(read(indexPath, captureRef.getSize())) {
+		return true;
+	}
+	build(captureRef);
+	// read only capture directory is fine, index then lives as long as this object
+	store(indexPath, captureRef.getSize());
+	return !this->entryVec.empty();
+}
+
+bool CaptureIndex::findTimestamp(uint64_t timestampUs, CaptureBlockIndex &indexRef) const
+{
+	if(this->entryVec.empty()) {
+		return false;
+	}
+	auto it = std::upper_bound(
+		this->entryVec.begin(),
+		this->entryVec.end(),
+		timestampUs,
+		[](uint64_t timestampUs, const CaptureBlockIndex &entryRef) {
+			return timestampUs < entryRef.firstTimestamp;
+		}
+	);
+	indexRef = it == this->entryVec.begin() ? *it : *(it - 1);
+	return true;
+}
+
+bool CaptureIndex::findFrame(uint64_t frame, CaptureBlockIndex &indexRef) const
+{
+	if(this->entryVec.empty()) {
+		return false;
+	}
+	auto it = std::upper_bound(
+		this->entryVec.begin(),
+		this->entryVec.end(),
+		frame,
+		[](uint64_t frame, const CaptureBlockIndex &entryRef) {
+			return frame < entryRef.firstFrame;
+		}
+	);
+	indexRef = it == this->entryVec.begin() ? *it : *(it - 1);
+	return true;
+}
+
+bool CaptureIndex::isEmpty(void) const
+{
+	return this->entryVec.empty();
+}
+
+uint64_t CaptureIndex::getFirstTimestamp(void) const
+{
+	return this->entryVec.empty() ? 0 : this->entryVec.front().firstTimestamp;
+}
+
+uint64_t CaptureIndex::getLastTimestamp(void) const
+{
+	return this->entryVec.empty() ? 0 : this->entryVec.back().lastTimestamp;
+}
+
+uint64_t CaptureIndex::getNumOfFrames(void) const
+{
+	return this->entryVec.empty() ? 0 : this->entryVec.back().firstFrame + this->entryVec.back().numOfFrames;
+}
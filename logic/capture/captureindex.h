@@ -0,0 +1,78 @@
+/**
+ * @defgroup captureindex_h
+ * @{
+ * @file captureindex.h
+ * @brief Timestamp and frame index of a .cobs capture, kept in a .idx file next to it.
+ *
+ * File starts with a 32 byte header, all fields little endian:
+ *
+ * | offset | size | field                                          |
+ * |--------|------|------------------------------------------------|
+ * | 0      | 8    | magic "UDSTIDX\0"                              |
+ * | 8      | 2    | version                                        |
+ * | 10     | 2    | header size, entries start here                |
+ * | 12     | 2    | entry size                                     |
+ * | 14     | 2    | reserved, 0                                    |
+ * | 16     | 8    | size of capture the index covers, 0 unfinished |
+ * | 24     | 8    | number of entries                              |
+ *
+ * Entries follow, one per block in file order, each a block index record as in
+ * captureformat.h without COBS encoding. Entries have a fixed size, so a lookup is a binary
+ * search over firstFrame or firstTimestamp. Timestamps are expected not to go backwards.
+ *
+ * Plain captures get their index written along with the capture. Compressed and legacy
+ * captures, and captures whose index is missing or does not match, get it built on demand
+ * by scanning the capture once, that scan only decodes block headers of V1 files. An index cut
+ * short, which still names the right capture size, is told apart by its number of entries.
+ */
+#ifndef CAPTUREINDEX_H
+#define CAPTUREINDEX_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "capturefile.h"
+
+class CaptureIndex
+{
+public:
+	CaptureIndex(void);
+	~CaptureIndex();
+
+	static QString getPath(const QString &capturePathRef);
+
+	/// @brief Capture side, entries are appended while capture is written.
+	bool create(const QString &indexPathRef);
+	void append(const CaptureBlockIndex &indexRef);
+	/// @brief Marks index complete for a capture of captureSize bytes and closes it.
+	void finish(uint64_t captureSize);
+
+	/// @brief Loads index of an open capture, builds and stores it when missing or stale.
+	bool load(CaptureFile &captureRef);
+	/// @brief Block to start from to reach first frame at or after timestampUs.
+	bool findTimestamp(uint64_t timestampUs, CaptureBlockIndex &indexRef) const;
+	/// @brief Block holding frame number frame, counted from 0.
+	bool findFrame(uint64_t frame, CaptureBlockIndex &indexRef) const;
+	bool isEmpty(void) const;
+	uint64_t getFirstTimestamp(void) const;
+	uint64_t getLastTimestamp(void) const;
+	/// @brief Frames the index covers.
+	uint64_t getNumOfFrames(void) const;
+
+	static const uint16_t version = 2;
+	static const size_t headerSize = 32;
+private:
+	QFile file;
+	uint64_t numOfAppended;   //!< entries written since create
+	std::vector<CaptureBlockIndex> entryVec;
+	bool read(const QString &indexPathRef, uint64_t captureSize);
+	void build(CaptureFile &captureRef);
+	bool store(const QString &indexPathRef, uint64_t captureSize);
+	static void writeHeader(uint8_t *dstPtr, uint64_t captureSize, uint64_t numOfEntries);
+	static const char magic[8];
+};
+
+#endif // CAPTUREINDEX_H
+
+/// @}
@@ -0,0 +1,220 @@
+#include <cstring>
+#include "capturereader.h"
+
+CaptureReader::CaptureReader(void) :
+	dataPtr(nullptr),
+	size(0),
+	pos(0),
+	offset(0),
+	isEnd(true),
+	version(CaptureVersion::Invalid),
+	createdUs(0),
+	numOfBadRecords(0),
+	recordPos(0),
+	recordBfr(CaptureFormat::maxRecordSize),
+	blockBfr(),
+	blockPos(0)
+{
+}
+
+CaptureVersion CaptureReader::open(const uint8_t *dataPtr, size_t size, bool isEnd)
+{
+	this->dataPtr = dataPtr;
+	this->size = size;
+	this->offset = 0;
+	this->isEnd = isEnd;
+	this->version = CaptureFormat::detect(dataPtr, size);
+	this->createdUs = CaptureFormat::getCreatedUs(dataPtr, size);
+	this->pos = CaptureFormat::getDataOffset(this->version);
+	this->numOfBadRecords = 0;
+	this->blockBfr.clear();
+	this->blockPos = 0;
+	if(this->version == CaptureVersion::Invalid) {
+		this->pos = size;
+		this->isEnd = true;
+	}
+	return this->version;
+}
+
+void CaptureReader::setWindow(const uint8_t *dataPtr, size_t size, uint64_t offset, bool isEnd)
+{
+	// decompressed block is a copy, it carries over to the new window
+	this->offset = offset;
+	this->dataPtr = dataPtr;
+	this->size = size;
+	this->pos = 0;
+	this->isEnd = isEnd;
+}
+
+bool CaptureReader::isWindowDone(void) const
+{
+	return !this->isEnd;
+}
+
+CaptureVersion CaptureReader::getVersion(void) const
+{
+	return this->version;
+}
+
+uint64_t CaptureReader::getCreatedUs(void) const
+{
+	return this->createdUs;
+}
+
+size_t CaptureReader::nextRecord(void)
+{
+	while(this->pos < this->size) {
+		const uint8_t *startPtr = this->dataPtr + this->pos;
+		// C libraries vectorize memchr, delimiter scan runs far beyond disk speed
+		const uint8_t *endPtr = static_cast<const uint8_t *>(memchr(startPtr, 0, this->size - this->pos));
+
+		if(endPtr == nullptr) {
+			if(!this->isEnd && this->pos != 0) {
+				// record goes on in next window
+				break;
+			}
+			// record cut off by end of file, capture was not closed cleanly,
+			// or longer than a whole window which no valid record is
+			this->pos = this->size;
+			break;
+		}
+		this->recordPos = this->pos;
+		this->pos += (endPtr - startPtr) + 1;
+		if(endPtr == startPtr) {
+			continue;
+		}
+		if(this->recordBfr.size() < (size_t)(endPtr - startPtr)) {
+			this->recordBfr.resize(endPtr - startPtr);
+		}
+		// straight from the mapped file, no copy before decoding
+		const size_t recordSize = CaptureFormat::decodeRecord(startPtr, endPtr - startPtr, this->recordBfr.data(), this->recordBfr.size());
+		if(recordSize == 0) {
+			++this->numOfBadRecords;
+			continue;
+		}
+		return recordSize;
+	}
+	return 0;
+}
+
+bool CaptureReader::nextBlockFrame(CanMsg &canMsgRef)
+{
+	const uint8_t *blockPtr = reinterpret_cast<const uint8_t *>(this->blockBfr.constData());
+	const qsizetype remaining = this->blockBfr.size() - this->blockPos;
+
+	if(remaining < (qsizetype)CaptureFormat::frameHeaderSize) {
+		return false;
+	}
+	const size_t recordSize = CaptureFormat::getRecordSize(blockPtr + this->blockPos);
+	if(recordSize == 0 || (qsizetype)recordSize > remaining ||
+		!CaptureFormat::decodeFrame(blockPtr + this->blockPos, recordSize, canMsgRef)) {
+		// rest of the block cannot be trusted
+		++this->numOfBadRecords;
+		this->blockPos = this->blockBfr.size();
+		return false;
+	}
+	this->blockPos += recordSize;
+	return true;
+}
+
+bool CaptureReader::next(CanMsg &canMsgRef)
+{
+	size_t recordSize = 0;
+	CaptureBlockIndex index;
+
+	if(nextBlockFrame(canMsgRef)) {
+		return true;
+	}
+	while((recordSize = nextRecord()) != 0) {
+		const uint8_t *recordPtr = this->recordBfr.data();
+		if(this->version == CaptureVersion::Legacy) {
+			if(CaptureFormat::decodeLegacyFrame(recordPtr, recordSize, canMsgRef)) {
+				return true;
+			}
+		} else if(recordPtr[0] == static_cast<uint8_t>(CaptureRecordType::BlockIndex)) {
+			continue;
+		} else if(recordPtr[0] == static_cast<uint8_t>(CaptureRecordType::CompressedBlock)) {
+			this->blockPos = 0;
+			if(!CaptureFormat::decompressBlock(recordPtr, recordSize, index, this->blockBfr)) {
+				this->blockBfr.clear();
+			} else if(nextBlockFrame(canMsgRef)) {
+				return true;
+			} else {
+				continue;
+			}
+		} else if(CaptureFormat::decodeFrame(recordPtr, recordSize, canMsgRef)) {
+			return true;
+		}
+		++this->numOfBadRecords;
+	}
+	return false;
+}
+
+bool CaptureReader::nextBlockIndex(CaptureBlockIndex &indexRef)
+{
+	size_t recordSize = 0;
+
+	if(this->version != CaptureVersion::V1) {
+		this->pos = this->size;
+		return false;
+	}
+	this->blockBfr.clear();
+	this->blockPos = 0;
+	while((recordSize = nextRecord()) != 0) {
+		const uint8_t *recordPtr = this->recordBfr.data();
+		if(CaptureFormat::decodeBlockIndex(recordPtr, recordSize, indexRef)) {
+			return true;
+		}
+		if(recordPtr[0] == static_cast<uint8_t>(CaptureRecordType::CompressedBlock) && recordSize > CaptureFormat::compressedHeaderSize) {
+			// header is enough, payload stays compressed
+			memcpy(&indexRef.numOfFrames, recordPtr + 4, sizeof(indexRef.numOfFrames));
+			memcpy(&indexRef.firstFrame, recordPtr + 16, sizeof(indexRef.firstFrame));
+			memcpy(&indexRef.firstTimestamp, recordPtr + 24, sizeof(indexRef.firstTimestamp));
+			memcpy(&indexRef.lastTimestamp, recordPtr + 32, sizeof(indexRef.lastTimestamp));
+			indexRef.blockOffset = this->offset + this->recordPos;
+			return true;
+		}
+	}
+	return false;
+}
+
+void CaptureReader::seek(uint64_t offset)
+{
+	const uint64_t dataOffset = CaptureFormat::getDataOffset(this->version);
+
+	this->blockBfr.clear();
+	this->blockPos = 0;
+	if(offset < dataOffset) {
+		offset = dataOffset;
+	}
+	if(offset < this->offset) {
+		offset = this->offset;
+	}
+	if(offset >= this->offset + this->size) {
+		this->pos = this->size;
+		return;
+	}
+	const size_t windowPos = offset - this->offset;
+	// a record starts right after a delimiter, at data offset or where a window starts
+	if(offset == dataOffset || windowPos == 0 || this->dataPtr[windowPos - 1] == 0) {
+		this->pos = windowPos;
+		return;
+	}
+	const uint8_t *zeroPtr = static_cast<const uint8_t *>(memchr(this->dataPtr + windowPos, 0, this->size - windowPos));
+	this->pos = zeroPtr == nullptr ? this->size : (zeroPtr - this->dataPtr) + 1;
+}
+
+uint64_t CaptureReader::getPos(void) const
+{
+	return this->offset + this->pos;
+}
+
+uint64_t CaptureReader::getSize(void) const
+{
+	return this->offset + this->size;
+}
+
+uint64_t CaptureReader::getNumOfBadRecords(void) const
+{
+	return this->numOfBadRecords;
+}
@@ -0,0 +1,67 @@
+/**
+ * @defgroup capturereader_h
+ * @{
+ * @file capturereader.h
+ * @brief Sequential reader of .cobs captures held in memory, current and legacy format.
+ * Compressed blocks are decompressed one at a time, only when a frame of them is needed.
+ * A large file can be handed over in windows, for example mapped one after the other, the
+ * reader then stops in front of a record that runs past the window and asks for the next one.
+ */
+#ifndef CAPTUREREADER_H
+#define CAPTUREREADER_H
+
+#include <QByteArray>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "captureformat.h"
+
+class CaptureReader
+{
+public:
+	CaptureReader(void);
+
+	/// @brief Buffer has to outlive the reader. Returns detected format.
+	/// Buffer is the whole file, or its first window when isEnd is false.
+	CaptureVersion open(const uint8_t *dataPtr, size_t size, bool isEnd = true);
+	/// @brief Continues in another window of the file. Window has to start on a record, usually at getPos().
+	void setWindow(const uint8_t *dataPtr, size_t size, uint64_t offset, bool isEnd);
+	/// @brief After next() returned false: file goes on past current window, see setWindow.
+	bool isWindowDone(void) const;
+	CaptureVersion getVersion(void) const;
+	/// @brief See CaptureFormat::getCreatedUs.
+	uint64_t getCreatedUs(void) const;
+	/// @brief Next frame, block index records are skipped. False at end of data or window.
+	bool next(CanMsg &canMsgRef);
+	/// @brief Next block index or compressed block header, frames are skipped. False at end of data.
+	/// For compressed blocks blockOffset is the offset of the block record itself.
+	bool nextBlockIndex(CaptureBlockIndex &indexRef);
+	/// @brief Continues at the first record that starts at or after file offset, within current window.
+	void seek(uint64_t offset);
+	/// @brief File offset of next record.
+	uint64_t getPos(void) const;
+	/// @brief File offset where current window ends.
+	uint64_t getSize(void) const;
+	/// @brief Records that failed to decode, they are skipped.
+	uint64_t getNumOfBadRecords(void) const;
+private:
+	const uint8_t *dataPtr;
+	size_t size;
+	size_t pos;
+	uint64_t offset;                 //!< file offset of dataPtr
+	bool isEnd;                      //!< window reaches end of file
+	CaptureVersion version;
+	uint64_t createdUs;
+	uint64_t numOfBadRecords;
+	size_t recordPos;                //!< window offset of last record returned by nextRecord
+	std::vector<uint8_t> recordBfr;  //!< grows to the largest compressed block
+	QByteArray blockBfr;             //!< plain frame records of current compressed block
+	qsizetype blockPos;
+	/// @brief Decodes next record into recordBfr, returns its size, 0 at end of data.
+	size_t nextRecord(void);
+	bool nextBlockFrame(CanMsg &canMsgRef);
+};
+
+#endif // CAPTUREREADER_H
+
+/// @}
@@ -0,0 +1,154 @@
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <cstring>
+#include "capturefile.h"
+#include "captureindex.h"
+#include "capturerepair.h"
+#include "util.h"
+
+RepairResult CaptureRepair::repair(const QString &filePathRef, uint64_t &droppedBytesRef, QString &errorStrRef)
+{
+	QFile file(filePathRef);
+	uint8_t header[CaptureFormat::fileHeaderSize] = {};
+	QByteArray bfr;
+	qint64 size = 0;
+	qint64 dataStart = 0;
+	qint64 lastPos = -1;
+	qint64 cutPos = 0;
+
+	droppedBytesRef = 0;
+	if(!file.open(QIODevice::ReadWrite)) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	size = file.size();
+	const qint64 headerSize = file.read(reinterpret_cast<char *>(header), sizeof(header));
+	const CaptureVersion version = CaptureFormat::detect(header, headerSize > 0 ? headerSize : 0);
+	// zero fill of a power loss may follow what made it to disk
+	if(!findLastNonZero(file, 0, size, lastPos)) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	if(isHeaderCut(header, size, lastPos + 1)) {
+		// no record made it to disk, header is written anew
+		CaptureFormat::writeFileHeader(header, QFileInfo(filePathRef).lastModified().toMSecsSinceEpoch() * 1000ULL);
+		if(!file.resize(0) || !file.seek(0) || file.write(reinterpret_cast<const char *>(header), sizeof(header)) != sizeof(header) || !Util::syncFile(file)) {
+			errorStrRef = file.errorString();
+			return RepairResult::Failed;
+		}
+		droppedBytesRef = size;
+		return RepairResult::Repaired;
+	}
+	// no file starts with a zero
+	if(header[0] == 0 || version == CaptureVersion::Invalid) {
+		errorStrRef = "Not a capture or unknown capture version";
+		return RepairResult::Failed;
+	}
+	dataStart = CaptureFormat::getDataOffset(version);
+
+	// lastPos skipped delimiter of last record and any zero fill
+	cutPos = dataStart;
+	if(lastPos >= dataStart) {
+		// last record starts after the zero before it
+		const qint64 windowStart = qMax(dataStart, lastPos + 1 - maxRecordSize);
+		if(!file.seek(windowStart) || (bfr = file.read(lastPos + 1 - windowStart)).size() != lastPos + 1 - windowStart) {
+			errorStrRef = file.errorString();
+			return RepairResult::Failed;
+		}
+		qint64 i = bfr.size() - 1;
+		while(i >= 0 && bfr[i] != 0) {
+			--i;
+		}
+		if(i < 0 && windowStart > dataStart) {
+			errorStrRef = QString("No record end in last %1 MiB").arg(maxRecordSize / 1024 / 1024);
+			return RepairResult::Failed;
+		}
+		const qint64 recordStart = windowStart + i + 1;
+		const bool isDelimited = lastPos + 1 < size;
+		const uint8_t *recordPtr = reinterpret_cast<const uint8_t *>(bfr.constData()) + i + 1;
+		cutPos = isDelimited && isRecordValid(version, recordPtr, lastPos + 1 - recordStart) ? lastPos + 2 : recordStart;
+	}
+
+	if(cutPos < size) {
+		if(!file.resize(cutPos) || !Util::syncFile(file)) {
+			errorStrRef = file.errorString();
+			return RepairResult::Failed;
+		}
+		droppedBytesRef = size - cutPos;
+	}
+	file.close();
+
+	if(version == CaptureVersion::V1) {
+		// index written along was left unfinished, load rebuilds it for the size the capture has now
+		CaptureFile capture;
+		CaptureIndex index;
+		if(capture.open(filePathRef)) {
+			index.load(capture);
+		}
+	}
+	return droppedBytesRef != 0 ? RepairResult::Repaired : RepairResult::Complete;
+}
+
+bool CaptureRepair::findLastNonZero(QFile &fileRef, qint64 startPos, qint64 endPos, qint64 &posRef)
+{
+	QByteArray bfr;
+
+	posRef = -1;
+	for(qint64 pos = endPos; pos > startPos; ) {
+		const qint64 readSize = qMin(chunkSize, pos - startPos);
+		pos -= readSize;
+		if(!fileRef.seek(pos) || (bfr = fileRef.read(readSize)).size() != readSize) {
+			return false;
+		}
+		for(qint64 i = readSize - 1; i >= 0; --i) {
+			if(bfr[i] != 0) {
+				posRef = pos + i;
+				return true;
+			}
+		}
+	}
+	return true;
+}
+
+bool CaptureRepair::isHeaderCut(const uint8_t *headerPtr, qint64 size, qint64 writtenSize)
+{
+	uint8_t expected[CaptureFormat::fileHeaderSize];
+	uint64_t createdUs = 0;
+
+	if(writtenSize > (qint64)CaptureFormat::fileHeaderSize) {
+		return false;
+	}
+	CaptureFormat::writeFileHeader(expected, 0);
+	if(memcmp(headerPtr, expected, qMin(writtenSize, fixedHeaderSize)) != 0) {
+		return false;
+	}
+	memcpy(&createdUs, headerPtr + fixedHeaderSize, sizeof(createdUs));
+	return size < (qint64)CaptureFormat::fileHeaderSize || createdUs < minCreatedUs;
+}
+
+bool CaptureRepair::isRecordValid(CaptureVersion version, const uint8_t *srcPtr, size_t size)
+{
+	QByteArray recordBfr(size, 0);
+	uint8_t *recordPtr = reinterpret_cast<uint8_t *>(recordBfr.data());
+	CanMsg canMsg;
+	CaptureBlockIndex index;
+	QByteArray framesBfr;
+
+	const size_t recordSize = CaptureFormat::decodeRecord(srcPtr, size, recordPtr, size);
+	if(recordSize == 0) {
+		return false;
+	}
+	if(version == CaptureVersion::Legacy) {
+		return CaptureFormat::decodeLegacyFrame(recordPtr, recordSize, canMsg);
+	}
+	switch(static_cast<CaptureRecordType>(recordPtr[0])) {
+	case CaptureRecordType::Frame:
+		return CaptureFormat::decodeFrame(recordPtr, recordSize, canMsg);
+	case CaptureRecordType::BlockIndex:
+		return CaptureFormat::decodeBlockIndex(recordPtr, recordSize, index);
+	case CaptureRecordType::CompressedBlock:
+		return CaptureFormat::decompressBlock(recordPtr, recordSize, index, framesBfr);
+	}
+	return false;
+}
@@ -0,0 +1,57 @@
+/**
+ * @defgroup capturerepair_h
+ * @{
+ * @file capturerepair.h
+ * @brief Repairs a .cobs capture that was cut short by a crash or a power loss.
+ *
+ * Every record ends with a zero byte, so a capture cut short still holds all records up to the
+ * last delimiter that made it to disk. What comes after that is dropped: a record without its
+ * delimiter, and zero bytes a file system may leave behind after a power loss. The last record
+ * left is decoded as well and dropped when it does not decode, a tail cut within a zero fill
+ * looks complete but is not. Only the tail is read, repair does not depend on capture size.
+ * A header cut short is written anew, zero fill after it or not.
+ * A V1 capture gets its .idx rebuilt afterwards, one written along was left unfinished.
+ */
+#ifndef CAPTUREREPAIR_H
+#define CAPTUREREPAIR_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include "captureformat.h"
+
+enum class RepairResult
+{
+	Complete, //!< nothing to repair
+	Repaired,
+	Failed    //!< file error or not a capture, see errorStrRef
+};
+
+class CaptureRepair
+{
+public:
+	/// @brief droppedBytesRef is what was cut off the end of the file.
+	static RepairResult repair(const QString &filePathRef, uint64_t &droppedBytesRef, QString &errorStrRef);
+
+	static const qint64 chunkSize = 1024 * 1024;
+	/// @brief Longest record looked for, compressed block records stay far below it.
+	static const qint64 maxRecordSize = 4 * 1024 * 1024;
+	/// @brief Magic, version, header size and frames per block, the same in every V1 header.
+	static const qint64 fixedHeaderSize = 16;
+	/// @brief A creation time before 2000-01-01 is a header cut within its time.
+	static const uint64_t minCreatedUs = 946684800ULL * 1000000;
+private:
+	/// @brief Position of last byte other than zero in [startPos, endPos), -1 when there is none.
+	/// False on read error.
+	static bool findLastNonZero(QFile &fileRef, qint64 startPos, qint64 endPos, qint64 &posRef);
+	/// @brief Header cut short before its creation time made it to disk, zero fill aside. No record
+	/// follows it, writtenSize is where the zero fill starts.
+	static bool isHeaderCut(const uint8_t *headerPtr, qint64 size, qint64 writtenSize);
+	static bool isRecordValid(CaptureVersion version, const uint8_t *srcPtr, size_t size);
+};
+
+#endif // CAPTUREREPAIR_H
+
+/// @}
@@ -0,0 +1,387 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include "capturestream.h"
+#include "captureindex.h"
+
+const QString CaptureStream::manifestExt = ".manifest";
+const QByteArray CaptureStream::manifestMagic = QByteArrayLiteral("UDSTMAN 1");
+
+CaptureStream::CaptureStream(void) :
+	segmentList(),
+	segmentInfoVec(),
+	segmentIdx(0),
+	file(),
+	textFile(),
+	errorStr(""),
+	numOfBadRecords(0),
+	isPending(false),
+	pendingMsg(),
+	frame(0)
+{
+}
+
+bool CaptureStream::isManifest(const QString &pathRef)
+{
+	QFile manifestFile(pathRef);
+
+	if(!manifestFile.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	return manifestFile.readLine().trimmed() == manifestMagic;
+}
+
+bool CaptureStream::readManifest(const QString &pathRef, QStringList &segmentListRef)
+{
+	QFile manifestFile(pathRef);
+	const QDir dir = QFileInfo(pathRef).absoluteDir();
+
+	if(!manifestFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false;
+	}
+	if(manifestFile.readLine().trimmed() != manifestMagic) {
+		return false;
+	}
+	segmentListRef.clear();
+	while(!manifestFile.atEnd()) {
+		const QString name = QString::fromUtf8(manifestFile.readLine().trimmed());
+		if(!name.isEmpty()) {
+			segmentListRef.append(dir.filePath(name));
+		}
+	}
+	return true;
+}
+
+bool CaptureStream::writeManifest(const QString &pathRef, const QStringList &segmentListRef)
+{
+	// a reader never sees a half written manifest
+	QSaveFile manifestFile(pathRef);
+
+	if(!manifestFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		return false;
+	}
+	manifestFile.write(manifestMagic + "\n");
+	for(const QString &segmentRef : segmentListRef) {
+		manifestFile.write(QFileInfo(segmentRef).fileName().toUtf8() + "\n");
+	}
+	return manifestFile.commit();
+}
+
+bool CaptureStream::open(const QString &pathRef)
+{
+	close();
+
+	if(isManifest(pathRef)) {
+		if(!readManifest(pathRef, this->segmentList)) {
+			this->errorStr = "Manifest cannot be read: " + pathRef;
+			return false;
+		}
+	} else if(CaptureText::detect(pathRef) != CaptureTextFormat::Unknown) {
+		this->segmentList = QStringList({ pathRef });
+		if(!this->textFile.open(pathRef)) {
+			this->errorStr = pathRef + ": " + this->textFile.errorString();
+			return false;
+		}
+		return true;
+	} else {
+		this->segmentList = QStringList({ pathRef });
+	}
+	if(this->segmentList.isEmpty()) {
+		this->errorStr = "Manifest lists no segments: " + pathRef;
+		return false;
+	}
+	this->segmentInfoVec.assign(this->segmentList.size(), SegmentInfo());
+	return openSegment(0);
+}
+
+void CaptureStream::close(void)
+{
+	this->file.close();
+	this->textFile.close();
+	this->segmentList.clear();
+	this->segmentInfoVec.clear();
+	this->segmentIdx = 0;
+	this->errorStr = "";
+	this->numOfBadRecords = 0;
+	this->isPending = false;
+	this->frame = 0;
+}
+
+bool CaptureStream::isOpen(void) const
+{
+	return this->file.isOpen() || this->textFile.isOpen();
+}
+
+QString CaptureStream::errorString(void) const
+{
+	return this->errorStr;
+}
+
+CaptureVersion CaptureStream::getVersion(void) const
+{
+	return this->file.getVersion();
+}
+
+uint64_t CaptureStream::getCreatedUs(void) const
+{
+	return isText() ? 0 : this->file.getCreatedUs();
+}
+
+CaptureTextFormat CaptureStream::getTextFormat(void) const
+{
+	return this->textFile.getFormat();
+}
+
+bool CaptureStream::isText(void) const
+{
+	return this->textFile.isOpen();
+}
+
+bool CaptureStream::nextInSegment(CanMsg &canMsgRef)
+{
+	if(isText()) {
+		return this->textFile.next(canMsgRef);
+	}
+	return this->file.isOpen() && this->file.next(canMsgRef);
+}
+
+/// Segment index moves on even when segment cannot be opened, next() then skips it.
+bool CaptureStream::openSegment(int segmentIdx)
+{
+	this->file.close();
+	this->segmentIdx = segmentIdx;
+	this->isPending = false;
+	if(!this->file.open(this->segmentList[segmentIdx])) {
+		this->errorStr = this->segmentList[segmentIdx] + ": " + this->file.errorString();
+		return false;
+	}
+	return true;
+}
+
+/// Seeks and counts stop at a segment that cannot be opened instead of skipping it,
+/// every frame number after it would be off.
+bool CaptureStream::countSegment(int segmentIdx, CaptureIndex &indexRef, uint64_t &numOfFramesRef)
+{
+	SegmentInfo &infoRef = this->segmentInfoVec[segmentIdx];
+	CanMsg canMsg;
+
+	if(!openSegment(segmentIdx)) {
+		return false;
+	}
+	if(indexRef.load(this->file)) {
+		numOfFramesRef = indexRef.getNumOfFrames();
+	} else {
+		// no block to seek to, what frames there are still count for the segments after it
+		numOfFramesRef = 0;
+		if(!openSegment(segmentIdx)) {
+			return false;
+		}
+		while(this->file.next(canMsg)) {
+			++numOfFramesRef;
+		}
+	}
+	infoRef.isCounted = true;
+	infoRef.isIndexed = !indexRef.isEmpty();
+	infoRef.numOfFrames = numOfFramesRef;
+	infoRef.lastTimestamp = indexRef.getLastTimestamp();
+	return true;
+}
+
+bool CaptureStream::isSegmentCounted(int segmentIdx) const
+{
+	return segmentIdx + 1 < this->segmentList.size() && this->segmentInfoVec[segmentIdx].isCounted;
+}
+
+bool CaptureStream::next(CanMsg &canMsgRef)
+{
+	if(this->isPending) {
+		canMsgRef = this->pendingMsg;
+		this->isPending = false;
+		++this->frame;
+		return true;
+	}
+	while(true) {
+		if(nextInSegment(canMsgRef)) {
+			++this->frame;
+			return true;
+		}
+		if(this->segmentIdx + 1 >= this->segmentList.size()) {
+			return false;
+		}
+		this->numOfBadRecords += this->file.getNumOfBadRecords();
+		openSegment(this->segmentIdx + 1);
+	}
+}
+
+/// Text logs have no index, they are read from the start up to the first frame at or after both.
+bool CaptureStream::seekText(uint64_t timestampUs, uint64_t frame)
+{
+	this->isPending = false;
+	if(!this->textFile.rewind()) {
+		return false;
+	}
+	for(uint64_t current = 0; this->textFile.next(this->pendingMsg); ++current) {
+		if(current >= frame && this->pendingMsg.timestamp >= timestampUs) {
+			this->isPending = true;
+			this->frame = current;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CaptureStream::seekTimestamp(uint64_t timestampUs)
+{
+	uint64_t firstFrame = 0;
+
+	this->errorStr = "";
+	if(isText()) {
+		return seekText(timestampUs, 0);
+	}
+	for(int i = 0; i < this->segmentList.size(); ++i) {
+		CaptureIndex index;
+		CaptureBlockIndex block = {};
+		uint64_t numOfFrames = 0;
+		const bool isLast = i + 1 == this->segmentList.size();
+
+		if(isSegmentCounted(i)) {
+			const SegmentInfo &infoRef = this->segmentInfoVec[i];
+			if(!infoRef.isIndexed || infoRef.lastTimestamp < timestampUs) {
+				firstFrame += infoRef.numOfFrames;
+				continue;
+			}
+		}
+		if(!countSegment(i, index, numOfFrames)) {
+			return false;
+		}
+		if(index.isEmpty() || (index.getLastTimestamp() < timestampUs && !isLast)) {
+			firstFrame += numOfFrames;
+			continue;
+		}
+		index.findTimestamp(timestampUs, block);
+		this->file.seek(block.blockOffset);
+		for(uint64_t current = firstFrame + block.firstFrame; this->file.next(this->pendingMsg); ++current) {
+			if(this->pendingMsg.timestamp >= timestampUs) {
+				this->isPending = true;
+				this->frame = current;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool CaptureStream::seekFrame(uint64_t frame)
+{
+	uint64_t firstFrame = 0;
+
+	this->errorStr = "";
+	if(isText()) {
+		return seekText(0, frame);
+	}
+	for(int i = 0; i < this->segmentList.size(); ++i) {
+		CaptureIndex index;
+		CaptureBlockIndex block = {};
+		uint64_t numOfFrames = 0;
+		const bool isLast = i + 1 == this->segmentList.size();
+
+		if(isSegmentCounted(i)) {
+			const SegmentInfo &infoRef = this->segmentInfoVec[i];
+			if(!infoRef.isIndexed || frame >= firstFrame + infoRef.numOfFrames) {
+				firstFrame += infoRef.numOfFrames;
+				continue;
+			}
+		}
+		if(!countSegment(i, index, numOfFrames)) {
+			return false;
+		}
+		if(index.isEmpty() || (frame >= firstFrame + numOfFrames && !isLast)) {
+			firstFrame += numOfFrames;
+			continue;
+		}
+		index.findFrame(frame - firstFrame, block);
+		this->file.seek(block.blockOffset);
+		for(uint64_t current = firstFrame + block.firstFrame; this->file.next(this->pendingMsg); ++current) {
+			if(current >= frame) {
+				this->isPending = true;
+				this->frame = current;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool CaptureStream::rewind(void)
+{
+	this->frame = 0;
+	if(isText()) {
+		this->isPending = false;
+		return this->textFile.rewind();
+	}
+	return openSegment(0);
+}
+
+/// Rewinds the stream to its first frame.
+uint64_t CaptureStream::getFirstTimestamp(void)
+{
+	CanMsg canMsg;
+
+	this->frame = 0;
+	if(isText()) {
+		this->isPending = false;
+		const bool isFound = this->textFile.rewind() && this->textFile.next(canMsg);
+		this->textFile.rewind();
+		return isFound ? canMsg.timestamp : 0;
+	}
+	for(int i = 0; i < this->segmentList.size(); ++i) {
+		if(openSegment(i) && this->file.next(canMsg)) {
+			openSegment(i);
+			return canMsg.timestamp;
+		}
+	}
+	return 0;
+}
+
+/// Index of a segment that has none yet is built and stored on the way.
+uint64_t CaptureStream::getNumOfFrames(void)
+{
+	uint64_t numOfFrames = 0;
+
+	if(isText()) {
+		return 0;
+	}
+	for(int i = 0; i < this->segmentList.size(); ++i) {
+		CaptureIndex index;
+		uint64_t numOfSegmentFrames = 0;
+
+		if(isSegmentCounted(i)) {
+			numOfFrames += this->segmentInfoVec[i].numOfFrames;
+			continue;
+		}
+		if(!countSegment(i, index, numOfSegmentFrames)) {
+			numOfFrames = 0;
+			break;
+		}
+		numOfFrames += numOfSegmentFrames;
+	}
+	openSegment(0);
+	this->frame = 0;
+	return numOfFrames;
+}
+
+uint64_t CaptureStream::getFrame(void) const
+{
+	return this->frame;
+}
+
+uint64_t CaptureStream::getNumOfBadRecords(void) const
+{
+	return this->numOfBadRecords + this->file.getNumOfBadRecords() + this->textFile.getNumOfBadRecords();
+}
+
+QStringList CaptureStream::getSegmentList(void) const
+{
+	return this->segmentList;
+}
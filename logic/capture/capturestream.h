@@ -0,0 +1,104 @@
+/**
+ * @defgroup capturestream_h
+ * @{
+ * @file capturestream.h
+ * @brief Capture that may be split into rotated segments, read as one stream.
+ *
+ * A rotated capture is described by a manifest, a text file next to its segments:
+ *
+ *     UDSTMAN 1
+ *     20250505_190901_003.cobs
+ *     20250505_190901_004.cobs
+ *
+ * First line is magic and version, every further line names a segment in capture order,
+ * relative to the manifest. Each segment is a complete .cobs capture with its own .idx.
+ * A plain .cobs file opens as a stream of one segment, so does a text log of another tool, see
+ * capturetext.h. Text logs have no index, seeking in them reads from the start.
+ * Frame count and last timestamp of a segment are kept once it was counted, seeks pass by such
+ * segments without opening them. The last segment is always counted again, it may still grow.
+ */
+#ifndef CAPTURESTREAM_H
+#define CAPTURESTREAM_H
+
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <vector>
+#include "capturefile.h"
+#include "captureindex.h"
+#include "capturetext.h"
+
+class CaptureStream
+{
+public:
+	CaptureStream(void);
+
+	/// @brief Manifest or single capture.
+	bool open(const QString &pathRef);
+	void close(void);
+	bool isOpen(void) const;
+	QString errorString(void) const;
+	/// @brief Version of segment being read.
+	CaptureVersion getVersion(void) const;
+	/// @brief Creation time of segment being read, 0 for text logs and older captures.
+	uint64_t getCreatedUs(void) const;
+	/// @brief Unknown unless stream is a text log.
+	CaptureTextFormat getTextFormat(void) const;
+	/// @brief Next frame, moves on to next segment at the end of one. False at end of stream.
+	bool next(CanMsg &canMsgRef);
+	/// @brief Positions on the first frame at or after timestampUs, through segment indexes.
+	/// False past the end, or with errorString set when a segment on the way cannot be read.
+	bool seekTimestamp(uint64_t timestampUs);
+	/// @brief Positions on frame number frame, counted from 0 over all segments. False as seekTimestamp.
+	bool seekFrame(uint64_t frame);
+	/// @brief Back to the first frame, without the index.
+	bool rewind(void);
+	uint64_t getFirstTimestamp(void);
+	/// @brief Frames of all segments as their indexes count them, 0 for a text log or when a segment
+	/// cannot be read. Rewinds the stream.
+	uint64_t getNumOfFrames(void);
+	/// @brief Number of the frame next() returns next, counted from 0 over all segments.
+	uint64_t getFrame(void) const;
+	uint64_t getNumOfBadRecords(void) const;
+	QStringList getSegmentList(void) const;
+
+	static bool isManifest(const QString &pathRef);
+	static bool readManifest(const QString &pathRef, QStringList &segmentListRef);
+	/// @brief Replaces manifest atomically, segment names are stored relative to it.
+	static bool writeManifest(const QString &pathRef, const QStringList &segmentListRef);
+	static const QString manifestExt;
+private:
+	/// @brief What seeks need to know of a segment to pass it by.
+	struct SegmentInfo
+	{
+		bool isCounted;
+		bool isIndexed;        //!< has a block to seek to
+		uint64_t numOfFrames;
+		uint64_t lastTimestamp;
+	};
+	static const QByteArray manifestMagic;
+	QStringList segmentList;   //!< absolute paths
+	std::vector<SegmentInfo> segmentInfoVec; //!< one per segment, filled as segments are counted
+	int segmentIdx;
+	CaptureFile file;
+	CaptureText textFile;      //!< used instead of file for text logs
+	QString errorStr;
+	uint64_t numOfBadRecords;  //!< of segments next() already left
+	bool isPending;            //!< pendingMsg is next frame, left there by a seek
+	CanMsg pendingMsg;
+	uint64_t frame;            //!< see getFrame
+	bool openSegment(int segmentIdx);
+	/// @brief Opens segment and loads its index. Frames of a segment its index has none of are
+	/// counted by reading it. False when it cannot be opened, frame numbers after it would be off.
+	bool countSegment(int segmentIdx, CaptureIndex &indexRef, uint64_t &numOfFramesRef);
+	/// @brief Counted before and not the last one, which may still grow.
+	bool isSegmentCounted(int segmentIdx) const;
+	bool isText(void) const;
+	/// @brief Next frame of current segment.
+	bool nextInSegment(CanMsg &canMsgRef);
+	bool seekText(uint64_t timestampUs, uint64_t frame);
+};
+
+#endif // CAPTURESTREAM_H
+
+/// @}
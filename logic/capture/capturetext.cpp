@@ -0,0 +1,737 @@
+#include <cstring>
+#include "capturetext.h"
+
+CaptureText::CaptureText(void) :
+	file(),
+	errorStr(""),
+	format(CaptureTextFormat::Unknown),
+	chunk(),
+	chunkPos(0),
+	isEof(false),
+	numOfBadRecords(0),
+	trcColumns(),
+	isTrcLegacy(true),
+	isAscDec(false),
+	isAscRelative(false),
+	ascTimestamp(0),
+	candumpIfaceVec()
+{
+}
+
+CaptureText::~CaptureText()
+{
+	close();
+}
+
+CaptureTextFormat CaptureText::detect(const QString &filePathRef)
+{
+	QFile detectFile(filePathRef);
+
+	if(!detectFile.open(QIODevice::ReadOnly)) {
+		return CaptureTextFormat::Unknown;
+	}
+	const QByteArray head = detectFile.read(detectSize);
+	return detect(head.constData(), head.size());
+}
+
+CaptureTextFormat CaptureText::detect(const char *dataPtr, size_t size)
+{
+	const char *endPtr = dataPtr + size;
+	Token token = {};
+
+	// a zero byte is a record delimiter of a .cobs capture, never part of a text log
+	if(memchr(dataPtr, 0, size) != nullptr) {
+		return CaptureTextFormat::Unknown;
+	}
+	while(dataPtr < endPtr) {
+		const char *lineEndPtr = static_cast<const char *>(memchr(dataPtr, '\n', endPtr - dataPtr));
+		const char *linePtr = dataPtr;
+
+		if(lineEndPtr == nullptr) {
+			lineEndPtr = endPtr;
+		}
+		dataPtr = lineEndPtr + 1;
+		if(!nextToken(linePtr, lineEndPtr, token)) {
+			continue;
+		}
+		// first line that is not blank decides
+		if(token.ptr[0] == ';') {
+			return CaptureTextFormat::Trc;
+		}
+		if(token.ptr[0] == '(' && memchr(linePtr, '#', lineEndPtr - linePtr) != nullptr) {
+			return CaptureTextFormat::Candump;
+		}
+		if(isToken(token, "date") || isToken(token, "base") || isToken(token, "Begin") ||
+			(token.size >= 2 && token.ptr[0] == '/' && token.ptr[1] == '/')) {
+			return CaptureTextFormat::Asc;
+		}
+		break;
+	}
+	return CaptureTextFormat::Unknown;
+}
+
+QString CaptureText::getFormatName(CaptureTextFormat format)
+{
+	switch(format) {
+	case CaptureTextFormat::Trc:
+		return "PEAK trc";
+	case CaptureTextFormat::Candump:
+		return "candump";
+	case CaptureTextFormat::Asc:
+		return "Vector ASC";
+	default:
+		return "cobs";
+	}
+}
+
+bool CaptureText::open(const QString &filePathRef)
+{
+	close();
+
+	this->format = detect(filePathRef);
+	if(this->format == CaptureTextFormat::Unknown) {
+		this->errorStr = "Not a trc, candump or ASC log";
+		return false;
+	}
+	this->file.setFileName(filePathRef);
+	if(!this->file.open(QIODevice::ReadOnly)) {
+		this->errorStr = this->file.errorString();
+		return false;
+	}
+	reset();
+	return true;
+}
+
+void CaptureText::close(void)
+{
+	this->file.close();
+	this->errorStr = "";
+	this->format = CaptureTextFormat::Unknown;
+	this->chunk.clear();
+	this->chunkPos = 0;
+}
+
+bool CaptureText::isOpen(void) const
+{
+	return this->file.isOpen();
+}
+
+QString CaptureText::errorString(void) const
+{
+	return this->errorStr;
+}
+
+QString CaptureText::getFilePath(void) const
+{
+	return this->file.fileName();
+}
+
+CaptureTextFormat CaptureText::getFormat(void) const
+{
+	return this->format;
+}
+
+uint64_t CaptureText::getNumOfBadRecords(void) const
+{
+	return this->numOfBadRecords;
+}
+
+/// Header state goes too, the header is read again from the first line.
+void CaptureText::reset(void)
+{
+	this->chunk.clear();
+	this->chunkPos = 0;
+	this->isEof = false;
+	this->numOfBadRecords = 0;
+	// a trace without $FILEVERSION is 1.0
+	this->trcColumns = "NOTIdlD";
+	this->isTrcLegacy = true;
+	this->isAscDec = false;
+	this->isAscRelative = false;
+	this->ascTimestamp = 0;
+	this->candumpIfaceVec.clear();
+}
+
+bool CaptureText::rewind(void)
+{
+	if(!this->file.isOpen() || !this->file.seek(0)) {
+		return false;
+	}
+	reset();
+	return true;
+}
+
+bool CaptureText::next(CanMsg &canMsgRef)
+{
+	const char *linePtr = nullptr;
+	const char *endPtr = nullptr;
+
+	while(nextLine(linePtr, endPtr)) {
+		LineType lineType = LineType::Other;
+
+		canMsgRef.flags = 0;
+		canMsgRef.channel = 0;
+		canMsgRef.dataLength = 0;
+		switch(this->format) {
+		case CaptureTextFormat::Trc:
+			lineType = parseTrc(linePtr, endPtr, canMsgRef);
+			break;
+		case CaptureTextFormat::Candump:
+			lineType = parseCandump(linePtr, endPtr, canMsgRef);
+			break;
+		case CaptureTextFormat::Asc:
+			lineType = parseAsc(linePtr, endPtr, canMsgRef);
+			break;
+		default:
+			return false;
+		}
+		if(lineType == LineType::Frame) {
+			return true;
+		}
+		if(lineType == LineType::Bad) {
+			++this->numOfBadRecords;
+		}
+	}
+	return false;
+}
+
+bool CaptureText::nextLine(const char *&linePtr, const char *&endPtr)
+{
+	while(true) {
+		const char *startPtr = this->chunk.constData() + this->chunkPos;
+		const size_t remaining = this->chunk.size() - this->chunkPos;
+		const char *newLinePtr = static_cast<const char *>(memchr(startPtr, '\n', remaining));
+
+		if(newLinePtr != nullptr) {
+			linePtr = startPtr;
+			endPtr = newLinePtr;
+			this->chunkPos += (newLinePtr - startPtr) + 1;
+			if(endPtr != linePtr && endPtr[-1] == '\r') {
+				--endPtr;
+			}
+			return true;
+		}
+		if(this->isEof) {
+			if(remaining == 0) {
+				return false;
+			}
+			// last line has no line end
+			linePtr = startPtr;
+			endPtr = startPtr + remaining;
+			this->chunkPos = this->chunk.size();
+			return true;
+		}
+		readChunk();
+	}
+}
+
+/// Moves the partial line left in chunk to its front and fills up the rest from file.
+void CaptureText::readChunk(void)
+{
+	const qsizetype remaining = this->chunk.size() - this->chunkPos;
+
+	if(remaining != 0 && this->chunkPos != 0) {
+		memmove(this->chunk.data(), this->chunk.constData() + this->chunkPos, remaining);
+	}
+	this->chunkPos = 0;
+	this->chunk.resize(remaining + chunkSize);
+	const qint64 readSize = this->file.read(this->chunk.data() + remaining, chunkSize);
+	if(readSize <= 0) {
+		this->isEof = true;
+		this->chunk.resize(remaining);
+		return;
+	}
+	this->chunk.resize(remaining + readSize);
+}
+
+void CaptureText::parseTrcHeader(const char *linePtr, const char *endPtr)
+{
+	static const char versionKey[] = ";$FILEVERSION=";
+	static const char columnsKey[] = ";$COLUMNS=";
+	const size_t size = endPtr - linePtr;
+
+	if(size > sizeof(versionKey) - 1 && memcmp(linePtr, versionKey, sizeof(versionKey) - 1) == 0) {
+		this->isTrcLegacy = linePtr[sizeof(versionKey) - 1] == '1';
+		// 2.0 has no $COLUMNS line, it always uses these
+		this->trcColumns = "NOTIdlD";
+		return;
+	}
+	if(size > sizeof(columnsKey) - 1 && memcmp(linePtr, columnsKey, sizeof(columnsKey) - 1) == 0) {
+		this->trcColumns.clear();
+		for(const char *ptr = linePtr + sizeof(columnsKey) - 1; ptr < endPtr; ++ptr) {
+			if(*ptr != ',' && *ptr != ' ') {
+				this->trcColumns.append(*ptr);
+			}
+		}
+	}
+}
+
+/// 2.x line, `7  12.345 DT     0123 Rx 8  01 02 03 04 05 06 07 08`, columns as in trcColumns.
+CaptureText::LineType CaptureText::parseTrc(const char *linePtr, const char *endPtr, CanMsg &canMsgRef)
+{
+	Token token = {};
+	uint32_t value = 0;
+	bool isRtr = false;
+	bool hasLength = false;
+
+	if(linePtr == endPtr) {
+		return LineType::Other;
+	}
+	if(linePtr[0] == ';') {
+		parseTrcHeader(linePtr, endPtr);
+		return LineType::Other;
+	}
+	if(this->isTrcLegacy) {
+		return parseTrcLegacy(linePtr, endPtr, canMsgRef);
+	}
+	for(qsizetype i = 0; i < this->trcColumns.size(); ++i) {
+		const char column = this->trcColumns[i];
+
+		if(column == 'D') {
+			if(isRtr) {
+				break;
+			}
+			if(!hasLength || !parseData(linePtr, endPtr, false, canMsgRef)) {
+				return LineType::Bad;
+			}
+			break;
+		}
+		if(!nextToken(linePtr, endPtr, token)) {
+			return LineType::Bad;
+		}
+		switch(column) {
+		case 'O':
+			if(!parseFixed(token, 3, canMsgRef.timestamp)) {
+				return LineType::Bad;
+			}
+			break;
+		case 'T':
+			// status, error and event lines carry no frame
+			if(token.size != 2) {
+				return LineType::Other;
+			}
+			if(isToken(token, "RR")) {
+				isRtr = true;
+				canMsgRef.flags |= CanMsgFlagRtr;
+			} else if(isToken(token, "FD")) {
+				canMsgRef.flags |= CanMsgFlagFd;
+			} else if(isToken(token, "FB")) {
+				canMsgRef.flags |= CanMsgFlagFd | CanMsgFlagBrs;
+			} else if(isToken(token, "FE")) {
+				canMsgRef.flags |= CanMsgFlagFd | CanMsgFlagEsi;
+			} else if(isToken(token, "BI")) {
+				canMsgRef.flags |= CanMsgFlagFd | CanMsgFlagBrs | CanMsgFlagEsi;
+			} else if(!isToken(token, "DT")) {
+				return LineType::Other;
+			}
+			break;
+		case 'B':
+			if(!parseDec(token, value)) {
+				return LineType::Bad;
+			}
+			canMsgRef.channel = value > 0 ? value - 1 : 0;
+			break;
+		case 'I':
+			if(!parseHex(token, value)) {
+				return LineType::Bad;
+			}
+			canMsgRef.id = value;
+			// PEAK writes 4 digits for 11 bit and 8 for 29 bit ids
+			canMsgRef.flags |= (token.size > 4 || value > 0x7FF) ? CanMsgFlagExtended : 0;
+			break;
+		case 'd':
+			canMsgRef.flags |= isToken(token, "Tx") ? CanMsgFlagTx : 0;
+			break;
+		case 'l':
+			if(!parseDec(token, value) || value > sizeof(CanMsg::data)) {
+				return LineType::Bad;
+			}
+			canMsgRef.dataLength = value;
+			hasLength = true;
+			break;
+		case 'L':
+			if(!parseDec(token, value) || value > 15) {
+				return LineType::Bad;
+			}
+			canMsgRef.dataLength = (canMsgRef.flags & CanMsgFlagFd) ? dlcToLength(value) : qMin<uint32_t>(value, 8);
+			hasLength = true;
+			break;
+		default:
+			// N message number, R reserved
+			break;
+		}
+	}
+	if(isRtr) {
+		canMsgRef.dataLength = 0;
+	}
+	return LineType::Frame;
+}
+
+/// 1.x line, `1)  1059.9  Rx  0300  8  00 00 00 00 04 00 00 00`. 1.0 has no direction,
+/// 1.2 and 1.3 add a bus column in front of it and 1.3 a reserved `-` after the id.
+CaptureText::LineType CaptureText::parseTrcLegacy(const char *linePtr, const char *endPtr, CanMsg &canMsgRef)
+{
+	Token token = {};
+	uint32_t value = 0;
+
+	if(!nextToken(linePtr, endPtr, token) || token.ptr[token.size - 1] != ')') {
+		return LineType::Other;
+	}
+	if(!nextToken(linePtr, endPtr, token) || !parseFixed(token, 3, canMsgRef.timestamp)) {
+		return LineType::Bad;
+	}
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	if(token.size == 1 && parseDec(token, value)) {
+		canMsgRef.channel = value > 0 ? value - 1 : 0;
+		if(!nextToken(linePtr, endPtr, token)) {
+			return LineType::Bad;
+		}
+	}
+	if(isToken(token, "Rx") || isToken(token, "Tx")) {
+		canMsgRef.flags |= isToken(token, "Tx") ? CanMsgFlagTx : 0;
+		if(!nextToken(linePtr, endPtr, token)) {
+			return LineType::Bad;
+		}
+	}
+	// Warng and Error lines end up here
+	if(!parseHex(token, value)) {
+		return LineType::Other;
+	}
+	canMsgRef.id = value;
+	canMsgRef.flags |= (token.size > 4 || value > 0x7FF) ? CanMsgFlagExtended : 0;
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	if(isToken(token, "-") && !nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	if(!parseDec(token, value) || value > 8) {
+		return LineType::Bad;
+	}
+	canMsgRef.dataLength = value;
+	const char *dataPtr = linePtr;
+	if(nextToken(dataPtr, endPtr, token) && isToken(token, "RTR")) {
+		canMsgRef.dataLength = 0;
+		canMsgRef.flags |= CanMsgFlagRtr;
+		return LineType::Frame;
+	}
+	return parseData(linePtr, endPtr, false, canMsgRef) ? LineType::Frame : LineType::Bad;
+}
+
+/// `(1436509052.249713) vcan0 123#11223344`, `12345678##311223344` for FD, `123#R` for remote
+/// frames, newer candump adds ` T` or ` R` for the direction.
+CaptureText::LineType CaptureText::parseCandump(const char *linePtr, const char *endPtr, CanMsg &canMsgRef)
+{
+	Token token = {};
+	Token iface = {};
+	uint32_t value = 0;
+
+	if(!nextToken(linePtr, endPtr, token) || token.ptr[0] != '(') {
+		return LineType::Other;
+	}
+	if(token.size < 3 || token.ptr[token.size - 1] != ')') {
+		return LineType::Bad;
+	}
+	if(!parseFixed({ token.ptr + 1, token.size - 2 }, 6, canMsgRef.timestamp)) {
+		return LineType::Bad;
+	}
+	if(!nextToken(linePtr, endPtr, iface) || !nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	const char *framePtr = token.ptr;
+	const char *frameEndPtr = token.ptr + token.size;
+	const char *hashPtr = static_cast<const char *>(memchr(framePtr, '#', token.size));
+	if(hashPtr == nullptr || !parseHex({ framePtr, (size_t)(hashPtr - framePtr) }, value)) {
+		return LineType::Bad;
+	}
+	// 8 digits carry the 29 bit id, or an error frame with CAN_ERR_FLAG set
+	if(hashPtr - framePtr == 8) {
+		if(value & 0x20000000u) {
+			return LineType::Other;
+		}
+		canMsgRef.flags |= CanMsgFlagExtended;
+	}
+	canMsgRef.id = value;
+	framePtr = hashPtr + 1;
+	if(framePtr < frameEndPtr && *framePtr == '#') {
+		if(frameEndPtr - framePtr < 2 || hexDigit(framePtr[1]) < 0) {
+			return LineType::Bad;
+		}
+		const int fdFlags = hexDigit(framePtr[1]);
+		canMsgRef.flags |= CanMsgFlagFd;
+		canMsgRef.flags |= (fdFlags & 0x01) ? CanMsgFlagBrs : 0;
+		canMsgRef.flags |= (fdFlags & 0x02) ? CanMsgFlagEsi : 0;
+		framePtr += 2;
+	} else if(framePtr < frameEndPtr && *framePtr == 'R') {
+		canMsgRef.flags |= CanMsgFlagRtr;
+		framePtr = frameEndPtr;
+	}
+	const size_t maxLength = (canMsgRef.flags & CanMsgFlagFd) ? sizeof(CanMsg::data) : 8;
+	while(framePtr + 1 < frameEndPtr && *framePtr != '_') {
+		const int high = hexDigit(framePtr[0]);
+		const int low = hexDigit(framePtr[1]);
+		if(high < 0 || low < 0 || canMsgRef.dataLength == maxLength) {
+			return LineType::Bad;
+		}
+		canMsgRef.data[canMsgRef.dataLength++] = (high << 4) | low;
+		framePtr += 2;
+	}
+	// `_<dlc>` of classic frames with a DLC above 8 is left out
+	if(framePtr != frameEndPtr && *framePtr != '_') {
+		return LineType::Bad;
+	}
+	if(nextToken(linePtr, endPtr, token) && isToken(token, "T")) {
+		canMsgRef.flags |= CanMsgFlagTx;
+	}
+	canMsgRef.channel = getCandumpChannel(iface);
+	return LineType::Frame;
+}
+
+uint8_t CaptureText::getCandumpChannel(const Token &ifaceRef)
+{
+	for(size_t i = 0; i < this->candumpIfaceVec.size(); ++i) {
+		const QByteArray &nameRef = this->candumpIfaceVec[i];
+		if((size_t)nameRef.size() == ifaceRef.size && memcmp(nameRef.constData(), ifaceRef.ptr, ifaceRef.size) == 0) {
+			return i;
+		}
+	}
+	this->candumpIfaceVec.push_back(QByteArray(ifaceRef.ptr, ifaceRef.size));
+	return this->candumpIfaceVec.size() - 1;
+}
+
+/// `0.012345 1  123x  Rx   d 8 01 02 03 04 05 06 07 08  Length = 0 BitCount = 0`, `r` instead of
+/// `d` for remote frames, `x` marks 29 bit ids. CANFD lines go to parseAscFd.
+CaptureText::LineType CaptureText::parseAsc(const char *linePtr, const char *endPtr, CanMsg &canMsgRef)
+{
+	Token token = {};
+	uint32_t value = 0;
+	uint64_t timestamp = 0;
+
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Other;
+	}
+	if(isToken(token, "base")) {
+		while(nextToken(linePtr, endPtr, token)) {
+			if(isToken(token, "dec") || isToken(token, "hex")) {
+				this->isAscDec = isToken(token, "dec");
+			} else if(isToken(token, "relative") || isToken(token, "absolute")) {
+				this->isAscRelative = isToken(token, "relative");
+			}
+		}
+		return LineType::Other;
+	}
+	if(!parseFixed(token, 6, timestamp)) {
+		return LineType::Other;
+	}
+	this->ascTimestamp = this->isAscRelative ? this->ascTimestamp + timestamp : timestamp;
+	canMsgRef.timestamp = this->ascTimestamp;
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Other;
+	}
+	if(isToken(token, "CANFD")) {
+		return parseAscFd(linePtr, endPtr, canMsgRef);
+	}
+	// events, statistics and the like have no channel number
+	if(!parseDec(token, value)) {
+		return LineType::Other;
+	}
+	canMsgRef.channel = value > 0 ? value - 1 : 0;
+	if(!nextToken(linePtr, endPtr, token) || token.size == 0) {
+		return LineType::Other;
+	}
+	const bool isExtended = token.ptr[token.size - 1] == 'x';
+	const Token id = { token.ptr, token.size - (isExtended ? 1 : 0) };
+	// ErrorFrame and Statistic: fail here
+	if(!(this->isAscDec ? parseDec(id, value) : parseHex(id, value))) {
+		return LineType::Other;
+	}
+	canMsgRef.id = value;
+	canMsgRef.flags |= isExtended ? CanMsgFlagExtended : 0;
+	if(!nextToken(linePtr, endPtr, token) || !(isToken(token, "Rx") || isToken(token, "Tx"))) {
+		return LineType::Other;
+	}
+	canMsgRef.flags |= isToken(token, "Tx") ? CanMsgFlagTx : 0;
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	if(isToken(token, "r")) {
+		canMsgRef.flags |= CanMsgFlagRtr;
+		return LineType::Frame;
+	}
+	if(!isToken(token, "d") || !nextToken(linePtr, endPtr, token) || !parseHex(token, value) || value > 15) {
+		return LineType::Bad;
+	}
+	canMsgRef.dataLength = qMin<uint32_t>(value, 8);
+	return parseData(linePtr, endPtr, this->isAscDec, canMsgRef) ? LineType::Frame : LineType::Bad;
+}
+
+/// After `CANFD`: `1 Rx 123x  [name] 1 0 d 12  01 02 ...`, channel, direction, id, optional
+/// symbolic name, BRS, ESI, DLC in hex, data length, data.
+CaptureText::LineType CaptureText::parseAscFd(const char *linePtr, const char *endPtr, CanMsg &canMsgRef)
+{
+	Token token = {};
+	uint32_t value = 0;
+
+	canMsgRef.flags |= CanMsgFlagFd;
+	if(!nextToken(linePtr, endPtr, token) || !parseDec(token, value)) {
+		return LineType::Bad;
+	}
+	canMsgRef.channel = value > 0 ? value - 1 : 0;
+	if(!nextToken(linePtr, endPtr, token) || !(isToken(token, "Rx") || isToken(token, "Tx"))) {
+		return LineType::Other;
+	}
+	canMsgRef.flags |= isToken(token, "Tx") ? CanMsgFlagTx : 0;
+	if(!nextToken(linePtr, endPtr, token) || token.size == 0) {
+		return LineType::Bad;
+	}
+	const bool isExtended = token.ptr[token.size - 1] == 'x';
+	const Token id = { token.ptr, token.size - (isExtended ? 1 : 0) };
+	// ErrorFrame lines
+	if(!(this->isAscDec ? parseDec(id, value) : parseHex(id, value))) {
+		return LineType::Other;
+	}
+	canMsgRef.id = value;
+	canMsgRef.flags |= isExtended ? CanMsgFlagExtended : 0;
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	if(!isToken(token, "0") && !isToken(token, "1") && !nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	canMsgRef.flags |= isToken(token, "1") ? CanMsgFlagBrs : 0;
+	if(!nextToken(linePtr, endPtr, token)) {
+		return LineType::Bad;
+	}
+	canMsgRef.flags |= isToken(token, "1") ? CanMsgFlagEsi : 0;
+	// DLC is implied by data length
+	if(!nextToken(linePtr, endPtr, token) || !nextToken(linePtr, endPtr, token) ||
+		!parseDec(token, value) || value > sizeof(CanMsg::data)) {
+		return LineType::Bad;
+	}
+	canMsgRef.dataLength = value;
+	return parseData(linePtr, endPtr, this->isAscDec, canMsgRef) ? LineType::Frame : LineType::Bad;
+}
+
+bool CaptureText::nextToken(const char *&ptr, const char *endPtr, Token &tokenRef)
+{
+	while(ptr < endPtr && (*ptr == ' ' || *ptr == '\t')) {
+		++ptr;
+	}
+	if(ptr == endPtr) {
+		return false;
+	}
+	tokenRef.ptr = ptr;
+	while(ptr < endPtr && *ptr != ' ' && *ptr != '\t') {
+		++ptr;
+	}
+	tokenRef.size = ptr - tokenRef.ptr;
+	return true;
+}
+
+bool CaptureText::isToken(const Token &tokenRef, const char *textPtr)
+{
+	return strlen(textPtr) == tokenRef.size && memcmp(tokenRef.ptr, textPtr, tokenRef.size) == 0;
+}
+
+int CaptureText::hexDigit(char c)
+{
+	if(c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if(c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	if(c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+bool CaptureText::parseHex(const Token &tokenRef, uint32_t &valueRef)
+{
+	if(tokenRef.size == 0 || tokenRef.size > 8) {
+		return false;
+	}
+	valueRef = 0;
+	for(size_t i = 0; i < tokenRef.size; ++i) {
+		const int digit = hexDigit(tokenRef.ptr[i]);
+		if(digit < 0) {
+			return false;
+		}
+		valueRef = (valueRef << 4) | digit;
+	}
+	return true;
+}
+
+bool CaptureText::parseDec(const Token &tokenRef, uint32_t &valueRef)
+{
+	if(tokenRef.size == 0 || tokenRef.size > 9) {
+		return false;
+	}
+	valueRef = 0;
+	for(size_t i = 0; i < tokenRef.size; ++i) {
+		const char c = tokenRef.ptr[i];
+		if(c < '0' || c > '9') {
+			return false;
+		}
+		valueRef = valueRef * 10 + (c - '0');
+	}
+	return true;
+}
+
+bool CaptureText::parseFixed(const Token &tokenRef, unsigned fractionDigits, uint64_t &valueRef)
+{
+	const char *ptr = tokenRef.ptr;
+	const char *endPtr = tokenRef.ptr + tokenRef.size;
+	uint64_t value = 0;
+	unsigned digits = 0;
+
+	// whole part
+	while(ptr < endPtr && *ptr >= '0' && *ptr <= '9') {
+		value = value * 10 + (*ptr++ - '0');
+		++digits;
+	}
+	if(digits == 0 || digits > 18) {
+		return false;
+	}
+	if(ptr < endPtr && *ptr == '.') {
+		++ptr;
+	}
+	for(unsigned i = 0; i < fractionDigits; ++i) {
+		value *= 10;
+		if(ptr < endPtr && *ptr >= '0' && *ptr <= '9') {
+			value += *ptr++ - '0';
+		}
+	}
+	while(ptr < endPtr && *ptr >= '0' && *ptr <= '9') {
+		++ptr;
+	}
+	if(ptr != endPtr) {
+		return false;
+	}
+	valueRef = value;
+	return true;
+}
+
+bool CaptureText::parseData(const char *&ptr, const char *endPtr, bool isDec, CanMsg &canMsgRef)
+{
+	Token token = {};
+	uint32_t value = 0;
+
+	for(uint8_t i = 0; i < canMsgRef.dataLength; ++i) {
+		if(!nextToken(ptr, endPtr, token) || !(isDec ? parseDec(token, value) : parseHex(token, value)) || value > 0xFF) {
+			return false;
+		}
+		canMsgRef.data[i] = value;
+	}
+	return true;
+}
+
+uint8_t CaptureText::dlcToLength(uint32_t dlc)
+{
+	static const uint8_t lengthArr[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+	return lengthArr[dlc & 0x0F];
+}
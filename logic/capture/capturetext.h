@@ -0,0 +1,120 @@
+/**
+ * @defgroup capturetext_h
+ * @{
+ * @file capturetext.h
+ * @brief Text logs of other CAN tools read as a capture: PEAK .trc, candump -l and Vector ASC.
+ *
+ * Format is told from the first bytes of the file, not its extension:
+ *
+ * - .trc: first line starts with ';', versions 1.x and 2.x, 2.x columns as given by $COLUMNS.
+ * - candump: first line starts with '(', as written by candump -l, `(1436509052.249713) vcan0 123#11223344`.
+ * - ASC: starts with a `date`, `base`, `Begin Triggerblock` or `//` line, classic and CANFD frame lines.
+ *
+ * File is read in chunks and split into lines with memchr, each line is cut into tokens by hand.
+ * Status, error and event lines are skipped, frame lines that cannot be parsed count as bad records.
+ * Timestamps are microseconds: offset from start of trace for .trc, time since epoch for candump and
+ * time since start of measurement for ASC. Channels are counted from 0, candump interfaces are
+ * numbered in the order they first show up.
+ */
+#ifndef CAPTURETEXT_H
+#define CAPTURETEXT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "canmsg.h"
+
+enum class CaptureTextFormat
+{
+	Unknown, //!< not a text log, .cobs captures end up here
+	Trc,
+	Candump,
+	Asc
+};
+
+class CaptureText
+{
+public:
+	CaptureText(void);
+	~CaptureText();
+
+	/// @brief False when file cannot be opened or is no text log, see errorString.
+	bool open(const QString &filePathRef);
+	void close(void);
+	bool isOpen(void) const;
+	QString errorString(void) const;
+	QString getFilePath(void) const;
+	CaptureTextFormat getFormat(void) const;
+	/// @brief Next frame, false at end of file.
+	bool next(CanMsg &canMsgRef);
+	/// @brief Starts over at first line.
+	bool rewind(void);
+	uint64_t getNumOfBadRecords(void) const;
+
+	static CaptureTextFormat detect(const QString &filePathRef);
+	/// @brief Format of a log starting with size bytes at dataPtr.
+	static CaptureTextFormat detect(const char *dataPtr, size_t size);
+	static QString getFormatName(CaptureTextFormat format);
+
+	static const qint64 chunkSize = 1024 * 1024;
+	/// @brief Bytes detect looks at.
+	static const qint64 detectSize = 4096;
+private:
+	enum class LineType
+	{
+		Frame,
+		Other, //!< comment, header or event, skipped
+		Bad    //!< frame line that does not parse
+	};
+	struct Token
+	{
+		const char *ptr;
+		size_t size;
+	};
+
+	QFile file;
+	QString errorStr;
+	CaptureTextFormat format;
+	QByteArray chunk;
+	qsizetype chunkPos;
+	bool isEof;
+	uint64_t numOfBadRecords;
+	QByteArray trcColumns;       //!< one letter per column, see $COLUMNS
+	bool isTrcLegacy;            //!< 1.x layout, numbered lines with ')'
+	bool isAscDec;               //!< base dec, ids and data are decimal
+	bool isAscRelative;          //!< timestamps relative to previous line
+	uint64_t ascTimestamp;
+	std::vector<QByteArray> candumpIfaceVec;
+
+	void reset(void);
+	/// @brief Next line without its line end, points into chunk until the following call.
+	bool nextLine(const char *&linePtr, const char *&endPtr);
+	void readChunk(void);
+	LineType parseTrc(const char *linePtr, const char *endPtr, CanMsg &canMsgRef);
+	LineType parseTrcLegacy(const char *linePtr, const char *endPtr, CanMsg &canMsgRef);
+	void parseTrcHeader(const char *linePtr, const char *endPtr);
+	LineType parseCandump(const char *linePtr, const char *endPtr, CanMsg &canMsgRef);
+	LineType parseAsc(const char *linePtr, const char *endPtr, CanMsg &canMsgRef);
+	LineType parseAscFd(const char *linePtr, const char *endPtr, CanMsg &canMsgRef);
+	uint8_t getCandumpChannel(const Token &ifaceRef);
+
+	/// @brief Skips blanks, false when line has no token left.
+	static bool nextToken(const char *&ptr, const char *endPtr, Token &tokenRef);
+	static bool isToken(const Token &tokenRef, const char *textPtr);
+	/// @brief Value of a hex digit, -1 for any other character.
+	static int hexDigit(char c);
+	static bool parseHex(const Token &tokenRef, uint32_t &valueRef);
+	static bool parseDec(const Token &tokenRef, uint32_t &valueRef);
+	/// @brief Decimal with optional fraction, scaled by 10^fractionDigits, extra digits dropped.
+	static bool parseFixed(const Token &tokenRef, unsigned fractionDigits, uint64_t &valueRef);
+	/// @brief Reads dataLength data bytes as separate tokens, false when line holds fewer.
+	static bool parseData(const char *&ptr, const char *endPtr, bool isDec, CanMsg &canMsgRef);
+	static uint8_t dlcToLength(uint32_t dlc);
+};
+
+#endif // CAPTURETEXT_H
+
+/// @}
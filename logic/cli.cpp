@@ -12,33 +12,50 @@
 #include <iostream>
 #include "util.h"
 #include "cli.h"
-#include "cobs.h"
 
 Cli::Cli(QObject *parent) :
 	QObject(parent),
 	name("UdsTracerCli"),
 	version("1.0.0"),
-	uds(),
-	reqCanId(0),
-	respCanId(0),
-	reqRawCanIsoTp(),
-	respRawCanIsoTp(),
-	traceUds(),
+	frameQueue(stageQueueCapacity),
+	traceQueue(stageQueueCapacity),
+	guiQueue(stageQueueCapacity),
+	decodeThread(),
+	sinkThread(),
+	decoder(&this->frameQueue, &this->traceQueue, &this->guiQueue),
+	canLog(&this->frameQueue),
+	traceUds(&this->traceQueue),
+	statsTimer(),
 	isCanConnected(false),
-	canLogFilePtr(nullptr),
-	canLogFilePath(""),
+	exitCode(0),
 	cmd()
 {
-	zeroOutIsoTp();
 	connect(&this->cmd, &Cmd::configAllLoaded, this, &Cli::configAllLoaded);
 	connect(&this->cmd, &Cmd::canEventOccured, this, &Cli::onCanEventOccured);
-	connect(this, &Cli::canMsgReceived, this, &Cli::onCanMsgReceived);
-	connect(
-		this,
-		&Cli::udsPacketReceived,
-		&this->traceUds,
-		&TraceUds::onUdsPacketReceived
-	);
+	// rx wake ups go straight to the decoder, they do not pass through gui thread
+	connect(&this->cmd, &Cmd::canEventOccured, &this->decoder, &Decoder::onCanEventOccured);
+	connect(&this->decoder, &Decoder::started, &this->canLog, &CanLog::open);
+	connect(&this->decoder, &Decoder::started, &this->traceUds, &TraceUds::open);
+	connect(&this->decoder, &Decoder::framesReady, &this->canLog, &CanLog::onFramesReady);
+	connect(&this->decoder, &Decoder::tracePacketsReady, &this->traceUds, &TraceUds::onPacketsReady);
+	connect(&this->decoder, &Decoder::guiPacketsReady, this, &Cli::onGuiPacketsReady);
+	connect(&this->decoder, &Decoder::stopped, &this->canLog, &CanLog::close);
+	connect(&this->decoder, &Decoder::stopped, &this->traceUds, &TraceUds::close);
+	// final numbers once everything received is decoded
+	connect(&this->decoder, &Decoder::stopped, this, &Cli::logStats);
+	connect(&this->cmd, &Cmd::statsRequested, this, &Cli::logStats);
+	connect(&this->statsTimer, &QTimer::timeout, this, &Cli::logStats);
+
+	this->decodeThread.start();
+	this->sinkThread.start();
+}
+
+Cli::~Cli()
+{
+	this->decodeThread.quit();
+	this->sinkThread.quit();
+	this->decodeThread.wait();
+	this->sinkThread.wait();
 }
 
 void Cli::init(int argc, char **argvPtrPtr)
@@ -46,121 +63,155 @@ void Cli::init(int argc, char **argvPtrPtr)
 	handleCliArgs(argc, argvPtrPtr);
 }
 
-void Cli::openCanLogFile(const QString &logDirPathRef)
+int Cli::getExitCode(void) const
 {
-	if (this->canLogFilePtr != nullptr) {
-		Util::log(LogType::Generic, LogSt::Warn, "Trace file closed: " + this->canLogFilePath);
-		this->canLogFilePtr->close();
-		delete canLogFilePtr;
-	}
-
-	if(QDir(logDirPathRef).exists()) {
-		this->canLogFilePath = logDirPathRef + "/" + Util::getFileName() + ".cobs";
-		this->canLogFilePtr = new QFile(this->canLogFilePath);
-		if (this->canLogFilePtr->open(QIODevice::WriteOnly)) {
-			Util::log(LogType::Generic, LogSt::Ok, "CAN log file opened: " + this->canLogFilePath);
-		} else {
-			Util::log(LogType::CmdRespThrow, LogSt::Nok, "Failed to open CAN log file: " + this->canLogFilePath);
-			delete this->canLogFilePtr;
-			this->canLogFilePtr = nullptr;
-		}
-	} else {
-		Util::log(LogType::GenericThrow, LogSt::Nok, "Log directory does not exist: " + logDirPathRef);
-	}
+	return this->exitCode;
 }
 
-void Cli::zeroOutIsoTp()
+void Cli::placeStage(QObject *stagePtr, bool isThreaded, QThread *threadPtr)
 {
-	memset(
-		(void *)&this->reqIsoTp,
-		0,
-		sizeof(this->reqIsoTp)
-	);
-	memset(
-		(void *)&this->respIsoTp,
-		0,
-		sizeof(this->respIsoTp)
-	);
-	memset(
-		(void *)&this->reqSendBfrArr,
-		0,
-		sizeof(this->reqSendBfrArr)
-	);
-	memset(
-		(void *)&this->reqRecvBfrArr,
-		0,
-		sizeof(this->reqRecvBfrArr)
-	);
-	memset(
-		(void *)&this->respSendBfrArr,
-		0,
-		sizeof(this->respSendBfrArr)
-	);
-	memset(
-		(void *)&this->respRecvBfrArr,
-		0,
-		sizeof(this->respRecvBfrArr)
-	);
+	QThread *targetPtr = isThreaded ? threadPtr : this->thread();
+
+	// moveToThread has to be called from the thread stage currently lives in.
+	// Events already posted to the stage move together with it, so order is kept.
+	QMetaObject::invokeMethod(stagePtr, [stagePtr, targetPtr]() {
+		stagePtr->moveToThread(targetPtr);
+	});
 }
 
 void Cli::onCanEventOccured(CanEvent event)
 {
 	switch(event) {
 	case CanEvent::Connected:
+		// ExecPermit of every later command is checked against this
+		this->isCanConnected.store(true);
 		emit canConnectionEvented(true);
 		{
 			const ConfigAll &cfgAll = this->cmd.getConfigAll();
-			openCanLogFile(cfgAll.tracer.getLogDirPath());
-			this->traceUds.open(cfgAll.tracer.getLogDirPath());
-
-			zeroOutIsoTp();
-
-			this->reqCanId = static_cast<uint32_t>(cfgAll.tracer.getReqIdHex().toUInt(nullptr, 16));
-			this->respCanId = static_cast<uint32_t>(cfgAll.tracer.getRespIdHex().toUInt(nullptr, 16));
-
-			this->reqIsoTp.init(
-				0x12, // not important we are not going to send anything
-				this->reqSendBfrArr,
-				sizeof(this->reqSendBfrArr),
-				this->reqRecvBfrArr,
-				sizeof(this->reqRecvBfrArr)
-			);
-			this->respIsoTp.init(
-				0x13, // not important we are not going to send anything
-				this->respSendBfrArr,
-				sizeof(this->respSendBfrArr),
-				this->respRecvBfrArr,
-				sizeof(this->respRecvBfrArr)
-			);
-
-
-			Util::log(LogType::Generic, LogSt::Ok, "ISOTP handles initialized successfully.");
+			const QString logDirPath = cfgAll.tracer.getLogDirPath();
+			const bool isDecodeThreaded = cfgAll.generic.getDecodeThread() == "on";
+			const bool isSinkThreaded = cfgAll.generic.getSinkThread() == "on";
+			const size_t sinkQueueSize = cfgAll.generic.getSinkQueueSize().toULongLong();
+			const int statsPeriodSec = cfgAll.generic.getStatsPeriodSec().toInt();
+			const size_t logFlushBytes = cfgAll.generic.getLogFlushKb().toULongLong() * 1024;
+			const int logFlushMs = cfgAll.generic.getLogFlushMs().toInt();
+			const bool isLogCompressed = cfgAll.generic.getLogCompress() == "on";
+			const int logSyncMs = cfgAll.generic.getLogSyncMs().toInt();
+			const uint64_t rotateBytes = cfgAll.generic.getRotateMb().toULongLong() * 1024 * 1024;
+			const int rotateMin = cfgAll.generic.getRotateMin().toInt();
+			const unsigned rotateKeep = cfgAll.generic.getRotateKeep().toUInt();
+			Can *canPtr = this->cmd.getCanInterface();
+
+			if(!QDir(logDirPath).exists()) {
+				Util::log(LogType::GenericThrow, LogSt::Nok, "Log directory does not exist: " + logDirPath);
+			}
+
+			uint32_t reqCanId = static_cast<uint32_t>(cfgAll.tracer.getReqIdHex().toUInt(nullptr, 16));
+			uint32_t respCanId = static_cast<uint32_t>(cfgAll.tracer.getRespIdHex().toUInt(nullptr, 16));
+
+			this->frameQueue.setLimit(sinkQueueSize);
+			this->traceQueue.setLimit(sinkQueueSize);
+			this->guiQueue.setLimit(sinkQueueSize);
+
+			placeStage(&this->canLog, isSinkThreaded, &this->sinkThread);
+			placeStage(&this->traceUds, isSinkThreaded, &this->sinkThread);
+			placeStage(&this->decoder, isDecodeThreaded, &this->decodeThread);
+
+			CanLog *canLogPtr = &this->canLog;
+			QMetaObject::invokeMethod(canLogPtr, [=]() {
+				canLogPtr->setFlush(logFlushBytes, logFlushMs);
+				canLogPtr->setCompress(isLogCompressed);
+				canLogPtr->setSync(logSyncMs);
+				canLogPtr->setRotation(rotateBytes, rotateMin, rotateKeep);
+			});
+
+			TraceUds *traceUdsPtr = &this->traceUds;
+			QMetaObject::invokeMethod(traceUdsPtr, [=]() {
+				traceUdsPtr->setRotation(rotateBytes, rotateMin, rotateKeep);
+				traceUdsPtr->setSync(logSyncMs);
+			});
+
+			Decoder *decoderPtr = &this->decoder;
+			QMetaObject::invokeMethod(decoderPtr, [=]() {
+				decoderPtr->start(canPtr, reqCanId, respCanId, logDirPath);
+			});
+
+			if(statsPeriodSec > 0) {
+				this->statsTimer.start(statsPeriodSec * 1000);
+			}
 		}
 		break;
 	case CanEvent::Disconnected:
-		emit canConnectionEvented(false);
-
-		this->traceUds.close();
-
-		if(this->canLogFilePtr != nullptr) {
-			Util::log(LogType::Generic, LogSt::Ok, "Can log file closed: " + this->canLogFilePath);
-			this->canLogFilePtr->close();
-			delete this->canLogFilePtr;
-			this->canLogFilePtr = nullptr;
-			this->canLogFilePath = "";
+		this->isCanConnected.store(false);
+		this->statsTimer.stop();
+		{
+			// decoder drains rx queue, then sinks drain their queues and close
+			Decoder *decoderPtr = &this->decoder;
+			QMetaObject::invokeMethod(decoderPtr, [decoderPtr]() {
+				decoderPtr->stop();
+			});
 		}
-
+		emit canConnectionEvented(false);
 		break;
 	case CanEvent::MessageReceived:
-		Can *canIntPtr = this->cmd.getCanInterface();
-		while(!canIntPtr->rxQueue.isEmpty()) {
-			CanMsg canMsg = canIntPtr->rxQueue.dequeue();
-			emit canMsgReceived(canMsg);
-		}
+		// handled by decoder
 		break;
 	}
 }
 
+/// Counters are written by rx and decode threads, numbers in one line may be
+/// a few frames apart while capture is running. After disconnect they are exact.
+void Cli::logStats(void)
+{
+	const Can *canPtr = this->cmd.getCanInterface();
+	const RxStats &rxStatsRef = canPtr->rxStats;
+	const DecodeStats &decodeStatsRef = this->decoder.stats;
+	const WriterStats &writerStatsRef = this->canLog.getWriterStats();
+	const uint64_t logBytesIn = writerStatsRef.bytesIn.get();
+	const uint64_t logBytesWritten = writerStatsRef.bytesWritten.get();
+	const uint64_t logBusyNs = writerStatsRef.busyNs.get();
+	const uint64_t lost =
+		rxStatsRef.framesDropped.get() +
+		rxStatsRef.driverOverruns.get() +
+		decodeStatsRef.guiPacketsDropped.get();
+
+	QString s = QString(
+		"Stats read: %1, queued: %2, spilled: %3, dropped: %4, overruns: %5, rx queue high: %6/%7, "
+		"decoded: %8, backlog: %9, log queue high: %10/%11, packets: %12, gui dropped: %13, "
+		"log written: %14 KiB, log ratio: %15, log writer: %16 MB/s, log syncs: %17"
+	)
+		.arg(rxStatsRef.framesRead.get())
+		.arg(rxStatsRef.framesQueued.get())
+		.arg(rxStatsRef.framesSpilled.get())
+		.arg(rxStatsRef.framesDropped.get())
+		.arg(rxStatsRef.driverOverruns.get())
+		.arg(rxStatsRef.queueHighWater.get())
+		.arg(canPtr->getRxQueueLimit())
+		.arg(decodeStatsRef.framesDecoded.get())
+		.arg(canPtr->rxQueue.size() + this->frameQueue.size())
+		.arg(decodeStatsRef.logQueueHighWater.get())
+		.arg(this->frameQueue.getLimit())
+		.arg(decodeStatsRef.packetsDecoded.get())
+		.arg(decodeStatsRef.guiPacketsDropped.get())
+		.arg(logBytesWritten / 1024)
+		.arg(logBytesWritten != 0 ? (double)logBytesIn / logBytesWritten : 1.0, 0, 'f', 2)
+		// bytes per ns of writer time, what the writer could sustain
+		.arg(logBusyNs != 0 ? (double)logBytesIn * 1000.0 / logBusyNs : 0.0, 0, 'f', 1)
+		.arg(writerStatsRef.syncs.get());
+
+	Util::log(LogType::Generic, lost == 0 ? LogSt::Ok : LogSt::Warn, s);
+}
+
+void Cli::onGuiPacketsReady(void)
+{
+	UdsPacket packet;
+
+	this->guiQueue.ack();
+	while(this->guiQueue.tryPop(packet)) {
+		emit udsPacketReceived(packet.isReq, packet.rawCanMsgStr, packet.packetInfo);
+	}
+}
+
 void Cli::loadCommands(const QString &filePathRef)
 {
 	if (!filePathRef.isEmpty()) {
@@ -236,6 +287,10 @@ void Cli::handleCliArgs(int argc, char **argvPtrPtr)
 			"Show commands");
 	parser.addOption(showOption);
 
+	QCommandLineOption decodeOption(QStringList() << "d" << "decode",
+			"Decode devReplay capture into traces in a directory and exit.", "dir");
+	parser.addOption(decodeOption);
+
 	QStringList arguments;
 	for (int i = 0; i < argc; ++i) {
 		arguments << QString::fromUtf8(argvPtrPtr[i]);
@@ -247,6 +302,17 @@ void Cli::handleCliArgs(int argc, char **argvPtrPtr)
 		loadCommands(fileName);
 	}
 
+	// batch mode, runs before any window is shown, caller exits once the capture is decoded
+	if (parser.isSet(decodeOption)) {
+		try {
+			commandMapWThrow({{CmdDef::decodeCapture.name, parser.value(decodeOption)}});
+		} catch (const std::exception &e) {
+			std::cout << e.what() << std::endl;
+			this->exitCode = 1;
+		}
+		return;
+	}
+
 	if (parser.isSet(cliOption)) {
 		this->libMode = false;
 		QThread* inputThread = createInputThread();
@@ -266,7 +332,7 @@ void Cli::commandMap(const QMap<QString, QString> &cmdMapRef)
 	QMap<QString, QString> permittedCmds;
 
 	for(const QString &keyRef : cmdMapRef.keys()) {
-		if(CmdDef::isExecPermitted(keyRef, cmdMapRef[keyRef], this->isCanConnected)) {
+		if(CmdDef::isExecPermitted(keyRef, cmdMapRef[keyRef], this->isCanConnected.load())) {
 			permittedCmds.insert(keyRef, cmdMapRef[keyRef]);
 		}
 	}
@@ -280,126 +346,13 @@ void Cli::commandMapWThrow(const QMap<QString, QString> &cmdMapRef)
 	QMap<QString, QString> permittedCmds;
 
 	for(const QString &keyRef : cmdMapRef.keys()) {
-		if(CmdDef::isExecPermitted(keyRef, cmdMapRef[keyRef], this->isCanConnected)) {
+		if(CmdDef::isExecPermitted(keyRef, cmdMapRef[keyRef], this->isCanConnected.load())) {
 			permittedCmds.insert(keyRef, cmdMapRef[keyRef]);
 		}
 	}
 	this->cmd.commandMapWThrow(permittedCmds);
 }
 
-void Cli::onCanMsgReceived(const CanMsg &canMsgRef)
-{
-	uint8_t localArr[0xffff] = {0};
-	uint16_t outSize = 0;
-	IsoTpRet isoTpRet = IsoTpRet::OK;
-	QVector<uint8_t> localVector;
-
-	QString s = Can::getMsgStr(canMsgRef);
-
-	if(this->canLogFilePtr != nullptr) {
-		uint8_t rawCanMsg[sizeof(CanMsg)];
-		char c = 0;
-		size_t rawCanMsgSize = Can::getRawCanMsg(canMsgRef, rawCanMsg, sizeof(rawCanMsg));
-		uint8_t encodedRaw[sizeof(CanMsg) * 2];
-		cobs_encode_result result = cobs_encode(encodedRaw, sizeof(encodedRaw), rawCanMsg, rawCanMsgSize);
-		if (result.out_len > 0) {
-			this->canLogFilePtr->write(reinterpret_cast<const char *>(encodedRaw), result.out_len);
-			this->canLogFilePtr->flush();
-		}
-		this->canLogFilePtr->write(reinterpret_cast<const char *>(&c), 1);
-	}
-
-	if(canMsgRef.id == this->reqCanId) {
-		this->reqRawCanIsoTp.append(canMsgRef);
-		this->reqIsoTp.on_can_message(canMsgRef.data, canMsgRef.dataLength);
-	} else if(canMsgRef.id == this->respCanId) {
-		this->respRawCanIsoTp.append(canMsgRef);
-		this->respIsoTp.on_can_message(canMsgRef.data, canMsgRef.dataLength);
-	}
-
-	for(int i = 0; i < 10; ++i) {
-		this->reqIsoTp.poll();
-		outSize = 0;
-		isoTpRet = this->reqIsoTp.receive(localArr, (uint16_t)sizeof(localArr), &outSize);
-
-		if(isoTpRet == IsoTpRet::OK) {
-			localVector.clear();
-			for(int i = 0; i < (int)outSize; ++i) {
-				localVector.append(localArr[i]);
-			}
-			udsReqMsg(localVector);
-			this->reqRawCanIsoTp.clear();
-		}
-
-		this->respIsoTp.poll();
-		outSize = 0;
-		isoTpRet = this->respIsoTp.receive(localArr, (uint16_t)sizeof(localArr), &outSize);
-
-		if(isoTpRet == IsoTpRet::OK) {
-			localVector.clear();
-			for(int i = 0; i < (int)outSize; ++i) {
-				localVector.append(localArr[i]);
-			}
-			udsRespMsg(localVector);
-			this->respRawCanIsoTp.clear();
-		}
-	}
-}
-
-void Cli::udsReqMsg(const QVector<uint8_t> &data)
-{
-	if(data.length() == 0) {
-		return;
-	}
-	QVector<UdsInfo> packetInfo;
-	QString s = "";
-	
-	this->uds.getReqInfo(data, packetInfo);
-	
-	for(int i = 0; i < this->reqRawCanIsoTp.length() && i < 2; ++i) {
-		s += Can::getMsgStr(this->reqRawCanIsoTp[i]) + "\\n";
-	}
-	s = this->reqRawCanIsoTp.length() > 2 ? (s + "\\n...") : s;
-
-	// printing is too slow, comment out if you really need it
-	//Util::log(
-	//	LogType::CanMsg,
-	//	LogSt::Ok,
-	//	s
-	//);
-	Util::log(
-		LogType::UdsReqMsg,
-		LogSt::Ok,
-		packetInfo[0].getHexStr(10)
-	);
-	emit udsPacketReceived(true, s, packetInfo);
-}
-void Cli::udsRespMsg(const QVector<uint8_t> &data)
-{
-	if(data.length() == 0) {
-		return;
-	}
-	QVector<UdsInfo> packetInfo;
-	QString s = "";
-	this->uds.getRespInfo(data, packetInfo);
-	for(int i = 0; i < this->respRawCanIsoTp.length() && i < 2; ++i) {
-		s += Can::getMsgStr(this->respRawCanIsoTp[i]) + "\\n";
-	}
-	s = this->respRawCanIsoTp.length() > 2 ? (s + "\\n...") : s;
-	// printing is too slow, comment out if you really need it
-	//Util::log(
-	//	LogType::CanMsg,
-	//	LogSt::Ok,
-	//	s
-	//);
-	Util::log(
-		LogType::UdsRespMsg,
-		LogSt::Ok,
-		packetInfo[0].getHexStr(10)
-	);
-	emit udsPacketReceived(false, s, packetInfo);
-}
-
 QThread* Cli::createInputThread(void)
 {
 	QThread* inputThread = QThread::create([this]() {
@@ -4,10 +4,13 @@
 #include <QObject>
 #include <QString>
 #include <QThread>
-#include <QFile>
 #include <QElapsedTimer>
+#include <QTimer>
+#include <atomic>
+#include "canlog.h"
 #include "cmd.h"
-#include "isotp.hpp"
+#include "decoder.h"
+#include "spscqueue.h"
 #include "uds.h"
 #include "traceuds.h"
 
@@ -18,11 +21,13 @@ public:
 	const QString name;
 	const QString version;
 	Cli(QObject *parent);
+	~Cli();
 	void init(int argc, char **argvPtrPtr);
+	/// @brief Exit code of a batch run by the command line, e.g. -d.
+	int getExitCode(void) const;
 signals:
 	void commandReceived(const QString &cmdStrRef);
 	void configAllLoaded(const ConfigAll &cfgAllRef);
-	void canMsgReceived(const CanMsg &canMsgRef);
 	void udsMsgReceived(bool isReq, const QVector<uint8_t> &udsMsgRef);
 	void canConnectionEvented(bool isConnected);
 	void udsPacketReceived(
@@ -33,35 +38,31 @@ signals:
 public slots:
 	void commandMap(const QMap<QString, QString> &cmdMapRef);
 	void commandMapWThrow(const QMap<QString, QString> &cmdMapRef);
-	void onCanMsgReceived(const CanMsg &canMsgRef);
 private:
-	Uds uds;
-	IsoTp reqIsoTp;
-	IsoTp respIsoTp;
-	uint8_t reqSendBfrArr[16];
-	uint8_t reqRecvBfrArr[10240];
-	uint8_t respSendBfrArr[16];
-	uint8_t respRecvBfrArr[10240];
-	uint32_t reqCanId;
-	uint32_t respCanId;
-	QVector<CanMsg> reqRawCanIsoTp;
-	QVector<CanMsg> respRawCanIsoTp;
+	/// Physical size of stage queues, sinkQueueSize limits how much of it is used.
+	static const size_t stageQueueCapacity = 16384;
+	StageQueue<CanMsg, CanFrameRing> frameQueue;
+	StageQueue<UdsPacket> traceQueue;
+	StageQueue<UdsPacket> guiQueue;
+	QThread decodeThread;
+	QThread sinkThread;
+	Decoder decoder;
+	CanLog canLog;
 	TraceUds traceUds;
-	bool isCanConnected;
+	QTimer statsTimer;
+	std::atomic<bool> isCanConnected; //!< follows CanEvent, read by cli input thread too
+	int exitCode;
 	bool libMode;
-	QFile *canLogFilePtr;
-	QString canLogFilePath;
 	Cmd cmd;
-	void udsReqMsg(const QVector<uint8_t> &data);
-	void udsRespMsg(const QVector<uint8_t> &data);
 	QThread* createInputThread(void);
 	void handleCliArgs(int argc, char **argvPtrPtr);
-	void openCanLogFile(const QString &logDirPathRef);
 	void loadCommands(const QString &filePathRef);
-	void zeroOutIsoTp(void);
+	void placeStage(QObject *stagePtr, bool isThreaded, QThread *threadPtr);
 	void showCommand(void);
 private slots:
 	void onCanEventOccured(CanEvent event);
+	void onGuiPacketsReady(void);
+	void logStats(void);
 };
 
 #endif // CLI_H
@@ -6,9 +6,11 @@ Cmd::Cmd(QObject *parent)
 	isThrowEn{false}
 {
 	this->configAll.generic.setCanType(CanType::Std);
-	connect(&this->peakFdCan, &PeakFdCan::eventOccured, this, &Cmd::canEventOccured);
-	connect(&this->peakStdCan, &PeakStdCan::eventOccured, this, &Cmd::canEventOccured);
-	connect(&this->replayCan, &ReplayCan::eventOccured, this, &Cmd::canEventOccured);
+	// direct, so rx wake ups reach decoder without a hop through gui thread
+	connect(&this->peakFdCan, &PeakFdCan::eventOccured, this, &Cmd::canEventOccured, Qt::DirectConnection);
+	connect(&this->peakStdCan, &PeakStdCan::eventOccured, this, &Cmd::canEventOccured, Qt::DirectConnection);
+	connect(&this->replayCan, &ReplayCan::eventOccured, this, &Cmd::canEventOccured, Qt::DirectConnection);
+	connect(&this->socketCan, &SocketCan::eventOccured, this, &Cmd::canEventOccured, Qt::DirectConnection);
 }
 
 void Cmd::callHandleFunctions(const QMap<QString, QString> &cmdMapRef)
@@ -17,7 +19,9 @@ void Cmd::callHandleFunctions(const QMap<QString, QString> &cmdMapRef)
 	handleConfigFd(cmdMapRef);
 	handleConfigStd(cmdMapRef);
 	handleConfigReplay(cmdMapRef);
+	handleConfigSocket(cmdMapRef);
 	handleConfigTracer(cmdMapRef);
+	handleConfigGeneric(cmdMapRef);
 	handleFileOp(cmdMapRef);
 	handleCanInterface(cmdMapRef);
 }
@@ -53,6 +57,8 @@ Can *Cmd::getCanInterface(void)
 		retCanPtr = dynamic_cast<Can *>(&this->peakStdCan);
 	} else if(canType == CanType::Replay) {
 		retCanPtr = dynamic_cast<Can *>(&this->replayCan);
+	} else if(canType == CanType::Socket) {
+		retCanPtr = dynamic_cast<Can *>(&this->socketCan);
 	}
 
 	return retCanPtr;
@@ -99,6 +105,101 @@ void Cmd::handleConfigTracer(const QMap<QString, QString> &cmdMapRef)
 	}
 }
 
+void Cmd::handleConfigGeneric(const QMap<QString, QString> &cmdMapRef)
+{
+	using namespace CmdDef;
+
+	for(const QString &keyRef : cmdMapRef.keys()) {
+		QString value = cmdMapRef[keyRef];
+		const QVector<QString> pair = {keyRef, value};
+
+		if(isOkToExec(rxNotify, pair)) {
+			this->configAll.generic.setRxNotify(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rxNotify, value, "");
+		}
+
+		if(isOkToExec(rxNotifyUs, pair)) {
+			this->configAll.generic.setRxNotifyUs(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rxNotifyUs, value, "");
+		}
+
+		if(isOkToExec(decodeThread, pair)) {
+			this->configAll.generic.setDecodeThread(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, decodeThread, value, "");
+		}
+
+		if(isOkToExec(sinkThread, pair)) {
+			this->configAll.generic.setSinkThread(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, sinkThread, value, "");
+		}
+
+		if(isOkToExec(sinkQueueSize, pair)) {
+			this->configAll.generic.setSinkQueueSize(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, sinkQueueSize, value, "");
+		}
+
+		if(isOkToExec(timestampBase, pair)) {
+			this->configAll.generic.setTimestampBase(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, timestampBase, value, "");
+		}
+
+		if(isOkToExec(statsPeriodSec, pair)) {
+			this->configAll.generic.setStatsPeriodSec(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, statsPeriodSec, value, "");
+		}
+
+		if(isOkToExec(rxQueuePolicy, pair)) {
+			this->configAll.generic.setRxQueuePolicy(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rxQueuePolicy, value, "");
+		}
+
+		if(isOkToExec(rxQueueSize, pair)) {
+			this->configAll.generic.setRxQueueSize(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rxQueueSize, value, "");
+		}
+
+		if(isOkToExec(logFlushKb, pair)) {
+			this->configAll.generic.setLogFlushKb(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, logFlushKb, value, "");
+		}
+
+		if(isOkToExec(logFlushMs, pair)) {
+			this->configAll.generic.setLogFlushMs(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, logFlushMs, value, "");
+		}
+
+		if(isOkToExec(logCompress, pair)) {
+			this->configAll.generic.setLogCompress(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, logCompress, value, "");
+		}
+
+		if(isOkToExec(logSyncMs, pair)) {
+			this->configAll.generic.setLogSyncMs(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, logSyncMs, value, "");
+		}
+
+		if(isOkToExec(rotateMb, pair)) {
+			this->configAll.generic.setRotateMb(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rotateMb, value, "");
+		}
+
+		if(isOkToExec(rotateMin, pair)) {
+			this->configAll.generic.setRotateMin(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rotateMin, value, "");
+		}
+
+		if(isOkToExec(rotateKeep, pair)) {
+			this->configAll.generic.setRotateKeep(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, rotateKeep, value, "");
+		}
+
+		if(isOkToExec(decodeWorkers, pair)) {
+			this->configAll.generic.setDecodeWorkers(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, decodeWorkers, value, "");
+		}
+	}
+}
+
 void Cmd::handleCanInterface(const QMap<QString, QString> &cmdMapRef)
 {
 	using namespace CmdDef;
@@ -111,8 +212,19 @@ void Cmd::handleCanInterface(const QMap<QString, QString> &cmdMapRef)
 			Util::log(LogType::CmdResp, LogSt::Ok, canType, value, "");
 		}
 
-		if(value == "on" && isOkToExec(CmdDef::connect, pair)) {
+		if(isOkToExec(stats, pair)) {
+			Util::log(LogType::CmdResp, LogSt::Ok, stats, value, "");
+			emit statsRequested();
+		}
+
+		if(isOkToExec(replay, pair) || isOkToExec(seekMs, pair)) {
+			handleReplayTransport(keyRef, value);
+		}
+
+		// off has to get through while connected, on only makes sense while disconnected
+		if(value == "on" && isOkToExec(CmdDef::connect, pair) && isDisconnected(CmdDef::connect, value)) {
 			QString canType = configAll.generic.getCanType();
+			getCanInterface()->configure(configAll.generic);
 			if(canType == CanType::Fd) {
 				try {
 					peakFdCan.connect(static_cast<const void *>(&configAll.fd));
@@ -152,6 +264,19 @@ void Cmd::handleCanInterface(const QMap<QString, QString> &cmdMapRef)
 						QString("Failed to replay connect: %1").arg(e.what())
 					);
 				}
+			} else if (canType == CanType::Socket) {
+				try {
+					socketCan.connect(static_cast<const void *>(&configAll.socket));
+					Util::log(LogType::CmdResp, LogSt::Ok, CmdDef::connect, value, "socket connected");
+				} catch (const std::exception &e) {
+					Util::log(
+						this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+						LogSt::Nok,
+						CmdDef::connect,
+						value,
+						QString("Failed to socket connect: %1").arg(e.what())
+					);
+				}
 			}
 		}
 
@@ -166,7 +291,41 @@ void Cmd::handleCanInterface(const QMap<QString, QString> &cmdMapRef)
 			} else if (canType == CanType::Replay) {
 				replayCan.disconnect();
 				Util::log(LogType::CmdResp, LogSt::Ok, CmdDef::connect, value, "");
+			} else if (canType == CanType::Socket) {
+				socketCan.disconnect();
+				Util::log(LogType::CmdResp, LogSt::Ok, CmdDef::connect, value, "");
 			}
 		}
 	}
 }
+
+void Cmd::handleReplayTransport(const QString &nameRef, const QString &valueRef)
+{
+	const CmdDef::Cmd &cmdRef = nameRef == CmdDef::seekMs.name ? CmdDef::seekMs : CmdDef::replay;
+
+	if(this->configAll.generic.getCanType() != CanType::Replay || !this->replayCan.isConnected()) {
+		Util::log(
+			this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+			LogSt::Nok,
+			cmdRef,
+			valueRef,
+			"Replay is not running"
+		);
+		return;
+	}
+	if(nameRef == CmdDef::seekMs.name) {
+		this->replayCan.seek(valueRef.toULongLong());
+	} else if(valueRef == "pause") {
+		this->replayCan.pause();
+	} else if(valueRef == "resume") {
+		this->replayCan.resume();
+	} else if(valueRef == "stepFrame") {
+		this->replayCan.stepFrame();
+	} else if(valueRef == "stepPacket") {
+		this->replayCan.stepPacket(
+			static_cast<uint32_t>(this->configAll.tracer.getReqIdHex().toUInt(nullptr, 16)),
+			static_cast<uint32_t>(this->configAll.tracer.getRespIdHex().toUInt(nullptr, 16))
+		);
+	}
+	Util::log(LogType::CmdResp, LogSt::Ok, cmdRef, valueRef, "");
+}
@@ -8,6 +8,7 @@
 #include "peakfdcan.h"
 #include "peakstdcan.h"
 #include "replaycan.h"
+#include "socketcan.h"
 
 class Cmd : public QObject
 {
@@ -22,6 +23,7 @@ public:
 signals:
 	void configAllLoaded(const ConfigAll &configAll);
 	void canEventOccured(CanEvent canEvent);
+	void statsRequested(void);
 
 private:
 	ConfigAll configAll;
@@ -29,6 +31,7 @@ private:
 	PeakFdCan peakFdCan;
 	PeakStdCan peakStdCan;
 	ReplayCan replayCan;
+	SocketCan socketCan;
 
 	QMap<QString, QString> getCmdMap(int argc, char **argvPtrPtr);
 	QMap<QString, QString> getCmdMap(const QVector<QString> &argvRef);
@@ -41,11 +44,20 @@ private:
 	void handleConfigStd(const QMap<QString, QString> &cmdMapRef);
 	void handleConfigApp(const QMap<QString, QString> &cmdMapRef);
 	void handleConfigReplay(const QMap<QString, QString> &cmdMapRef);
+	void handleConfigSocket(const QMap<QString, QString> &cmdMapRef);
 	void handleConfigTracer(const QMap<QString, QString> &cmdMapRef);
+	void handleConfigGeneric(const QMap<QString, QString> &cmdMapRef);
 	void handleFileOp(const QMap<QString, QString> &cmdMapRef);
 	void handleCanInterface(const QMap<QString, QString> &cmdMapRef);
+	/// @brief replay and seekMs, only while a replay runs.
+	void handleReplayTransport(const QString &nameRef, const QString &valueRef);
 
+	/// @brief Logs cmdRef as refused and returns false while connected.
+	bool isDisconnected(const CmdDef::Cmd &cmdRef, const QString &valueRef);
 	QDomElement getConfigXmlRoot(const QString &filePathRef);
+	void exportCapture(const QString &dstPathRef);
+	void repairLogs(const QString &dirPathRef);
+	void decodeCapture(const QString &dirPathRef);
 };
 
 #endif // CMD_H
@@ -118,5 +118,70 @@ void Cmd::handleConfigReplay(const QMap<QString, QString> &cmdMapRef)
 			Util::log(LogType::CmdResp, LogSt::Ok, devReplay, value, "");
 			continue;
 		}
+
+		if(isOkToExec(startMs, { keyRef, value })) {
+			this->configAll.replay.setStartMs(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, startMs, value, "");
+			continue;
+		}
+
+		if(isOkToExec(startFrame, { keyRef, value })) {
+			this->configAll.replay.setStartFrame(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, startFrame, value, "");
+			continue;
+		}
+
+		if(isOkToExec(speedPct, { keyRef, value })) {
+			this->configAll.replay.setSpeedPct(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, speedPct, value, "");
+			continue;
+		}
+
+		if(isOkToExec(endMs, { keyRef, value })) {
+			this->configAll.replay.setEndMs(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, endMs, value, "");
+			continue;
+		}
+
+		if(isOkToExec(endFrame, { keyRef, value })) {
+			this->configAll.replay.setEndFrame(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, endFrame, value, "");
+			continue;
+		}
+
+		if(isOkToExec(idAllow, { keyRef, value })) {
+			this->configAll.replay.setIdAllow(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, idAllow, value, "");
+			continue;
+		}
+
+		if(isOkToExec(idDeny, { keyRef, value })) {
+			this->configAll.replay.setIdDeny(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, idDeny, value, "");
+			continue;
+		}
+
+		if(isOkToExec(loop, { keyRef, value })) {
+			this->configAll.replay.setLoop(value);
+			// also while replaying
+			this->replayCan.setLoop(value == "on");
+			Util::log(LogType::CmdResp, LogSt::Ok, loop, value, "");
+			continue;
+		}
+	}
+}
+
+void Cmd::handleConfigSocket(const QMap<QString, QString> &cmdMapRef)
+{
+	using namespace CmdDef;
+
+	for(const QString &keyRef : cmdMapRef.keys()) {
+		QString value = cmdMapRef[keyRef];
+
+		if(isOkToExec(devSocket, { keyRef, value })) {
+			this->configAll.socket.setDev(value);
+			Util::log(LogType::CmdResp, LogSt::Ok, devSocket, value, "");
+			continue;
+		}
 	}
 }
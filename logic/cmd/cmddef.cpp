@@ -8,11 +8,14 @@
 namespace CmdDef {
 	const QString positiveNumberRegex("^[0-9]+$");
 	const QString hexNumberRegex("^[0-9A-Fa-f]+$");
+	// comma separated, empty for none
+	const QString hexNumberListRegex("^([0-9A-Fa-f]+(,[0-9A-Fa-f]+)*)?$");
 	QMap<QString, const Cmd *> allCommands = {};
 
 	const QMap<ValueType, QString> valueTypeNames = {
 		{ ValueType::PositiveNumber, "PositiveNumber" },
 		{ ValueType::HexNumber, "HexNumber" },
+		{ ValueType::HexNumberList, "HexNumberList" },
 		{ ValueType::ExistingFilePath, "ExistingFilePath" },
 		{ ValueType::NewOrExistingFilePath, "NewOrExistingFilePath" },
 		{ ValueType::ExistingDirPath, "ExistingDirPath" },
@@ -26,6 +29,7 @@ namespace CmdDef {
 		{ Type::CanFdCfg, "CanFdCfg" },
 		{ Type::CanStdCfg, "CanStdCfg" },
 		{ Type::CanReplayCfg, "CanReplayCfg" },
+		{ Type::CanSocketCfg, "CanSocketCfg" },
 		{ Type::TracerCfg, "TracerCfg" },
 		{ Type::FileOp, "FileOperations" },
 		{ Type::CanInterface, "CanInterface"},
@@ -152,6 +156,11 @@ namespace CmdDef {
 			match = regex.match(value);
 			isOk = match.hasMatch();
 			break;
+		case ValueType::HexNumberList:
+			regex.setPattern(hexNumberListRegex);
+			match = regex.match(value);
+			isOk = match.hasMatch();
+			break;
 		case ValueType::ExistingFilePath:
 			isOk = QFile::exists(value);
 			break;
@@ -205,6 +214,16 @@ namespace CmdDef {
 	const Cmd baud("baud", ValueType::PositiveNumber, Type::CanStdCfg, ExecPermit::Disconnected);
 
 	const Cmd devReplay("devReplay", ValueType::ExistingFilePath, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd startMs("startMs", ValueType::PositiveNumber, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd startFrame("startFrame", ValueType::PositiveNumber, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd speedPct("speedPct", ValueType::PositiveNumber, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd endMs("endMs", ValueType::PositiveNumber, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd endFrame("endFrame", ValueType::PositiveNumber, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd idAllow("idAllow", ValueType::HexNumberList, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd idDeny("idDeny", ValueType::HexNumberList, Type::CanReplayCfg, ExecPermit::Disconnected);
+	const Cmd loop("loop", {"on", "off"}, Type::CanReplayCfg, ExecPermit::Both);
+
+	const Cmd devSocket("devSocket", ValueType::None, Type::CanSocketCfg, ExecPermit::Disconnected);
 
 	const Cmd reqIdHex("reqIdHex", ValueType::HexNumber, Type::TracerCfg, ExecPermit::Disconnected);
 	const Cmd respIdHex("respIdHex", ValueType::HexNumber, Type::TracerCfg, ExecPermit::Disconnected);
@@ -212,8 +231,32 @@ namespace CmdDef {
 
 	const Cmd storeConfig("storeConfig", ValueType::NewOrExistingFilePath, Type::FileOp, ExecPermit::Both);
 	const Cmd loadConfig("loadConfig", ValueType::ExistingFilePath, Type::FileOp, ExecPermit::Disconnected);
+	const Cmd exportCapture("exportCapture", ValueType::NewOrExistingFilePath, Type::FileOp, ExecPermit::Disconnected);
+	const Cmd repairLogs("repairLogs", ValueType::ExistingDirPath, Type::FileOp, ExecPermit::Disconnected);
+	const Cmd decodeCapture("decodeCapture", ValueType::ExistingDirPath, Type::FileOp, ExecPermit::Disconnected);
+
+	const Cmd connect("connect", { "on", "off" }, Type::CanInterface, ExecPermit::Both);
+	const Cmd canType("canType", {"Std", "Fd", "Replay", "Socket"}, Type::CanInterface, ExecPermit::Disconnected);
+	const Cmd stats("stats", ValueType::Empty, Type::CanInterface, ExecPermit::Both);
+	const Cmd replay("replay", {"pause", "resume", "stepFrame", "stepPacket"}, Type::CanInterface, ExecPermit::Connected);
+	const Cmd seekMs("seekMs", ValueType::PositiveNumber, Type::CanInterface, ExecPermit::Connected);
 
-	const Cmd connect("connect", { "on", "off" }, Type::CanInterface, ExecPermit::Disconnected);
-	const Cmd canType("canType", {"Std", "Fd", "Replay"}, Type::CanInterface, ExecPermit::Disconnected);
+	const Cmd rxNotify("rxNotify", {"Edge", "Rate", "Frame"}, Type::Generic, ExecPermit::Disconnected);
+	const Cmd rxNotifyUs("rxNotifyUs", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd decodeThread("decodeThread", {"on", "off"}, Type::Generic, ExecPermit::Disconnected);
+	const Cmd sinkThread("sinkThread", {"on", "off"}, Type::Generic, ExecPermit::Disconnected);
+	const Cmd sinkQueueSize("sinkQueueSize", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd timestampBase("timestampBase", {"Device", "Monotonic"}, Type::Generic, ExecPermit::Disconnected);
+	const Cmd statsPeriodSec("statsPeriodSec", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd rxQueuePolicy("rxQueuePolicy", {"Block", "DropOldest", "DropNewest", "Spill"}, Type::Generic, ExecPermit::Disconnected);
+	const Cmd rxQueueSize("rxQueueSize", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd logFlushKb("logFlushKb", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd logFlushMs("logFlushMs", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd logCompress("logCompress", {"on", "off"}, Type::Generic, ExecPermit::Disconnected);
+	const Cmd logSyncMs("logSyncMs", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd rotateMb("rotateMb", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd rotateMin("rotateMin", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd rotateKeep("rotateKeep", ValueType::PositiveNumber, Type::Generic, ExecPermit::Disconnected);
+	const Cmd decodeWorkers("decodeWorkers", ValueType::PositiveNumber, Type::Generic, ExecPermit::Both);
 
 }
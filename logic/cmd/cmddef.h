@@ -9,6 +9,7 @@ namespace CmdDef {
 	enum class ValueType {
 		PositiveNumber,
 		HexNumber,
+		HexNumberList,
 		ExistingFilePath,
 		NewOrExistingFilePath,
 		ExistingDirPath,
@@ -22,6 +23,7 @@ namespace CmdDef {
 		CanFdCfg,
 		CanStdCfg,
 		CanReplayCfg,
+		CanSocketCfg,
 		TracerCfg,
 		FileOp,
 		CanInterface,
@@ -82,6 +84,16 @@ namespace CmdDef {
 	extern const Cmd baud;
 	// Can Replay Configuration commands
 	extern const Cmd devReplay;
+	extern const Cmd startMs;
+	extern const Cmd startFrame;
+	extern const Cmd speedPct;
+	extern const Cmd endMs;
+	extern const Cmd endFrame;
+	extern const Cmd idAllow;
+	extern const Cmd idDeny;
+	extern const Cmd loop;
+	// Can Socket Configuration commands
+	extern const Cmd devSocket;
 	// Tracer Configuration commands
 	extern const Cmd reqIdHex;
 	extern const Cmd respIdHex;
@@ -89,9 +101,33 @@ namespace CmdDef {
 	// File op commands
 	extern const Cmd storeConfig;
 	extern const Cmd loadConfig;
+	extern const Cmd exportCapture;
+	extern const Cmd repairLogs;
+	extern const Cmd decodeCapture;
 	// Can Interface commands
 	extern const Cmd connect;
 	extern const Cmd canType;
+	extern const Cmd stats;
+	extern const Cmd replay;
+	extern const Cmd seekMs;
+	// Generic commands
+	extern const Cmd rxNotify;
+	extern const Cmd rxNotifyUs;
+	extern const Cmd decodeThread;
+	extern const Cmd sinkThread;
+	extern const Cmd sinkQueueSize;
+	extern const Cmd timestampBase;
+	extern const Cmd statsPeriodSec;
+	extern const Cmd rxQueuePolicy;
+	extern const Cmd rxQueueSize;
+	extern const Cmd logFlushKb;
+	extern const Cmd logFlushMs;
+	extern const Cmd logCompress;
+	extern const Cmd logSyncMs;
+	extern const Cmd rotateMb;
+	extern const Cmd rotateMin;
+	extern const Cmd rotateKeep;
+	extern const Cmd decodeWorkers;
 }
 
 #endif // CMDDEF_H
@@ -1,10 +1,18 @@
+#include <QDir>
 #include <QDomDocument>
 #include <QDomElement>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
 //#include <QXmlSchema>
 //#include <QXmlSchemaValidator>
+#include "captureexport.h"
+#include "capturerepair.h"
+#include "capturestream.h"
 #include "cmd.h"
+#include "offlinedecoder.h"
+#include "traceuds.h"
 #include "util.h"
 
 void Cmd::handleFileOp(const QMap<QString, QString> &cmdMapRef)
@@ -52,9 +60,127 @@ void Cmd::handleFileOp(const QMap<QString, QString> &cmdMapRef)
 				);
 			}
 		}
+
+		if(isOkToExec(CmdDef::exportCapture, pair) && isDisconnected(CmdDef::exportCapture, value)) {
+			exportCapture(value);
+		}
+
+		if(isOkToExec(CmdDef::repairLogs, pair) && isDisconnected(CmdDef::repairLogs, value)) {
+			repairLogs(value);
+		}
+
+		if(isOkToExec(CmdDef::decodeCapture, pair) && isDisconnected(CmdDef::decodeCapture, value)) {
+			decodeCapture(value);
+		}
 	}
 }
 
+/// File operations run on the calling thread from start to end. During a capture that thread
+/// would stall behind them, and logs being written would be read or changed under the writer.
+bool Cmd::isDisconnected(const CmdDef::Cmd &cmdRef, const QString &valueRef)
+{
+	if(!getCanInterface()->isConnected()) {
+		return true;
+	}
+	Util::log(
+		this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+		LogSt::Nok,
+		cmdRef,
+		valueRef,
+		"Disconnect first"
+	);
+	return false;
+}
+
+/// Converts capture named by devReplay, runs to the end of it before returning.
+void Cmd::exportCapture(const QString &dstPathRef)
+{
+	const QString srcPath = this->configAll.replay.getDev();
+	CaptureStream captureStream;
+	CaptureExport captureExport;
+	QElapsedTimer timer;
+	CanMsg canMsg;
+
+	if(!captureStream.open(srcPath)) {
+		Util::log(
+			this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+			LogSt::Nok,
+			CmdDef::exportCapture,
+			dstPathRef,
+			"Capture open failed: " + captureStream.errorString()
+		);
+		return;
+	}
+	if(!captureExport.open(dstPathRef)) {
+		Util::log(
+			this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+			LogSt::Nok,
+			CmdDef::exportCapture,
+			dstPathRef,
+			"Failed to open file for writing: " + captureExport.errorString()
+		);
+		return;
+	}
+	timer.start();
+	while(captureStream.next(canMsg)) {
+		captureExport.write(canMsg);
+	}
+	captureExport.close();
+	const double sec = qMax<qint64>(timer.elapsed(), 1) / 1000.0;
+	Util::log(
+		LogType::CmdResp,
+		LogSt::Ok,
+		CmdDef::exportCapture,
+		dstPathRef,
+		QString("%1 frames, %2 MB in %3 s, %4 MB/s, %5 damaged records skipped")
+			.arg(captureExport.getNumOfFrames())
+			.arg(captureExport.getNumOfBytes() / 1e6, 0, 'f', 1)
+			.arg(sec, 0, 'f', 1)
+			.arg(captureExport.getNumOfBytes() / 1e6 / sec, 0, 'f', 0)
+			.arg(captureStream.getNumOfBadRecords())
+	);
+}
+
+/// Closes what a crash or power loss left open in a log directory, files that are complete
+/// stay as they are. Runs through the whole directory before returning.
+void Cmd::repairLogs(const QString &dirPathRef)
+{
+	const QDir dir(dirPathRef);
+	const QStringList fileList = dir.entryList({ "*.cobs", "*.json", "*.html" }, QDir::Files, QDir::Name);
+	unsigned numOfRepaired = 0;
+	unsigned numOfFailed = 0;
+	uint64_t droppedBytes = 0;
+
+	for(const QString &fileNameRef : fileList) {
+		const QString filePath = dir.filePath(fileNameRef);
+		uint64_t fileDroppedBytes = 0;
+		QString errorStr;
+		const RepairResult result = fileNameRef.endsWith(".cobs") ?
+			CaptureRepair::repair(filePath, fileDroppedBytes, errorStr) :
+			TraceUds::repair(filePath, fileDroppedBytes, errorStr);
+
+		if(result == RepairResult::Repaired) {
+			++numOfRepaired;
+			droppedBytes += fileDroppedBytes;
+			Util::log(LogType::Generic, LogSt::Warn, QString("Repaired %1, %2 bytes dropped").arg(filePath).arg(fileDroppedBytes));
+		} else if(result == RepairResult::Failed) {
+			++numOfFailed;
+			Util::log(LogType::Generic, LogSt::Nok, "Failed to repair " + filePath + ": " + errorStr);
+		}
+	}
+	Util::log(
+		numOfFailed == 0 || !this->isThrowEn ? LogType::CmdResp : LogType::CmdRespThrow,
+		numOfFailed == 0 ? LogSt::Ok : LogSt::Nok,
+		CmdDef::repairLogs,
+		dirPathRef,
+		QString("%1 files checked, %2 repaired, %3 bytes dropped, %4 failed")
+			.arg(fileList.size())
+			.arg(numOfRepaired)
+			.arg(droppedBytes)
+			.arg(numOfFailed)
+	);
+}
+
 QDomElement Cmd::getConfigXmlRoot(const QString &filePathRef)
 {
 	QDomElement root;
@@ -123,3 +249,65 @@ QDomElement Cmd::getConfigXmlRoot(const QString &filePathRef)
 
 	return root;
 }
+
+/// Decodes capture named by devReplay into UDS traces, named after the capture, in dirPathRef.
+/// Frames go from reader to decoder to trace files on the calling thread, no queue, no signal
+/// and no pacing in between. Runs to the end of the capture before returning.
+void Cmd::decodeCapture(const QString &dirPathRef)
+{
+	const QString srcPath = this->configAll.replay.getDev();
+	const QString basePath = QDir(dirPathRef).filePath(QFileInfo(srcPath).completeBaseName());
+	const uint32_t reqCanId = static_cast<uint32_t>(this->configAll.tracer.getReqIdHex().toUInt(nullptr, 16));
+	const uint32_t respCanId = static_cast<uint32_t>(this->configAll.tracer.getRespIdHex().toUInt(nullptr, 16));
+	const uint64_t rotateBytes = this->configAll.generic.getRotateMb().toULongLong() * 1024 * 1024;
+	const int rotateMin = this->configAll.generic.getRotateMin().toInt();
+	const unsigned rotateKeep = this->configAll.generic.getRotateKeep().toUInt();
+	OfflineDecoder offlineDecoder;
+	TraceUds traceUds(nullptr);
+	QElapsedTimer timer;
+
+	// json trace is opened for append, it would end up with two headers
+	if(QFile::exists(basePath + ".json") || QFile::exists(basePath + "_000.json")) {
+		Util::log(
+			this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+			LogSt::Nok,
+			CmdDef::decodeCapture,
+			dirPathRef,
+			"Trace of this capture already exists: " + basePath
+		);
+		return;
+	}
+
+	timer.start();
+	offlineDecoder.setIds(reqCanId, respCanId);
+	offlineDecoder.setWorkers(this->configAll.generic.getDecodeWorkers().toInt());
+	traceUds.setRotation(rotateBytes, rotateMin, rotateKeep);
+	traceUds.setSync(this->configAll.generic.getLogSyncMs().toInt());
+	traceUds.openBase(basePath);
+	const bool isOk = offlineDecoder.run(srcPath, traceUds);
+	traceUds.close();
+	if(!isOk) {
+		Util::log(
+			this->isThrowEn ? LogType::CmdRespThrow : LogType::CmdResp,
+			LogSt::Nok,
+			CmdDef::decodeCapture,
+			dirPathRef,
+			"Capture read failed: " + offlineDecoder.errorString()
+		);
+		return;
+	}
+	const double sec = qMax<qint64>(timer.nsecsElapsed(), 1) / 1e9;
+	Util::log(
+		LogType::CmdResp,
+		LogSt::Ok,
+		CmdDef::decodeCapture,
+		dirPathRef,
+		QString("%1 frames, %2 packets in %3 s, %4 frames/s on %5 workers, %6 damaged records skipped")
+			.arg(offlineDecoder.getNumOfFrames())
+			.arg(offlineDecoder.getNumOfPackets())
+			.arg(sec, 0, 'f', 3)
+			.arg(offlineDecoder.getNumOfFrames() / sec, 0, 'f', 0)
+			.arg(offlineDecoder.getNumOfWorkers())
+			.arg(offlineDecoder.getNumOfBadRecords())
+	);
+}
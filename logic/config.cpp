@@ -8,6 +8,16 @@ const QString ConfigAll::name = "ConfigAll";
 const QString CanType::Std = "Std";
 const QString CanType::Fd = "Fd";
 const QString CanType::Replay = "Replay";
+const QString CanType::Socket = "Socket";
+const QString TimestampBaseType::Device = "Device";
+const QString TimestampBaseType::Monotonic = "Monotonic";
+const QString RxNotifyType::Edge = "Edge";
+const QString RxNotifyType::Rate = "Rate";
+const QString RxNotifyType::Frame = "Frame";
+const QString RxQueuePolicyType::Block = "Block";
+const QString RxQueuePolicyType::DropOldest = "DropOldest";
+const QString RxQueuePolicyType::DropNewest = "DropNewest";
+const QString RxQueuePolicyType::Spill = "Spill";
 
 const QByteArray ConfigAll::xsdData = QByteArrayLiteral(R"(<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema">
 	<xs:element name="ConfigAll">
@@ -17,6 +27,23 @@ const QByteArray ConfigAll::xsdData = QByteArrayLiteral(R"(<xs:schema xmlns:xs="
 					<xs:complexType>
 						<xs:sequence>
 							<xs:element name="canType" type="xs:string" />
+							<xs:element name="rxNotify" type="xs:string" minOccurs="0" />
+							<xs:element name="rxNotifyUs" type="xs:integer" minOccurs="0" />
+							<xs:element name="decodeThread" type="xs:string" minOccurs="0" />
+							<xs:element name="sinkThread" type="xs:string" minOccurs="0" />
+							<xs:element name="sinkQueueSize" type="xs:integer" minOccurs="0" />
+							<xs:element name="timestampBase" type="xs:string" minOccurs="0" />
+							<xs:element name="statsPeriodSec" type="xs:integer" minOccurs="0" />
+							<xs:element name="rxQueuePolicy" type="xs:string" minOccurs="0" />
+							<xs:element name="rxQueueSize" type="xs:integer" minOccurs="0" />
+							<xs:element name="logFlushKb" type="xs:integer" minOccurs="0" />
+							<xs:element name="logFlushMs" type="xs:integer" minOccurs="0" />
+							<xs:element name="logCompress" type="xs:string" minOccurs="0" />
+							<xs:element name="logSyncMs" type="xs:integer" minOccurs="0" />
+							<xs:element name="rotateMb" type="xs:integer" minOccurs="0" />
+							<xs:element name="rotateMin" type="xs:integer" minOccurs="0" />
+							<xs:element name="rotateKeep" type="xs:integer" minOccurs="0" />
+							<xs:element name="decodeWorkers" type="xs:integer" minOccurs="0" />
 						</xs:sequence>
 					</xs:complexType>
 				</xs:element>
@@ -50,6 +77,21 @@ const QByteArray ConfigAll::xsdData = QByteArrayLiteral(R"(<xs:schema xmlns:xs="
 					<xs:complexType>
 						<xs:sequence>
 							<xs:element name="devReplay" type="xs:string" />
+							<xs:element name="endFrame" type="xs:integer" minOccurs="0" />
+							<xs:element name="endMs" type="xs:integer" minOccurs="0" />
+							<xs:element name="idAllow" type="xs:string" minOccurs="0" />
+							<xs:element name="idDeny" type="xs:string" minOccurs="0" />
+							<xs:element name="loop" type="xs:string" minOccurs="0" />
+							<xs:element name="speedPct" type="xs:integer" minOccurs="0" />
+							<xs:element name="startFrame" type="xs:integer" minOccurs="0" />
+							<xs:element name="startMs" type="xs:integer" minOccurs="0" />
+						</xs:sequence>
+					</xs:complexType>
+				</xs:element>
+				<xs:element name="CanSocketCfg" minOccurs="0">
+					<xs:complexType>
+						<xs:sequence>
+							<xs:element name="devSocket" type="xs:string" />
 						</xs:sequence>
 					</xs:complexType>
 				</xs:element>
@@ -83,7 +125,8 @@ void ConfigAbstract::setMap(const QMap<QString, QString> &mapRef)
 
 void ConfigAbstract::setXml(const QDomElement &elem)
 {
-	QMap<QString, QString> map;
+	// keys missing in older project files keep their defaults
+	QMap<QString, QString> map = this->defMap;
 	QDomNodeList nodeList = elem.childNodes();
 	for (int i = 0; i < nodeList.size(); i++) {
 		QDomNode node = nodeList.at(i);
@@ -132,7 +175,24 @@ ConfigGeneric::ConfigGeneric(QObject *parent):
 		parent,
 		CmdDef::typeNames[CmdDef::Type::Generic],
 		{
-			{ CmdDef::canType.name , CmdDef::canType.possibleValues[0] }
+			{ CmdDef::canType.name , CmdDef::canType.possibleValues[0] },
+			{ CmdDef::rxNotify.name, RxNotifyType::Edge },
+			{ CmdDef::rxNotifyUs.name, "1000" },
+			{ CmdDef::decodeThread.name, "on" },
+			{ CmdDef::sinkThread.name, "on" },
+			{ CmdDef::sinkQueueSize.name, "4096" },
+			{ CmdDef::timestampBase.name, TimestampBaseType::Device },
+			{ CmdDef::statsPeriodSec.name, "10" },
+			{ CmdDef::rxQueuePolicy.name, RxQueuePolicyType::Block },
+			{ CmdDef::rxQueueSize.name, "16384" },
+			{ CmdDef::logFlushKb.name, "256" },
+			{ CmdDef::logFlushMs.name, "200" },
+			{ CmdDef::logCompress.name, "off" },
+			{ CmdDef::logSyncMs.name, "1000" },
+			{ CmdDef::rotateMb.name, "0" },
+			{ CmdDef::rotateMin.name, "0" },
+			{ CmdDef::rotateKeep.name, "0" },
+			{ CmdDef::decodeWorkers.name, "0" }
 		}
 	)
 {
@@ -143,11 +203,181 @@ void ConfigGeneric::setCanType(QString canType)
 	this->map[CmdDef::canType.name] = canType;
 }
 
+void ConfigGeneric::setRxNotify(const QString &rxNotifyRef)
+{
+	this->map[CmdDef::rxNotify.name] = rxNotifyRef;
+}
+
+void ConfigGeneric::setRxNotifyUs(const QString &rxNotifyUsRef)
+{
+	this->map[CmdDef::rxNotifyUs.name] = rxNotifyUsRef;
+}
+
+void ConfigGeneric::setDecodeThread(const QString &decodeThreadRef)
+{
+	this->map[CmdDef::decodeThread.name] = decodeThreadRef;
+}
+
+void ConfigGeneric::setSinkThread(const QString &sinkThreadRef)
+{
+	this->map[CmdDef::sinkThread.name] = sinkThreadRef;
+}
+
+void ConfigGeneric::setSinkQueueSize(const QString &sinkQueueSizeRef)
+{
+	this->map[CmdDef::sinkQueueSize.name] = sinkQueueSizeRef;
+}
+
+void ConfigGeneric::setTimestampBase(const QString &timestampBaseRef)
+{
+	this->map[CmdDef::timestampBase.name] = timestampBaseRef;
+}
+
+void ConfigGeneric::setStatsPeriodSec(const QString &statsPeriodSecRef)
+{
+	this->map[CmdDef::statsPeriodSec.name] = statsPeriodSecRef;
+}
+
+void ConfigGeneric::setRxQueuePolicy(const QString &rxQueuePolicyRef)
+{
+	this->map[CmdDef::rxQueuePolicy.name] = rxQueuePolicyRef;
+}
+
+void ConfigGeneric::setRxQueueSize(const QString &rxQueueSizeRef)
+{
+	this->map[CmdDef::rxQueueSize.name] = rxQueueSizeRef;
+}
+
+void ConfigGeneric::setLogFlushKb(const QString &logFlushKbRef)
+{
+	this->map[CmdDef::logFlushKb.name] = logFlushKbRef;
+}
+
+void ConfigGeneric::setLogFlushMs(const QString &logFlushMsRef)
+{
+	this->map[CmdDef::logFlushMs.name] = logFlushMsRef;
+}
+
+void ConfigGeneric::setLogCompress(const QString &logCompressRef)
+{
+	this->map[CmdDef::logCompress.name] = logCompressRef;
+}
+
+void ConfigGeneric::setLogSyncMs(const QString &logSyncMsRef)
+{
+	this->map[CmdDef::logSyncMs.name] = logSyncMsRef;
+}
+
+void ConfigGeneric::setRotateMb(const QString &rotateMbRef)
+{
+	this->map[CmdDef::rotateMb.name] = rotateMbRef;
+}
+
+void ConfigGeneric::setRotateMin(const QString &rotateMinRef)
+{
+	this->map[CmdDef::rotateMin.name] = rotateMinRef;
+}
+
+void ConfigGeneric::setRotateKeep(const QString &rotateKeepRef)
+{
+	this->map[CmdDef::rotateKeep.name] = rotateKeepRef;
+}
+
+void ConfigGeneric::setDecodeWorkers(const QString &decodeWorkersRef)
+{
+	this->map[CmdDef::decodeWorkers.name] = decodeWorkersRef;
+}
+
 QString ConfigGeneric::getCanType(void) const
 {
 	return this->map[CmdDef::canType.name];
 }
 
+QString ConfigGeneric::getRxNotify(void) const
+{
+	return this->map[CmdDef::rxNotify.name];
+}
+
+QString ConfigGeneric::getRxNotifyUs(void) const
+{
+	return this->map[CmdDef::rxNotifyUs.name];
+}
+
+QString ConfigGeneric::getDecodeThread(void) const
+{
+	return this->map[CmdDef::decodeThread.name];
+}
+
+QString ConfigGeneric::getSinkThread(void) const
+{
+	return this->map[CmdDef::sinkThread.name];
+}
+
+QString ConfigGeneric::getSinkQueueSize(void) const
+{
+	return this->map[CmdDef::sinkQueueSize.name];
+}
+
+QString ConfigGeneric::getTimestampBase(void) const
+{
+	return this->map[CmdDef::timestampBase.name];
+}
+
+QString ConfigGeneric::getStatsPeriodSec(void) const
+{
+	return this->map[CmdDef::statsPeriodSec.name];
+}
+
+QString ConfigGeneric::getRxQueuePolicy(void) const
+{
+	return this->map[CmdDef::rxQueuePolicy.name];
+}
+
+QString ConfigGeneric::getRxQueueSize(void) const
+{
+	return this->map[CmdDef::rxQueueSize.name];
+}
+
+QString ConfigGeneric::getLogFlushKb(void) const
+{
+	return this->map[CmdDef::logFlushKb.name];
+}
+
+QString ConfigGeneric::getLogFlushMs(void) const
+{
+	return this->map[CmdDef::logFlushMs.name];
+}
+
+QString ConfigGeneric::getLogCompress(void) const
+{
+	return this->map[CmdDef::logCompress.name];
+}
+
+QString ConfigGeneric::getLogSyncMs(void) const
+{
+	return this->map[CmdDef::logSyncMs.name];
+}
+
+QString ConfigGeneric::getRotateMb(void) const
+{
+	return this->map[CmdDef::rotateMb.name];
+}
+
+QString ConfigGeneric::getRotateMin(void) const
+{
+	return this->map[CmdDef::rotateMin.name];
+}
+
+QString ConfigGeneric::getRotateKeep(void) const
+{
+	return this->map[CmdDef::rotateKeep.name];
+}
+
+QString ConfigGeneric::getDecodeWorkers(void) const
+{
+	return this->map[CmdDef::decodeWorkers.name];
+}
+
 
 ConfigFd::ConfigFd(QObject *parent):
 	ConfigAbstract(
@@ -362,7 +592,15 @@ ConfigReplay::ConfigReplay(QObject *parent):
 		parent,
 		CmdDef::typeNames[CmdDef::Type::CanReplayCfg],
 		{
-			{ CmdDef::devReplay.name, QDir::homePath() + "/log.blf" }
+			{ CmdDef::devReplay.name, QDir::homePath() + "/log.blf" },
+			{ CmdDef::startMs.name, "0" },
+			{ CmdDef::startFrame.name, "0" },
+			{ CmdDef::speedPct.name, "100" },
+			{ CmdDef::endMs.name, "0" },
+			{ CmdDef::endFrame.name, "0" },
+			{ CmdDef::idAllow.name, "" },
+			{ CmdDef::idDeny.name, "" },
+			{ CmdDef::loop.name, "off" }
 		}
 	)
 {
@@ -391,6 +629,120 @@ QString ConfigReplay::getDev(void) const
 	return this->map[CmdDef::devReplay.name];
 }
 
+void ConfigReplay::setStartMs(const QString &startMsRef)
+{
+	this->map[CmdDef::startMs.name] = startMsRef;
+}
+
+QString ConfigReplay::getStartMs(void) const
+{
+	return this->map[CmdDef::startMs.name];
+}
+
+void ConfigReplay::setStartFrame(const QString &startFrameRef)
+{
+	this->map[CmdDef::startFrame.name] = startFrameRef;
+}
+
+QString ConfigReplay::getStartFrame(void) const
+{
+	return this->map[CmdDef::startFrame.name];
+}
+
+void ConfigReplay::setSpeedPct(const QString &speedPctRef)
+{
+	this->map[CmdDef::speedPct.name] = speedPctRef;
+}
+
+QString ConfigReplay::getSpeedPct(void) const
+{
+	return this->map[CmdDef::speedPct.name];
+}
+
+void ConfigReplay::setEndMs(const QString &endMsRef)
+{
+	this->map[CmdDef::endMs.name] = endMsRef;
+}
+
+QString ConfigReplay::getEndMs(void) const
+{
+	return this->map[CmdDef::endMs.name];
+}
+
+void ConfigReplay::setEndFrame(const QString &endFrameRef)
+{
+	this->map[CmdDef::endFrame.name] = endFrameRef;
+}
+
+QString ConfigReplay::getEndFrame(void) const
+{
+	return this->map[CmdDef::endFrame.name];
+}
+
+void ConfigReplay::setIdAllow(const QString &idAllowRef)
+{
+	this->map[CmdDef::idAllow.name] = idAllowRef;
+}
+
+QString ConfigReplay::getIdAllow(void) const
+{
+	return this->map[CmdDef::idAllow.name];
+}
+
+void ConfigReplay::setIdDeny(const QString &idDenyRef)
+{
+	this->map[CmdDef::idDeny.name] = idDenyRef;
+}
+
+QString ConfigReplay::getIdDeny(void) const
+{
+	return this->map[CmdDef::idDeny.name];
+}
+
+void ConfigReplay::setLoop(const QString &loopRef)
+{
+	this->map[CmdDef::loop.name] = loopRef;
+}
+
+QString ConfigReplay::getLoop(void) const
+{
+	return this->map[CmdDef::loop.name];
+}
+
+ConfigSocket::ConfigSocket(QObject *parent):
+	ConfigAbstract(
+		parent,
+		CmdDef::typeNames[CmdDef::Type::CanSocketCfg],
+		{
+			{ CmdDef::devSocket.name, "can0" }
+		}
+	)
+{
+	for (const QString &keyRef : CmdDef::typeCmdNames[CmdDef::Type::CanSocketCfg]) {
+		if (!defMap.contains(keyRef)) {
+			Util::log(LogType::GenericThrow, "Key missing in socket:" + keyRef);
+		}
+	}
+
+	for (const QString &keyRef : defMap.keys()) {
+		if (!CmdDef::typeCmdNames[CmdDef::Type::CanSocketCfg].contains(keyRef)) {
+			Util::log(LogType::GenericThrow, "Extra key in socket:" + keyRef);
+		}
+	}
+
+	reset();
+}
+
+void ConfigSocket::setDev(const QString &devRef)
+{
+	this->map[CmdDef::devSocket.name] = devRef;
+}
+
+QString ConfigSocket::getDev(void) const
+{
+	return this->map[CmdDef::devSocket.name];
+}
+
 ConfigTracer::ConfigTracer(QObject *parent):
 	ConfigAbstract(
 		parent,
@@ -456,11 +808,13 @@ void ConfigAll::setXml(const QDomElement &root)
 	QDomElement configFdElem = root.firstChildElement(this->fd.getName());
 	QDomElement configStdElem = root.firstChildElement(this->std.getName());
 	QDomElement configReplayElem = root.firstChildElement(this->replay.getName());
+	QDomElement configSocketElem = root.firstChildElement(this->socket.getName());
 	QDomElement configTracerElem = root.firstChildElement(this->tracer.getName());
 	this->generic.setXml(configGeneric);
 	this->fd.setXml(configFdElem);
 	this->std.setXml(configStdElem);
 	this->replay.setXml(configReplayElem);
+	this->socket.setXml(configSocketElem);
 	this->tracer.setXml(configTracerElem);
 }
 
@@ -472,10 +826,12 @@ void ConfigAll::getXml(QDomDocument &domDocRef)
 	QDomElement configFdElem = this->fd.getXml();
 	QDomElement configStdElem = this->std.getXml();
 	QDomElement configReplayElem = this->replay.getXml();
+	QDomElement configSocketElem = this->socket.getXml();
 	QDomElement configTracerElem = this->tracer.getXml();
 	root.appendChild(configGenericElem);
 	root.appendChild(configFdElem);
 	root.appendChild(configStdElem);
 	root.appendChild(configReplayElem);
+	root.appendChild(configSocketElem);
 	root.appendChild(configTracerElem);
 }
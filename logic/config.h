@@ -11,6 +11,31 @@ public:
 	static const QString Std;
 	static const QString Fd;
 	static const QString Replay;
+	static const QString Socket;
+};
+
+/// @brief Where frame timestamps start from.
+class TimestampBaseType {
+public:
+	static const QString Device;     //!< device clock as is
+	static const QString Monotonic;  //!< shifted onto host CLOCK_MONOTONIC at first frame
+};
+
+/// @brief How rx thread wakes up the consumer of rx queue.
+class RxNotifyType {
+public:
+	static const QString Edge;  //!< only when queue goes from empty to non-empty
+	static const QString Rate;  //!< at most once per rxNotifyUs, also the latency bound
+	static const QString Frame; //!< on every frame
+};
+
+/// @brief What rx thread does with frames that do not fit in rx queue.
+class RxQueuePolicyType {
+public:
+	static const QString Block;      //!< wait for decoder, nothing is lost while driver buffers
+	static const QString DropOldest; //!< newest rxQueueSize frames are kept, older ones are lost
+	static const QString DropNewest; //!< frames that do not fit are lost
+	static const QString Spill;      //!< overflow goes to a temporary file and is re-ingested
 };
 
 class ConfigAbstract : public QObject
@@ -30,6 +55,7 @@ public:
 	friend class ConfigFd;
 	friend class ConfigStd;
 	friend class ConfigReplay;
+	friend class ConfigSocket;
 	friend class ConfigTracer;
 	friend class ConfigGeneric;
 
@@ -45,8 +71,42 @@ public:
 	ConfigGeneric(QObject *parent = nullptr);
 
 	void setCanType(QString canType);
+	void setRxNotify(const QString &rxNotifyRef);
+	void setRxNotifyUs(const QString &rxNotifyUsRef);
+	void setDecodeThread(const QString &decodeThreadRef);
+	void setSinkThread(const QString &sinkThreadRef);
+	void setSinkQueueSize(const QString &sinkQueueSizeRef);
+	void setTimestampBase(const QString &timestampBaseRef);
+	void setStatsPeriodSec(const QString &statsPeriodSecRef);
+	void setRxQueuePolicy(const QString &rxQueuePolicyRef);
+	void setRxQueueSize(const QString &rxQueueSizeRef);
+	void setLogFlushKb(const QString &logFlushKbRef);
+	void setLogFlushMs(const QString &logFlushMsRef);
+	void setLogCompress(const QString &logCompressRef);
+	void setLogSyncMs(const QString &logSyncMsRef);
+	void setRotateMb(const QString &rotateMbRef);
+	void setRotateMin(const QString &rotateMinRef);
+	void setRotateKeep(const QString &rotateKeepRef);
+	void setDecodeWorkers(const QString &decodeWorkersRef);
 
 	QString getCanType(void) const;
+	QString getRxNotify(void) const;
+	QString getRxNotifyUs(void) const;
+	QString getDecodeThread(void) const;
+	QString getSinkThread(void) const;
+	QString getSinkQueueSize(void) const;
+	QString getTimestampBase(void) const;
+	QString getStatsPeriodSec(void) const;
+	QString getRxQueuePolicy(void) const;
+	QString getRxQueueSize(void) const;
+	QString getLogFlushKb(void) const;
+	QString getLogFlushMs(void) const;
+	QString getLogCompress(void) const;
+	QString getLogSyncMs(void) const;
+	QString getRotateMb(void) const;
+	QString getRotateMin(void) const;
+	QString getRotateKeep(void) const;
+	QString getDecodeWorkers(void) const;
 };
 
 class ConfigFd : public ConfigAbstract
@@ -98,6 +158,40 @@ class ConfigReplay : public ConfigAbstract
 public:
 	ConfigReplay(QObject *parent = nullptr);
 
+	void setDev(const QString &devRef);
+	/// @brief Replay starts this many milliseconds after first frame of the capture.
+	void setStartMs(const QString &startMsRef);
+	/// @brief Replay starts at this frame, counted from 0. Used when startMs is 0.
+	void setStartFrame(const QString &startFrameRef);
+	/// @brief Replay speed in percent of recorded speed, 0 replays as fast as possible.
+	void setSpeedPct(const QString &speedPctRef);
+	/// @brief Replay stops before first frame this many milliseconds after first frame of the
+	/// capture, 0 replays to the end.
+	void setEndMs(const QString &endMsRef);
+	/// @brief Replay stops before this frame, counted as startFrame. Used when endMs is 0.
+	void setEndFrame(const QString &endFrameRef);
+	/// @brief Comma separated hex ids, only these are replayed. Empty replays all.
+	void setIdAllow(const QString &idAllowRef);
+	/// @brief Comma separated hex ids left out of replay, also when idAllow lists them.
+	void setIdDeny(const QString &idDenyRef);
+	/// @brief "on" starts over from the window start at the end of the window.
+	void setLoop(const QString &loopRef);
+	QString getDev(void) const;
+	QString getStartMs(void) const;
+	QString getStartFrame(void) const;
+	QString getSpeedPct(void) const;
+	QString getEndMs(void) const;
+	QString getEndFrame(void) const;
+	QString getIdAllow(void) const;
+	QString getIdDeny(void) const;
+	QString getLoop(void) const;
+};
+
+class ConfigSocket : public ConfigAbstract
+{
+public:
+	ConfigSocket(QObject *parent = nullptr);
+
 	void setDev(const QString &devRef);
 	QString getDev(void) const;
 };
@@ -126,6 +220,7 @@ public:
 	ConfigFd fd;
 	ConfigStd std;
 	ConfigReplay replay;
+	ConfigSocket socket;
 	ConfigTracer tracer;
 	void setXml(const QDomElement &elem);
 	void getXml(QDomDocument &domDocRef);
@@ -0,0 +1,123 @@
+#include <QThread>
+#include "decoder.h"
+#include "util.h"
+
+Decoder::Decoder(
+	StageQueue<CanMsg, CanFrameRing> *frameQueuePtr,
+	StageQueue<UdsPacket> *traceQueuePtr,
+	StageQueue<UdsPacket> *guiQueuePtr,
+	QObject *parent
+) :
+	QObject(parent),
+	frameQueuePtr(frameQueuePtr),
+	traceQueuePtr(traceQueuePtr),
+	guiQueuePtr(guiQueuePtr),
+	canPtr(nullptr),
+	isStarted(false),
+	packetDecoder()
+{
+}
+
+void Decoder::start(Can *canPtr, uint32_t reqCanId, uint32_t respCanId, const QString &logDirPathRef)
+{
+	this->canPtr = canPtr;
+	this->stats.reset();
+	this->packetDecoder.start(reqCanId, respCanId);
+	Util::log(LogType::Generic, LogSt::Ok, "ISOTP handles initialized successfully.");
+
+	emit started(logDirPathRef);
+	this->isStarted = true;
+	// rx thread may have queued frames before we were started
+	drainRxQueue();
+}
+
+void Decoder::stop(void)
+{
+	// frames pushed right before disconnect may not have their own wake up
+	drainRxQueue();
+	this->isStarted = false;
+	this->canPtr = nullptr;
+	emit stopped();
+}
+
+void Decoder::onCanEventOccured(CanEvent event)
+{
+	// connection events are sequenced by Cli through start and stop
+	if(event == CanEvent::MessageReceived) {
+		drainRxQueue();
+	}
+}
+
+void Decoder::drainRxQueue(void)
+{
+	size_t numOfMsg = 0;
+
+	if(!this->isStarted) {
+		return;
+	}
+
+	this->canPtr->ackRx();
+	while((numOfMsg = this->canPtr->popRx(this->rxBatchArr, rxBatchSize)) != 0) {
+		for(size_t i = 0; i < numOfMsg; ++i) {
+			decode(this->rxBatchArr[i]);
+		}
+	}
+}
+
+void Decoder::pushFrame(const CanMsg &canMsgRef)
+{
+	// lossless, wait for log sink when it falls behind
+	while(this->frameQueuePtr->isFull() || !this->frameQueuePtr->push(canMsgRef)) {
+		if(this->frameQueuePtr->arm()) {
+			emit framesReady();
+		}
+		QThread::yieldCurrentThread();
+	}
+	this->stats.logQueueHighWater.update(this->frameQueuePtr->size());
+	if(this->frameQueuePtr->arm()) {
+		emit framesReady();
+	}
+}
+
+void Decoder::pushPacket(const UdsPacket &packetRef)
+{
+	// lossless, wait for trace sink when it falls behind
+	while(this->traceQueuePtr->isFull() || !this->traceQueuePtr->push(packetRef)) {
+		if(this->traceQueuePtr->arm()) {
+			emit tracePacketsReady();
+		}
+		QThread::yieldCurrentThread();
+	}
+	this->stats.packetsDecoded.add();
+	this->stats.traceQueueHighWater.update(this->traceQueuePtr->size());
+	if(this->traceQueuePtr->arm()) {
+		emit tracePacketsReady();
+	}
+
+	// gui is only a view, trace files keep everything
+	if(!this->guiQueuePtr->isFull() && this->guiQueuePtr->push(packetRef)) {
+		if(this->guiQueuePtr->arm()) {
+			emit guiPacketsReady();
+		}
+	} else {
+		this->stats.guiPacketsDropped.add();
+	}
+}
+
+void Decoder::decode(const CanMsg &canMsgRef)
+{
+	UdsPacket packet;
+
+	this->stats.framesDecoded.add();
+	pushFrame(canMsgRef);
+
+	if(!this->packetDecoder.decode(canMsgRef, packet)) {
+		return;
+	}
+	Util::log(
+		packet.isReq ? LogType::UdsReqMsg : LogType::UdsRespMsg,
+		LogSt::Ok,
+		packet.packetInfo[0].getHexStr(10)
+	);
+	pushPacket(packet);
+}
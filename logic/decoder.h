@@ -0,0 +1,63 @@
+/**
+ * @defgroup decoder_h
+ * @{
+ * @file decoder.h
+ * @brief Decode stage of the capture pipeline.
+ * Drains CAN rx queue, reassembles ISO-TP and decodes UDS through a PacketDecoder. Frames and packets are handed
+ * to sink stages (CAN log, UDS trace, GUI) through bounded queues so that each stage
+ * can run on its own thread.
+ */
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <QObject>
+#include <QString>
+#include "can.h"
+#include "packetdecoder.h"
+#include "spscqueue.h"
+#include "stats.h"
+#include "uds.h"
+
+class Decoder : public QObject
+{
+	Q_OBJECT
+public:
+	explicit Decoder(
+		StageQueue<CanMsg, CanFrameRing> *frameQueuePtr,
+		StageQueue<UdsPacket> *traceQueuePtr,
+		StageQueue<UdsPacket> *guiQueuePtr,
+		QObject *parent = nullptr
+	);
+	void start(Can *canPtr, uint32_t reqCanId, uint32_t respCanId, const QString &logDirPathRef);
+	void stop(void);
+	void decode(const CanMsg &canMsgRef);
+
+	DecodeStats stats;
+signals:
+	/// @brief Sinks open their files on this.
+	void started(const QString &logDirPathRef);
+	/// @brief Sinks drain what is left and close on this.
+	void stopped(void);
+	void framesReady(void);
+	void tracePacketsReady(void);
+	void guiPacketsReady(void);
+public slots:
+	void onCanEventOccured(CanEvent event);
+private:
+	StageQueue<CanMsg, CanFrameRing> *frameQueuePtr;
+	StageQueue<UdsPacket> *traceQueuePtr;
+	StageQueue<UdsPacket> *guiQueuePtr;
+	Can *canPtr;
+	bool isStarted;
+	PacketDecoder packetDecoder;
+	static const size_t rxBatchSize = 64;
+	CanMsg rxBatchArr[rxBatchSize];
+
+	void drainRxQueue(void);
+	void pushFrame(const CanMsg &canMsgRef);
+	void pushPacket(const UdsPacket &packetRef);
+};
+
+#endif // DECODER_H
+
+/// @}
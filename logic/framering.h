@@ -0,0 +1,206 @@
+/**
+ * @defgroup framering_h
+ * @{
+ * @file framering.h
+ * @brief Lock-free single producer, single consumer ring of variable length CAN frames.
+ * Frames are stored compact: 16 byte header (id, length, flags, channel, timestamp) followed by payload rounded up
+ * to 8 bytes. Classic frame takes 24 bytes, 64 byte FD frame takes 80 bytes, instead of always
+ * copying a full CanMsg. The message struct is only used as a view on push and pop.
+ */
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+template <typename Msg>
+class FrameRing {
+public:
+	static constexpr size_t cacheLineSize = 64;
+	static constexpr size_t wordSize = sizeof(uint64_t);
+	static constexpr size_t headerWords = 2;
+	static constexpr size_t maxDataLength = sizeof(Msg::data);
+
+	/// @brief Capacity is in classic frames and rounded up to the next power of two.
+	/// FD frames use more of the ring, so fewer of them fit.
+	explicit FrameRing(size_t capacity) :
+		head(0),
+		headCount(0),
+		cachedTail(0),
+		tail(0),
+		tailCount(0),
+		cachedHead(0),
+		frameCapacity(roundUpPow2(capacity)),
+		mask(roundUpPow2(this->frameCapacity * getWords(8)) - 1),
+		buffer(std::make_unique<uint64_t[]>(mask + 1))
+	{
+	}
+
+	FrameRing(const FrameRing &) = delete;
+	FrameRing &operator=(const FrameRing &) = delete;
+
+	/// @brief Producer side. Returns false when there is no room for the frame.
+	bool push(const Msg &msgRef) {
+		return pushN(&msgRef, 1) == 1;
+	}
+
+	/// @brief Producer side. Pushes as many as fit, returns number pushed.
+	size_t pushN(const Msg *msgPtr, size_t count) {
+		const size_t t = this->tail.load(std::memory_order_relaxed);
+		size_t used = 0;
+		size_t i = 0;
+
+		for(; i < count; ++i) {
+			const size_t dataLength = getDataLength(msgPtr[i]);
+			const size_t words = getWords(dataLength);
+			if(words > wordCapacity() - (t + used - this->cachedHead)) {
+				this->cachedHead = this->head.load(std::memory_order_acquire);
+				if(words > wordCapacity() - (t + used - this->cachedHead)) {
+					break;
+				}
+			}
+			write(t + used, msgPtr[i], dataLength);
+			used += words;
+		}
+		if(i != 0) {
+			this->tailCount.store(this->tailCount.load(std::memory_order_relaxed) + i, std::memory_order_relaxed);
+			this->tail.store(t + used, std::memory_order_release);
+		}
+		return i;
+	}
+
+	/// @brief Consumer side. Returns false when the ring is empty.
+	bool tryPop(Msg &msgRef) {
+		return tryPopN(&msgRef, 1) == 1;
+	}
+
+	/// @brief Consumer side. Pops up to maxCount frames, returns number popped.
+	size_t tryPopN(Msg *msgPtr, size_t maxCount) {
+		const size_t h = this->head.load(std::memory_order_relaxed);
+		size_t used = 0;
+		size_t i = 0;
+
+		if(this->cachedTail == h) {
+			this->cachedTail = this->tail.load(std::memory_order_acquire);
+		}
+		for(; i < maxCount; ++i) {
+			if(h + used == this->cachedTail) {
+				this->cachedTail = this->tail.load(std::memory_order_acquire);
+				if(h + used == this->cachedTail) {
+					break;
+				}
+			}
+			used += read(h + used, msgPtr[i]);
+		}
+		if(i != 0) {
+			this->headCount.store(this->headCount.load(std::memory_order_relaxed) + i, std::memory_order_relaxed);
+			this->head.store(h + used, std::memory_order_release);
+		}
+		return i;
+	}
+
+	/// @brief Safe from either side, result may be stale by the time it is used.
+	bool isEmpty() const {
+		return this->head.load(std::memory_order_acquire) == this->tail.load(std::memory_order_acquire);
+	}
+
+	/// @brief Number of frames, safe from either side, may be stale.
+	size_t size() const {
+		const size_t tc = this->tailCount.load(std::memory_order_relaxed);
+		const size_t hc = this->headCount.load(std::memory_order_relaxed);
+		return tc > hc ? (tc - hc) : 0;
+	}
+
+	/// @brief Capacity in classic frames.
+	size_t capacity() const {
+		return this->frameCapacity;
+	}
+
+	/// @brief Bytes held by the ring, independent of frame type.
+	size_t capacityBytes() const {
+		return wordCapacity() * wordSize;
+	}
+
+private:
+	/// @brief Record header, exactly two words.
+	struct Header {
+		uint32_t id;
+		uint8_t dataLength;
+		uint8_t flags;
+		uint8_t channel;
+		uint8_t reserved;
+		uint64_t timestamp;
+	};
+	static_assert(sizeof(Header) == headerWords * wordSize, "FrameRing header has to be two words");
+
+	static size_t roundUpPow2(size_t value) {
+		size_t pow2 = 1;
+		while(pow2 < value) {
+			pow2 <<= 1;
+		}
+		return pow2;
+	}
+
+	static size_t getWords(size_t dataLength) {
+		return headerWords + (dataLength + wordSize - 1) / wordSize;
+	}
+
+	static size_t getDataLength(const Msg &msgRef) {
+		return msgRef.dataLength > maxDataLength ? maxDataLength : msgRef.dataLength;
+	}
+
+	size_t wordCapacity() const {
+		return this->mask + 1;
+	}
+
+	// Words may wrap around the end of buffer, so everything is copied word by word.
+	// Msg::data is 64 bytes, reading or writing whole words of it never goes out of bounds.
+	void write(size_t idx, const Msg &msgRef, size_t dataLength) {
+		Header header = {};
+		header.id = msgRef.id;
+		header.dataLength = static_cast<uint8_t>(dataLength);
+		header.flags = msgRef.flags;
+		header.channel = msgRef.channel;
+		header.timestamp = msgRef.timestamp;
+		memcpy(&this->buffer[idx & this->mask], &header, wordSize);
+		memcpy(&this->buffer[(idx + 1) & this->mask], reinterpret_cast<const uint8_t *>(&header) + wordSize, wordSize);
+		for(size_t i = 0; i * wordSize < dataLength; ++i) {
+			memcpy(&this->buffer[(idx + headerWords + i) & this->mask], msgRef.data + i * wordSize, wordSize);
+		}
+	}
+
+	size_t read(size_t idx, Msg &msgRef) const {
+		Header header;
+		memcpy(&header, &this->buffer[idx & this->mask], wordSize);
+		memcpy(reinterpret_cast<uint8_t *>(&header) + wordSize, &this->buffer[(idx + 1) & this->mask], wordSize);
+		msgRef.id = header.id;
+		msgRef.dataLength = header.dataLength;
+		msgRef.flags = header.flags;
+		msgRef.channel = header.channel;
+		msgRef.timestamp = header.timestamp;
+		for(size_t i = 0; i * wordSize < header.dataLength; ++i) {
+			memcpy(msgRef.data + i * wordSize, &this->buffer[(idx + headerWords + i) & this->mask], wordSize);
+		}
+		return getWords(header.dataLength);
+	}
+
+	// consumer owned
+	alignas(cacheLineSize) std::atomic<size_t> head; //!< in words
+	std::atomic<size_t> headCount; //!< in frames
+	size_t cachedTail;
+	// producer owned
+	alignas(cacheLineSize) std::atomic<size_t> tail; //!< in words
+	std::atomic<size_t> tailCount; //!< in frames
+	size_t cachedHead;
+	// shared, read only after construction
+	alignas(cacheLineSize) const size_t frameCapacity;
+	const size_t mask;
+	std::unique_ptr<uint64_t[]> buffer;
+};
+
+#endif // FRAMERING_H
+
+/// @}
@@ -533,6 +533,36 @@ IsoTpRet IsoTp::receive(
 	return IsoTpRet::OK;
 }
 
+bool IsoTp::is_receiving(void) const
+{
+	return IsoTpReceiveStatus::INPROGRESS == link.receive_status;
+}
+
+bool IsoTp::is_start_frame(const uint8_t *data, uint8_t len)
+{
+	IsoTpCanMessage message;
+	uint16_t payload_length;
+
+	if (len < 2 || len > 8) {
+		return false;
+	}
+
+	memcpy(message.as.data_array.ptr, data, len);
+	memset(message.as.data_array.ptr + len, 0, sizeof(message.as.data_array.ptr) - len);
+
+	/* same checks as receive_single_frame and receive_first_frame, overflow ends a reception too */
+	switch (message.as.common.type) {
+	case static_cast<uint8_t>(IsoTpProtocolControlInformation::SINGLE):
+		return 0 != message.as.single_frame.SF_DL && message.as.single_frame.SF_DL <= (len - 1);
+	case static_cast<uint8_t>(IsoTpProtocolControlInformation::FIRST_FRAME):
+		payload_length = message.as.first_frame.FF_DL_high;
+		payload_length = (payload_length << 8) + message.as.first_frame.FF_DL_low;
+		return 8 == len && payload_length > 7;
+	default:
+		return false;
+	}
+}
+
 ///////////////////////////////////////////////////////
 ///                 VIRTUAL FUNCTIONS               ///
 ///////////////////////////////////////////////////////
@@ -115,6 +115,15 @@ public:
 		const uint16_t payload_size,
 		uint16_t *out_size
 	);
+	/**
+	 * @brief Tells whether a multi-frame message is being received, first frame is in and more are due.
+	 */
+	bool is_receiving(void) const;
+	/**
+	 * @brief Tells whether a frame starts a message whatever the link was doing: a single frame or
+	 * a first frame on_can_message accepts. One it rejects for its length leaves the link as it was.
+	 */
+	static bool is_start_frame(const uint8_t *data, uint8_t len);
 	void user_debug(const char* message, ...);
 	IsoTpRet user_send_can(
 		const uint32_t arbitration_id,
@@ -0,0 +1,337 @@
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include "offlinedecoder.h"
+#include "packetdecoder.h"
+
+OfflineDecoder::OfflineDecoder(void) :
+	capturePath(),
+	reqCanId(0),
+	respCanId(0),
+	numOfWorkers(0),
+	numOfWorkersRun(1),
+	minChunkFrames(defaultMinChunkFrames),
+	epochOffsetUs(0),
+	errorStr(),
+	numOfFrames(0),
+	numOfPackets(0),
+	numOfBadRecords(0),
+	chunkVec(),
+	mutex(),
+	stateCond(),
+	nextChunk(0),
+	numOfDecoded(0),
+	numOfWritten(0),
+	isAborted(false)
+{
+}
+
+void OfflineDecoder::setWorkers(int numOfWorkers)
+{
+	this->numOfWorkers = numOfWorkers;
+}
+
+void OfflineDecoder::setIds(uint32_t reqCanId, uint32_t respCanId)
+{
+	this->reqCanId = reqCanId;
+	this->respCanId = respCanId;
+}
+
+void OfflineDecoder::setMinChunkFrames(uint64_t minChunkFrames)
+{
+	this->minChunkFrames = minChunkFrames;
+}
+
+QString OfflineDecoder::errorString(void) const
+{
+	return this->errorStr;
+}
+
+int OfflineDecoder::getNumOfWorkers(void) const
+{
+	return this->numOfWorkersRun;
+}
+
+uint64_t OfflineDecoder::getNumOfFrames(void) const
+{
+	return this->numOfFrames;
+}
+
+uint64_t OfflineDecoder::getNumOfPackets(void) const
+{
+	return this->numOfPackets;
+}
+
+uint64_t OfflineDecoder::getNumOfBadRecords(void) const
+{
+	return this->numOfBadRecords;
+}
+
+bool OfflineDecoder::run(const QString &capturePathRef, TraceUds &traceUdsRef)
+{
+	CaptureStream stream;
+
+	this->capturePath = capturePathRef;
+	this->errorStr.clear();
+	this->numOfFrames = 0;
+	this->numOfPackets = 0;
+	this->numOfBadRecords = 0;
+	this->numOfWorkersRun = 1;
+	if(!stream.open(capturePathRef)) {
+		this->errorStr = stream.errorString();
+		return false;
+	}
+	this->epochOffsetUs = getEpochOffsetUs(stream);
+	const int numOfWorkers = this->numOfWorkers > 0 ? this->numOfWorkers : qMax(QThread::idealThreadCount(), 1);
+	// text logs have no index to find chunks with
+	const uint64_t totalFrames = numOfWorkers > 1 ? stream.getNumOfFrames() : 0;
+	if(totalFrames <= this->minChunkFrames) {
+		return runSerial(stream, traceUdsRef);
+	}
+	stream.close();
+	this->numOfWorkersRun = numOfWorkers;
+	return runParallel(totalFrames, traceUdsRef);
+}
+
+int64_t OfflineDecoder::getEpochOffsetUs(CaptureStream &streamRef)
+{
+	const uint64_t createdUs = streamRef.getCreatedUs();
+	const uint64_t firstTimestamp = streamRef.getFirstTimestamp();
+
+	// first frame counts as taken when capture was created
+	if(createdUs != 0) {
+		return static_cast<int64_t>(createdUs - firstTimestamp);
+	}
+	// log of a tool that stamps wall clock, candump for one
+	if(firstTimestamp >= minEpochUs) {
+		return 0;
+	}
+	// relative or uptime stamps, first frame counts as taken when decoding started. Fixed once,
+	// so every worker and every packet of the run gets the same time base.
+	return QDateTime::currentMSecsSinceEpoch() * 1000 - static_cast<int64_t>(firstTimestamp);
+}
+
+bool OfflineDecoder::runSerial(CaptureStream &streamRef, TraceUds &traceUdsRef)
+{
+	PacketDecoder packetDecoder;
+	CanMsg canMsg;
+	UdsPacket packet;
+
+	// same packets as a decode in chunks gets
+	packetDecoder.start(this->reqCanId, this->respCanId, false);
+	packetDecoder.setCaptureTime(this->epochOffsetUs);
+	while(streamRef.next(canMsg)) {
+		++this->numOfFrames;
+		if(packetDecoder.decode(canMsg, packet)) {
+			traceUdsRef.write(packet);
+			++this->numOfPackets;
+		}
+	}
+	this->numOfBadRecords = streamRef.getNumOfBadRecords();
+	return true;
+}
+
+bool OfflineDecoder::runParallel(uint64_t totalFrames, TraceUds &traceUdsRef)
+{
+	QVector<QThread *> threadVec;
+	bool isOk = true;
+
+	const uint64_t chunkFrames = qMax(
+		this->minChunkFrames,
+		(totalFrames + this->numOfWorkersRun * chunksPerWorker - 1) / (this->numOfWorkersRun * chunksPerWorker)
+	);
+	this->chunkVec.clear();
+	this->chunkVec.resize((totalFrames + chunkFrames - 1) / chunkFrames);
+	for(size_t i = 0; i < this->chunkVec.size(); ++i) {
+		Chunk &chunkRef = this->chunkVec[i];
+		chunkRef.startFrame = i * chunkFrames;
+		// frames the indexes missed go to the last one
+		chunkRef.endFrame = i + 1 < this->chunkVec.size() ? chunkRef.startFrame + chunkFrames : UINT64_MAX;
+		chunkRef.byteSpan = 0;
+		chunkRef.numOfFrames = 0;
+		chunkRef.numOfBadRecords = 0;
+		chunkRef.isDecoded = false;
+		chunkRef.isRendered = false;
+		chunkRef.isFailed = false;
+	}
+	this->nextChunk = 0;
+	this->numOfDecoded = 0;
+	this->numOfWritten = 0;
+	this->isAborted = false;
+
+	for(int i = 0; i < this->numOfWorkersRun; ++i) {
+		threadVec.append(QThread::create([this]{ work(); }));
+		threadVec.last()->start();
+	}
+
+	for(size_t k = 0; k < this->chunkVec.size(); ++k) {
+		Chunk &chunkRef = this->chunkVec[k];
+		{
+			QMutexLocker locker(&this->mutex);
+			while(!chunkRef.isRendered) {
+				this->stateCond.wait(&this->mutex);
+			}
+			if(chunkRef.isFailed) {
+				this->isAborted = true;
+				this->stateCond.wakeAll();
+				isOk = false;
+				break;
+			}
+		}
+		qsizetype jsonStart = 0;
+		qsizetype htmlStart = 0;
+		for(size_t i = 0; i < chunkRef.jsonEndVec.size(); ++i) {
+			traceUdsRef.writeRendered(
+				chunkRef.jsonBfr.constData() + jsonStart,
+				chunkRef.jsonEndVec[i] - jsonStart,
+				chunkRef.htmlBfr.constData() + htmlStart,
+				chunkRef.htmlEndVec[i] - htmlStart
+			);
+			jsonStart = chunkRef.jsonEndVec[i];
+			htmlStart = chunkRef.htmlEndVec[i];
+		}
+		this->numOfFrames += chunkRef.numOfFrames;
+		this->numOfPackets += chunkRef.jsonEndVec.size();
+		this->numOfBadRecords += chunkRef.numOfBadRecords;
+		QByteArray().swap(chunkRef.jsonBfr);
+		QByteArray().swap(chunkRef.htmlBfr);
+		std::vector<qsizetype>().swap(chunkRef.jsonEndVec);
+		std::vector<qsizetype>().swap(chunkRef.htmlEndVec);
+
+		QMutexLocker locker(&this->mutex);
+		++this->numOfWritten;
+		this->stateCond.wakeAll();
+	}
+
+	for(QThread *threadPtr : threadVec) {
+		threadPtr->wait();
+		delete threadPtr;
+	}
+	this->chunkVec.clear();
+	return isOk;
+}
+
+void OfflineDecoder::work(void)
+{
+	QMutexLocker locker(&this->mutex);
+
+	while(true) {
+		// stays ahead of writing by a few chunks each, not by the whole capture
+		while(!this->isAborted && this->nextChunk < this->chunkVec.size() &&
+			this->nextChunk >= this->numOfWritten + static_cast<size_t>(this->numOfWorkersRun * maxAheadFactor)) {
+			this->stateCond.wait(&this->mutex);
+		}
+		if(this->isAborted || this->nextChunk >= this->chunkVec.size()) {
+			return;
+		}
+		const size_t chunkIdx = this->nextChunk++;
+		Chunk &chunkRef = this->chunkVec[chunkIdx];
+
+		locker.unlock();
+		const bool isOk = decodeChunk(chunkRef);
+		locker.relock();
+		chunkRef.isDecoded = true;
+		while(this->numOfDecoded < this->chunkVec.size() && this->chunkVec[this->numOfDecoded].isDecoded) {
+			++this->numOfDecoded;
+		}
+		if(!isOk) {
+			chunkRef.isFailed = true;
+			chunkRef.isRendered = true;
+			this->stateCond.wakeAll();
+			continue;
+		}
+		this->stateCond.wakeAll();
+
+		// where packets stand in the trace depends on all packets before them
+		while(this->numOfDecoded < chunkIdx) {
+			this->stateCond.wait(&this->mutex);
+		}
+		uint64_t byteIdx = 0;
+		std::vector<FramePacket> carriedVec;
+		for(size_t i = 0; i < chunkIdx; ++i) {
+			byteIdx += this->chunkVec[i].byteSpan;
+			for(const FramePacket &framePacketRef : this->chunkVec[i].carriedVec) {
+				if(framePacketRef.frame < chunkRef.startFrame) {
+					byteIdx += framePacketRef.byteSpan;
+				} else if(framePacketRef.frame < chunkRef.endFrame) {
+					carriedVec.push_back(framePacketRef);
+				}
+			}
+		}
+
+		locker.unlock();
+		renderChunk(chunkRef, byteIdx, carriedVec);
+		locker.relock();
+		chunkRef.isRendered = true;
+		this->stateCond.wakeAll();
+	}
+}
+
+bool OfflineDecoder::decodeChunk(Chunk &chunkRef)
+{
+	CaptureStream stream;
+	PacketDecoder packetDecoder;
+	CanMsg canMsg;
+	FramePacket framePacket;
+	uint64_t frame = chunkRef.startFrame;
+
+	if(!stream.open(this->capturePath) || !stream.seekFrame(chunkRef.startFrame)) {
+		QMutexLocker locker(&this->mutex);
+		this->errorStr = QString("Frame %1: %2").arg(chunkRef.startFrame).arg(stream.errorString());
+		return false;
+	}
+	// a seek may pass damaged records before the chunk, they belong to the chunk before
+	const uint64_t badStart = stream.getNumOfBadRecords();
+
+	packetDecoder.start(this->reqCanId, this->respCanId, false);
+	packetDecoder.setCaptureTime(this->epochOffsetUs);
+	while(frame < chunkRef.endFrame && stream.next(canMsg)) {
+		if(packetDecoder.decode(canMsg, framePacket.packet)) {
+			framePacket.frame = frame;
+			framePacket.byteSpan = TraceUds::getByteSpan(framePacket.packet);
+			chunkRef.byteSpan += framePacket.byteSpan;
+			chunkRef.packetVec.push_back(framePacket);
+		}
+		++frame;
+	}
+	chunkRef.numOfFrames = frame - chunkRef.startFrame;
+	chunkRef.numOfBadRecords = stream.getNumOfBadRecords() - badStart;
+
+	packetDecoder.carryOver();
+	while(packetDecoder.isCarrying() && stream.next(canMsg)) {
+		if(packetDecoder.decodeCarried(canMsg, framePacket.packet)) {
+			framePacket.frame = frame;
+			framePacket.byteSpan = TraceUds::getByteSpan(framePacket.packet);
+			chunkRef.carriedVec.push_back(framePacket);
+		}
+		++frame;
+	}
+	return true;
+}
+
+void OfflineDecoder::renderChunk(Chunk &chunkRef, uint64_t byteIdx, std::vector<FramePacket> &carriedVecRef)
+{
+	const std::vector<FramePacket> &packetVecRef = chunkRef.packetVec;
+	size_t packetIdx = 0;
+	size_t carriedIdx = 0;
+
+	// request and response side may both carry over, in frame order they are not
+	std::sort(carriedVecRef.begin(), carriedVecRef.end(), [](const FramePacket &aRef, const FramePacket &bRef) {
+		return aRef.frame < bRef.frame;
+	});
+	chunkRef.jsonEndVec.reserve(packetVecRef.size() + carriedVecRef.size());
+	chunkRef.htmlEndVec.reserve(packetVecRef.size() + carriedVecRef.size());
+	while(packetIdx < packetVecRef.size() || carriedIdx < carriedVecRef.size()) {
+		const bool isCarried = carriedIdx < carriedVecRef.size() &&
+			(packetIdx >= packetVecRef.size() || carriedVecRef[carriedIdx].frame < packetVecRef[packetIdx].frame);
+		const UdsPacket &packetRef = isCarried ? carriedVecRef[carriedIdx++].packet : packetVecRef[packetIdx++].packet;
+
+		TraceUds::render(packetRef, byteIdx, chunkRef.jsonBfr, chunkRef.htmlBfr);
+		chunkRef.jsonEndVec.push_back(chunkRef.jsonBfr.size());
+		chunkRef.htmlEndVec.push_back(chunkRef.htmlBfr.size());
+	}
+	// text is all writing needs
+	std::vector<FramePacket>().swap(chunkRef.packetVec);
+}
@@ -0,0 +1,124 @@
+/**
+ * @defgroup offlinedecoder_h
+ * @{
+ * @file offlinedecoder.h
+ * @brief Decodes a whole capture into UDS traces, as fast as frames can be read and packets written.
+ *
+ * With one worker, frames go from reader to PacketDecoder to TraceUds on the calling thread.
+ * With more, the capture is cut into chunks of frames, reached through the capture index, and
+ * workers take chunks in order:
+ *
+ * - decode: fresh PacketDecoder from the first frame of the chunk to its end, then on into the
+ *   frames that follow for packets still in progress, see PacketDecoder::carryOver.
+ * - render: once every chunk before it is decoded, it is known where its packets stand in the
+ *   trace. Packets the chunk before carried over into it are merged in by frame and the JSON and
+ *   HTML text of all of them is rendered, see TraceUds::render.
+ *
+ * The calling thread writes rendered chunks in capture order, traces come out as one worker
+ * writes them. Packets are traced at the time of the frame that completes them, counted from the
+ * creation time of the capture, so the trace is in timestamp order however workers interleave.
+ * Logs without a creation time keep their stamps when these are wall clock, relative ones are
+ * counted from the start of decoding. Workers stay at most maxAheadFactor chunks each ahead of
+ * writing, memory does not grow with capture size. A text log has no index, it is decoded with
+ * one worker.
+ */
+#ifndef OFFLINEDECODER_H
+#define OFFLINEDECODER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <cstdint>
+#include <vector>
+#include "capturestream.h"
+#include "traceuds.h"
+#include "uds.h"
+
+class OfflineDecoder
+{
+public:
+	OfflineDecoder(void);
+
+	/// @brief 0 takes one worker per core.
+	void setWorkers(int numOfWorkers);
+	void setIds(uint32_t reqCanId, uint32_t respCanId);
+	/// @brief Captures of up to minChunkFrames are decoded on the calling thread, larger ones in
+	/// chunks of at least that many frames. Tests lower it to get chunks of small captures.
+	void setMinChunkFrames(uint64_t minChunkFrames);
+	/// @brief Decodes capture into traceUdsRef, which has to be open. Runs to the end of the
+	/// capture before returning, false when it cannot be read, see errorString.
+	bool run(const QString &capturePathRef, TraceUds &traceUdsRef);
+	QString errorString(void) const;
+	/// @brief Workers last run had, 1 when it decoded on the calling thread.
+	int getNumOfWorkers(void) const;
+	uint64_t getNumOfFrames(void) const;
+	uint64_t getNumOfPackets(void) const;
+	uint64_t getNumOfBadRecords(void) const;
+
+	/// @brief Smaller chunks cost more in seeks and carry over than workers gain.
+	static const uint64_t defaultMinChunkFrames = 256 * 1024;
+	static const int chunksPerWorker = 8;
+	static const int maxAheadFactor = 2;
+	/// @brief Stamps from 2000-01-01 on are taken as wall clock, earlier ones as relative.
+	static const int64_t minEpochUs = 946684800LL * 1000000;
+private:
+	/// Packet with the number of the frame that completed it
+	class FramePacket
+	{
+	public:
+		uint64_t frame;
+		uint64_t byteSpan;   //!< see TraceUds::getByteSpan
+		UdsPacket packet;
+	};
+
+	class Chunk
+	{
+	public:
+		uint64_t startFrame;
+		uint64_t endFrame;
+		std::vector<FramePacket> packetVec;   //!< completed within chunk, dropped once rendered
+		std::vector<FramePacket> carriedVec;  //!< carried over, completed after chunk end
+		uint64_t byteSpan;                    //!< of packetVec
+		uint64_t numOfFrames;
+		uint64_t numOfBadRecords;
+		QByteArray jsonBfr;                   //!< rendered packets, in capture order
+		QByteArray htmlBfr;
+		std::vector<qsizetype> jsonEndVec;    //!< where text of each packet ends
+		std::vector<qsizetype> htmlEndVec;
+		bool isDecoded;
+		bool isRendered;
+		bool isFailed;
+	};
+
+	QString capturePath;
+	uint32_t reqCanId;
+	uint32_t respCanId;
+	int numOfWorkers;         //!< as set, 0 for one per core
+	int numOfWorkersRun;      //!< of last run
+	uint64_t minChunkFrames;
+	int64_t epochOffsetUs;    //!< frame timestamp to wall clock, see PacketDecoder::setCaptureTime
+	QString errorStr;
+	uint64_t numOfFrames;
+	uint64_t numOfPackets;
+	uint64_t numOfBadRecords;
+	std::vector<Chunk> chunkVec;
+	QMutex mutex;
+	QWaitCondition stateCond;  //!< a chunk was decoded, rendered or written
+	size_t nextChunk;          //!< next one a worker takes
+	size_t numOfDecoded;       //!< chunks before it are all decoded
+	size_t numOfWritten;
+	bool isAborted;
+
+	/// @brief Frame timestamp to wall clock, see PacketDecoder::setCaptureTime. Rewinds the stream.
+	static int64_t getEpochOffsetUs(CaptureStream &streamRef);
+	bool runSerial(CaptureStream &streamRef, TraceUds &traceUdsRef);
+	bool runParallel(uint64_t totalFrames, TraceUds &traceUdsRef);
+	void work(void);
+	bool decodeChunk(Chunk &chunkRef);
+	void renderChunk(Chunk &chunkRef, uint64_t byteIdx, std::vector<FramePacket> &carriedVecRef);
+};
+
+#endif // OFFLINEDECODER_H
+
+/// @}
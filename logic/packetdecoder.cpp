@@ -0,0 +1,149 @@
+#include <cstring>
+#include "can.h"
+#include "packetdecoder.h"
+
+PacketDecoder::PacketDecoder(void) :
+	uds(),
+	req(),
+	resp(),
+	udsBfr(),
+	reqCanId(0),
+	respCanId(0),
+	isTimed(true),
+	isCaptureTime(false),
+	epochOffsetUs(0)
+{
+	initSide(this->req, 0x12);
+	initSide(this->resp, 0x13);
+}
+
+void PacketDecoder::start(uint32_t reqCanId, uint32_t respCanId, bool isTimed)
+{
+	this->reqCanId = reqCanId;
+	this->respCanId = respCanId;
+	this->isTimed = isTimed;
+	// not important we are not going to send anything
+	initSide(this->req, 0x12);
+	initSide(this->resp, 0x13);
+	this->udsBfr.reserve(recvBfrSize);
+}
+
+void PacketDecoder::setCaptureTime(int64_t epochOffsetUs)
+{
+	this->isCaptureTime = true;
+	this->epochOffsetUs = epochOffsetUs;
+}
+
+void PacketDecoder::initSide(Side &sideRef, uint32_t sendId)
+{
+	memset(sideRef.sendBfrArr, 0, sizeof(sideRef.sendBfrArr));
+	memset(sideRef.recvBfrArr, 0, sizeof(sideRef.recvBfrArr));
+	sideRef.isoTp.init(
+		sendId,
+		sideRef.sendBfrArr,
+		sizeof(sideRef.sendBfrArr),
+		sideRef.recvBfrArr,
+		sizeof(sideRef.recvBfrArr)
+	);
+	sideRef.rawCanIsoTp.clear();
+	sideRef.rawCanIsoTp.reserve(rawCanIsoTpMax + 1);
+	sideRef.isCarried = false;
+}
+
+bool PacketDecoder::decode(const CanMsg &canMsgRef, UdsPacket &packetRef)
+{
+	const bool isReq = canMsgRef.id == this->reqCanId;
+
+	if(!isReq && canMsgRef.id != this->respCanId) {
+		poll();
+		return false;
+	}
+	Side &sideRef = isReq ? this->req : this->resp;
+
+	// a packet string holds frames of its own packet only, whatever came before on this side
+	if(IsoTp::is_start_frame(canMsgRef.data, canMsgRef.dataLength)) {
+		sideRef.rawCanIsoTp.clear();
+	}
+	// only first frames are printed, rest is just counted as "..."
+	if(sideRef.rawCanIsoTp.length() <= rawCanIsoTpMax) {
+		sideRef.rawCanIsoTp.append(canMsgRef);
+	}
+	sideRef.isoTp.on_can_message(canMsgRef.data, canMsgRef.dataLength);
+	poll();
+	return receive(sideRef, isReq, canMsgRef.timestamp, packetRef);
+}
+
+/// Any frame moves time on, a side stuck mid packet times out without a frame of its own.
+void PacketDecoder::poll(void)
+{
+	if(!this->isTimed) {
+		return;
+	}
+	this->req.isoTp.poll();
+	this->resp.isoTp.poll();
+}
+
+void PacketDecoder::carryOver(void)
+{
+	this->req.isCarried = this->req.isoTp.is_receiving();
+	this->resp.isCarried = this->resp.isoTp.is_receiving();
+}
+
+bool PacketDecoder::isCarrying(void) const
+{
+	return this->req.isCarried || this->resp.isCarried;
+}
+
+bool PacketDecoder::decodeCarried(const CanMsg &canMsgRef, UdsPacket &packetRef)
+{
+	const bool isReq = canMsgRef.id == this->reqCanId;
+
+	if(!isReq && canMsgRef.id != this->respCanId) {
+		return false;
+	}
+	Side &sideRef = isReq ? this->req : this->resp;
+	if(!sideRef.isCarried) {
+		return false;
+	}
+	if(IsoTp::is_start_frame(canMsgRef.data, canMsgRef.dataLength)) {
+		sideRef.isCarried = false;
+		return false;
+	}
+	const bool isDecoded = decode(canMsgRef, packetRef);
+	sideRef.isCarried = sideRef.isoTp.is_receiving();
+	return isDecoded;
+}
+
+bool PacketDecoder::receive(Side &sideRef, bool isReq, uint64_t timestamp, UdsPacket &packetRef)
+{
+	uint16_t outSize = 0;
+	QString s = "";
+
+	if(sideRef.isoTp.receive(this->outArr, recvBfrSize, &outSize) != IsoTpRet::OK) {
+		return false;
+	}
+	if(outSize == 0) {
+		sideRef.rawCanIsoTp.clear();
+		return false;
+	}
+	// vector keeps its capacity across packets
+	this->udsBfr.resize(outSize);
+	memcpy(this->udsBfr.data(), this->outArr, outSize);
+
+	if(isReq) {
+		this->uds.getReqInfo(this->udsBfr, packetRef.packetInfo);
+	} else {
+		this->uds.getRespInfo(this->udsBfr, packetRef.packetInfo);
+	}
+	for(int i = 0; i < sideRef.rawCanIsoTp.length() && i < rawCanIsoTpMax; ++i) {
+		s += Can::getMsgStr(sideRef.rawCanIsoTp[i]) + "\\n";
+	}
+	s = sideRef.rawCanIsoTp.length() > rawCanIsoTpMax ? (s + "\\n...") : s;
+	sideRef.rawCanIsoTp.clear();
+
+	packetRef.isReq = isReq;
+	packetRef.isCaptureTime = this->isCaptureTime;
+	packetRef.timestampUs = this->isCaptureTime ? timestamp + this->epochOffsetUs : 0;
+	packetRef.rawCanMsgStr = s;
+	return true;
+}
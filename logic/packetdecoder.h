@@ -0,0 +1,79 @@
+/**
+ * @defgroup packetdecoder_h
+ * @{
+ * @file packetdecoder.h
+ * @brief Reassembles ISO-TP and decodes UDS for one request and response CAN id pair.
+ * Plain class without queues or signals: Decoder runs it on frames of the capture pipeline,
+ * offline decoding runs it straight on frames read from a capture. ISO-TP is only fed on the side
+ * a frame belongs to. Timed decoding polls both sides on every frame, of any id, as the decoder
+ * before it did, so timeouts and recovery of a live capture stay as they were.
+ *
+ * A capture decoded in chunks gets one decoder per chunk, each starts with no packet in progress.
+ * Packets that began before a chunk are finished by the decoder of the chunk before it: once at
+ * its end, it carries on with consecutive frames of packets still in progress only, see carryOver.
+ */
+#ifndef PACKETDECODER_H
+#define PACKETDECODER_H
+
+#include <QVector>
+#include <cstdint>
+#include "canmsg.h"
+#include "isotp.hpp"
+#include "uds.h"
+
+class PacketDecoder
+{
+public:
+	PacketDecoder(void);
+	/// @brief Drops any packet in progress. Untimed leaves out ISO-TP timeouts, they run on wall
+	/// clock and would make the result of an offline decode depend on how fast it runs.
+	void start(uint32_t reqCanId, uint32_t respCanId, bool isTimed = true);
+	/// @brief Packets get the timestamp of the frame that completes them plus epochOffsetUs,
+	/// a trace of a capture then shows capture time. Without it they are traced at time of writing.
+	void setCaptureTime(int64_t epochOffsetUs);
+	/// @brief True when frame completes a packet, packetRef holds it then. One frame completes
+	/// one packet at most.
+	bool decode(const CanMsg &canMsgRef, UdsPacket &packetRef);
+	/// @brief From here on only packets already in progress are decoded, see decodeCarried.
+	void carryOver(void);
+	/// @brief False once no packet is carried over on either side, frames that follow are left
+	/// to whoever decodes from there.
+	bool isCarrying(void) const;
+	/// @brief As decode for packets carried over. A single or first frame ISO-TP accepts ends carry
+	/// over of its side, a decoder that starts fresh at that frame gets the same packets from there on.
+	bool decodeCarried(const CanMsg &canMsgRef, UdsPacket &packetRef);
+private:
+	/// Frames kept for the packet string, one more is kept to know there were more.
+	static const int rawCanIsoTpMax = 2;
+	static const uint16_t recvBfrSize = 10240;
+
+	/// ISO-TP state of one direction
+	class Side
+	{
+	public:
+		IsoTp isoTp;
+		uint8_t sendBfrArr[16];
+		uint8_t recvBfrArr[recvBfrSize];
+		QVector<CanMsg> rawCanIsoTp;
+		bool isCarried;
+	};
+
+	Uds uds;
+	Side req;
+	Side resp;
+	uint8_t outArr[recvBfrSize];
+	QVector<uint8_t> udsBfr;
+	uint32_t reqCanId;
+	uint32_t respCanId;
+	bool isTimed;
+	bool isCaptureTime;
+	int64_t epochOffsetUs;
+
+	void initSide(Side &sideRef, uint32_t sendId);
+	void poll(void);
+	bool receive(Side &sideRef, bool isReq, uint64_t timestamp, UdsPacket &packetRef);
+};
+
+#endif // PACKETDECODER_H
+
+/// @}
@@ -1,4 +1,11 @@
 #include <QVector>
+#include <QThread>
+#ifndef Q_OS_WIN32
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 #include "peakbasiccan.h"
 #include "util.h"
 
@@ -34,10 +41,63 @@ PeakBasicCan::PeakBasicCan(void) :
 		{PCAN_ERROR_INITIALIZE, "Channel is not initialized"},
 		{PCAN_ERROR_ILLOPERATION, "Invalid operation"}
 	})
+	, rxEventPcanHandle(invalidPcanHandle)
+#ifdef Q_OS_WIN32
+	, rxEventHandle(NULL)
+	, wakeEventHandle(NULL)
+#else
+	, rxEventFd(-1)
+	, wakeFd(-1)
+#endif
 {
 
 }
 
+uint32_t PeakBasicCan::getOverruns(TPCANStatus readResult, BYTE msgType, const BYTE *dataPtr) const
+{
+	const TPCANStatus overrunMask = PCAN_ERROR_OVERRUN | PCAN_ERROR_QOVERRUN;
+	uint32_t overruns = 0;
+
+	if((readResult & overrunMask) != 0) {
+		++overruns;
+	}
+	// status message carries the status big endian in the first four data bytes
+	if(readResult == PCAN_ERROR_OK && (msgType & PCAN_MESSAGE_STATUS) != 0) {
+		TPCANStatus msgStatus =
+			((TPCANStatus)dataPtr[0] << 24) |
+			((TPCANStatus)dataPtr[1] << 16) |
+			((TPCANStatus)dataPtr[2] << 8) |
+			(TPCANStatus)dataPtr[3];
+		if((msgStatus & overrunMask) != 0) {
+			++overruns;
+		}
+	}
+	return overruns;
+}
+
+bool PeakBasicCan::isRxReadFailed(TPCANStatus readResult)
+{
+	const TPCANStatus statusMask = PCAN_ERROR_ANYBUSERR | PCAN_ERROR_OVERRUN | PCAN_ERROR_QOVERRUN;
+
+	if(readResult == PCAN_ERROR_OK || readResult == PCAN_ERROR_QRCVEMPTY) {
+		return false;
+	}
+	return (readResult & ~statusMask) != 0;
+}
+
+uint8_t PeakBasicCan::getCanMsgFlags(BYTE msgType)
+{
+	uint8_t flags = 0;
+
+	flags |= (msgType & PCAN_MESSAGE_EXTENDED) ? CanMsgFlagExtended : 0;
+	flags |= (msgType & PCAN_MESSAGE_FD) ? CanMsgFlagFd : 0;
+	flags |= (msgType & PCAN_MESSAGE_BRS) ? CanMsgFlagBrs : 0;
+	flags |= (msgType & PCAN_MESSAGE_ESI) ? CanMsgFlagEsi : 0;
+	flags |= (msgType & PCAN_MESSAGE_RTR) ? CanMsgFlagRtr : 0;
+	flags |= (msgType & PCAN_MESSAGE_ECHO) ? CanMsgFlagTx : 0;
+	return flags;
+}
+
 QString PeakBasicCan::getStatusStr(TPCANStatus st)
 {
 	QString retStr = "";
@@ -98,3 +158,126 @@ TPCANHandle PeakBasicCan::getPeakHandleId(QString devStr)
 
 	return getPeakHandleId(deviceNum);
 }
+
+/// Hooks up driver receive event so rx thread can sleep while bus is idle.
+/// When the event can't be had rx falls back to polling with a short sleep.
+/// Returns false only when driver hands out an event that can't be waited on,
+/// rx would spin on it, so caller fails the connect.
+bool PeakBasicCan::openRxEvent(TPCANHandle pcanHandle)
+{
+	TPCANStatus st;
+
+	closeRxEvent();
+	this->rxEventPcanHandle = pcanHandle;
+#ifdef Q_OS_WIN32
+	this->rxEventHandle = CreateEvent(NULL, FALSE, FALSE, NULL);
+	this->wakeEventHandle = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if(this->rxEventHandle == NULL || this->wakeEventHandle == NULL) {
+		Util::log(LogType::Generic, LogSt::Warn, "Failed to create receive event, polling instead");
+		closeRxEvent();
+		return true;
+	}
+	st = CAN_SetValue(pcanHandle, PCAN_RECEIVE_EVENT, &this->rxEventHandle, sizeof(this->rxEventHandle));
+#else
+	// on linux receive event is always on, driver only hands out its fd
+	st = CAN_GetValue(pcanHandle, PCAN_RECEIVE_EVENT, &this->rxEventFd, sizeof(this->rxEventFd));
+	// ppoll reports a bad fd as ready at once, checked before wakeFd may take its number
+	if(st == PCAN_ERROR_OK && (this->rxEventFd < 0 || fcntl(this->rxEventFd, F_GETFD) < 0)) {
+		closeRxEvent();
+		return false;
+	}
+	this->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(this->wakeFd < 0) {
+		Util::log(LogType::Generic, LogSt::Warn, "Failed to create wake up eventfd, polling instead");
+		closeRxEvent();
+		return true;
+	}
+#endif
+	if(st != PCAN_ERROR_OK) {
+		Util::log(LogType::Generic, LogSt::Warn, "Receive event unavailable, polling instead: " + getStatusStr(st));
+		closeRxEvent();
+		return true;
+	}
+	return true;
+}
+
+void PeakBasicCan::closeRxEvent(void)
+{
+#ifdef Q_OS_WIN32
+	if(this->rxEventHandle != NULL) {
+		HANDLE nullHandle = NULL;
+		CAN_SetValue(this->rxEventPcanHandle, PCAN_RECEIVE_EVENT, &nullHandle, sizeof(nullHandle));
+		CloseHandle(this->rxEventHandle);
+		this->rxEventHandle = NULL;
+	}
+	if(this->wakeEventHandle != NULL) {
+		CloseHandle(this->wakeEventHandle);
+		this->wakeEventHandle = NULL;
+	}
+#else
+	// rxEventFd belongs to driver, it goes away with CAN_Uninitialize
+	this->rxEventFd = -1;
+	if(this->wakeFd >= 0) {
+		::close(this->wakeFd);
+		this->wakeFd = -1;
+	}
+#endif
+	this->rxEventPcanHandle = this->invalidPcanHandle;
+}
+
+/// Blocks until driver has frames, timeout passes or wakeRxEvent is called.
+PeakRxWait PeakBasicCan::waitRxEvent(int64_t timeoutUs)
+{
+#ifdef Q_OS_WIN32
+	if(this->rxEventHandle == NULL) {
+		QThread::usleep(100);
+		return PeakRxWait::Timeout;
+	}
+	HANDLE handles[2] = { this->wakeEventHandle, this->rxEventHandle };
+	DWORD timeoutMs = (DWORD)((timeoutUs + 999) / 1000);
+	DWORD ret = WaitForMultipleObjects(2, handles, FALSE, timeoutMs);
+	if(ret == WAIT_OBJECT_0) {
+		return PeakRxWait::Stopped;
+	} else if(ret == WAIT_OBJECT_0 + 1) {
+		return PeakRxWait::Ready;
+	}
+	return PeakRxWait::Timeout;
+#else
+	if(this->rxEventFd < 0) {
+		QThread::usleep(100);
+		return PeakRxWait::Timeout;
+	}
+	struct pollfd fds[2] = {
+		{ .fd = this->wakeFd, .events = POLLIN, .revents = 0 },
+		{ .fd = this->rxEventFd, .events = POLLIN, .revents = 0 }
+	};
+	struct timespec timeout = {
+		.tv_sec = (time_t)(timeoutUs / 1000000),
+		.tv_nsec = (long)((timeoutUs % 1000000) * 1000)
+	};
+	int ret = ppoll(fds, 2, &timeout, nullptr);
+	if(ret <= 0) {
+		return PeakRxWait::Timeout;
+	}
+	if(fds[0].revents != 0) {
+		return PeakRxWait::Stopped;
+	}
+	return PeakRxWait::Ready;
+#endif
+}
+
+/// Thread safe, used by disconnect to release a blocked rx thread.
+void PeakBasicCan::wakeRxEvent(void)
+{
+#ifdef Q_OS_WIN32
+	if(this->wakeEventHandle != NULL) {
+		SetEvent(this->wakeEventHandle);
+	}
+#else
+	if(this->wakeFd >= 0) {
+		uint64_t one = 1;
+		ssize_t ret = ::write(this->wakeFd, &one, sizeof(one));
+		(void)ret;
+	}
+#endif
+}
@@ -4,7 +4,18 @@
 #include <QObject>
 #include <QMap>
 #include <QString>
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#endif
 #include "PCANBasic.h"
+#include "canmsg.h"
+
+/// @brief Result of waiting on driver receive event.
+enum class PeakRxWait {
+	Ready,   //!< driver has frames in its receive queue
+	Timeout, //!< nothing arrived in time
+	Stopped  //!< wakeRxEvent was called
+};
 
 class PeakBasicCan
 {
@@ -16,8 +27,29 @@ public:
 	TPCANHandle getPeakHandleId(QString devStr);
 signals:
 
+protected:
+	bool openRxEvent(TPCANHandle pcanHandle);
+	void closeRxEvent(void);
+	PeakRxWait waitRxEvent(int64_t timeoutUs);
+	void wakeRxEvent(void);
+	/// @brief Returns number of overruns reported by a read, either as read result
+	/// or inside a status message.
+	uint32_t getOverruns(TPCANStatus readResult, BYTE msgType, const BYTE *dataPtr) const;
+	/// @brief True when a read failed for another reason than an empty queue,
+	/// bus status or overrun. Those are reported while frames are still queued.
+	static bool isRxReadFailed(TPCANStatus readResult);
+	static uint8_t getCanMsgFlags(BYTE msgType);
+
 private:
 	const QMap<TPCANStatus, QString> statusStrings;
+	TPCANHandle rxEventPcanHandle;
+#ifdef Q_OS_WIN32
+	HANDLE rxEventHandle;
+	HANDLE wakeEventHandle;
+#else
+	int rxEventFd;
+	int wakeFd;
+#endif
 };
 
 #endif // PEAKBASICCAN_H
@@ -48,6 +48,10 @@ void PeakFdCan::connect(const void * configPtr)
 
 	if (stsResult != PCAN_ERROR_OK) {
 		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", getStatusStr(stsResult));
+	} else if(!openRxEvent(this->pcanHandle)) {
+		CAN_Uninitialize(this->pcanHandle);
+		this->pcanHandle = this->invalidPcanHandle;
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", "Driver receive event is not usable");
 	} else {
 		Util::log(LogType::CmdResp, LogSt::Ok, CmdDef::connect, "on", this->pcanConfigStr);
 		emit eventOccured(CanEvent::Connected);
@@ -62,6 +66,7 @@ void PeakFdCan::disconnect(void)
 		return;
 	}
 	stopRxThread();
+	closeRxEvent();
 	CAN_Uninitialize(this->pcanHandle);
 	this->pcanHandle = this->invalidPcanHandle;
 	emit eventOccured(CanEvent::Disconnected);
@@ -69,28 +74,61 @@ void PeakFdCan::disconnect(void)
 
 void PeakFdCan::peakFdMsgToCanMsg(const TPCANMsgFD &peakMsgRef, TPCANTimestampFD timestamp, CanMsg &canMsgRef)
 {
+	// FD frames carry a DLC code, above 8 it no longer equals the length
+	static const uint8_t dlcToLength[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
 	uint32_t idMask = 0x7FF;
 
+	canMsgRef.flags = getCanMsgFlags(peakMsgRef.MSGTYPE);
 	if ((peakMsgRef.MSGTYPE & PCAN_MESSAGE_EXTENDED) == PCAN_MESSAGE_EXTENDED) {
 		idMask = 0x1FFFFFFF;
 	}
 
 	canMsgRef.id = peakMsgRef.ID & idMask;
-	canMsgRef.dataLength = peakMsgRef.DLC;
-	memcpy(canMsgRef.data, peakMsgRef.DATA, peakMsgRef.DLC);
-	canMsgRef.timestamp = timestamp;
+	canMsgRef.dataLength = dlcToLength[peakMsgRef.DLC & 0x0F];
+	memcpy(canMsgRef.data, peakMsgRef.DATA, canMsgRef.dataLength);
+	canMsgRef.timestamp = this->rxTimestamp.toUs(timestamp);
+	canMsgRef.channel = 0;
 }
 
 void PeakFdCan::rx()
 {
-	TPCANStatus peakResult;
+	TPCANStatus peakResult = PCAN_ERROR_OK;
 	TPCANMsgFD peakCanMsg;
 	TPCANTimestampFD peakTimestamp;
+	size_t numOfMsg = 0;
 
-	peakResult = CAN_ReadFD(this->pcanHandle, &peakCanMsg, &peakTimestamp);
-	if (peakResult == PCAN_ERROR_OK) {
-		peakFdMsgToCanMsg(peakCanMsg, peakTimestamp, this->canMsg);
-		this->rxQueue.enqueue(this->canMsg);
-		emit eventOccured(CanEvent::MessageReceived);
+	// drain driver queue so a whole burst costs one handoff, reads are bounded as well
+	// so a run of status results can't hold back frames already collected
+	for(size_t numOfReads = 0; numOfReads < rxBurstSize; ++numOfReads) {
+		peakResult = CAN_ReadFD(this->pcanHandle, &peakCanMsg, &peakTimestamp);
+		this->rxStats.driverOverruns.add(getOverruns(peakResult, peakCanMsg.MSGTYPE, peakCanMsg.DATA));
+		if(peakResult == PCAN_ERROR_QRCVEMPTY || isRxReadFailed(peakResult)) {
+			break;
+		}
+		// bus status or queue overrun, frames behind it are still queued
+		if(peakResult != PCAN_ERROR_OK) {
+			continue;
+		}
+		// status and error frames are not traffic
+		if((peakCanMsg.MSGTYPE & (PCAN_MESSAGE_STATUS | PCAN_MESSAGE_ERRFRAME)) != 0) {
+			continue;
+		}
+		peakFdMsgToCanMsg(peakCanMsg, peakTimestamp, this->rxBurstArr[numOfMsg]);
+		++numOfMsg;
 	}
+
+	if(numOfMsg != 0) {
+		pushRx(this->rxBurstArr, numOfMsg);
+		notifyRx();
+	}
+
+	if(peakResult == PCAN_ERROR_QRCVEMPTY || isRxReadFailed(peakResult)) {
+		// nothing left to read, sleep until driver signals
+		waitRxEvent(getRxWaitUs());
+	}
+}
+
+void PeakFdCan::wakeRx(void)
+{
+	wakeRxEvent();
 }
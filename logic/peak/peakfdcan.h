@@ -20,6 +20,7 @@ signals:
 private:
 	const ConfigFd *configFdPtr;
 	void rx(void) override;
+	void wakeRx(void) override;
 	TPCANHandle pcanHandle;
 	QString pcanConfigStr;
 	char pcanConfigCStr[10000];
@@ -49,6 +49,10 @@ void PeakStdCan::connect(const void *configPtr)
 
 	if (stsResult != PCAN_ERROR_OK) {
 		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", getStatusStr(stsResult));
+	} else if(!openRxEvent(this->pcanHandle)) {
+		CAN_Uninitialize(this->pcanHandle);
+		this->pcanHandle = this->invalidPcanHandle;
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", "Driver receive event is not usable");
 	} else {
 		Util::log(LogType::CmdResp, LogSt::Ok, CmdDef::connect, "on", QString("%1 %2").arg(dev).arg(baudrate));
 		emit eventOccured(CanEvent::Connected);
@@ -63,6 +67,7 @@ void PeakStdCan::disconnect(void)
 		return;
 	}
 	stopRxThread();
+	closeRxEvent();
 	CAN_Uninitialize(this->pcanHandle);
 	this->pcanHandle = this->invalidPcanHandle;
 	emit eventOccured(CanEvent::Disconnected);
@@ -72,20 +77,51 @@ void PeakStdCan::rx()
 {
 	TPCANMsg peakCanMsg;
 	TPCANTimestamp peakTimestamp;
-	TPCANStatus peakResult;
+	TPCANStatus peakResult = PCAN_ERROR_OK;
+	size_t numOfMsg = 0;
+
+	// drain driver queue so a whole burst costs one handoff, reads are bounded as well
+	// so a run of status results can't hold back frames already collected
+	for(size_t numOfReads = 0; numOfReads < rxBurstSize; ++numOfReads) {
+		peakResult = CAN_Read(this->pcanHandle, &peakCanMsg, &peakTimestamp);
+		this->rxStats.driverOverruns.add(getOverruns(peakResult, peakCanMsg.MSGTYPE, peakCanMsg.DATA));
+		if(peakResult == PCAN_ERROR_QRCVEMPTY || isRxReadFailed(peakResult)) {
+			break;
+		}
+		// bus status or queue overrun, frames behind it are still queued
+		if(peakResult != PCAN_ERROR_OK) {
+			continue;
+		}
+		// status and error frames are not traffic
+		if((peakCanMsg.MSGTYPE & (PCAN_MESSAGE_STATUS | PCAN_MESSAGE_ERRFRAME)) != 0) {
+			continue;
+		}
+		peakStdMsgToCanMsg(peakCanMsg, peakTimestamp, this->rxBurstArr[numOfMsg]);
+		++numOfMsg;
+	}
+
+	if(numOfMsg != 0) {
+		pushRx(this->rxBurstArr, numOfMsg);
+		notifyRx();
+	}
 
-	peakResult = CAN_Read(this->pcanHandle, &peakCanMsg, &peakTimestamp);
-	if(peakResult == PCAN_ERROR_OK) {
-		peakStdMsgToCanMsg(peakCanMsg, peakTimestamp, this->canMsg);
-		this->rxQueue.enqueue(this->canMsg);
-		emit eventOccured(CanEvent::MessageReceived);
+	if(peakResult == PCAN_ERROR_QRCVEMPTY || isRxReadFailed(peakResult)) {
+		// nothing left to read, sleep until driver signals
+		waitRxEvent(getRxWaitUs());
 	}
 }
 
+void PeakStdCan::wakeRx(void)
+{
+	wakeRxEvent();
+}
+
 void PeakStdCan::peakStdMsgToCanMsg(const TPCANMsg &peakMsgRef, TPCANTimestamp peakTimestamp, CanMsg &canMsgRef)
 {
 	uint32_t idMask = 0x7FF;
 
+	canMsgRef.flags = getCanMsgFlags(peakMsgRef.MSGTYPE);
+	canMsgRef.channel = 0;
 	if ((peakMsgRef.MSGTYPE & PCAN_MESSAGE_EXTENDED) == PCAN_MESSAGE_EXTENDED) {
 		idMask = 0x1FFFFFFF;
 	}
@@ -93,7 +129,12 @@ void PeakStdCan::peakStdMsgToCanMsg(const TPCANMsg &peakMsgRef, TPCANTimestamp p
 	canMsgRef.id = peakMsgRef.ID & idMask;
 	canMsgRef.dataLength = peakMsgRef.LEN;
 	memcpy(canMsgRef.data, peakMsgRef.DATA, peakMsgRef.LEN);
-	canMsgRef.timestamp = peakTimestamp.millis;
+	// micros + 1000 * millis + 0x100000000 * 1000 * millis_overflow, as in PCANBasic docs
+	canMsgRef.timestamp = this->rxTimestamp.toUs(
+		(uint64_t)peakTimestamp.micros +
+		1000ULL * peakTimestamp.millis +
+		0x100000000ULL * 1000ULL * peakTimestamp.millis_overflow
+	);
 }
 
 TPCANBaudrate PeakStdCan::getPcanBaud(uint64_t baudrate)
@@ -21,6 +21,7 @@ private:
 	const TPCANBaudrate invalidPcanBaud = 0;
 	ConfigStd *configStdPtr;
 	void rx(void) override;
+	void wakeRx(void) override;
 	TPCANHandle pcanHandle;
 	TPCANBaudrate getPcanBaud(uint64_t baudrate);
 	void peakStdMsgToCanMsg(const TPCANMsg &peakMsgRef, TPCANTimestamp peakTimestamp, CanMsg &canMsgRef);
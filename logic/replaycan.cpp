@@ -1,22 +1,47 @@
+#include <QFileInfo>
+#include <algorithm>
 #include "replaycan.h"
 #include "util.h"
-#include "cobs.h"
 
 ReplayCan::ReplayCan(QObject *parent)
 	: Can(parent)
 	, configReplayPtr(nullptr)
+	, captureStream()
 	, filePath("")
+	, paceTimer()
+	, paceFirstUs(0)
+	, isPaceStarted(false)
+	, firstUs(0)
+	, windowStartUs(0)
+	, windowStartFrame(0)
+	, endUs(UINT64_MAX)
+	, endFrame(UINT64_MAX)
+	, idAllowVec()
+	, idDenyVec()
+	, transportMutex()
+	, transportCond()
+	, isTransportPending(false)
+	, isLoop(false)
+	, isPaused(false)
+	, stepRequest(ReplayStep::None)
+	, stepReqCanId(0)
+	, stepRespCanId(0)
+	, seekRequestMs(-1)
+	, step(ReplayStep::None)
+	, stepDecoder()
+	, stepPacketBfr()
+	, isFrameHeld(false)
+	, isJump(false)
+	, shiftUs(0)
+	, lastShiftedUs(0)
 {
 
 }
 
 ReplayCan::~ReplayCan()
 {
-	if (this->filePtr != nullptr) {
-		this->filePtr->close();
-		delete filePtr;
-		this->filePtr = nullptr;
-	}
+	stopRxThread();
+	this->captureStream.close();
 }
 
 void ReplayCan::connect(const void *configPtr)
@@ -33,8 +58,7 @@ void ReplayCan::connect(const void *configPtr)
 		return;
 	}
 	this->filePath = this->configReplayPtr->getDev();
-	this->filePtr = new QFile(this->filePath);
-	if (!filePtr->exists()) {
+	if (!QFileInfo::exists(this->filePath)) {
 		Util::log(
 			LogType::CmdRespThrow,
 			LogSt::Nok,
@@ -45,20 +69,23 @@ void ReplayCan::connect(const void *configPtr)
 		return;
 	}
 
-	if (!filePtr->open(QIODevice::ReadOnly)) {
+	// a replay that ended itself may still be closing the stream
+	waitRxThreadExit();
+	// maps the file window by window, memory stays bounded however large the file is,
+	// a manifest is replayed segment after segment, text logs of other tools are read in chunks
+	if (!this->captureStream.open(this->filePath)) {
 		Util::log(
 			LogType::CmdRespThrow,
 			LogSt::Nok,
 			CmdDef::connect,
 			"on",
-			"Replay file open failed"
+			"Replay file open failed: " + this->captureStream.errorString()
 		);
 		return;
-	} 
-	
-	this->fileSize = this->filePtr->size();
+	}
 
-	if(this->fileSize == 0) {
+	if(QFileInfo(this->filePath).size() == 0) {
+		this->captureStream.close();
 		Util::log(
 			LogType::CmdRespThrow,
 			LogSt::Nok,
@@ -69,6 +96,15 @@ void ReplayCan::connect(const void *configPtr)
 		return;
 	}
 	
+	{
+		QMutexLocker locker(&this->transportMutex);
+		this->isPaused = false;
+		this->stepRequest = ReplayStep::None;
+		this->seekRequestMs = -1;
+		this->isTransportPending.store(false);
+	}
+	this->isLoop.store(this->configReplayPtr->getLoop() == "on");
+
 	Util::log(
 		LogType::CmdResp,
 		LogSt::Ok,
@@ -93,81 +129,370 @@ void ReplayCan::disconnect(void)
 		return;
 	}
 	stopRxThread();
-	this->filePtr->close();
-	delete filePtr;
-	this->filePtr = nullptr;
-	this->fileSize = 0;
+	this->captureStream.close();
 	this->filePath = "";
 	emit eventOccured(CanEvent::Disconnected);
 }
 
-void ReplayCan::rx(void)
+bool ReplayCan::seekWindow(void)
 {
-	if (this->filePtr == nullptr) {
-		Util::log(
-			LogType::CmdRespThrow,
-			LogSt::Nok,
-			CmdDef::connect,
-			"on",
-			"Replay file pointer is null"
-		);
-		return;
+	const uint64_t startMs = this->configReplayPtr->getStartMs().toULongLong();
+	const uint64_t startFrame = this->configReplayPtr->getStartFrame().toULongLong();
+	const uint64_t endMs = this->configReplayPtr->getEndMs().toULongLong();
+	const uint64_t endFrame = this->configReplayPtr->getEndFrame().toULongLong();
+	bool isFound = false;
+
+	this->endUs = UINT64_MAX;
+	this->endFrame = UINT64_MAX;
+	// seeks count from it as well
+	this->firstUs = this->captureStream.getFirstTimestamp();
+	// startMs wins as it does for endMs, seeks do not go before either
+	this->windowStartUs = startMs != 0 ? this->firstUs + startMs * 1000 : 0;
+	this->windowStartFrame = startMs == 0 ? startFrame : 0;
+	if(endMs != 0) {
+		this->endUs = this->firstUs + endMs * 1000;
+	} else if(endFrame != 0) {
+		this->endFrame = endFrame;
+	}
+	if((endMs != 0 && endMs <= startMs) || (endMs == 0 && endFrame != 0 && startMs == 0 && endFrame <= startFrame)) {
+		Util::log(LogType::Generic, LogSt::Warn, "Replay window ends before it starts: " + this->filePath);
 	}
 
-	QVector<uint8_t> canFrame;
-	canFrame.clear();
-	uint8_t rawData[sizeof(CanMsg)];
-	size_t rawDataSize = sizeof(CanMsg);
-	char byte;
+	if(startMs == 0 && startFrame == 0) {
+		return true;
+	}
+	// segment indexes take it to the right block, the rest is a walk through one block
+	if(startMs != 0) {
+		isFound = this->captureStream.seekTimestamp(this->firstUs + startMs * 1000);
+	} else {
+		isFound = this->captureStream.seekFrame(startFrame);
+	}
+	if(!isFound && !this->captureStream.errorString().isEmpty()) {
+		Util::log(LogType::Generic, LogSt::Nok, "Replay start cannot be found: " + this->captureStream.errorString());
+		return false;
+	}
+	if(!isFound) {
+		Util::log(LogType::Generic, LogSt::Warn, "Replay start is past the end of capture: " + this->filePath);
+		return true;
+	}
+	Util::log(LogType::Generic, LogSt::Ok, "Replay starts at requested position: " + this->filePath);
+	return true;
+}
 
-	std::unique_ptr<uint8_t[]> buffer = std::make_unique<uint8_t[]>(this->fileSize);
-	if (buffer == nullptr) {
-		Util::log(
-			LogType::CmdRespThrow,
-			LogSt::Nok,
-			CmdDef::connect,
-			"on",
-			"Buffer allocation failed"
-		);
+bool ReplayCan::isIdReplayed(uint32_t id) const
+{
+	if(!this->idAllowVec.isEmpty() && !std::binary_search(this->idAllowVec.cbegin(), this->idAllowVec.cend(), id)) {
+		return false;
+	}
+	return this->idDenyVec.isEmpty() || !std::binary_search(this->idDenyVec.cbegin(), this->idDenyVec.cend(), id);
+}
+
+QVector<uint32_t> ReplayCan::parseIdList(const QString &idListRef)
+{
+	QVector<uint32_t> idVec;
+
+	for(const QString &idRef : idListRef.split(',', Qt::SkipEmptyParts)) {
+		idVec.append(idRef.trimmed().toUInt(nullptr, 16));
+	}
+	std::sort(idVec.begin(), idVec.end());
+	idVec.erase(std::unique(idVec.begin(), idVec.end()), idVec.end());
+	return idVec;
+}
+
+int ReplayCan::getSpeedPct(void) const
+{
+	const int speedPct = this->configReplayPtr->getSpeedPct().toInt();
+
+	if(speedPct == 0) {
+		return 0;
+	}
+	return qBound(minSpeedPct, speedPct, maxSpeedPct);
+}
+
+void ReplayCan::pause(void)
+{
+	QMutexLocker locker(&this->transportMutex);
+
+	this->isPaused = true;
+	this->isTransportPending.store(true);
+	this->transportCond.wakeAll();
+}
+
+void ReplayCan::resume(void)
+{
+	QMutexLocker locker(&this->transportMutex);
+
+	this->isPaused = false;
+	this->isTransportPending.store(true);
+	this->transportCond.wakeAll();
+}
+
+void ReplayCan::stepFrame(void)
+{
+	QMutexLocker locker(&this->transportMutex);
+
+	this->isPaused = true;
+	this->stepRequest = ReplayStep::Frame;
+	this->isTransportPending.store(true);
+	this->transportCond.wakeAll();
+}
+
+void ReplayCan::stepPacket(uint32_t reqCanId, uint32_t respCanId)
+{
+	QMutexLocker locker(&this->transportMutex);
+
+	this->isPaused = true;
+	this->stepRequest = ReplayStep::Packet;
+	this->stepReqCanId = reqCanId;
+	this->stepRespCanId = respCanId;
+	this->isTransportPending.store(true);
+	this->transportCond.wakeAll();
+}
+
+void ReplayCan::seek(uint64_t seekMs)
+{
+	QMutexLocker locker(&this->transportMutex);
+
+	this->seekRequestMs = static_cast<int64_t>(seekMs);
+	this->isTransportPending.store(true);
+	this->transportCond.wakeAll();
+}
+
+void ReplayCan::setLoop(bool isLoop)
+{
+	this->isLoop.store(isLoop);
+}
+
+/// Paused rx thread waits on transportCond, a disconnect has to wake it.
+void ReplayCan::wakeRx(void)
+{
+	QMutexLocker locker(&this->transportMutex);
+
+	this->transportCond.wakeAll();
+}
+
+/// Requests are taken in order seek, step, pause: a seek while paused moves the position and
+/// stays paused, a step sends its frames before replay pauses again. A seek may build the capture
+/// index, it runs without the lock, requests do not wait for it.
+bool ReplayCan::handleTransport(void)
+{
+	int64_t seekMs = -1;
+	bool isNewStep = false;
+	uint32_t reqCanId = 0;
+	uint32_t respCanId = 0;
+
+	{
+		QMutexLocker locker(&this->transportMutex);
+		this->isTransportPending.store(false);
+		seekMs = this->seekRequestMs;
+		this->seekRequestMs = -1;
+		if(this->stepRequest != ReplayStep::None) {
+			this->step = this->stepRequest;
+			this->stepRequest = ReplayStep::None;
+			isNewStep = true;
+			reqCanId = this->stepReqCanId;
+			respCanId = this->stepRespCanId;
+		}
+	}
+	if(seekMs >= 0) {
+		this->isFrameHeld = false;
+		this->isJump = true;
+		const uint64_t seekUs = this->firstUs + static_cast<uint64_t>(seekMs) * 1000;
+		bool isAtWindowStart = seekUs < this->windowStartUs;
+		bool isFound = this->captureStream.seekTimestamp(qMax(seekUs, this->windowStartUs));
+		if(isFound && this->captureStream.getFrame() < this->windowStartFrame) {
+			isAtWindowStart = true;
+			isFound = this->captureStream.seekFrame(this->windowStartFrame);
+		}
+		if(isFound && isAtWindowStart) {
+			Util::log(LogType::Generic, LogSt::Ok, QString("Replay at window start, seek was to %1 ms").arg(seekMs));
+		} else if(isFound) {
+			Util::log(LogType::Generic, LogSt::Ok, QString("Replay at %1 ms").arg(seekMs));
+		} else if(!this->captureStream.errorString().isEmpty()) {
+			Util::log(LogType::Generic, LogSt::Nok, QString("Replay seek %1 ms failed: %2").arg(seekMs).arg(this->captureStream.errorString()));
+		} else {
+			Util::log(LogType::Generic, LogSt::Warn, QString("Replay seek %1 ms is past the end of capture").arg(seekMs));
+		}
+	}
+	if(isNewStep && this->step == ReplayStep::Packet) {
+		this->stepDecoder.start(reqCanId, respCanId, false);
+	}
+	if(this->step == ReplayStep::None) {
+		QMutexLocker locker(&this->transportMutex);
+		while(this->isPaused && this->isRxRunning.load() && !this->isTransportPending.load()) {
+			this->transportCond.wait(&this->transportMutex);
+		}
+	}
+	// frames waited for before are sent as soon as replay goes on
+	this->isPaceStarted = false;
+	return this->isRxRunning.load();
+}
+
+/// Sleeps in steps short enough to notice a stop, spins through the last spinNs.
+bool ReplayCan::waitUntil(qint64 deadlineNs)
+{
+	qint64 remainingNs = 0;
+
+	while((remainingNs = deadlineNs - this->paceTimer.nsecsElapsed()) > 0) {
+		if(!this->isRxRunning.load() || this->isTransportPending.load()) {
+			return false;
+		}
+		if(remainingNs > spinNs) {
+			QThread::usleep(qMin(remainingNs - spinNs, maxSleepNs) / 1000);
+		} else {
+			QThread::yieldCurrentThread();
+		}
+	}
+	return true;
+}
+
+void ReplayCan::flushBurst(size_t &numOfMsgRef)
+{
+	if(numOfMsgRef == 0) {
 		return;
 	}
+	pushRx(this->rxBurstArr, numOfMsgRef);
+	notifyRx();
+	numOfMsgRef = 0;
+}
 
-	// Read the file into the buffer
-	size_t bytesRead = this->filePtr->read((char *)buffer.get(), this->fileSize);
-	if (bytesRead != this->fileSize) {
+void ReplayCan::rx(void)
+{
+	const int speedPct = getSpeedPct();
+	QElapsedTimer runTimer;
+	uint64_t numOfFrames = 0;
+	uint64_t numOfPassFrames = 0;
+	uint64_t numOfLoops = 0;
+	uint64_t numOfLeftOut = 0;
+	size_t numOfMsg = 0;
+
+	if (!this->captureStream.isOpen()) {
 		Util::log(
 			LogType::CmdRespThrow,
 			LogSt::Nok,
 			CmdDef::connect,
 			"on",
-			"File read failed"
+			"Replay file is not open"
 		);
 		return;
 	}
 
-	for(uint64_t i = 0; i < this->fileSize; ++i) {
-		byte = buffer[i];
-		if (byte == 0) {
-			// COBS decode
-			cobs_decode_result result = cobs_decode(
-				rawData,
-				rawDataSize,
-				canFrame.data(),
-				canFrame.size()
-			);
-			getCanMsgFromRaw(
-				rawData,
-				result.out_len,
-				this->canMsg
-			);
-			this->rxQueue.enqueue(this->canMsg);
-			emit eventOccured(CanEvent::MessageReceived);
-			canFrame.clear();
-			QThread::msleep(1);
-		} else {
-			canFrame.append((uint8_t)byte);
+	if(this->captureStream.getTextFormat() != CaptureTextFormat::Unknown) {
+		Util::log(LogType::Generic, LogSt::Ok, "Replaying " + CaptureText::getFormatName(this->captureStream.getTextFormat()) + " log: " + this->filePath);
+	} else if(this->captureStream.getVersion() == CaptureVersion::Invalid) {
+		Util::log(LogType::Generic, LogSt::Nok, "Unsupported replay file version: " + this->filePath);
+	}
+	this->idAllowVec = parseIdList(this->configReplayPtr->getIdAllow());
+	this->idDenyVec = parseIdList(this->configReplayPtr->getIdDeny());
+	this->step = ReplayStep::None;
+	this->isPaceStarted = false;
+	this->isFrameHeld = false;
+	this->isJump = false;
+	this->shiftUs = 0;
+	this->lastShiftedUs = 0;
+	const bool isWindowFound = seekWindow();
+	runTimer.start();
+	while(isWindowFound && this->isRxRunning.load()) {
+		if(this->isTransportPending.load()) {
+			flushBurst(numOfMsg);
+			if(!handleTransport()) {
+				break;
+			}
+			continue;
+		}
+		if(this->isFrameHeld) {
+			this->isFrameHeld = false;
+		} else if(!this->captureStream.next(this->canMsg) ||
+			// checked on recorded values, before a frame is waited for
+			this->canMsg.timestamp >= this->endUs || this->captureStream.getFrame() > this->endFrame) {
+			flushBurst(numOfMsg);
+			// a window without a frame to replay would loop in place
+			if(!this->isLoop.load() || numOfPassFrames == 0) {
+				break;
+			}
+			this->captureStream.rewind();
+			if(!seekWindow()) {
+				break;
+			}
+			this->isJump = true;
+			this->isPaceStarted = false;
+			numOfPassFrames = 0;
+			++numOfLoops;
+			continue;
+		}
+		if(!isIdReplayed(this->canMsg.id)) {
+			++numOfLeftOut;
+			continue;
 		}
+		// steps are sent at once
+		if(this->step == ReplayStep::None) {
+			if(!this->isPaceStarted) {
+				this->paceFirstUs = this->canMsg.timestamp;
+				this->isPaceStarted = true;
+				this->paceTimer.start();
+			} else if(speedPct != 0 && this->canMsg.timestamp > this->paceFirstUs) {
+				// offset from first frame, not from previous one, a late frame does not delay the rest
+				const qint64 deadlineNs = (this->canMsg.timestamp - this->paceFirstUs) * 100000 / speedPct;
+				if(deadlineNs > this->paceTimer.nsecsElapsed()) {
+					flushBurst(numOfMsg);
+					if(!waitUntil(deadlineNs)) {
+						this->isFrameHeld = true;
+						continue;
+					}
+				}
+			}
+		}
+		// first frame after a jump goes on from the last one sent, with none sent yet it keeps its own
+		if(this->isJump) {
+			if(numOfFrames != 0) {
+				this->shiftUs = this->lastShiftedUs - this->canMsg.timestamp;
+			}
+			this->isJump = false;
+		}
+		this->lastShiftedUs = this->canMsg.timestamp + this->shiftUs;
+		this->canMsg.timestamp = this->rxTimestamp.toUs(this->lastShiftedUs);
+		this->rxBurstArr[numOfMsg++] = this->canMsg;
+		++numOfFrames;
+		++numOfPassFrames;
+		if(numOfMsg == rxBurstSize) {
+			flushBurst(numOfMsg);
+		}
+		if(this->step == ReplayStep::Frame ||
+			(this->step == ReplayStep::Packet && this->stepDecoder.decode(this->canMsg, this->stepPacketBfr))) {
+			flushBurst(numOfMsg);
+			this->step = ReplayStep::None;
+			// paused again
+			this->isTransportPending.store(true);
+		}
+	}
+	flushBurst(numOfMsg);
+	if(numOfFrames != 0) {
+		Util::log(
+			LogType::Generic,
+			LogSt::Ok,
+			QString("Replayed %1 frames in %2 s at %3")
+				.arg(numOfFrames)
+				.arg(runTimer.elapsed() / 1000.0, 0, 'f', 3)
+				.arg(speedPct == 0 ? QString("full speed") : QString("%1%").arg(speedPct))
+		);
+	}
+	if(numOfLoops != 0) {
+		Util::log(LogType::Generic, LogSt::Ok, QString("Replay looped %1 times").arg(numOfLoops));
+	}
+	if(numOfLeftOut != 0) {
+		Util::log(LogType::Generic, LogSt::Ok, QString("Replay left out %1 frames by id").arg(numOfLeftOut));
+	}
+	if(this->captureStream.getNumOfBadRecords() != 0) {
+		Util::log(
+			LogType::Generic,
+			LogSt::Warn,
+			QString("Replay skipped %1 damaged records").arg(this->captureStream.getNumOfBadRecords())
+		);
 	}
 
-	disconnect();
+	drainRxSpill();
+	// stopped from outside, disconnect already runs
+	if(this->isRxRunning.load()) {
+		disconnect();
+	}
 }
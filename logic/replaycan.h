@@ -1,10 +1,44 @@
+/**
+ * @defgroup replaycan_h
+ * @{
+ * @file replaycan.h
+ * @brief Replays a capture as if it was received from a bus.
+ * Frames are paced by their recorded timestamps: every frame has an absolute deadline on a
+ * monotonic clock, its offset from the first replayed frame divided by speed. A late frame
+ * does not shift the ones after it, so pacing errors do not add up over a long capture.
+ * Frames that are due go to the rx queue together, a burst is not split into single pushes.
+ *
+ * Replay may be limited to a window of the capture and to some ids. The window start is looked up
+ * through the capture index, frames before it are not read at all. Frames of ids left out are
+ * dropped right after reading, they are not paced, queued or decoded.
+ *
+ * While connected, replay is driven like a player: pause, resume, seek, step and loop. Requests
+ * come from the command thread, the rx thread picks them up between frames, one atomic flag is all
+ * a frame costs while none is pending. Seeks go through the capture index like the window start.
+ * Pacing starts over after every request, timestamps handed on keep going forward across seeks and
+ * loops, decoder and traces do not see time go back.
+ */
 #ifndef REPLAYCAN_H
 #define REPLAYCAN_H
 
-#include <QFile>
 #include <QObject>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
 #include "can.h"
+#include "capturestream.h"
 #include "config.h"
+#include "packetdecoder.h"
+
+/// @brief What replay sends before it pauses again.
+enum class ReplayStep
+{
+	None,
+	Frame,  //!< next replayed frame
+	Packet  //!< frames up to the end of the next UDS packet that starts
+};
 
 class ReplayCan : public Can
 {
@@ -15,14 +49,75 @@ public:
 
 	void connect(const void *configPtr) override;
 	void disconnect(void) override;
+	void pause(void);
+	void resume(void);
+	/// @brief Pauses, then sends one frame.
+	void stepFrame(void);
+	/// @brief Pauses, then sends frames until a UDS packet between these ids is complete.
+	void stepPacket(uint32_t reqCanId, uint32_t respCanId);
+	/// @brief Goes on from the first frame seekMs milliseconds after first frame of the capture,
+	/// a seek before the window start goes to the window start.
+	void seek(uint64_t seekMs);
+	/// @brief Starts over from the window start at the end of the window.
+	void setLoop(bool isLoop);
 signals:
 
 private:
 	const ConfigReplay *configReplayPtr;
 	void rx(void) override;
-	QFile *filePtr;
+	void wakeRx(void) override;
+	/// @brief Moves to startMs or startFrame through the capture index, sets endUs and endFrame.
+	/// False when a segment on the way cannot be read.
+	bool seekWindow(void);
+	bool isIdReplayed(uint32_t id) const;
+	/// @brief Sorted ids of a comma separated hex list.
+	static QVector<uint32_t> parseIdList(const QString &idListRef);
+	/// @brief Speed from config, clamped to minSpeedPct..maxSpeedPct, 0 stays 0.
+	int getSpeedPct(void) const;
+	/// @brief False when replay was stopped or a request came in while waiting.
+	bool waitUntil(qint64 deadlineNs);
+	void flushBurst(size_t &numOfMsgRef);
+	/// @brief Carries out pending requests, waits while paused. False when replay was stopped.
+	bool handleTransport(void);
+	CaptureStream captureStream; //!< single capture or manifest of rotated segments
 	QString filePath;
-	uint64_t fileSize;
+	QElapsedTimer paceTimer;     //!< started with first frame paced from
+	uint64_t paceFirstUs;        //!< recorded timestamp of that frame
+	bool isPaceStarted;
+	uint64_t firstUs;            //!< of the capture, seeks count from it
+	uint64_t windowStartUs;      //!< recorded timestamp of window start, 0 for none
+	uint64_t windowStartFrame;   //!< frame number of window start, 0 for none
+	uint64_t endUs;              //!< recorded timestamp replay stops at, UINT64_MAX for none
+	uint64_t endFrame;           //!< frame number replay stops at, UINT64_MAX for none
+	QVector<uint32_t> idAllowVec;
+	QVector<uint32_t> idDenyVec;
+
+	QMutex transportMutex;       //!< guards requests below
+	QWaitCondition transportCond;
+	std::atomic<bool> isTransportPending;
+	std::atomic<bool> isLoop;
+	bool isPaused;
+	ReplayStep stepRequest;
+	uint32_t stepReqCanId;
+	uint32_t stepRespCanId;
+	int64_t seekRequestMs;       //!< -1 for none
+
+	ReplayStep step;             //!< rx thread only, step being sent
+	PacketDecoder stepDecoder;   //!< tells where a packet step ends
+	UdsPacket stepPacketBfr;
+	bool isFrameHeld;            //!< canMsg was read, a request came before it was sent
+	bool isJump;                 //!< next frame follows a seek or loop
+	uint64_t shiftUs;            //!< added to recorded timestamps
+	uint64_t lastShiftedUs;
+
+	static const int minSpeedPct = 10;
+	static const int maxSpeedPct = 10000;
+	/// @brief Sleeps overshoot by tens of microseconds, the last stretch before a deadline is spun.
+	static const qint64 spinNs = 200 * 1000;
+	/// @brief Longest single sleep, a stop is noticed within this.
+	static const qint64 maxSleepNs = 20 * 1000 * 1000;
 };
 
 #endif // REPLAYCAN_H
+
+/// @}
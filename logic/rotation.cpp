@@ -0,0 +1,93 @@
+#include <QFile>
+#include "rotation.h"
+
+Rotation::Rotation(void) :
+	maxBytes(0),
+	maxMs(0),
+	keep(0),
+	basePath(""),
+	segment(0),
+	segmentTimer()
+{
+}
+
+void Rotation::configure(uint64_t maxBytes, int maxMin, unsigned keep)
+{
+	this->maxBytes = maxBytes;
+	this->maxMs = maxMin > 0 ? maxMin * 60LL * 1000LL : 0;
+	this->keep = keep;
+}
+
+bool Rotation::isEnabled(void) const
+{
+	return this->maxBytes != 0 || this->maxMs != 0;
+}
+
+void Rotation::start(const QString &basePathRef)
+{
+	this->basePath = basePathRef;
+	this->segment = 0;
+	this->segmentTimer.start();
+}
+
+bool Rotation::isDue(uint64_t segmentBytes) const
+{
+	if(this->maxBytes != 0 && segmentBytes >= this->maxBytes) {
+		return true;
+	}
+	return this->maxMs != 0 && this->segmentTimer.elapsed() >= this->maxMs;
+}
+
+void Rotation::next(void)
+{
+	++this->segment;
+	this->segmentTimer.start();
+}
+
+unsigned Rotation::getSegment(void) const
+{
+	return this->segment;
+}
+
+unsigned Rotation::getFirstKept(void) const
+{
+	if(this->keep == 0 || this->segment < this->keep) {
+		return 0;
+	}
+	return this->segment - this->keep + 1;
+}
+
+QString Rotation::getBasePath(void) const
+{
+	return this->basePath;
+}
+
+QString Rotation::getPath(const QString &extRef) const
+{
+	return getPath(extRef, this->segment);
+}
+
+QString Rotation::getPath(const QString &extRef, unsigned segment) const
+{
+	if(!isEnabled()) {
+		return this->basePath + extRef;
+	}
+	return QString("%1_%2%3").arg(this->basePath).arg(segment, 3, 10, QChar('0')).arg(extRef);
+}
+
+QStringList Rotation::removeExpired(const QStringList &extListRef) const
+{
+	QStringList removedList;
+
+	if(getFirstKept() == 0) {
+		return removedList;
+	}
+	const unsigned expired = getFirstKept() - 1;
+	for(const QString &extRef : extListRef) {
+		const QString path = getPath(extRef, expired);
+		if(QFile::remove(path)) {
+			removedList.append(path);
+		}
+	}
+	return removedList;
+}
@@ -0,0 +1,50 @@
+/**
+ * @defgroup rotation_h
+ * @{
+ * @file rotation.h
+ * @brief Splits a log into rolling segments by size and age, keeps only the last ones.
+ * Segment n of session base is named base_nnn.ext, with rotation off the single file is
+ * named base.ext like before. Each sink owns one and asks it when to start the next segment.
+ */
+#ifndef ROTATION_H
+#define ROTATION_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+
+class Rotation
+{
+public:
+	Rotation(void);
+
+	/// @brief 0 turns the respective limit off. keep 0 keeps every segment.
+	void configure(uint64_t maxBytes, int maxMin, unsigned keep);
+	bool isEnabled(void) const;
+	/// @brief Starts a session at segment 0, base is path without extension.
+	void start(const QString &basePathRef);
+	/// @brief Segment is due to be closed once it holds maxBytes or is maxMin old.
+	bool isDue(uint64_t segmentBytes) const;
+	/// @brief Moves on to next segment.
+	void next(void);
+	unsigned getSegment(void) const;
+	/// @brief Oldest segment still kept.
+	unsigned getFirstKept(void) const;
+	QString getBasePath(void) const;
+	QString getPath(const QString &extRef) const;
+	QString getPath(const QString &extRef, unsigned segment) const;
+	/// @brief Removes files of the segment that just fell out of keep, returns their names.
+	QStringList removeExpired(const QStringList &extListRef) const;
+private:
+	uint64_t maxBytes;
+	int64_t maxMs;
+	unsigned keep;
+	QString basePath;
+	unsigned segment;
+	QElapsedTimer segmentTimer;
+};
+
+#endif // ROTATION_H
+
+/// @}
@@ -0,0 +1,119 @@
+#include <QDir>
+#include "rxspill.h"
+#include "captureformat.h"
+#include "util.h"
+
+RxSpill::RxSpill(void) :
+	filePtr(nullptr),
+	readBfr(),
+	readBfrPos(0),
+	readFilePos(0),
+	numOfMsg(0)
+{
+}
+
+RxSpill::~RxSpill()
+{
+	clear();
+	delete this->filePtr;
+	this->filePtr = nullptr;
+}
+
+size_t RxSpill::write(const CanMsg *canMsgPtr, size_t numOfMsg)
+{
+	uint8_t record[CaptureFormat::maxRecordSize];
+	size_t numOfWritten = 0;
+
+	if(this->filePtr == nullptr) {
+		this->filePtr = new QTemporaryFile(QDir::tempPath() + "/udstracer_spill_XXXXXX");
+		if(!this->filePtr->open()) {
+			Util::log(LogType::Generic, LogSt::Nok, "Failed to open rx spill file: " + this->filePtr->errorString());
+			delete this->filePtr;
+			this->filePtr = nullptr;
+			return 0;
+		}
+	}
+
+	// reads move file position, writes always append
+	if(!this->filePtr->seek(this->filePtr->size())) {
+		return 0;
+	}
+	for(; numOfWritten < numOfMsg; ++numOfWritten) {
+		size_t recordSize = CaptureFormat::encodeFrame(canMsgPtr[numOfWritten], record);
+		if(this->filePtr->write(reinterpret_cast<const char *>(record), recordSize) != (qint64)recordSize) {
+			break;
+		}
+	}
+	this->numOfMsg += numOfWritten;
+	return numOfWritten;
+}
+
+/// Makes sure at least minSize unparsed bytes are in readBfr, if file has them.
+bool RxSpill::fillReadBfr(qint64 minSize)
+{
+	if(this->readBfr.size() - this->readBfrPos >= minSize) {
+		return true;
+	}
+	this->readBfr.remove(0, this->readBfrPos);
+	this->readBfrPos = 0;
+	// pending writes have to reach the file before reading them back
+	this->filePtr->flush();
+	if(!this->filePtr->seek(this->readFilePos)) {
+		return false;
+	}
+	QByteArray chunk = this->filePtr->read(readChunkSize);
+	this->readFilePos += chunk.size();
+	this->readBfr.append(chunk);
+	return this->readBfr.size() >= minSize;
+}
+
+size_t RxSpill::read(CanMsg *canMsgPtr, size_t maxNumOfMsg)
+{
+	// plain capture frame records, without COBS
+	size_t numOfRead = 0;
+
+	while(numOfRead < maxNumOfMsg && this->numOfMsg != 0) {
+		if(!fillReadBfr(CaptureFormat::frameHeaderSize)) {
+			break;
+		}
+		const uint8_t *recordPtr = reinterpret_cast<const uint8_t *>(this->readBfr.constData()) + this->readBfrPos;
+		const qint64 recordSize = CaptureFormat::getRecordSize(recordPtr);
+		if(!fillReadBfr(recordSize)) {
+			break;
+		}
+		recordPtr = reinterpret_cast<const uint8_t *>(this->readBfr.constData()) + this->readBfrPos;
+		CaptureFormat::decodeFrame(recordPtr, recordSize, canMsgPtr[numOfRead]);
+		this->readBfrPos += recordSize;
+		--this->numOfMsg;
+		++numOfRead;
+	}
+
+	if(this->numOfMsg == 0) {
+		clear();
+	}
+	return numOfRead;
+}
+
+size_t RxSpill::clear(void)
+{
+	size_t numOfDropped = this->numOfMsg;
+
+	this->numOfMsg = 0;
+	this->readBfr.clear();
+	this->readBfrPos = 0;
+	this->readFilePos = 0;
+	if(this->filePtr != nullptr) {
+		this->filePtr->resize(0);
+	}
+	return numOfDropped;
+}
+
+size_t RxSpill::size(void) const
+{
+	return this->numOfMsg;
+}
+
+bool RxSpill::isEmpty(void) const
+{
+	return this->numOfMsg == 0;
+}
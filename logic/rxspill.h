@@ -0,0 +1,44 @@
+/**
+ * @defgroup rxspill_h
+ * @{
+ * @file rxspill.h
+ * @brief On-disk overflow segment of the rx queue.
+ * With Spill policy, frames that do not fit in rx queue are appended to a temporary file and
+ * fed back into the queue, oldest first, as soon as the decoder makes room. Only the rx thread
+ * touches it, so there is no locking. File is truncated whenever it is fully re-ingested.
+ */
+#ifndef RXSPILL_H
+#define RXSPILL_H
+
+#include <QByteArray>
+#include <QTemporaryFile>
+#include <cstddef>
+#include "canmsg.h"
+
+class RxSpill
+{
+public:
+	RxSpill(void);
+	~RxSpill();
+
+	/// @brief Appends frames, returns number written. Temporary file is created on first use.
+	size_t write(const CanMsg *canMsgPtr, size_t numOfMsg);
+	/// @brief Removes oldest frames, returns number read.
+	size_t read(CanMsg *canMsgPtr, size_t maxNumOfMsg);
+	/// @brief Drops everything, returns number of frames dropped.
+	size_t clear(void);
+	size_t size(void) const;
+	bool isEmpty(void) const;
+private:
+	static const qint64 readChunkSize = 64 * 1024;
+	QTemporaryFile *filePtr;
+	QByteArray readBfr;
+	qint64 readBfrPos;   //!< parse position in readBfr
+	qint64 readFilePos;  //!< file offset right after readBfr
+	size_t numOfMsg;
+	bool fillReadBfr(qint64 minSize);
+};
+
+#endif // RXSPILL_H
+
+/// @}
@@ -0,0 +1,359 @@
+#include "socketcan.h"
+#include "util.h"
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#endif
+
+SocketCan::SocketCan(QObject *parent)
+	: Can(parent)
+	, configSocketPtr(nullptr)
+	, sockFd(invalidFd)
+	, wakeFd(invalidFd)
+	, rxqOvfl(0)
+	, rxErrno(0)
+	, tsSource(TsSource::Host)
+	, lastTimestampNs(0)
+{
+
+}
+
+SocketCan::~SocketCan()
+{
+	if(isConnected()) {
+		disconnect();
+	}
+	// rx thread that disconnected on a lost device may still be closing the fds
+	waitRxThreadExit();
+	closeFds();
+}
+
+void SocketCan::closeFds(void)
+{
+#ifdef Q_OS_LINUX
+	if(this->sockFd != invalidFd) {
+		::close(this->sockFd);
+		this->sockFd = invalidFd;
+	}
+	if(this->wakeFd != invalidFd) {
+		::close(this->wakeFd);
+		this->wakeFd = invalidFd;
+	}
+#endif
+}
+
+#ifdef Q_OS_LINUX
+
+void SocketCan::connect(const void *configPtr)
+{
+	struct ifreq ifr;
+	struct sockaddr_can addr;
+	int enable = 1;
+	QString dev;
+
+	this->configSocketPtr = (const ConfigSocket *)configPtr;
+	if(this->configSocketPtr == nullptr) {
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, "Socket can config pointer is null");
+	}
+
+	dev = this->configSocketPtr->getDev();
+	// fds of a connection that ended itself are closed before new ones are opened
+	waitRxThreadExit();
+	if(dev.isEmpty() || dev.toUtf8().size() >= IFNAMSIZ) {
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", QString("Invalid interface %1!").arg(dev));
+		return;
+	}
+
+	this->sockFd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+	if(this->sockFd < 0) {
+		this->sockFd = invalidFd;
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", QString("socket: %1").arg(strerror(errno)));
+		return;
+	}
+
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, dev.toUtf8().constData(), IFNAMSIZ - 1);
+	if(::ioctl(this->sockFd, SIOCGIFINDEX, &ifr) < 0) {
+		closeFds();
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", QString("Invalid interface %1!").arg(dev));
+		return;
+	}
+
+	// classic and FD frames on the same socket, kernel tells them apart by size
+	if(::setsockopt(this->sockFd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) < 0) {
+		Util::log(LogType::Generic, LogSt::Warn, dev + " has no FD support, classic frames only");
+	}
+
+	// one clock for the whole capture, hardware when interface stamps frames, kernel software otherwise
+	int tsFlags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	this->tsSource = TsSource::Software;
+	this->lastTimestampNs = 0;
+	if(enableHwTimestamp(dev)) {
+		tsFlags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+		this->tsSource = TsSource::Hardware;
+	}
+	if(::setsockopt(this->sockFd, SOL_SOCKET, SO_TIMESTAMPING, &tsFlags, sizeof(tsFlags)) < 0) {
+		this->tsSource = TsSource::Software;
+		if(::setsockopt(this->sockFd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0) {
+			this->tsSource = TsSource::Host;
+			Util::log(LogType::Generic, LogSt::Warn, dev + " kernel timestamps are not available");
+		}
+	}
+	if(this->tsSource == TsSource::Hardware) {
+		Util::log(LogType::Generic, LogSt::Ok, dev + " hardware timestamps");
+	}
+
+	// kernel reports frames it dropped because socket buffer was full
+	this->rxqOvfl = 0;
+	if(::setsockopt(this->sockFd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0) {
+		Util::log(LogType::Generic, LogSt::Warn, dev + " socket overruns can not be counted");
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifr.ifr_ifindex;
+	if(::bind(this->sockFd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		QString err = strerror(errno);
+		closeFds();
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", QString("bind %1: %2").arg(dev).arg(err));
+		return;
+	}
+
+	this->rxErrno = 0;
+	this->wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(this->wakeFd < 0) {
+		this->wakeFd = invalidFd;
+		closeFds();
+		Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", QString("eventfd: %1").arg(strerror(errno)));
+		return;
+	}
+
+	Util::log(LogType::CmdResp, LogSt::Ok, CmdDef::connect, "on", dev);
+	emit eventOccured(CanEvent::Connected);
+	startRxThread();
+}
+
+/// SIOCSHWTSTAMP needs CAP_NET_ADMIN, stamping turned on up front (hwstamp_ctl) is taken as is.
+/// CAN drivers only accept tx on with every rx frame stamped.
+bool SocketCan::enableHwTimestamp(const QString &devRef)
+{
+	struct ifreq ifr;
+	struct hwtstamp_config hwConfig;
+
+	memset(&ifr, 0, sizeof(ifr));
+	memset(&hwConfig, 0, sizeof(hwConfig));
+	strncpy(ifr.ifr_name, devRef.toUtf8().constData(), IFNAMSIZ - 1);
+	ifr.ifr_data = (char *)&hwConfig;
+	if(::ioctl(this->sockFd, SIOCGHWTSTAMP, &ifr) == 0 && hwConfig.rx_filter == HWTSTAMP_FILTER_ALL) {
+		return true;
+	}
+	memset(&hwConfig, 0, sizeof(hwConfig));
+	hwConfig.tx_type = HWTSTAMP_TX_ON;
+	hwConfig.rx_filter = HWTSTAMP_FILTER_ALL;
+	return ::ioctl(this->sockFd, SIOCSHWTSTAMP, &ifr) == 0 && hwConfig.rx_filter == HWTSTAMP_FILTER_ALL;
+}
+
+void SocketCan::disconnect(void)
+{
+	if(!isConnected()) {
+		Util::log(LogType::CmdResp, LogSt::Warn, CmdDef::connect, "off", "Not Connected to disconnect!");
+		return;
+	}
+	stopRxThread();
+	closeFds();
+	emit eventOccured(CanEvent::Disconnected);
+}
+
+void SocketCan::rx()
+{
+	// one control buffer per frame, big enough for SCM_TIMESTAMPING (3 timespecs) and SO_RXQ_OVFL
+	static const size_t ctrlSize = CMSG_SPACE(sizeof(struct timespec) * 3) + CMSG_SPACE(sizeof(uint32_t));
+	struct canfd_frame frameArr[rxBurstSize];
+	struct iovec iovArr[rxBurstSize];
+	struct mmsghdr msgArr[rxBurstSize];
+	alignas(struct cmsghdr) uint8_t ctrlArr[rxBurstSize][ctrlSize];
+	int numOfMsg = 0;
+	size_t numOfFrame = 0;
+
+	for(size_t i = 0; i < rxBurstSize; ++i) {
+		iovArr[i].iov_base = &frameArr[i];
+		iovArr[i].iov_len = sizeof(frameArr[i]);
+		memset(&msgArr[i].msg_hdr, 0, sizeof(msgArr[i].msg_hdr));
+		msgArr[i].msg_hdr.msg_iov = &iovArr[i];
+		msgArr[i].msg_hdr.msg_iovlen = 1;
+		msgArr[i].msg_hdr.msg_control = ctrlArr[i];
+		msgArr[i].msg_hdr.msg_controllen = ctrlSize;
+	}
+
+	// whole driver burst in one syscall
+	numOfMsg = ::recvmmsg(this->sockFd, msgArr, rxBurstSize, MSG_DONTWAIT, nullptr);
+	if(numOfMsg < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+		if(handleRxError(errno)) {
+			waitRxEvent(rxErrorWaitUs, false);
+		}
+		return;
+	}
+	if(numOfMsg <= 0) {
+		waitRxEvent(getRxWaitUs(), true);
+		return;
+	}
+	if(this->rxErrno != 0) {
+		Util::log(LogType::Generic, LogSt::Ok, "recvmmsg: reading again");
+		this->rxErrno = 0;
+	}
+
+	for(int i = 0; i < numOfMsg; ++i) {
+		const struct canfd_frame &frameRef = frameArr[i];
+		CanMsg &canMsgRef = this->rxBurstArr[numOfFrame];
+		uint64_t timestampNs = 0;
+
+		for(struct cmsghdr *cmsgPtr = CMSG_FIRSTHDR(&msgArr[i].msg_hdr);
+			cmsgPtr != nullptr;
+			cmsgPtr = CMSG_NXTHDR(&msgArr[i].msg_hdr, cmsgPtr)
+		) {
+			if(cmsgPtr->cmsg_level != SOL_SOCKET) {
+				continue;
+			}
+			if(cmsgPtr->cmsg_type == SO_TIMESTAMPING) {
+				struct timespec tsArr[3];
+				memcpy(tsArr, CMSG_DATA(cmsgPtr), sizeof(tsArr));
+				// [2] raw hardware, [0] software, only the one picked at connect
+				const struct timespec &tsRef = tsArr[this->tsSource == TsSource::Hardware ? 2 : 0];
+				timestampNs = (uint64_t)tsRef.tv_sec * 1000000000ULL + (uint64_t)tsRef.tv_nsec;
+			} else if(cmsgPtr->cmsg_type == SO_TIMESTAMPNS) {
+				struct timespec ts;
+				memcpy(&ts, CMSG_DATA(cmsgPtr), sizeof(ts));
+				timestampNs = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+			} else if(cmsgPtr->cmsg_type == SO_RXQ_OVFL) {
+				// running total since socket was opened
+				uint32_t rxqOvfl = 0;
+				memcpy(&rxqOvfl, CMSG_DATA(cmsgPtr), sizeof(rxqOvfl));
+				this->rxStats.driverOverruns.add((uint32_t)(rxqOvfl - this->rxqOvfl));
+				this->rxqOvfl = rxqOvfl;
+			}
+		}
+
+		if(msgArr[i].msg_len != CAN_MTU && msgArr[i].msg_len != CANFD_MTU) {
+			continue;
+		}
+		// error frames are not traffic
+		if(frameRef.can_id & CAN_ERR_FLAG) {
+			continue;
+		}
+
+		canMsgRef.flags = 0;
+		canMsgRef.channel = 0;
+		if(frameRef.can_id & CAN_EFF_FLAG) {
+			canMsgRef.id = frameRef.can_id & CAN_EFF_MASK;
+			canMsgRef.flags |= CanMsgFlagExtended;
+		} else {
+			canMsgRef.id = frameRef.can_id & CAN_SFF_MASK;
+		}
+		canMsgRef.dataLength = frameRef.len > CANFD_MAX_DLEN ? CANFD_MAX_DLEN : frameRef.len;
+		if(frameRef.can_id & CAN_RTR_FLAG) {
+			canMsgRef.dataLength = 0;
+			canMsgRef.flags |= CanMsgFlagRtr;
+		}
+		if(msgArr[i].msg_len == CANFD_MTU) {
+			canMsgRef.flags |= CanMsgFlagFd;
+			canMsgRef.flags |= (frameRef.flags & CANFD_BRS) ? CanMsgFlagBrs : 0;
+			canMsgRef.flags |= (frameRef.flags & CANFD_ESI) ? CanMsgFlagEsi : 0;
+		}
+		if(msgArr[i].msg_hdr.msg_flags & MSG_DONTROUTE) {
+			// local loopback of a frame sent from this host
+			canMsgRef.flags |= CanMsgFlagTx;
+		}
+		memcpy(canMsgRef.data, frameRef.data, canMsgRef.dataLength);
+		if(this->tsSource == TsSource::Host) {
+			// no kernel timestamps, host time is the best we have
+			canMsgRef.timestamp = this->rxTimestamp.toUs(TimestampNormalizer::getMonotonicUs());
+		} else {
+			// a frame without a stamp keeps the clock, it gets the one before it
+			if(timestampNs != 0) {
+				this->lastTimestampNs = timestampNs;
+			}
+			canMsgRef.timestamp = this->rxTimestamp.toUs(this->lastTimestampNs / 1000);
+		}
+		++numOfFrame;
+	}
+
+	if(numOfFrame != 0) {
+		pushRx(this->rxBurstArr, numOfFrame);
+		notifyRx();
+	}
+}
+
+void SocketCan::waitRxEvent(int64_t waitUs, bool isSockWaited)
+{
+	struct pollfd pollArr[2];
+	struct timespec timeout;
+
+	pollArr[0].fd = this->wakeFd;
+	pollArr[0].events = POLLIN;
+	pollArr[1].fd = this->sockFd;
+	pollArr[1].events = POLLIN;
+	timeout.tv_sec = waitUs / 1000000;
+	timeout.tv_nsec = (waitUs % 1000000) * 1000;
+	::ppoll(pollArr, isSockWaited ? 2 : 1, &timeout, nullptr);
+}
+
+/// Interface going down is reported on every read until it is up again, it is logged once.
+/// Errors that mean the interface or socket is gone end the capture.
+bool SocketCan::handleRxError(int error)
+{
+	if(error != this->rxErrno) {
+		Util::log(LogType::Generic, LogSt::Nok, QString("recvmmsg: %1").arg(strerror(error)));
+		this->rxErrno = error;
+	}
+	if(error != ENODEV && error != ENXIO && error != EBADF) {
+		return true;
+	}
+	drainRxSpill();
+	if(this->isRxRunning.load()) {
+		disconnect();
+	}
+	return false;
+}
+
+void SocketCan::wakeRx(void)
+{
+	uint64_t one = 1;
+
+	if(this->wakeFd != invalidFd) {
+		ssize_t ret = ::write(this->wakeFd, &one, sizeof(one));
+		(void)ret;
+	}
+}
+
+#else
+
+void SocketCan::connect(const void *configPtr)
+{
+	(void)configPtr;
+	Util::log(LogType::CmdRespThrow, LogSt::Nok, CmdDef::connect, "on", "SocketCAN is only available on Linux");
+}
+
+void SocketCan::disconnect(void)
+{
+	Util::log(LogType::CmdResp, LogSt::Warn, CmdDef::connect, "off", "Not Connected to disconnect!");
+}
+
+void SocketCan::rx()
+{
+}
+
+void SocketCan::wakeRx(void)
+{
+}
+
+#endif
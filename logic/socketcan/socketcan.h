@@ -0,0 +1,61 @@
+/**
+ * @defgroup socketcan_h
+ * @{
+ * @file socketcan.h
+ * @brief SocketCAN capture backend, Linux only.
+ * Reads classic and FD frames from any SocketCAN interface (can0, vcan0...) in batches with
+ * recvmmsg. Each frame carries kernel timestamp, hardware one when interface provides it.
+ * Clock is picked once at connect, a capture never mixes controller and host time.
+ * Bitrate is not set here, interface has to be configured up front with `ip link`.
+ */
+#ifndef SOCKETCAN_H
+#define SOCKETCAN_H
+
+#include <QObject>
+#include "can.h"
+#include "config.h"
+
+class SocketCan : public Can
+{
+	Q_OBJECT
+public:
+	explicit SocketCan(QObject *parent = nullptr);
+	~SocketCan() override;
+
+	void connect(const void *configPtr) override;
+	void disconnect(void) override;
+signals:
+
+private:
+	/// @brief Clock frame timestamps come from, picked at connect.
+	enum class TsSource
+	{
+		Hardware, //!< controller clock, SCM_TIMESTAMPING raw hardware stamp
+		Software, //!< kernel CLOCK_REALTIME at driver rx
+		Host      //!< no kernel stamps, host monotonic time when frame is read
+	};
+	static const int invalidFd = -1;
+	const ConfigSocket *configSocketPtr;
+	int sockFd;
+	int wakeFd;
+	uint32_t rxqOvfl; //!< last SO_RXQ_OVFL total
+	int rxErrno;      //!< of last failed read, logged once until a read succeeds
+	TsSource tsSource;
+	uint64_t lastTimestampNs; //!< from tsSource, stands in for a frame that came without one
+	/// @brief Back off after a read error, interface may come back up meanwhile.
+	static const int64_t rxErrorWaitUs = 100000;
+	void rx(void) override;
+	void wakeRx(void) override;
+	/// @brief Blocks until frames arrive, disconnect wakes it, or waitUs passes.
+	/// A socket with an error pending is not waited on, it would wake at once.
+	void waitRxEvent(int64_t waitUs, bool isSockWaited);
+	/// @brief False when read has to stop, backend disconnected itself then.
+	bool handleRxError(int error);
+	/// @brief True when interface stamps received frames, turns it on when allowed to.
+	bool enableHwTimestamp(const QString &devRef);
+	void closeFds(void);
+};
+
+#endif // SOCKETCAN_H
+
+/// @}
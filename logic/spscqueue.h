@@ -0,0 +1,168 @@
+/**
+ * @defgroup spscqueue_h
+ * @{
+ * @file spscqueue.h
+ * @brief Lock-free single producer, single consumer ring buffer.
+ * Capacity is fixed at construction and nothing is allocated afterwards.
+ * Producer and consumer indexes live on their own cache lines, so the rx thread
+ * and the drain loop do not keep stealing the same line from each other.
+ */
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class SpscQueue {
+public:
+	static constexpr size_t cacheLineSize = 64;
+
+	/// @brief Capacity is rounded up to the next power of two.
+	explicit SpscQueue(size_t capacity) :
+		head(0),
+		cachedTail(0),
+		tail(0),
+		cachedHead(0),
+		mask(roundUpPow2(capacity) - 1),
+		buffer(std::make_unique<T[]>(mask + 1))
+	{
+	}
+
+	SpscQueue(const SpscQueue &) = delete;
+	SpscQueue &operator=(const SpscQueue &) = delete;
+
+	/// @brief Producer side. Returns false when the queue is full.
+	bool push(const T &value) {
+		return pushN(&value, 1) == 1;
+	}
+
+	/// @brief Producer side. Pushes as many as fit, returns number pushed.
+	size_t pushN(const T *valuePtr, size_t count) {
+		const size_t t = this->tail.load(std::memory_order_relaxed);
+		size_t free = capacity() - (t - this->cachedHead);
+		if(free < count) {
+			this->cachedHead = this->head.load(std::memory_order_acquire);
+			free = capacity() - (t - this->cachedHead);
+		}
+		if(count > free) {
+			count = free;
+		}
+		for(size_t i = 0; i < count; ++i) {
+			this->buffer[(t + i) & this->mask] = valuePtr[i];
+		}
+		this->tail.store(t + count, std::memory_order_release);
+		return count;
+	}
+
+	/// @brief Consumer side. Returns false when the queue is empty.
+	bool tryPop(T &value) {
+		return tryPopN(&value, 1) == 1;
+	}
+
+	/// @brief Consumer side. Pops up to maxCount items, returns number popped.
+	size_t tryPopN(T *valuePtr, size_t maxCount) {
+		const size_t h = this->head.load(std::memory_order_relaxed);
+		size_t avail = this->cachedTail - h;
+		if(avail < maxCount) {
+			this->cachedTail = this->tail.load(std::memory_order_acquire);
+			avail = this->cachedTail - h;
+		}
+		if(maxCount > avail) {
+			maxCount = avail;
+		}
+		for(size_t i = 0; i < maxCount; ++i) {
+			// move out so the slot does not keep shared data alive
+			valuePtr[i] = std::move(this->buffer[(h + i) & this->mask]);
+		}
+		this->head.store(h + maxCount, std::memory_order_release);
+		return maxCount;
+	}
+
+	/// @brief Safe from either side, result may be stale by the time it is used.
+	bool isEmpty() const {
+		return size() == 0;
+	}
+
+	size_t size() const {
+		const size_t h = this->head.load(std::memory_order_acquire);
+		const size_t t = this->tail.load(std::memory_order_acquire);
+		return t - h;
+	}
+
+	size_t capacity() const {
+		return this->mask + 1;
+	}
+
+private:
+	static size_t roundUpPow2(size_t value) {
+		size_t pow2 = 1;
+		while(pow2 < value) {
+			pow2 <<= 1;
+		}
+		return pow2;
+	}
+
+	// consumer owned
+	alignas(cacheLineSize) std::atomic<size_t> head;
+	size_t cachedTail;
+	// producer owned
+	alignas(cacheLineSize) std::atomic<size_t> tail;
+	size_t cachedHead;
+	// shared, read only after construction
+	alignas(cacheLineSize) const size_t mask;
+	std::unique_ptr<T[]> buffer;
+};
+
+/// @brief Queue used between pipeline stages.
+/// Adds a run time limit below physical capacity and an edge triggered wake up flag.
+/// Queue can be any single producer, single consumer queue with SpscQueue interface.
+template <typename T, typename Queue = SpscQueue<T>>
+class StageQueue : public Queue {
+public:
+	explicit StageQueue(size_t capacity) :
+		Queue(capacity),
+		limit(this->capacity()),
+		isWakePending(false)
+	{
+	}
+
+	void setLimit(size_t newLimit) {
+		if(newLimit == 0) {
+			newLimit = 1;
+		}
+		if(newLimit > this->capacity()) {
+			newLimit = this->capacity();
+		}
+		this->limit.store(newLimit);
+	}
+
+	size_t getLimit(void) const {
+		return this->limit.load();
+	}
+
+	bool isFull(void) const {
+		return this->size() >= this->limit.load();
+	}
+
+	/// @brief Producer side, after push. True when consumer has to be woken up.
+	bool arm(void) {
+		return !this->isWakePending.exchange(true);
+	}
+
+	/// @brief Consumer side, before draining.
+	void ack(void) {
+		this->isWakePending.store(false);
+	}
+
+private:
+	std::atomic<size_t> limit;
+	std::atomic<bool> isWakePending;
+};
+
+#endif // SPSCQUEUE_H
+
+/// @}
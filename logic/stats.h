@@ -0,0 +1,109 @@
+/**
+ * @defgroup stats_h
+ * @{
+ * @file stats.h
+ * @brief Counters of the capture pipeline.
+ * Counters are relaxed atomics, the hot path never takes a lock. High water marks have a single
+ * writer. A capture is complete when read == decoded and nothing was dropped or overrun.
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+/// @brief Monotonic counter, any thread may add.
+class StatCounter
+{
+public:
+	StatCounter(void) : value(0) {}
+	void add(uint64_t n = 1) {
+		this->value.fetch_add(n, std::memory_order_relaxed);
+	}
+	uint64_t get(void) const {
+		return this->value.load(std::memory_order_relaxed);
+	}
+	void reset(void) {
+		this->value.store(0, std::memory_order_relaxed);
+	}
+private:
+	std::atomic<uint64_t> value;
+};
+
+/// @brief Highest value seen, single writer.
+class StatHighWater
+{
+public:
+	StatHighWater(void) : value(0) {}
+	void update(uint64_t n) {
+		if(n > this->value.load(std::memory_order_relaxed)) {
+			this->value.store(n, std::memory_order_relaxed);
+		}
+	}
+	uint64_t get(void) const {
+		return this->value.load(std::memory_order_relaxed);
+	}
+	void reset(void) {
+		this->value.store(0, std::memory_order_relaxed);
+	}
+private:
+	std::atomic<uint64_t> value;
+};
+
+/// @brief Written by CAN rx thread, framesDropped also by rx queue consumer.
+class RxStats
+{
+public:
+	StatCounter framesRead;      //!< frames received from driver
+	StatCounter framesQueued;    //!< frames pushed to rx queue, spilled ones when they are re-ingested
+	StatCounter framesSpilled;   //!< frames that went through spill file
+	StatCounter framesDropped;   //!< frames lost by queue policy or on disconnect
+	StatCounter driverOverruns;  //!< overruns reported by driver or kernel
+	StatHighWater queueHighWater;
+	void reset(void) {
+		this->framesRead.reset();
+		this->framesQueued.reset();
+		this->framesSpilled.reset();
+		this->framesDropped.reset();
+		this->driverOverruns.reset();
+		this->queueHighWater.reset();
+	}
+};
+
+/// @brief Written by decoder.
+class DecodeStats
+{
+public:
+	StatCounter framesDecoded;
+	StatCounter packetsDecoded;
+	StatCounter guiPacketsDropped;
+	StatHighWater logQueueHighWater;
+	StatHighWater traceQueueHighWater;
+	void reset(void) {
+		this->framesDecoded.reset();
+		this->packetsDecoded.reset();
+		this->guiPacketsDropped.reset();
+		this->logQueueHighWater.reset();
+		this->traceQueueHighWater.reset();
+	}
+};
+
+/// @brief Written by log writer thread.
+class WriterStats
+{
+public:
+	StatCounter bytesIn;      //!< bytes handed to writer, before compression
+	StatCounter bytesWritten; //!< bytes that reached the file
+	StatCounter busyNs;       //!< time spent compressing, writing and syncing
+	StatCounter syncs;        //!< times file data was synced to disk
+	void reset(void) {
+		this->bytesIn.reset();
+		this->bytesWritten.reset();
+		this->busyNs.reset();
+		this->syncs.reset();
+	}
+};
+
+#endif // STATS_H
+
+/// @}
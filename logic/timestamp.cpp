@@ -0,0 +1,58 @@
+#include <chrono>
+#include "timestamp.h"
+
+TimestampNormalizer::TimestampNormalizer(void)
+{
+	reset(false);
+}
+
+void TimestampNormalizer::reset(bool isMonotonic, unsigned counterBits)
+{
+	this->isMonotonic = isMonotonic;
+	this->isFirst = true;
+	this->counterMask = counterBits >= 64 ? UINT64_MAX : ((1ULL << counterBits) - 1);
+	this->lastCounterUs = 0;
+	this->wrapUs = 0;
+	this->offsetUs = 0;
+	this->lastUs = 0;
+}
+
+uint64_t TimestampNormalizer::toUs(uint64_t counterUs)
+{
+	uint64_t us = 0;
+
+	counterUs &= this->counterMask;
+	// a jump back by more than half the range is a wrap, anything smaller is jitter
+	if(!this->isFirst &&
+		this->counterMask != UINT64_MAX &&
+		counterUs < this->lastCounterUs &&
+		(this->lastCounterUs - counterUs) > (this->counterMask >> 1)
+	) {
+		this->wrapUs += this->counterMask + 1;
+	}
+	this->lastCounterUs = counterUs;
+	us = this->wrapUs + counterUs;
+
+	if(this->isFirst) {
+		this->isFirst = false;
+		if(this->isMonotonic) {
+			this->offsetUs = (int64_t)(getMonotonicUs() - us);
+		}
+		this->lastUs = us + this->offsetUs;
+	}
+	us += this->offsetUs;
+
+	if(us < this->lastUs) {
+		us = this->lastUs;
+	}
+	this->lastUs = us;
+	return us;
+}
+
+/// steady_clock is CLOCK_MONOTONIC on Linux
+uint64_t TimestampNormalizer::getMonotonicUs(void)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
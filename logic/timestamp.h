@@ -0,0 +1,41 @@
+/**
+ * @defgroup timestamp_h
+ * @{
+ * @file timestamp.h
+ * @brief Puts backend timestamps into one 64 bit microsecond domain.
+ * Each backend converts its driver timestamp to microseconds and passes it through
+ * TimestampNormalizer. Narrow hardware counters are unwrapped, result never goes backwards.
+ * Optionally result is shifted onto host CLOCK_MONOTONIC, so frame timestamps can be compared
+ * with host time for latency measurements.
+ */
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <cstdint>
+
+class TimestampNormalizer
+{
+public:
+	TimestampNormalizer(void);
+
+	/// @brief Call before first frame of a capture.
+	/// @param isMonotonic shift onto host monotonic clock at first frame
+	/// @param counterBits width of device counter in microseconds, 64 means it does not wrap
+	void reset(bool isMonotonic, unsigned counterBits = 64);
+	/// @brief Only the rx thread may call this.
+	uint64_t toUs(uint64_t counterUs);
+
+	static uint64_t getMonotonicUs(void);
+private:
+	bool isMonotonic;
+	bool isFirst;
+	uint64_t counterMask;
+	uint64_t lastCounterUs;
+	uint64_t wrapUs;
+	int64_t offsetUs;
+	uint64_t lastUs;
+};
+
+#endif // TIMESTAMP_H
+
+/// @}
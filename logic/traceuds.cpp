@@ -1,6 +1,11 @@
 #include "traceuds.h"
 #include "util.h"
 #include <QDateTime>
+#include <QFileInfo>
+
+const QByteArray TraceUds::jsonHeader = QByteArrayLiteral("{\"traceEvents\":[\n");
+
+const QByteArray TraceUds::jsonFooter = QByteArrayLiteral("]}\n");
 
 const QByteArray TraceUds::htmlHeader = QByteArrayLiteral(R"(<!DOCTYPE html>
 <html lang="en">
@@ -77,53 +82,106 @@ const QByteArray TraceUds::htmlFooter = QByteArrayLiteral(R"(</ul>
 
 )");
 
-TraceUds::TraceUds(QObject *parent) :
+TraceUds::TraceUds(StageQueue<UdsPacket> *packetQueuePtr, QObject *parent) :
 	QObject{parent},
+	packetQueuePtr{packetQueuePtr},
 	logFilePtr{nullptr},
-	htmlFilePtr{nullptr}
+	htmlFilePtr{nullptr},
+	rotation{},
+	byteIdx{0},
+	jsonBfr{},
+	htmlBfr{},
+	syncMs{0},
+	syncTimer{},
+	rotateTimer{this}
 {
+	connect(&this->rotateTimer, &QTimer::timeout, this, &TraceUds::onRotateTimer);
+}
 
+TraceUds::~TraceUds()
+{
+	close();
+}
+
+void TraceUds::setRotation(uint64_t maxBytes, int maxMin, unsigned keep)
+{
+	this->rotation.configure(maxBytes, maxMin, keep);
+}
+
+void TraceUds::setSync(int syncMs)
+{
+	this->syncMs = syncMs > 0 ? syncMs : 0;
 }
 
 void TraceUds::open(const QString &logDirPathRef)
 {
-	QString logFileName = Util::getFileName() + ".json";
-	this->logFilePath = logDirPathRef + "/" + logFileName;
+	openBase(logDirPathRef + "/" + Util::getFileName());
+}
+
+void TraceUds::openBase(const QString &basePathRef)
+{
+	this->byteIdx = 0;
+	this->rotation.start(basePathRef);
+	openSegment();
+	if(this->rotation.isEnabled()) {
+		this->rotateTimer.start(rotateCheckMs);
+	}
+}
+
+void TraceUds::openSegment(void)
+{
+	this->logFilePath = this->rotation.getPath(".json");
 	// Open the log file in append mode
 	this->logFilePtr = new QFile(logFilePath);
 	if (!this->logFilePtr->open(QIODevice::Append | QIODevice::Text)) {
+		// running on sink thread, nobody to catch an exception here
 		Util::log(
-			LogType::GenericThrow,
+			LogType::Generic,
 			LogSt::Nok,
 			"Failed to open trace file: " + logFilePath
 		);
+		delete this->logFilePtr;
+		this->logFilePtr = nullptr;
+		return;
 	}
-	QString s = "{\"traceEvents\":[\n";
-	this->logFilePtr->write(s.toUtf8());
+	this->logFilePtr->write(jsonHeader);
 	this->logFilePtr->flush();
+	this->syncTimer.start();
 
-	logFileName = Util::getFileName() + ".html";
-	this->htmlFilePath = logDirPathRef + "/" + logFileName;
+	this->htmlFilePath = this->rotation.getPath(".html");
 	this->htmlFilePtr = new QFile(htmlFilePath);
 	if (!this->htmlFilePtr->open(QIODevice::WriteOnly | QIODevice::Text)) {
 		Util::log(
-			LogType::GenericThrow,
+			LogType::Generic,
 			LogSt::Nok,
 			"Failed to open HTML trace file: " + htmlFilePath
 		);
+		delete this->htmlFilePtr;
+		this->htmlFilePtr = nullptr;
+		return;
 	}
 	this->htmlFilePtr->write(htmlHeader);
 	this->htmlFilePtr->flush();
 }
 
 void TraceUds::close()
+{
+	this->rotateTimer.stop();
+	if(this->packetQueuePtr != nullptr) {
+		onPacketsReady();
+	}
+	closeSegment();
+}
+
+void TraceUds::closeSegment(void)
 {
 	if (this->logFilePtr == nullptr) {
 		return;
 	}
-	QString s = "]}\n";
-	this->logFilePtr->write(s.toUtf8());
-	this->logFilePtr->flush();
+	this->logFilePtr->write(jsonFooter);
+	if(this->syncMs != 0) {
+		Util::syncFile(*this->logFilePtr);
+	}
 	this->logFilePtr->close();
 	delete this->logFilePtr;
 	this->logFilePtr = nullptr;
@@ -136,7 +194,9 @@ void TraceUds::close()
 		return;
 	}
 	this->htmlFilePtr->write(htmlFooter);
-	this->htmlFilePtr->flush();
+	if(this->syncMs != 0) {
+		Util::syncFile(*this->htmlFilePtr);
+	}
 	this->htmlFilePtr->close();
 	delete this->htmlFilePtr;
 	this->htmlFilePtr = nullptr;
@@ -146,6 +206,7 @@ void TraceUds::close()
 }
 
 void TraceUds::writeJsonItem(
+	QByteArray &dstRef,
 	bool isBegin,
 	bool isReq,
 	uint8_t sid,
@@ -153,12 +214,9 @@ void TraceUds::writeJsonItem(
 	const QString &hexStr,
 	const QString &detail,
 	uint64_t byteIdx,
+	const QString &timestampStrRef,
 	const QString &rawStrRef
 ) {
-	if(this->logFilePtr == nullptr) {
-		return;
-	}
-
 	QString formatStr =
 		"{\"cat\":\"%1\", "
 		"\"pid\":%2, "
@@ -179,10 +237,6 @@ void TraceUds::writeJsonItem(
 	QString sidStr = QString("\"0x%1\"").arg(sid, 0, 16, QChar(' '));
 	QString isBeginStr = isBegin ? "b" : "e";
 	QString byteIdxStr = QString("%1").arg(byteIdx, 0, 10, QChar(' '));
-	QString timestampStr =
-		QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") +
-		QString("_") +
-		QString::number(QDateTime::currentMSecsSinceEpoch() % 1000);
 
 	QString s = formatStr
 	.arg(catStr) // 1
@@ -195,31 +249,193 @@ void TraceUds::writeJsonItem(
 	.arg(name) // 8
 	.arg(detail) // 9
 	.arg(hexStr) // 10
-	.arg(timestampStr) // 11
+	.arg(timestampStrRef) // 11
 	.arg(rawStrRef) // 12
 	;
 
-	this->logFilePtr->write(s.toUtf8());
+	dstRef.append(s.toUtf8());
 }
 
-void TraceUds::onUdsPacketReceived(
-	bool isReq,
-	const QString &rawCanMsgStrRef,
-	const QVector<UdsInfo> &packetInfoRef
-) {
+void TraceUds::onPacketsReady(void)
+{
+	UdsPacket packet;
+	bool isWritten = false;
+
+	this->packetQueuePtr->ack();
+	while(this->packetQueuePtr->tryPop(packet)) {
+		write(packet);
+		isWritten = true;
+	}
+	if(isWritten) {
+		syncSegment();
+	}
+}
+
+void TraceUds::write(const UdsPacket &packetRef)
+{
+	this->jsonBfr.clear();
+	this->htmlBfr.clear();
+	render(packetRef, this->byteIdx, this->jsonBfr, this->htmlBfr);
+	writeRendered(this->jsonBfr.constData(), this->jsonBfr.size(), this->htmlBfr.constData(), this->htmlBfr.size());
+}
+
+void TraceUds::writeRendered(const char *jsonPtr, qsizetype jsonSize, const char *htmlPtr, qsizetype htmlSize)
+{
+	if(this->logFilePtr != nullptr) {
+		this->logFilePtr->write(jsonPtr, jsonSize);
+	}
+	if(this->htmlFilePtr != nullptr) {
+		this->htmlFilePtr->write(htmlPtr, htmlSize);
+	}
+	rotate();
+}
+
+void TraceUds::onRotateTimer(void)
+{
+	rotate();
+}
+
+void TraceUds::rotate(void)
+{
+	// json is the larger of the two, it decides
+	if(this->logFilePtr != nullptr && this->rotation.isDue(this->logFilePtr->pos())) {
+		closeSegment();
+		this->rotation.next();
+		openSegment();
+		this->rotation.removeExpired({ ".json", ".html" });
+	}
+}
+
+void TraceUds::flush(void)
+{
+	if(this->logFilePtr != nullptr) {
+		this->logFilePtr->flush();
+	}
+	if(this->htmlFilePtr != nullptr) {
+		this->htmlFilePtr->flush();
+	}
+}
+
+/// Once per batch, packets are few next to frames. A crash of the tracer alone loses nothing
+/// that was flushed, the sync covers power loss and OS crashes.
+void TraceUds::syncSegment(void)
+{
+	flush();
+	if(this->syncMs == 0 || this->syncTimer.elapsed() < this->syncMs) {
+		return;
+	}
+	this->syncTimer.start();
+	if(this->logFilePtr != nullptr && !Util::syncFile(*this->logFilePtr)) {
+		Util::log(LogType::Generic, LogSt::Warn, "Failed to sync trace file: " + this->logFilePath);
+	}
+	if(this->htmlFilePtr != nullptr && !Util::syncFile(*this->htmlFilePtr)) {
+		Util::log(LogType::Generic, LogSt::Warn, "Failed to sync HTML trace file: " + this->htmlFilePath);
+	}
+}
+
+/// Complete trace ends with its footer, blank lines aside. Anything after the last line end is
+/// a line cut short, it is dropped before the footer goes on. A file that lost even its header
+/// is written anew.
+RepairResult TraceUds::repair(const QString &filePathRef, uint64_t &droppedBytesRef, QString &errorStrRef)
+{
+	const bool isHtml = QFileInfo(filePathRef).suffix().toLower() == "html";
+	const QByteArray &headerRef = isHtml ? htmlHeader : jsonHeader;
+	const QByteArray &footerRef = isHtml ? htmlFooter : jsonFooter;
+	const QByteArray endMark = isHtml ? QByteArrayLiteral("</html>") : QByteArrayLiteral("]}");
+	QFile file(filePathRef);
+	QByteArray tail;
+	qint64 size = 0;
+	qint64 cutPos = 0;
+
+	droppedBytesRef = 0;
+	if(!file.open(QIODevice::ReadWrite)) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	size = file.size();
+	// anything else that happens to share the extension is left alone, first line is
+	// compared only, line ends differ between systems. Zero fill of a power loss is no text.
+	const QByteArray firstLine = headerRef.left(headerRef.indexOf('\n'));
+	QByteArray start = file.read(qMin(size, (qint64)firstLine.size()));
+	if(start.indexOf('\0') >= 0) {
+		start = start.left(start.indexOf('\0'));
+	}
+	if(!firstLine.startsWith(start)) {
+		errorStrRef = "Not a UDS trace";
+		return RepairResult::Failed;
+	}
+	const qint64 tailSize = qMin(size, repairTailSize);
+	if(!file.seek(size - tailSize)) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	tail = file.read(tailSize);
+	if(tail.trimmed().endsWith(endMark)) {
+		return RepairResult::Complete;
+	}
+	const qsizetype lineEndPos = tail.lastIndexOf('\n');
+	if(lineEndPos >= 0) {
+		cutPos = size - tailSize + lineEndPos + 1;
+		// cut within a footer of several lines, the lines it left go before the footer is written
+		const QByteArray kept = tail.left(lineEndPos + 1);
+		for(qsizetype i = footerRef.size() - 2; i >= 0; --i) {
+			if(footerRef[i] == '\n' && kept.endsWith(footerRef.left(i + 1))) {
+				cutPos -= i + 1;
+				break;
+			}
+		}
+	}
+	if(!file.resize(cutPos) || !file.seek(cutPos)) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	if((cutPos == 0 && file.write(headerRef) != headerRef.size()) || file.write(footerRef) != footerRef.size()) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	if(!Util::syncFile(file)) {
+		errorStrRef = file.errorString();
+		return RepairResult::Failed;
+	}
+	droppedBytesRef = size - cutPos;
+	return RepairResult::Repaired;
+}
+
+void TraceUds::render(const UdsPacket &packetRef, uint64_t &byteIdxRef, QByteArray &jsonRef, QByteArray &htmlRef)
+{
 	jsonUdsPacketHandler(
-		isReq,
-		rawCanMsgStrRef,
-		packetInfoRef
+		jsonRef,
+		byteIdxRef,
+		packetRef.isReq,
+		packetRef.isCaptureTime,
+		packetRef.timestampUs,
+		packetRef.rawCanMsgStr,
+		packetRef.packetInfo
 	);
 	htmlUdsPacketHandler(
-		isReq,
-		rawCanMsgStrRef,
-		packetInfoRef
+		htmlRef,
+		packetRef.isReq,
+		packetRef.rawCanMsgStr,
+		packetRef.packetInfo
 	);
 }
 
-void TraceUds::addHtmlTrace(bool isReq, QString s)
+uint64_t TraceUds::getByteSpan(const UdsPacket &packetRef)
+{
+	const QVector<UdsInfo> &infoRef = packetRef.packetInfo;
+	uint64_t byteSpan = 0;
+
+	// as jsonUdsPacketHandler counts them
+	if(infoRef.length() == 0 || infoRef[0].hex.length() == 0) {
+		return 0;
+	}
+	for(int i = 1; i < infoRef.length(); ++i) {
+		byteSpan += static_cast<uint16_t>(infoRef[i].hex.length());
+	}
+	return byteSpan;
+}
+
+void TraceUds::addHtmlTrace(QByteArray &dstRef, bool isReq, QString s)
 {
 	QString type;
 
@@ -236,13 +452,11 @@ void TraceUds::addHtmlTrace(bool isReq, QString s)
 		s +
 		"</div></li>\n";
 
-	if (this->htmlFilePtr == nullptr) {
-		return;
-	}
-	this->htmlFilePtr->write(traceStr.toUtf8());
+	dstRef.append(traceStr.toUtf8());
 }
 
 void TraceUds::htmlUdsPacketHandler(
+	QByteArray &dstRef,
 	bool isReq,
 	const QString &rawCanMsgStrRef,
 	const QVector<UdsInfo> &packetInfoRef
@@ -261,7 +475,7 @@ void TraceUds::htmlUdsPacketHandler(
 			}
 		}
 		s = s.trimmed();
-		addHtmlTrace(isReq, s);
+		addHtmlTrace(dstRef, isReq, s);
 	} else {
 		uint32_t packetHexStrLen = 0;
 		QString s = "";
@@ -285,18 +499,20 @@ void TraceUds::htmlUdsPacketHandler(
 			s += packetInfoRef[i].name;
 		}
 
-		addHtmlTrace(isReq, s);
+		addHtmlTrace(dstRef, isReq, s);
 	}
 }
 
 void TraceUds::jsonUdsPacketHandler(
+	QByteArray &dstRef,
+	uint64_t &byteIdxRef,
 	bool isReq,
+	bool isCaptureTime,
+	uint64_t timestampUs,
 	const QString &rawCanMsgStrRef,
 	const QVector<UdsInfo> &packetInfoRef
 )
 {
-	static uint64_t byteIdx = 0;
-
 	// there is nothing to log
 	if(packetInfoRef.length() == 0) {
 		return;
@@ -304,9 +520,6 @@ void TraceUds::jsonUdsPacketHandler(
 	if(packetInfoRef[0].hex.length() == 0) {
 		return;
 	}
-	if(this->logFilePtr == nullptr) {
-		return;
-	}
 
 	uint8_t sid = packetInfoRef[0].hex[0];
 	QString name = "Raw";
@@ -320,15 +533,23 @@ void TraceUds::jsonUdsPacketHandler(
 	} else {
 		name += " Resp";
 	}
+	// once per packet, its items are written at the same time
+	const qint64 timestampMs = isCaptureTime ? timestampUs / 1000 : QDateTime::currentMSecsSinceEpoch();
+	const QString timestampStr =
+		QDateTime::fromMSecsSinceEpoch(timestampMs).toString("yyyyMMdd_HHmmss") +
+		QString("_") +
+		QString::number(timestampMs % 1000);
 
 	writeJsonItem(
+		dstRef,
 		true,
 		isReq,
 		sid,
 		name,
 		packetInfoRef[0].getHexStr(),
 		name,
-		byteIdx,
+		byteIdxRef,
+		timestampStr,
 		rawCanMsgStrRef
 	);
 
@@ -336,60 +557,68 @@ void TraceUds::jsonUdsPacketHandler(
 		uint16_t numOfBytes = packetInfoRef[i].hex.length();
 
 		writeJsonItem(
+			dstRef,
 			true,
 			isReq,
 			sid,
 			packetInfoRef[i].getHexStr(),
 			packetInfoRef[i].getHexStr(),
 			packetInfoRef[i].name,
-			byteIdx,
+			byteIdxRef,
+			timestampStr,
 			rawCanMsgStrRef
 		);
 		writeJsonItem(
+			dstRef,
 			false,
 			isReq,
 			sid,
 			packetInfoRef[i].getHexStr(),
 			packetInfoRef[i].getHexStr(),
 			packetInfoRef[i].name,
-			byteIdx + numOfBytes,
+			byteIdxRef + numOfBytes,
+			timestampStr,
 			rawCanMsgStrRef
 		);
 
 		writeJsonItem(
+			dstRef,
 			true,
 			isReq,
 			sid,
 			packetInfoRef[i].name,
 			packetInfoRef[i].getHexStr(),
 			packetInfoRef[i].name,
-			byteIdx,
+			byteIdxRef,
+			timestampStr,
 			rawCanMsgStrRef
 		);
 		writeJsonItem(
+			dstRef,
 			false,
 			isReq,
 			sid,
 			packetInfoRef[i].name,
 			packetInfoRef[i].getHexStr(),
 			packetInfoRef[i].name,
-			byteIdx + numOfBytes,
+			byteIdxRef + numOfBytes,
+			timestampStr,
 			rawCanMsgStrRef
 		);
 
-		byteIdx += numOfBytes;
+		byteIdxRef += numOfBytes;
 	}
 
 	writeJsonItem(
+		dstRef,
 		false,
 		isReq,
 		sid,
 		name,
 		packetInfoRef[0].getHexStr(),
 		name,
-		byteIdx,
+		byteIdxRef,
+		timestampStr,
 		rawCanMsgStrRef
 	);
-
-	this->logFilePtr->flush();
 }
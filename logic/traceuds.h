@@ -4,37 +4,86 @@
  * @file traceuds.h
  * @brief This is the main way to trace UDS packets.
  * It is used to log UDS packets in JSON format. JSON format is supported by Perfetto.
+ * With rotation on, JSON and HTML files are split into segments, each one complete on its own.
+ * Every batch of packets is flushed to the OS, with sync on it also reaches the disk every syncMs.
+ * A trace cut short by a crash lacks its closing lines, repair() adds them.
+ * Offline decoding has no queue, it opens files by name and hands packets to write() directly,
+ * or renders them on its own threads and hands the text to writeRendered().
  */
 
 #ifndef TRACEUDS_H
 #define TRACEUDS_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QByteArray>
+#include <QTimer>
+#include "capturerepair.h"
+#include "rotation.h"
+#include "spscqueue.h"
 #include "uds.h"
 
 class TraceUds : public QObject
 {
 	Q_OBJECT
 public:
-	explicit TraceUds(QObject *parent = nullptr);
+	/// @brief packetQueuePtr may be nullptr when packets only come through write().
+	explicit TraceUds(StageQueue<UdsPacket> *packetQueuePtr, QObject *parent = nullptr);
+	~TraceUds();
+	/// @brief Takes effect on next open, see Rotation::configure.
+	void setRotation(uint64_t maxBytes, int maxMin, unsigned keep);
+	/// @brief Takes effect on next open, 0 leaves it to the OS when data reaches the disk.
+	void setSync(int syncMs);
+	/// @brief Closes a .json or .html trace that was not closed, drops its last incomplete line.
+	static RepairResult repair(const QString &filePathRef, uint64_t &droppedBytesRef, QString &errorStrRef);
+	/// @brief As open, files are named basePathRef plus extension and segment.
+	void openBase(const QString &basePathRef);
+	/// @brief Writes one packet and moves on to the next segment when it is due.
+	void write(const UdsPacket &packetRef);
+	/// @brief As write, for the text render() made of one packet.
+	void writeRendered(const char *jsonPtr, qsizetype jsonSize, const char *htmlPtr, qsizetype htmlSize);
+	/// @brief Appends JSON and HTML text of one packet. byteIdxRef is the running byte index
+	/// JSON items are placed by, it is moved past the packet. Safe from any thread.
+	static void render(const UdsPacket &packetRef, uint64_t &byteIdxRef, QByteArray &jsonRef, QByteArray &htmlRef);
+	/// @brief How far render() moves the byte index for a packet.
+	static uint64_t getByteSpan(const UdsPacket &packetRef);
+public slots:
 	void open(const QString &logDirPathRef);
+	/// @brief Drains what is left in the queue before closing.
 	void close();
-public slots:
-	void onUdsPacketReceived(
-		bool isReq,
-		const QString &rawCanMsgStrRef,
-		const QVector<UdsInfo> &packetInfoRef
-	);
+	void onPacketsReady(void);
+private slots:
+	/// @brief Segment of rotateMin ends on time without packets coming in.
+	void onRotateTimer(void);
 private:
+	StageQueue<UdsPacket> *packetQueuePtr;
 	QFile *logFilePtr;
 	QFile *htmlFilePtr;
 	QString logFilePath;
+	static const QByteArray jsonHeader;
+	static const QByteArray jsonFooter;
 	static const QByteArray htmlHeader;
 	static const QByteArray htmlFooter;
+	/// @brief Longest tail repair() looks through for the last line end.
+	static const qint64 repairTailSize = 1024 * 1024;
 	QString htmlFilePath;
-	void writeJsonItem(
+	Rotation rotation;
+	uint64_t byteIdx;           //!< of packets written since open
+	QByteArray jsonBfr;         //!< text of packet being written
+	QByteArray htmlBfr;
+	int syncMs;
+	QElapsedTimer syncTimer;    //!< time since last sync
+	QTimer rotateTimer;         //!< runs while a rotated trace is open
+	static const int rotateCheckMs = 1000;
+	void openSegment(void);
+	/// @brief Hands what was written to the OS.
+	void flush(void);
+	void syncSegment(void);
+	void closeSegment(void);
+	void rotate(void);
+	static void writeJsonItem(
+		QByteArray &dstRef,
 		bool isBegin,
 		bool isReq,
 		uint8_t sid,
@@ -42,19 +91,25 @@ private:
 		const QString &hexStr,
 		const QString &detail,
 		uint64_t byteIdx,
+		const QString &timestampStrRef,
 		const QString &rawStrRef
 	);
-	void htmlUdsPacketHandler(
+	static void htmlUdsPacketHandler(
+		QByteArray &dstRef,
 		bool isReq,
 		const QString &rawCanMsgStrRef,
 		const QVector<UdsInfo> &packetInfoRef
 	);
-	void jsonUdsPacketHandler(
+	static void jsonUdsPacketHandler(
+		QByteArray &dstRef,
+		uint64_t &byteIdxRef,
 		bool isReq,
+		bool isCaptureTime,
+		uint64_t timestampUs,
 		const QString &rawCanMsgStrRef,
 		const QVector<UdsInfo> &packetInfoRef
 	);
-	void addHtmlTrace(bool isReq, QString s);
+	static void addHtmlTrace(QByteArray &dstRef, bool isReq, QString s);
 };
 
 #endif // TRACEUDS_H
@@ -17,6 +17,17 @@ public:
 	QString getHexStr(int numOfBytes) const;
 };
 
+/// @brief Decoded UDS packet as it travels from decoder to trace sinks.
+class UdsPacket
+{
+public:
+	bool isReq;
+	bool isCaptureTime;   //!< timestampUs is valid, else packet is traced at time of writing
+	uint64_t timestampUs; //!< traced at, microseconds since epoch
+	QString rawCanMsgStr;
+	QVector<UdsInfo> packetInfo;
+};
+
 class Uds : public QObject
 {
 	Q_OBJECT
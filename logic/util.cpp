@@ -4,6 +4,11 @@
 #include <QJsonObject>
 #include <QDateTime>
 #include <iostream>
+#ifdef Q_OS_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 const QMap<LogProp, QString> LogPropStr = {
 	{LogProp::Timestamp , "Timestamp"},
@@ -145,4 +150,19 @@ namespace Util {
 	{
 		return  QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
 	}
+
+	bool syncFile(QFile &fileRef)
+	{
+		if(!fileRef.flush()) {
+			return false;
+		}
+#if defined(Q_OS_WIN32)
+		return _commit(fileRef.handle()) == 0;
+#elif defined(Q_OS_LINUX)
+		// metadata other than size is not needed to read the file back
+		return fdatasync(fileRef.handle()) == 0;
+#else
+		return fsync(fileRef.handle()) == 0;
+#endif
+	}
 }
@@ -10,6 +10,7 @@
 #define UTIL_H
 
 #include <QObject>
+#include <QFile>
 #include <QMap>
 #include <QString>
 #include "cmddef.h"
@@ -54,6 +55,8 @@ namespace Util
 
 	uint64_t getTimeStamp();
 	QString getFileName();
+	/// @brief Flushes Qt buffer and waits until file data is on disk, not just in page cache.
+	bool syncFile(QFile &fileRef);
 
 	void log(LogType type, LogSt st, const CmdDef::Cmd &cmdRef, const QString &cmdValueRef, const QString &msgRef);
 	void log(LogType type, LogSt st, const CmdDef::Cmd &cmdRef, const QString &msgRef);
@@ -1,6 +1,7 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 #include <QMap>
 #include <QString>
 #include <QDebug>
@@ -12,18 +13,32 @@
 
 int main(int argc, char *argv[])
 {
-	QApplication a(argc, argv);
-	a.setApplicationName("CAN UDS Tracer");
-	a.setApplicationVersion("0.0.1");
-
 	bool libMode = true;
+	bool isDecodeMode = false;
 	for (int i = 1; i < argc; ++i) {
-		if (QString(argv[i]) == "--cli") {
+		const QString arg(argv[i]);
+		if (arg == "--cli") {
 			libMode = false;
-			break;
+		}
+		if (arg == "-d" || arg.startsWith("--decode")) {
+			isDecodeMode = true;
 		}
 	}
 
+	if (isDecodeMode) {
+		// no display needed, cli stops its threads on the way out once the capture is decoded
+		QCoreApplication a(argc, argv);
+		a.setApplicationName("CAN UDS Tracer");
+		a.setApplicationVersion("0.0.1");
+		Cli cli(nullptr);
+		cli.init(argc, argv);
+		return cli.getExitCode();
+	}
+
+	QApplication a(argc, argv);
+	a.setApplicationName("CAN UDS Tracer");
+	a.setApplicationVersion("0.0.1");
+
 	Cli cli(nullptr);
 	cli.init(argc, argv);
 	MainWindow w(nullptr, cli);
@@ -54,7 +54,7 @@ MainWindow::~MainWindow()
 
 void MainWindow::onCanConnectionEvented(bool isConnected)
 {
-	this->canTabFormPtr->setEnabled(!isConnected);
+	this->canTabFormPtr->setConnected(isConnected);
 }
 
 void MainWindow::onOpenAction()
@@ -0,0 +1,18 @@
+include(../tests.pri)
+
+# BufferedWriter flush rules, plus a benchmark against writing every frame straight to QFile.
+TARGET = tst_bufferedwriter
+
+SOURCES += \
+    tst_bufferedwriter.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/bufferedwriter.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/bufferedwriter.h
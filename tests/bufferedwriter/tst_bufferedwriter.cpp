@@ -0,0 +1,195 @@
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+#include "bufferedwriter.h"
+#include "captureformat.h"
+
+/// @brief BufferedWriter flush rules and content, plus the .cobs log write path before and after it.
+class TestBufferedWriter : public QObject
+{
+	Q_OBJECT
+private slots:
+	void closeWritesEverything(void);
+	void trickleIsFlushedByAge(void);
+	void fullBufferIsFlushedBySize(void);
+	void blockEncoderSeesWholeBlocks(void);
+	void benchmarkDirectWrite(void);
+	void benchmarkBufferedWriter(void);
+
+private:
+	static constexpr size_t batchSize = 64;   //!< as CanLog::batchSize
+	static constexpr size_t benchmarkFrames = 256 * 1024;
+	QTemporaryDir tempDir;
+	static QByteArray readFile(const QString &filePathRef);
+	static size_t encodeMsg(size_t seq, uint8_t *dstPtr);
+	static void bracketBlock(const char *blockPtr, size_t blockSize, QByteArray &outRef);
+};
+
+QByteArray TestBufferedWriter::readFile(const QString &filePathRef)
+{
+	QFile file(filePathRef);
+
+	if(!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+	return file.readAll();
+}
+
+/// Encoded classic frame record with delimiter, as CanLog writes it.
+size_t TestBufferedWriter::encodeMsg(size_t seq, uint8_t *dstPtr)
+{
+	uint8_t record[CaptureFormat::maxRecordSize];
+	CanMsg msg = {};
+
+	msg.id = (uint32_t)(0x700 + (seq & 0xFF));
+	msg.dataLength = 8;
+	for(uint8_t i = 0; i < msg.dataLength; ++i) {
+		msg.data[i] = (uint8_t)(seq + i);
+	}
+	msg.timestamp = seq * 100;
+	const size_t recordSize = CaptureFormat::encodeFrame(msg, record);
+	return CaptureFormat::encodeRecord(record, recordSize, dstPtr);
+}
+
+/// Test block encoder, block boundaries show up as brackets in the file.
+void TestBufferedWriter::bracketBlock(const char *blockPtr, size_t blockSize, QByteArray &outRef)
+{
+	outRef.append('<');
+	outRef.append(blockPtr, blockSize);
+	outRef.append('>');
+}
+
+void TestBufferedWriter::closeWritesEverything(void)
+{
+	const QString filePath = this->tempDir.filePath("all.bin");
+	const QByteArray header("HEADER");
+	BufferedWriter writer;
+	QByteArray expected(header);
+
+	// small flush size, writer swaps buffers many times while caller keeps writing
+	writer.setFlush(1024, 1000);
+	QVERIFY(writer.open(filePath, header));
+	for(int i = 0; i < 5000; ++i) {
+		const QByteArray chunk(1 + i % 97, (char)('a' + i % 26));
+		writer.write(chunk.constData(), chunk.size());
+		expected.append(chunk);
+	}
+	writer.close();
+
+	QVERIFY(!writer.isOpen());
+	QCOMPARE(readFile(filePath), expected);
+	QCOMPARE(writer.stats.bytesIn.get(), (uint64_t)expected.size());
+	QCOMPARE(writer.stats.bytesWritten.get(), (uint64_t)expected.size());
+}
+
+void TestBufferedWriter::trickleIsFlushedByAge(void)
+{
+	const QString filePath = this->tempDir.filePath("age.bin");
+	const QByteArray header("HEADER");
+	BufferedWriter writer;
+
+	// a quiet bus never fills the buffer, its frames still reach the file within flushMs
+	writer.setFlush(256 * 1024, 50);
+	QVERIFY(writer.open(filePath, header));
+	writer.write("0123456789", 10);
+	QTRY_COMPARE_WITH_TIMEOUT(QFileInfo(filePath).size(), (qint64)(header.size() + 10), 1000);
+	writer.write("abc", 3);
+	QTRY_COMPARE_WITH_TIMEOUT(QFileInfo(filePath).size(), (qint64)(header.size() + 13), 1000);
+	QVERIFY(writer.isOpen());
+	writer.close();
+	QCOMPARE(readFile(filePath), QByteArray("HEADER0123456789abc"));
+}
+
+void TestBufferedWriter::fullBufferIsFlushedBySize(void)
+{
+	const QString filePath = this->tempDir.filePath("size.bin");
+	BufferedWriter writer;
+	const QByteArray chunk(100, 'x');
+
+	// age alone would keep it buffered for the whole test
+	writer.setFlush(64, 60000);
+	QVERIFY(writer.open(filePath));
+	writer.write(chunk.constData(), chunk.size());
+	QTRY_COMPARE_WITH_TIMEOUT(QFileInfo(filePath).size(), (qint64)chunk.size(), 1000);
+	writer.close();
+}
+
+void TestBufferedWriter::blockEncoderSeesWholeBlocks(void)
+{
+	const QString filePath = this->tempDir.filePath("block.bin");
+	BufferedWriter writer;
+	QByteArray expected("HDR");
+	uint64_t blockBytes = 0;
+
+	writer.setFlush(256, 1000);
+	writer.setBlockEncoder(bracketBlock);
+	QVERIFY(writer.open(filePath, QByteArray("HDR")));
+	for(int i = 0; i < 500; ++i) {
+		const QByteArray block(1 + i % 40, (char)('a' + i % 26));
+		writer.write(block.constData(), block.size());
+		expected.append('<').append(block).append('>');
+		blockBytes += block.size();
+	}
+	writer.close();
+
+	// header is not encoded, every block is encoded on its own and in order
+	QCOMPARE(readFile(filePath), expected);
+	QCOMPARE(writer.stats.bytesIn.get(), (uint64_t)3 + blockBytes);
+	QCOMPARE(writer.stats.bytesWritten.get(), (uint64_t)expected.size());
+}
+
+/// What the log did before BufferedWriter: record and delimiter written on their own, flushed per frame.
+void TestBufferedWriter::benchmarkDirectWrite(void)
+{
+	const QString filePath = this->tempDir.filePath("direct.cobs");
+	uint8_t encoded[CaptureFormat::maxEncodedRecordSize];
+	const char delimiter = 0;
+	qint64 fileSize = 0;
+
+	QBENCHMARK {
+		QFile file(filePath);
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		fileSize = 0;
+		for(size_t i = 0; i < benchmarkFrames; ++i) {
+			const size_t encodedSize = encodeMsg(i, encoded);
+			file.write(reinterpret_cast<const char *>(encoded), encodedSize - 1);
+			file.write(&delimiter, 1);
+			file.flush();
+			fileSize += encodedSize;
+		}
+		file.close();
+	}
+	QCOMPARE(QFileInfo(filePath).size(), fileSize);
+}
+
+/// What CanLog does now: a batch of frames encoded into one buffer, handed to the writer at once.
+void TestBufferedWriter::benchmarkBufferedWriter(void)
+{
+	const QString filePath = this->tempDir.filePath("buffered.cobs");
+	QByteArray encodedBfr;
+	qint64 fileSize = 0;
+
+	encodedBfr.reserve(batchSize * CaptureFormat::maxEncodedRecordSize);
+	QBENCHMARK {
+		BufferedWriter writer;
+		QVERIFY(writer.open(filePath));
+		fileSize = 0;
+		for(size_t i = 0; i < benchmarkFrames; i += batchSize) {
+			encodedBfr.resize(0);
+			for(size_t j = i; j < i + batchSize; ++j) {
+				uint8_t encoded[CaptureFormat::maxEncodedRecordSize];
+				encodedBfr.append(reinterpret_cast<const char *>(encoded), encodeMsg(j, encoded));
+			}
+			writer.write(encodedBfr.constData(), encodedBfr.size());
+			fileSize += encodedBfr.size();
+		}
+		writer.close();
+	}
+	QCOMPARE(QFileInfo(filePath).size(), fileSize);
+}
+
+QTEST_GUILESS_MAIN(TestBufferedWriter)
+
+#include "tst_bufferedwriter.moc"
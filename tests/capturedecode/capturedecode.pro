@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+# Replay record decoding against the cobs library, plus benchmarks of the replay read path.
+TARGET = tst_capturedecode
+
+SOURCES += \
+    tst_capturedecode.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/capture/capturereader.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c
@@ -0,0 +1,237 @@
+#include <QVector>
+#include <QtTest>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "captureformat.h"
+#include "capturereader.h"
+#include "cobs.h"
+
+/// @brief Replay decode: CaptureFormat::decodeRecord against the cobs library, and the
+/// replay read path before and after it switched to memchr and decodeRecord.
+class TestCaptureDecode : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void decodeRecordMatchesCobs(void);
+	void malformedMatchesCobs(void);
+	void readerReadsEveryFrame(void);
+	void benchmarkByteLoop(void);
+	void benchmarkCobsDecode(void);
+	void benchmarkDecodeRecord(void);
+	void benchmarkCaptureReader(void);
+
+private:
+	static constexpr size_t benchmarkFrames = 1000000;
+	static constexpr size_t decodeBfrSize = 512; //!< larger than anything a test record decodes to
+	std::vector<uint8_t> capture;                //!< plain V1 capture of benchmarkFrames frames
+	static CanMsg makeMsg(size_t seq);
+	static bool isMsgEqual(const CanMsg &aRef, const CanMsg &bRef);
+};
+
+/// Mostly classic frames with a few FD ones, payload holds zeros so COBS runs stay short.
+CanMsg TestCaptureDecode::makeMsg(size_t seq)
+{
+	CanMsg msg = {};
+
+	msg.dataLength = seq % 16 == 0 ? 64 : (uint8_t)(seq % 9);
+	msg.flags = msg.dataLength > 8 ? CanMsgFlagFd : 0;
+	msg.id = (uint32_t)(0x600 + seq % 0x100);
+	msg.channel = 0;
+	msg.timestamp = seq * 250;
+	for(uint8_t i = 0; i < msg.dataLength; ++i) {
+		msg.data[i] = (uint8_t)(i % 3 == 0 ? 0 : seq + i);
+	}
+	return msg;
+}
+
+bool TestCaptureDecode::isMsgEqual(const CanMsg &aRef, const CanMsg &bRef)
+{
+	return
+		aRef.id == bRef.id &&
+		aRef.dataLength == bRef.dataLength &&
+		aRef.timestamp == bRef.timestamp &&
+		aRef.flags == bRef.flags &&
+		aRef.channel == bRef.channel &&
+		memcmp(aRef.data, bRef.data, aRef.dataLength) == 0;
+}
+
+void TestCaptureDecode::initTestCase(void)
+{
+	uint8_t record[CaptureFormat::maxRecordSize];
+	uint8_t encoded[CaptureFormat::maxEncodedRecordSize];
+
+	this->capture.resize((size_t)CaptureFormat::fileHeaderSize);
+	CaptureFormat::writeFileHeader(this->capture.data(), 0);
+	for(size_t i = 0; i < benchmarkFrames; ++i) {
+		const size_t recordSize = CaptureFormat::encodeFrame(makeMsg(i), record);
+		const size_t encodedSize = CaptureFormat::encodeRecord(record, recordSize, encoded);
+		this->capture.insert(this->capture.end(), encoded, encoded + encodedSize);
+	}
+}
+
+void TestCaptureDecode::decodeRecordMatchesCobs(void)
+{
+	std::mt19937 random(1);
+	uint8_t record[300];
+	uint8_t encoded[COBS_ENCODE_DST_BUF_LEN_MAX(sizeof(record))];
+	uint8_t decoded[decodeBfrSize];
+
+	// up to 300 bytes crosses the 254 byte run limit, zero density varies per record
+	for(int round = 0; round < 200000; ++round) {
+		const size_t recordSize = 1 + random() % sizeof(record);
+		const unsigned zeroPercent = random() % 101;
+		for(size_t i = 0; i < recordSize; ++i) {
+			record[i] = random() % 100 < zeroPercent ? 0 : (uint8_t)(1 + random() % 255);
+		}
+		const cobs_encode_result encodeResult = cobs_encode(encoded, sizeof(encoded), record, recordSize);
+		QCOMPARE(encodeResult.status, COBS_ENCODE_OK);
+		QVERIFY(memchr(encoded, 0, encodeResult.out_len) == nullptr);
+
+		const size_t decodedSize = CaptureFormat::decodeRecord(encoded, encodeResult.out_len, decoded, sizeof(decoded));
+		QCOMPARE(decodedSize, recordSize);
+		QVERIFY(memcmp(decoded, record, recordSize) == 0);
+		// too small a destination is an error, not a cut off record
+		QCOMPARE(CaptureFormat::decodeRecord(encoded, encodeResult.out_len, decoded, recordSize - 1), (size_t)0);
+	}
+}
+
+void TestCaptureDecode::malformedMatchesCobs(void)
+{
+	std::mt19937 random(2);
+	uint8_t src[80];
+	uint8_t decoded[decodeBfrSize];
+	uint8_t cobsDecoded[decodeBfrSize];
+	size_t numOfOk = 0;
+
+	// what a torn or corrupted record looks like between two delimiters: any non zero bytes
+	for(int round = 0; round < 500000; ++round) {
+		const size_t srcSize = 1 + random() % sizeof(src);
+		const unsigned maxCode = round % 2 == 0 ? 16 : 255;
+		for(size_t i = 0; i < srcSize; ++i) {
+			src[i] = (uint8_t)(1 + random() % maxCode);
+		}
+		const size_t decodedSize = CaptureFormat::decodeRecord(src, srcSize, decoded, sizeof(decoded));
+		const cobs_decode_result cobsResult = cobs_decode(cobsDecoded, sizeof(cobsDecoded), src, srcSize);
+		if(cobsResult.status != COBS_DECODE_OK) {
+			QCOMPARE(decodedSize, (size_t)0);
+			continue;
+		}
+		QCOMPARE(decodedSize, cobsResult.out_len);
+		QVERIFY(memcmp(decoded, cobsDecoded, decodedSize) == 0);
+		++numOfOk;
+	}
+	// both outcomes were covered
+	QVERIFY(numOfOk > 1000);
+	QVERIFY(numOfOk < 499000);
+}
+
+void TestCaptureDecode::readerReadsEveryFrame(void)
+{
+	CaptureReader reader;
+	CanMsg msg;
+	size_t numOfMsg = 0;
+
+	QCOMPARE(reader.open(this->capture.data(), this->capture.size()), CaptureVersion::V1);
+	while(reader.next(msg)) {
+		QVERIFY(isMsgEqual(msg, makeMsg(numOfMsg)));
+		++numOfMsg;
+	}
+	QCOMPARE(numOfMsg, benchmarkFrames);
+	QCOMPARE(reader.getNumOfBadRecords(), (uint64_t)0);
+}
+
+/// Replay before: every byte looked at and appended on its own, cobs_decode per record.
+void TestCaptureDecode::benchmarkByteLoop(void)
+{
+	QVector<uint8_t> encodedVect;
+	uint8_t decoded[decodeBfrSize];
+	CanMsg msg;
+	size_t numOfMsg = 0;
+
+	QBENCHMARK {
+		numOfMsg = 0;
+		encodedVect.clear();
+		for(size_t pos = CaptureFormat::fileHeaderSize; pos < this->capture.size(); ++pos) {
+			const uint8_t byte = this->capture[pos];
+			if(byte != 0) {
+				encodedVect.append(byte);
+				continue;
+			}
+			const cobs_decode_result result = cobs_decode(decoded, sizeof(decoded), encodedVect.constData(), encodedVect.size());
+			if(result.status == COBS_DECODE_OK && CaptureFormat::decodeFrame(decoded, result.out_len, msg)) {
+				++numOfMsg;
+			}
+			encodedVect.clear();
+		}
+	}
+	QCOMPARE(numOfMsg, benchmarkFrames);
+}
+
+/// memchr splits records, cobs_decode decodes them.
+void TestCaptureDecode::benchmarkCobsDecode(void)
+{
+	uint8_t decoded[decodeBfrSize];
+	CanMsg msg;
+	size_t numOfMsg = 0;
+
+	QBENCHMARK {
+		numOfMsg = 0;
+		const uint8_t *startPtr = this->capture.data() + CaptureFormat::fileHeaderSize;
+		const uint8_t *capEndPtr = this->capture.data() + this->capture.size();
+		const uint8_t *endPtr = nullptr;
+		while((endPtr = static_cast<const uint8_t *>(memchr(startPtr, 0, capEndPtr - startPtr))) != nullptr) {
+			const cobs_decode_result result = cobs_decode(decoded, sizeof(decoded), startPtr, endPtr - startPtr);
+			if(result.status == COBS_DECODE_OK && CaptureFormat::decodeFrame(decoded, result.out_len, msg)) {
+				++numOfMsg;
+			}
+			startPtr = endPtr + 1;
+		}
+	}
+	QCOMPARE(numOfMsg, benchmarkFrames);
+}
+
+/// memchr splits records, decodeRecord decodes them, as CaptureReader does.
+void TestCaptureDecode::benchmarkDecodeRecord(void)
+{
+	uint8_t decoded[decodeBfrSize];
+	CanMsg msg;
+	size_t numOfMsg = 0;
+
+	QBENCHMARK {
+		numOfMsg = 0;
+		const uint8_t *startPtr = this->capture.data() + CaptureFormat::fileHeaderSize;
+		const uint8_t *capEndPtr = this->capture.data() + this->capture.size();
+		const uint8_t *endPtr = nullptr;
+		while((endPtr = static_cast<const uint8_t *>(memchr(startPtr, 0, capEndPtr - startPtr))) != nullptr) {
+			const size_t decodedSize = CaptureFormat::decodeRecord(startPtr, endPtr - startPtr, decoded, sizeof(decoded));
+			if(decodedSize != 0 && CaptureFormat::decodeFrame(decoded, decodedSize, msg)) {
+				++numOfMsg;
+			}
+			startPtr = endPtr + 1;
+		}
+	}
+	QCOMPARE(numOfMsg, benchmarkFrames);
+}
+
+/// Whole replay read path on one mapped window.
+void TestCaptureDecode::benchmarkCaptureReader(void)
+{
+	CaptureReader reader;
+	CanMsg msg;
+	size_t numOfMsg = 0;
+
+	QBENCHMARK {
+		numOfMsg = 0;
+		reader.open(this->capture.data(), this->capture.size());
+		while(reader.next(msg)) {
+			++numOfMsg;
+		}
+	}
+	QCOMPARE(numOfMsg, benchmarkFrames);
+}
+
+QTEST_GUILESS_MAIN(TestCaptureDecode)
+
+#include "tst_capturedecode.moc"
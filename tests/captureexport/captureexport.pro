@@ -0,0 +1,20 @@
+include(../tests.pri)
+
+# Frames exported as candump and ASC and read back, plus formatting against snprintf.
+TARGET = tst_captureexport
+
+SOURCES += \
+    tst_captureexport.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/captureexport.cpp \
+    $$SRC_ROOT/logic/capture/capturetext.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/bufferedwriter.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    $$SRC_ROOT/logic/capture/captureexport.h \
+    $$SRC_ROOT/logic/capture/capturetext.h \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/bufferedwriter.h
@@ -0,0 +1,205 @@
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "captureexport.h"
+#include "capturetext.h"
+
+/// @brief Frames exported as candump and ASC and read back by CaptureText, plus line formatting
+/// by hand against snprintf.
+class TestCaptureExport : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void roundTrip_data(void);
+	void roundTrip(void);
+	void benchmarkSnprintf(void);
+	void benchmarkFormatCandump(void);
+	void benchmarkFormatAsc(void);
+
+private:
+	static constexpr uint64_t startUs = 1746472200123456ULL;
+	static constexpr size_t benchmarkFrames = 256 * 1024;
+	QTemporaryDir tempDir;
+	std::vector<CanMsg> msgVec;       //!< every kind of frame the formats tell apart
+	std::vector<CanMsg> benchmarkVec; //!< classic frames of 8 bytes with a few FD ones
+	static CanMsg makeMsg(uint64_t timestamp, uint8_t channel, uint32_t id, uint8_t flags, uint8_t dataLength);
+	static QByteArray msgStr(const CanMsg &msgRef);
+	static size_t formatSnprintf(const CanMsg &canMsgRef, char *dstPtr);
+};
+
+/// Payload counts up from the id, so no two frames carry the same data.
+CanMsg TestCaptureExport::makeMsg(uint64_t timestamp, uint8_t channel, uint32_t id, uint8_t flags, uint8_t dataLength)
+{
+	CanMsg msg = {};
+
+	msg.timestamp = timestamp;
+	msg.channel = channel;
+	msg.id = id;
+	msg.flags = flags;
+	msg.dataLength = dataLength;
+	for(uint8_t i = 0; i < dataLength; ++i) {
+		msg.data[i] = (uint8_t)(id + i * 0x11);
+	}
+	return msg;
+}
+
+/// Every field in one line, a mismatch shows which one differs.
+QByteArray TestCaptureExport::msgStr(const CanMsg &msgRef)
+{
+	char str[64];
+
+	snprintf(
+		str,
+		sizeof(str),
+		"%llu ch%u %X fl%02X len%u ",
+		(unsigned long long)msgRef.timestamp,
+		msgRef.channel,
+		msgRef.id,
+		msgRef.flags,
+		msgRef.dataLength
+	);
+	return QByteArray(str) + QByteArray(reinterpret_cast<const char *>(msgRef.data), msgRef.dataLength).toHex();
+}
+
+/// candump line as printf would write it, the baseline for formatting by hand.
+size_t TestCaptureExport::formatSnprintf(const CanMsg &canMsgRef, char *dstPtr)
+{
+	int size = snprintf(
+		dstPtr,
+		CaptureExport::maxLineSize,
+		(canMsgRef.flags & CanMsgFlagExtended) ? "(%llu.%06llu) can%u %08X#" : "(%llu.%06llu) can%u %03X#",
+		(unsigned long long)(canMsgRef.timestamp / 1000000),
+		(unsigned long long)(canMsgRef.timestamp % 1000000),
+		canMsgRef.channel,
+		canMsgRef.id
+	);
+	for(uint8_t i = 0; i < canMsgRef.dataLength; ++i) {
+		size += snprintf(dstPtr + size, CaptureExport::maxLineSize - size, "%02X", canMsgRef.data[i]);
+	}
+	size += snprintf(dstPtr + size, CaptureExport::maxLineSize - size, (canMsgRef.flags & CanMsgFlagTx) ? " T\n" : " R\n");
+	return size;
+}
+
+void TestCaptureExport::initTestCase(void)
+{
+	const uint8_t fdFlags[] = { 0, CanMsgFlagBrs, CanMsgFlagEsi, CanMsgFlagBrs | CanMsgFlagEsi };
+	const uint8_t fdLengths[] = { 0, 8, 12, 20, 64 };
+	uint64_t timestamp = startUs;
+
+	QVERIFY(this->tempDir.isValid());
+	// candump numbers interfaces as they show up, channel 0 has to come first
+	for(uint8_t channel = 0; channel < 2; ++channel) {
+		for(uint8_t dataLength = 0; dataLength <= 8; ++dataLength) {
+			this->msgVec.push_back(makeMsg(timestamp += 1, channel, 0x7FF - dataLength, 0, dataLength));
+			this->msgVec.push_back(makeMsg(timestamp += 250, channel, 0x1FFFFFF0 + dataLength, CanMsgFlagExtended | CanMsgFlagTx, dataLength));
+		}
+		this->msgVec.push_back(makeMsg(timestamp += 1000000, channel, 0x000, 0, 1));
+		this->msgVec.push_back(makeMsg(timestamp += 999999, channel, 0x123, CanMsgFlagRtr, 0));
+		this->msgVec.push_back(makeMsg(timestamp += 7, channel, 0x00000123, CanMsgFlagExtended | CanMsgFlagRtr | CanMsgFlagTx, 0));
+		for(uint8_t flags : fdFlags) {
+			for(uint8_t dataLength : fdLengths) {
+				this->msgVec.push_back(makeMsg(timestamp += 12345, channel, 0x700 + dataLength, CanMsgFlagFd | flags, dataLength));
+				this->msgVec.push_back(makeMsg(timestamp += 3, channel, 0x18DA00F1 + dataLength, CanMsgFlagFd | CanMsgFlagExtended | CanMsgFlagTx | flags, dataLength));
+			}
+		}
+	}
+	for(size_t i = 0; i < benchmarkFrames; ++i) {
+		const bool isFd = i % 16 == 0;
+		this->benchmarkVec.push_back(makeMsg(startUs + i * 250, 0, 0x100 + i % 0x600, isFd ? CanMsgFlagFd | CanMsgFlagBrs : 0, isFd ? 64 : 8));
+	}
+}
+
+void TestCaptureExport::roundTrip_data(void)
+{
+	QTest::addColumn<QString>("fileName");
+	QTest::addColumn<int>("format");
+
+	QTest::newRow("candump") << QString("export.log") << (int)CaptureTextFormat::Candump;
+	QTest::newRow("asc") << QString("export.asc") << (int)CaptureTextFormat::Asc;
+}
+
+void TestCaptureExport::roundTrip(void)
+{
+	QFETCH(QString, fileName);
+	QFETCH(int, format);
+	const QString filePath = this->tempDir.filePath(fileName);
+	CaptureExport captureExport;
+	CaptureText captureText;
+	CanMsg msg;
+	size_t numOfMsg = 0;
+
+	QVERIFY(captureExport.open(filePath));
+	for(const CanMsg &msgRef : this->msgVec) {
+		captureExport.write(msgRef);
+	}
+	captureExport.close();
+	QCOMPARE(captureExport.getNumOfFrames(), (uint64_t)this->msgVec.size());
+
+	QVERIFY(captureText.open(filePath));
+	QCOMPARE((int)captureText.getFormat(), format);
+	while(captureText.next(msg)) {
+		QVERIFY(numOfMsg < this->msgVec.size());
+		CanMsg expected = this->msgVec[numOfMsg++];
+		// ASC time starts at the first frame
+		if(format == (int)CaptureTextFormat::Asc) {
+			expected.timestamp -= startUs + 1;
+		}
+		QCOMPARE(msgStr(msg), msgStr(expected));
+	}
+	QCOMPARE(numOfMsg, this->msgVec.size());
+	QCOMPARE(captureText.getNumOfBadRecords(), (uint64_t)0);
+}
+
+/// Baseline: one snprintf per line and data byte.
+void TestCaptureExport::benchmarkSnprintf(void)
+{
+	std::vector<char> bfr(CaptureExport::maxLineSize);
+	uint64_t numOfBytes = 0;
+
+	QBENCHMARK {
+		numOfBytes = 0;
+		for(const CanMsg &msgRef : this->benchmarkVec) {
+			numOfBytes += formatSnprintf(msgRef, bfr.data());
+		}
+	}
+	QVERIFY(numOfBytes > benchmarkFrames * 30);
+}
+
+void TestCaptureExport::benchmarkFormatCandump(void)
+{
+	std::vector<char> bfr(CaptureExport::maxLineSize);
+	std::vector<char> snprintfBfr(CaptureExport::maxLineSize);
+	uint64_t numOfBytes = 0;
+
+	// a classic frame comes out as printf writes it
+	const size_t size = CaptureExport::formatCandump(this->benchmarkVec[1], bfr.data());
+	QCOMPARE(QByteArray(bfr.data(), size), QByteArray(snprintfBfr.data(), formatSnprintf(this->benchmarkVec[1], snprintfBfr.data())));
+	QBENCHMARK {
+		numOfBytes = 0;
+		for(const CanMsg &msgRef : this->benchmarkVec) {
+			numOfBytes += CaptureExport::formatCandump(msgRef, bfr.data());
+		}
+	}
+	QVERIFY(numOfBytes > benchmarkFrames * 30);
+}
+
+void TestCaptureExport::benchmarkFormatAsc(void)
+{
+	std::vector<char> bfr(CaptureExport::maxLineSize);
+	uint64_t numOfBytes = 0;
+
+	QBENCHMARK {
+		numOfBytes = 0;
+		for(const CanMsg &msgRef : this->benchmarkVec) {
+			numOfBytes += CaptureExport::formatAsc(msgRef, startUs, bfr.data());
+		}
+	}
+	QVERIFY(numOfBytes > benchmarkFrames * 30);
+}
+
+QTEST_GUILESS_MAIN(TestCaptureExport)
+
+#include "tst_captureexport.moc"
@@ -0,0 +1,24 @@
+include(../tests.pri)
+
+# Capture .idx: written along, built on demand, lookups and seeks, stale or cut indexes rebuilt.
+TARGET = tst_captureindex
+
+SOURCES += \
+    tst_captureindex.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/capturefile.cpp \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/capture/captureindex.cpp \
+    $$SRC_ROOT/logic/capture/capturereader.cpp \
+    $$SRC_ROOT/logic/capture/capturestream.cpp \
+    $$SRC_ROOT/logic/capture/capturetext.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    ../testcapture.h
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h
@@ -0,0 +1,312 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "captureindex.h"
+#include "capturestream.h"
+#include "testcapture.h"
+
+/// @brief .idx written along and built on demand, lookups in it and seeks through it, and
+/// stale or cut indexes being rebuilt.
+class TestCaptureIndex : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void builtOnDemand_data(void);
+	void builtOnDemand(void);
+	void writtenIndexIsRead(void);
+	void findBlock(void);
+	void seek_data(void);
+	void seek(void);
+	void staleIndexRebuilt_data(void);
+	void staleIndexRebuilt(void);
+
+private:
+	static constexpr uint64_t startUs = 1746472200000000ULL;
+	static constexpr uint64_t createdUs = 1746472200000000ULL;
+	static constexpr uint64_t numOfMsg = CaptureFormat::blockFrames * 5 + 123;
+	static constexpr uint32_t compressedBlockFrames = 1000;
+	static constexpr uint64_t blockGapUs = 5000;  //!< every blockFrames frames, seeks into it land on the next block
+	QTemporaryDir tempDir;
+	QString plainPath;
+	QString compressedPath;
+	std::vector<CanMsg> msgVec;
+	QByteArray plainIndex;       //!< .idx of plainPath as built on demand
+	static CanMsg makeFrame(uint64_t frame);
+	static QByteArray msgStr(const CanMsg &msgRef);
+	static QByteArray readFile(const QString &filePathRef);
+	static bool writeFile(const QString &filePathRef, const QByteArray &dataRef);
+	static uint64_t readHeaderField(const QByteArray &indexRef, int offset);
+	/// @brief Seeks to frames at block edges and in the gaps, by frame and by timestamp.
+	void checkSeeks(const QString &capturePathRef);
+};
+
+CanMsg TestCaptureIndex::makeFrame(uint64_t frame)
+{
+	const std::vector<uint8_t> data = { (uint8_t)frame, (uint8_t)(frame >> 8), (uint8_t)(frame >> 16) };
+
+	return TestCapture::makeMsg(0x100 + frame % 0x600, data, startUs + frame * 100 + frame / CaptureFormat::blockFrames * blockGapUs);
+}
+
+/// Every field in one line, a mismatch shows which one differs.
+QByteArray TestCaptureIndex::msgStr(const CanMsg &msgRef)
+{
+	char str[64];
+
+	snprintf(
+		str,
+		sizeof(str),
+		"%llu %X fl%02X len%u ",
+		(unsigned long long)msgRef.timestamp,
+		msgRef.id,
+		msgRef.flags,
+		msgRef.dataLength
+	);
+	return QByteArray(str) + QByteArray(reinterpret_cast<const char *>(msgRef.data), msgRef.dataLength).toHex();
+}
+
+QByteArray TestCaptureIndex::readFile(const QString &filePathRef)
+{
+	QFile file(filePathRef);
+
+	if(!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+	return file.readAll();
+}
+
+bool TestCaptureIndex::writeFile(const QString &filePathRef, const QByteArray &dataRef)
+{
+	QFile file(filePathRef);
+
+	return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(dataRef) == dataRef.size();
+}
+
+uint64_t TestCaptureIndex::readHeaderField(const QByteArray &indexRef, int offset)
+{
+	uint64_t value = 0;
+
+	memcpy(&value, indexRef.constData() + offset, sizeof(value));
+	return value;
+}
+
+void TestCaptureIndex::initTestCase(void)
+{
+	CaptureFile file;
+	CaptureIndex index;
+
+	QVERIFY(this->tempDir.isValid());
+	for(uint64_t i = 0; i < numOfMsg; ++i) {
+		this->msgVec.push_back(makeFrame(i));
+	}
+	this->plainPath = this->tempDir.filePath("plain.cobs");
+	this->compressedPath = this->tempDir.filePath("compressed.cobs");
+	QVERIFY(TestCapture::write(this->plainPath, this->msgVec, createdUs));
+	QVERIFY(TestCapture::writeCompressed(this->compressedPath, this->msgVec, createdUs, compressedBlockFrames));
+
+	QVERIFY(file.open(this->plainPath));
+	QVERIFY(index.load(file));
+	this->plainIndex = readFile(CaptureIndex::getPath(this->plainPath));
+	QVERIFY(!this->plainIndex.isEmpty());
+}
+
+void TestCaptureIndex::builtOnDemand_data(void)
+{
+	QTest::addColumn<bool>("isCompressed");
+
+	QTest::newRow("plain") << false;
+	QTest::newRow("compressed") << true;
+}
+
+/// Capture without .idx gets one on first load, with a block per block of the capture.
+void TestCaptureIndex::builtOnDemand(void)
+{
+	QFETCH(bool, isCompressed);
+	const QString capturePath = isCompressed ? this->compressedPath : this->plainPath;
+	const QString indexPath = CaptureIndex::getPath(capturePath);
+	const uint64_t blockFrames = isCompressed ? compressedBlockFrames : CaptureFormat::blockFrames;
+	const uint64_t numOfBlocks = (numOfMsg + blockFrames - 1) / blockFrames;
+	CaptureFile file;
+	CaptureIndex index;
+	CaptureBlockIndex block;
+
+	QFile::remove(indexPath);
+	QVERIFY(file.open(capturePath));
+	QVERIFY(index.load(file));
+	QCOMPARE(index.getNumOfFrames(), numOfMsg);
+	QCOMPARE(index.getFirstTimestamp(), this->msgVec.front().timestamp);
+	QCOMPARE(index.getLastTimestamp(), this->msgVec.back().timestamp);
+
+	const QByteArray indexFile = readFile(indexPath);
+	QCOMPARE(indexFile.size(), (int)(CaptureIndex::headerSize + numOfBlocks * CaptureFormat::blockIndexSize));
+	QCOMPARE(indexFile.left(8), QByteArray("UDSTIDX\0", 8));
+	QCOMPARE(readHeaderField(indexFile, 8) & 0xFFFF, (uint64_t)CaptureIndex::version);
+	QCOMPARE(readHeaderField(indexFile, 10) & 0xFFFF, (uint64_t)CaptureIndex::headerSize);
+	QCOMPARE(readHeaderField(indexFile, 12) & 0xFFFF, (uint64_t)CaptureFormat::blockIndexSize);
+	QCOMPARE(readHeaderField(indexFile, 16), file.getSize());
+	QCOMPARE(readHeaderField(indexFile, 24), numOfBlocks);
+	for(uint64_t i = 0; i < numOfBlocks; ++i) {
+		QVERIFY(CaptureFormat::decodeBlockIndex(
+			reinterpret_cast<const uint8_t *>(indexFile.constData()) + CaptureIndex::headerSize + i * CaptureFormat::blockIndexSize,
+			CaptureFormat::blockIndexSize,
+			block
+		));
+		const uint64_t lastFrame = qMin((i + 1) * blockFrames, numOfMsg) - 1;
+		QCOMPARE(block.firstFrame, i * blockFrames);
+		QCOMPARE((uint64_t)block.numOfFrames, lastFrame + 1 - i * blockFrames);
+		QCOMPARE(block.firstTimestamp, this->msgVec[i * blockFrames].timestamp);
+		QCOMPARE(block.lastTimestamp, this->msgVec[lastFrame].timestamp);
+	}
+}
+
+/// Index written along with the capture, as CanLog writes it, is read as is and not rebuilt.
+void TestCaptureIndex::writtenIndexIsRead(void)
+{
+	const QString indexPath = CaptureIndex::getPath(this->plainPath);
+	const uint64_t shiftUs = 7;
+	CaptureFile file;
+	CaptureIndex writer;
+	CaptureIndex index;
+	CaptureBlockIndex block;
+
+	QVERIFY(file.open(this->plainPath));
+	QVERIFY(writer.create(indexPath));
+	// timestamps moved a little, a rebuilt index would not have them
+	while(file.nextBlockIndex(block)) {
+		block.firstTimestamp += shiftUs;
+		block.lastTimestamp += shiftUs;
+		writer.append(block);
+	}
+	writer.finish(file.getSize());
+
+	QVERIFY(index.load(file));
+	QCOMPARE(index.getFirstTimestamp(), this->msgVec.front().timestamp + shiftUs);
+	QCOMPARE(index.getLastTimestamp(), this->msgVec.back().timestamp + shiftUs);
+	QCOMPARE(index.getNumOfFrames(), numOfMsg);
+	QVERIFY(writeFile(indexPath, this->plainIndex));
+}
+
+/// Lookups return the last block starting at or before what is looked for.
+void TestCaptureIndex::findBlock(void)
+{
+	const uint64_t blockFrames = CaptureFormat::blockFrames;
+	CaptureFile file;
+	CaptureIndex index;
+	CaptureBlockIndex block;
+
+	QVERIFY(!index.findFrame(0, block));
+	QVERIFY(!index.findTimestamp(0, block));
+	QVERIFY(file.open(this->plainPath));
+	QVERIFY(index.load(file));
+	for(uint64_t frame : { (uint64_t)0, (uint64_t)1, blockFrames - 1, blockFrames, blockFrames * 3 + 17, numOfMsg - 1, numOfMsg + 1000 }) {
+		const uint64_t firstFrame = qMin(frame, numOfMsg - 1) / blockFrames * blockFrames;
+		QVERIFY(index.findFrame(frame, block));
+		QCOMPARE(block.firstFrame, firstFrame);
+		if(frame < numOfMsg) {
+			QVERIFY(index.findTimestamp(this->msgVec[frame].timestamp, block));
+			QCOMPARE(block.firstFrame, firstFrame);
+		}
+	}
+	// before the first block, and in the gap after a block which holds nothing later
+	QVERIFY(index.findTimestamp(0, block));
+	QCOMPARE(block.firstFrame, (uint64_t)0);
+	QVERIFY(index.findTimestamp(this->msgVec[blockFrames * 2 - 1].timestamp + 1, block));
+	QCOMPARE(block.firstFrame, blockFrames);
+	QVERIFY(index.findTimestamp(this->msgVec.back().timestamp + 1, block));
+	QCOMPARE(block.firstFrame, numOfMsg / blockFrames * blockFrames);
+}
+
+void TestCaptureIndex::checkSeeks(const QString &capturePathRef)
+{
+	const uint64_t blockFrames = CaptureFormat::blockFrames;
+	const std::vector<uint64_t> frameVec = {
+		blockFrames * 2, 0, numOfMsg - 1, blockFrames - 1, blockFrames, compressedBlockFrames,
+		compressedBlockFrames - 1, blockFrames * 4 + 1, 1, numOfMsg / 2
+	};
+	CaptureStream stream;
+	CanMsg msg;
+
+	QVERIFY2(stream.open(capturePathRef), qPrintable(stream.errorString()));
+	for(uint64_t frame : frameVec) {
+		QVERIFY2(stream.seekFrame(frame), qPrintable(QString("frame %1").arg(frame)));
+		QCOMPARE(stream.getFrame(), frame);
+		QVERIFY(stream.next(msg));
+		QCOMPARE(msgStr(msg), msgStr(this->msgVec[frame]));
+
+		QVERIFY2(stream.seekTimestamp(this->msgVec[frame].timestamp), qPrintable(QString("timestamp of frame %1").arg(frame)));
+		QCOMPARE(stream.getFrame(), frame);
+		QVERIFY(stream.next(msg));
+		QCOMPARE(msgStr(msg), msgStr(this->msgVec[frame]));
+	}
+	// timestamp in the gap after a block lands on first frame of the next one
+	QVERIFY(stream.seekTimestamp(this->msgVec[blockFrames * 3 - 1].timestamp + 1));
+	QCOMPARE(stream.getFrame(), blockFrames * 3);
+	QVERIFY(stream.next(msg));
+	QCOMPARE(msgStr(msg), msgStr(this->msgVec[blockFrames * 3]));
+	QVERIFY(!stream.seekFrame(numOfMsg));
+	QVERIFY(!stream.seekTimestamp(this->msgVec.back().timestamp + 1));
+	QCOMPARE(stream.getNumOfFrames(), numOfMsg);
+}
+
+void TestCaptureIndex::seek_data(void)
+{
+	QTest::addColumn<bool>("isCompressed");
+
+	QTest::newRow("plain") << false;
+	QTest::newRow("compressed") << true;
+}
+
+void TestCaptureIndex::seek(void)
+{
+	QFETCH(bool, isCompressed);
+
+	checkSeeks(isCompressed ? this->compressedPath : this->plainPath);
+}
+
+void TestCaptureIndex::staleIndexRebuilt_data(void)
+{
+	QByteArray index;
+
+	QTest::addColumn<bool>("isPresent");
+	QTest::addColumn<QByteArray>("index");
+
+	QTest::newRow("missing") << false << QByteArray();
+	QTest::newRow("empty") << true << QByteArray();
+	index = this->plainIndex;
+	index.replace(16, 8, QByteArray(8, '\0'));
+	QTest::newRow("unfinished") << true << index;
+	index = this->plainIndex;
+	index[16] = (char)(index[16] - 1);
+	QTest::newRow("other capture size") << true << index;
+	index = this->plainIndex;
+	index[8] = 1;
+	QTest::newRow("older version") << true << index;
+	QTest::newRow("cut in header") << true << this->plainIndex.left(20);
+	QTest::newRow("header only") << true << this->plainIndex.left(CaptureIndex::headerSize);
+	QTest::newRow("cut after an entry") << true << this->plainIndex.left(this->plainIndex.size() - CaptureFormat::blockIndexSize);
+	QTest::newRow("cut in an entry") << true << this->plainIndex.left(this->plainIndex.size() - 5);
+	QTest::newRow("entry too many") << true << this->plainIndex + this->plainIndex.right(CaptureFormat::blockIndexSize);
+}
+
+/// Seeks over an .idx that does not belong to the capture as it is land right, and leave an
+/// index behind that matches one built from scratch.
+void TestCaptureIndex::staleIndexRebuilt(void)
+{
+	QFETCH(bool, isPresent);
+	QFETCH(QByteArray, index);
+	const QString indexPath = CaptureIndex::getPath(this->plainPath);
+
+	QFile::remove(indexPath);
+	if(isPresent) {
+		QVERIFY(writeFile(indexPath, index));
+	}
+	checkSeeks(this->plainPath);
+	QCOMPARE(readFile(indexPath).toHex(), this->plainIndex.toHex());
+}
+
+QTEST_GUILESS_MAIN(TestCaptureIndex)
+
+#include "tst_captureindex.moc"
@@ -0,0 +1,29 @@
+include(../tests.pri)
+
+# Captures and traces cut short near their end, repaired to their last complete record or line.
+TARGET = tst_capturerepair
+
+SOURCES += \
+    tst_capturerepair.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/capturefile.cpp \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/capture/captureindex.cpp \
+    $$SRC_ROOT/logic/capture/capturereader.cpp \
+    $$SRC_ROOT/logic/capture/capturerepair.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/uds/uds.cpp \
+    $$SRC_ROOT/logic/uds/gen/uds_def.cpp \
+    $$SRC_ROOT/logic/rotation.cpp \
+    $$SRC_ROOT/logic/traceuds.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    ../testcapture.h
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/uds/uds.h \
+    $$SRC_ROOT/logic/traceuds.h
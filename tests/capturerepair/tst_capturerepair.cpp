@@ -0,0 +1,322 @@
+#include <QByteArray>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <vector>
+#include "capturerepair.h"
+#include "testcapture.h"
+#include "traceuds.h"
+#include "uds.h"
+
+/// @brief Captures and traces cut short at every byte near their end, as a crash or a power loss
+/// leaves them, repaired to their last complete record or line. A second repair finds nothing to do.
+class TestCaptureRepair : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void completeIsLeftAlone(void);
+	void cutWithinRecord_data(void);
+	void cutWithinRecord(void);
+	void cutWithinZeroFill_data(void);
+	void cutWithinZeroFill(void);
+	void headerOnly(void);
+	void cutWithinHeader(void);
+	void notACapture(void);
+	void traceCutMidLine_data(void);
+	void traceCutMidLine(void);
+
+private:
+	static constexpr uint64_t createdUs = 1746472200000000ULL;
+	static constexpr int zeroFillSize = 4096;  //!< what a file system may leave after a power loss
+	QTemporaryDir tempDir;
+	QByteArray capture;            //!< plain V1 capture, ends with a block index record
+	QByteArray compressed;         //!< compressed V1 capture
+	QByteArray traceJson;          //!< complete trace of a few packets
+	QByteArray traceHtml;
+	qsizetype traceJsonBodyEnd;    //!< where the footer starts
+	qsizetype traceHtmlBodyEnd;
+	static QByteArray readFile(const QString &filePathRef);
+	static bool writeFile(const QString &filePathRef, const QByteArray &dataRef);
+	/// Size a capture cut to cutSize at most is repaired to.
+	static qsizetype getRepairedSize(const QByteArray &captureRef, qsizetype cutSize, bool isZeroFilled);
+	void checkRepair(const QString &filePathRef, RepairResult result, uint64_t droppedBytes, const QByteArray &expectedRef);
+};
+
+QByteArray TestCaptureRepair::readFile(const QString &filePathRef)
+{
+	QFile file(filePathRef);
+
+	if(!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+	return file.readAll();
+}
+
+bool TestCaptureRepair::writeFile(const QString &filePathRef, const QByteArray &dataRef)
+{
+	QFile file(filePathRef);
+
+	return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(dataRef) == dataRef.size();
+}
+
+/// Records end with their delimiter. One that lost it is dropped, unless a zero of the fill
+/// took its place and it still decodes.
+qsizetype TestCaptureRepair::getRepairedSize(const QByteArray &captureRef, qsizetype cutSize, bool isZeroFilled)
+{
+	if(isZeroFilled && cutSize < captureRef.size() && captureRef[cutSize] == 0) {
+		return cutSize + 1;
+	}
+	const qsizetype lastZero = captureRef.lastIndexOf('\0', cutSize - 1);
+	return lastZero >= (qsizetype)CaptureFormat::fileHeaderSize ? lastZero + 1 : (qsizetype)CaptureFormat::fileHeaderSize;
+}
+
+void TestCaptureRepair::checkRepair(const QString &filePathRef, RepairResult result, uint64_t droppedBytes, const QByteArray &expectedRef)
+{
+	const qint64 size = QFileInfo(filePathRef).size();
+	uint64_t dropped = 0;
+	QString errorStr;
+
+	QCOMPARE(CaptureRepair::repair(filePathRef, dropped, errorStr), result);
+	QCOMPARE(dropped, droppedBytes);
+	QCOMPARE(readFile(filePathRef), expectedRef);
+	QVERIFY(size >= expectedRef.size());
+	// repaired file is complete
+	QCOMPARE(CaptureRepair::repair(filePathRef, dropped, errorStr), RepairResult::Complete);
+	QCOMPARE(dropped, (uint64_t)0);
+	QCOMPARE(readFile(filePathRef), expectedRef);
+}
+
+void TestCaptureRepair::initTestCase(void)
+{
+	std::vector<CanMsg> msgVec;
+	const QString basePath = this->tempDir.filePath("trace");
+	TraceUds traceUds(nullptr);
+	Uds uds;
+	QByteArray json;
+	QByteArray html;
+	uint64_t byteIdx = 0;
+
+	QVERIFY(this->tempDir.isValid());
+	for(int i = 0; i < 10000; ++i) {
+		std::vector<uint8_t> data;
+		for(int n = 0; n < i % 9; ++n) {
+			data.push_back((uint8_t)(i + n));
+		}
+		msgVec.push_back(TestCapture::makeMsg(0x700 + i % 0x100, data, i * 500));
+	}
+	QVERIFY(TestCapture::write(this->tempDir.filePath("plain.cobs"), msgVec, createdUs));
+	QVERIFY(TestCapture::writeCompressed(this->tempDir.filePath("compressed.cobs"), msgVec, createdUs, 1000));
+	this->capture = readFile(this->tempDir.filePath("plain.cobs"));
+	this->compressed = readFile(this->tempDir.filePath("compressed.cobs"));
+	QVERIFY(this->capture.endsWith('\0'));
+	QVERIFY(this->compressed.endsWith('\0'));
+
+	// requests and responses of ReadDataByIdentifier as the decoder hands them over
+	traceUds.openBase(basePath);
+	for(int i = 0; i < 6; ++i) {
+		const bool isReq = i % 2 == 0;
+		UdsPacket packet;
+		packet.isReq = isReq;
+		packet.isCaptureTime = true;
+		packet.timestampUs = createdUs + i * 1000;
+		if(isReq) {
+			uds.getReqInfo({ 0x22, 0xF1, (uint8_t)(0x90 + i) }, packet.packetInfo);
+		} else {
+			uds.getRespInfo({ 0x62, 0xF1, (uint8_t)(0x90 + i), 0x57, 0x30, 0x4C }, packet.packetInfo);
+		}
+		TraceUds::render(packet, byteIdx, json, html);
+		traceUds.writeRendered(json.constData(), json.size(), html.constData(), html.size());
+		json.clear();
+		html.clear();
+	}
+	traceUds.close();
+	this->traceJson = readFile(basePath + ".json");
+	this->traceHtml = readFile(basePath + ".html");
+	// footer starts right after the last packet
+	this->traceJsonBodyEnd = this->traceJson.size() - QByteArray("]}\n").size();
+	this->traceHtmlBodyEnd = this->traceHtml.lastIndexOf("</li>\n") + 6;
+	QVERIFY(this->traceJson.endsWith("]}\n"));
+	QVERIFY(this->traceHtml.endsWith("</html>\n\n"));
+}
+
+void TestCaptureRepair::completeIsLeftAlone(void)
+{
+	const QString filePath = this->tempDir.filePath("complete.cobs");
+
+	QVERIFY(writeFile(filePath, this->capture));
+	checkRepair(filePath, RepairResult::Complete, 0, this->capture);
+	QVERIFY(writeFile(filePath, this->compressed));
+	checkRepair(filePath, RepairResult::Complete, 0, this->compressed);
+}
+
+void TestCaptureRepair::cutWithinRecord_data(void)
+{
+	QTest::addColumn<QByteArray>("captureBytes");
+	QTest::addColumn<qlonglong>("startSize");
+
+	// block index record and the last few frame records before it
+	QTest::newRow("plain") << this->capture << (qlonglong)(this->capture.size() - 160);
+	// last compressed block record, from the end of the one before it
+	const qsizetype lastRecordStart = this->compressed.lastIndexOf('\0', this->compressed.size() - 2) + 1;
+	QTest::newRow("compressed") << this->compressed << (qlonglong)(lastRecordStart - 16);
+}
+
+/// A crash of the writer, the record it was writing stays without delimiter. Every cut from
+/// startSize up to and including the complete file.
+void TestCaptureRepair::cutWithinRecord(void)
+{
+	QFETCH(QByteArray, captureBytes);
+	QFETCH(qlonglong, startSize);
+	const QString filePath = this->tempDir.filePath("cut.cobs");
+
+	for(qsizetype cutSize = startSize; cutSize <= captureBytes.size() && !QTest::currentTestFailed(); ++cutSize) {
+		const qsizetype repairedSize = getRepairedSize(captureBytes, cutSize, false);
+
+		QVERIFY(writeFile(filePath, captureBytes.left(cutSize)));
+		checkRepair(
+			filePath,
+			repairedSize == cutSize ? RepairResult::Complete : RepairResult::Repaired,
+			cutSize - repairedSize,
+			captureBytes.left(repairedSize)
+		);
+	}
+}
+
+void TestCaptureRepair::cutWithinZeroFill_data(void)
+{
+	cutWithinRecord_data();
+}
+
+/// The file grew on disk but its last blocks never got written, zeros follow the cut.
+/// A record cut short right before them looks delimited, it does not decode.
+void TestCaptureRepair::cutWithinZeroFill(void)
+{
+	QFETCH(QByteArray, captureBytes);
+	QFETCH(qlonglong, startSize);
+	const QString filePath = this->tempDir.filePath("zerofill.cobs");
+
+	for(qsizetype cutSize = startSize; cutSize <= captureBytes.size() && !QTest::currentTestFailed(); ++cutSize) {
+		const qsizetype repairedSize = getRepairedSize(captureBytes, cutSize, true);
+
+		QVERIFY(writeFile(filePath, captureBytes.left(cutSize) + QByteArray(zeroFillSize, '\0')));
+		checkRepair(filePath, RepairResult::Repaired, cutSize + zeroFillSize - repairedSize, captureBytes.left(repairedSize));
+	}
+}
+
+void TestCaptureRepair::headerOnly(void)
+{
+	const QString filePath = this->tempDir.filePath("header.cobs");
+	const QByteArray header = this->capture.left(CaptureFormat::fileHeaderSize);
+
+	QVERIFY(writeFile(filePath, header));
+	checkRepair(filePath, RepairResult::Complete, 0, header);
+	QVERIFY(writeFile(filePath, header + QByteArray(zeroFillSize, '\0')));
+	checkRepair(filePath, RepairResult::Repaired, zeroFillSize, header);
+}
+
+/// No record made it to disk. A header without its creation time is written anew with the file
+/// time, one that has it loses the zero fill only.
+void TestCaptureRepair::cutWithinHeader(void)
+{
+	const QString filePath = this->tempDir.filePath("cutheader.cobs");
+	const QByteArray header = this->capture.left(CaptureFormat::fileHeaderSize);
+
+	for(qsizetype cutSize = 0; cutSize < header.size(); ++cutSize) {
+		for(const QByteArray &fill : { QByteArray(), QByteArray(zeroFillSize, '\0') }) {
+			const QByteArray cut = header.left(cutSize) + fill;
+			const bool hasCreatedUs = cut.size() >= header.size() &&
+				CaptureFormat::getCreatedUs(reinterpret_cast<const uint8_t *>(cut.constData()), cut.size()) == createdUs;
+			uint64_t dropped = 0;
+			QString errorStr;
+
+			QVERIFY(writeFile(filePath, cut));
+			if(hasCreatedUs) {
+				checkRepair(filePath, RepairResult::Repaired, fill.size() + cutSize - header.size(), header);
+				continue;
+			}
+			QCOMPARE(CaptureRepair::repair(filePath, dropped, errorStr), RepairResult::Repaired);
+			QCOMPARE(dropped, (uint64_t)cut.size());
+			const QByteArray repaired = readFile(filePath);
+			QCOMPARE(repaired.size(), header.size());
+			QCOMPARE(repaired.left(16), header.left(16));
+			QVERIFY(CaptureFormat::getCreatedUs(reinterpret_cast<const uint8_t *>(repaired.constData()), repaired.size()) > createdUs);
+			QCOMPARE(CaptureRepair::repair(filePath, dropped, errorStr), RepairResult::Complete);
+			QCOMPARE(readFile(filePath), repaired);
+		}
+	}
+}
+
+void TestCaptureRepair::notACapture(void)
+{
+	const QString filePath = this->tempDir.filePath("unknown.cobs");
+	QByteArray unknown = this->capture;
+	const QByteArray text("(1436509052.249713) vcan0 123#11223344\n");
+	uint64_t dropped = 0;
+	QString errorStr;
+
+	// a later version, or zero fill followed by something
+	unknown[8] = 2;
+	for(const QByteArray &data : { unknown, QByteArray(zeroFillSize, '\0') + this->capture }) {
+		errorStr.clear();
+		QVERIFY(writeFile(filePath, data));
+		QCOMPARE(CaptureRepair::repair(filePath, dropped, errorStr), RepairResult::Failed);
+		QVERIFY(!errorStr.isEmpty());
+		QCOMPARE(readFile(filePath), data);
+	}
+
+	// a trace is told from its first line, not its extension
+	errorStr.clear();
+	QVERIFY(writeFile(filePath + ".json", text));
+	QCOMPARE(TraceUds::repair(filePath + ".json", dropped, errorStr), RepairResult::Failed);
+	QVERIFY(!errorStr.isEmpty());
+	QCOMPARE(readFile(filePath + ".json"), text);
+}
+
+void TestCaptureRepair::traceCutMidLine_data(void)
+{
+	QTest::addColumn<QString>("extension");
+	QTest::addColumn<QByteArray>("trace");
+	QTest::addColumn<qlonglong>("bodyEnd");
+
+	QTest::newRow("json") << QString(".json") << this->traceJson << (qlonglong)this->traceJsonBodyEnd;
+	QTest::newRow("html") << QString(".html") << this->traceHtml << (qlonglong)this->traceHtmlBodyEnd;
+}
+
+/// Every cut from within the last two packet lines to the end of the footer.
+void TestCaptureRepair::traceCutMidLine(void)
+{
+	QFETCH(QString, extension);
+	QFETCH(QByteArray, trace);
+	QFETCH(qlonglong, bodyEnd);
+	const QString filePath = this->tempDir.filePath("cut" + extension);
+	const QByteArray footer = trace.mid(bodyEnd);
+	const QByteArray endMark = extension == ".json" ? QByteArray("]}") : QByteArray("</html>");
+	const qsizetype startSize = trace.lastIndexOf('\n', trace.lastIndexOf('\n', bodyEnd - 2) - 1);
+
+	QVERIFY(startSize > 0);
+	for(qsizetype cutSize = startSize; cutSize <= trace.size() && !QTest::currentTestFailed(); ++cutSize) {
+		const QByteArray cut = trace.left(cutSize);
+		uint64_t dropped = 0;
+		QString errorStr;
+
+		QVERIFY(writeFile(filePath, cut));
+		if(cut.trimmed().endsWith(endMark)) {
+			QCOMPARE(TraceUds::repair(filePath, dropped, errorStr), RepairResult::Complete);
+			QCOMPARE(readFile(filePath), cut);
+			continue;
+		}
+		// complete lines are kept, packets and footer alike, footer lines left go before the footer does
+		const qsizetype keptSize = qMin(cut.lastIndexOf('\n') + 1, (qsizetype)bodyEnd);
+		const QByteArray expected = cut.left(keptSize) + footer;
+		QCOMPARE(TraceUds::repair(filePath, dropped, errorStr), RepairResult::Repaired);
+		QCOMPARE(dropped, (uint64_t)(cutSize - keptSize));
+		QCOMPARE(readFile(filePath), expected);
+		QCOMPARE(TraceUds::repair(filePath, dropped, errorStr), RepairResult::Complete);
+		QCOMPARE(readFile(filePath), expected);
+	}
+}
+
+QTEST_GUILESS_MAIN(TestCaptureRepair)
+
+#include "tst_capturerepair.moc"
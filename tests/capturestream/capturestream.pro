@@ -0,0 +1,28 @@
+include(../tests.pri)
+
+# Rotated captures: rotation, manifest, reading and seeking segments as one stream, CanLog rollover.
+TARGET = tst_capturestream
+
+SOURCES += \
+    tst_capturestream.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/capturefile.cpp \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/capture/captureindex.cpp \
+    $$SRC_ROOT/logic/capture/capturereader.cpp \
+    $$SRC_ROOT/logic/capture/capturestream.cpp \
+    $$SRC_ROOT/logic/capture/capturetext.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/bufferedwriter.cpp \
+    $$SRC_ROOT/logic/canlog.cpp \
+    $$SRC_ROOT/logic/rotation.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    ../testcapture.h
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/canlog.h
@@ -0,0 +1,374 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+#include <cstdio>
+#include <vector>
+#include "canlog.h"
+#include "capturestream.h"
+#include "rotation.h"
+#include "testcapture.h"
+
+/// @brief Rotated captures: segment names and retention, the manifest, reading and seeking
+/// over all segments as one stream, and CanLog rolling a live capture over.
+class TestCaptureStream : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void rotationPath(void);
+	void rotationRetention(void);
+	void manifestRoundTrip(void);
+	void streamOverSegments_data(void);
+	void streamOverSegments(void);
+	void seekAcrossSegments_data(void);
+	void seekAcrossSegments(void);
+	void seekPassesCountedSegments(void);
+	void canLogRollsOver(void);
+
+private:
+	static constexpr uint64_t startUs = 1746472200000000ULL;
+	static constexpr uint64_t createdUs = 1746472200000000ULL;
+	static constexpr int numOfSegments = 4;
+	static constexpr uint64_t segmentFrames = 10000;   //!< a few blocks each
+	static constexpr uint64_t frameUs = 100;
+	static constexpr uint64_t segmentGapUs = 1000000;  //!< between last frame of a segment and first of next
+	QTemporaryDir tempDir;
+	std::vector<CanMsg> msgVec; //!< every frame of every segment in stream order
+	static CanMsg makeFrame(uint64_t frame);
+	static QByteArray msgStr(const CanMsg &msgRef);
+	/// @brief Segments of msgVec and their manifest in a directory of their own, returns manifest path.
+	QString writeSegments(const QString &dirNameRef, bool isCompressed);
+};
+
+/// Timestamps step by frameUs within a segment and jump by segmentGapUs between segments.
+CanMsg TestCaptureStream::makeFrame(uint64_t frame)
+{
+	const uint64_t segment = frame / segmentFrames;
+	const std::vector<uint8_t> data = {
+		(uint8_t)frame, (uint8_t)(frame >> 8), (uint8_t)(frame >> 16), (uint8_t)segment
+	};
+
+	return TestCapture::makeMsg(0x100 + frame % 0x600, data, startUs + frame * frameUs + segment * segmentGapUs);
+}
+
+/// Every field in one line, a mismatch shows which one differs.
+QByteArray TestCaptureStream::msgStr(const CanMsg &msgRef)
+{
+	char str[64];
+
+	snprintf(
+		str,
+		sizeof(str),
+		"%llu %X fl%02X len%u ",
+		(unsigned long long)msgRef.timestamp,
+		msgRef.id,
+		msgRef.flags,
+		msgRef.dataLength
+	);
+	return QByteArray(str) + QByteArray(reinterpret_cast<const char *>(msgRef.data), msgRef.dataLength).toHex();
+}
+
+QString TestCaptureStream::writeSegments(const QString &dirNameRef, bool isCompressed)
+{
+	const QDir dir(this->tempDir.filePath(dirNameRef));
+	QStringList segmentList;
+
+	if(!QDir(this->tempDir.path()).mkpath(dirNameRef)) {
+		return QString();
+	}
+	for(int i = 0; i < numOfSegments; ++i) {
+		const std::vector<CanMsg> segmentVec(this->msgVec.begin() + i * segmentFrames, this->msgVec.begin() + (i + 1) * segmentFrames);
+		const QString segmentPath = dir.filePath(QString("seg_%1.cobs").arg(i, 3, 10, QChar('0')));
+		const bool isWritten = isCompressed ?
+			TestCapture::writeCompressed(segmentPath, segmentVec, createdUs, CaptureFormat::blockFrames) :
+			TestCapture::write(segmentPath, segmentVec, createdUs);
+		if(!isWritten) {
+			return QString();
+		}
+		segmentList.append(segmentPath);
+	}
+	const QString manifestPath = dir.filePath("seg" + CaptureStream::manifestExt);
+	return CaptureStream::writeManifest(manifestPath, segmentList) ? manifestPath : QString();
+}
+
+void TestCaptureStream::initTestCase(void)
+{
+	QVERIFY(this->tempDir.isValid());
+	for(uint64_t i = 0; i < numOfSegments * segmentFrames; ++i) {
+		this->msgVec.push_back(makeFrame(i));
+	}
+}
+
+void TestCaptureStream::rotationPath(void)
+{
+	Rotation rotation;
+
+	// rotation off keeps the single file name of before
+	rotation.configure(0, 0, 0);
+	rotation.start("/logs/20250505_190901");
+	QVERIFY(!rotation.isEnabled());
+	QCOMPARE(rotation.getPath(".cobs"), QString("/logs/20250505_190901.cobs"));
+	QVERIFY(!rotation.isDue(1ULL << 40));
+
+	rotation.configure(1000, 0, 0);
+	rotation.start("/logs/20250505_190901");
+	QVERIFY(rotation.isEnabled());
+	QCOMPARE(rotation.getPath(".cobs"), QString("/logs/20250505_190901_000.cobs"));
+	QVERIFY(!rotation.isDue(999));
+	QVERIFY(rotation.isDue(1000));
+	rotation.next();
+	QCOMPARE(rotation.getSegment(), 1u);
+	QCOMPARE(rotation.getPath(".cobs"), QString("/logs/20250505_190901_001.cobs"));
+	QCOMPARE(rotation.getPath(".cobs", 1234), QString("/logs/20250505_190901_1234.cobs"));
+	QCOMPARE(rotation.getBasePath(), QString("/logs/20250505_190901"));
+}
+
+/// Each segment opened removes the one that fell out of keep, with its index.
+void TestCaptureStream::rotationRetention(void)
+{
+	const unsigned keep = 3;
+	const QStringList extList = { ".cobs", CaptureIndex::getPath(".cobs") };
+	const QDir dir(this->tempDir.filePath("retention"));
+	Rotation rotation;
+
+	QVERIFY(QDir(this->tempDir.path()).mkpath("retention"));
+	rotation.configure(1000, 0, keep);
+	rotation.start(dir.filePath("base"));
+	for(unsigned segment = 0; segment < 8; ++segment) {
+		if(segment != 0) {
+			rotation.next();
+		}
+		for(const QString &extRef : extList) {
+			QFile file(rotation.getPath(extRef));
+			QVERIFY(file.open(QIODevice::WriteOnly));
+		}
+		const QStringList removedList = rotation.removeExpired(extList);
+		QCOMPARE(rotation.getFirstKept(), segment < keep ? 0u : segment - keep + 1);
+		if(segment < keep) {
+			QVERIFY(removedList.isEmpty());
+		} else {
+			QCOMPARE(removedList, QStringList({ rotation.getPath(".cobs", segment - keep), rotation.getPath(".cobs.idx", segment - keep) }));
+		}
+		for(unsigned kept = 0; kept <= segment; ++kept) {
+			const bool isKept = kept + keep > segment;
+			QCOMPARE(QFile::exists(rotation.getPath(".cobs", kept)), isKept);
+			QCOMPARE(QFile::exists(rotation.getPath(".cobs.idx", kept)), isKept);
+		}
+	}
+}
+
+void TestCaptureStream::manifestRoundTrip(void)
+{
+	const QDir dir(this->tempDir.filePath("manifest"));
+	const QString manifestPath = dir.filePath("base" + CaptureStream::manifestExt);
+	const QStringList segmentList = { dir.filePath("base_004.cobs"), dir.filePath("base_005.cobs"), dir.filePath("base_006.cobs") };
+	QStringList readList;
+
+	QVERIFY(QDir(this->tempDir.path()).mkpath("manifest"));
+	QVERIFY(CaptureStream::writeManifest(manifestPath, segmentList));
+	QVERIFY(CaptureStream::isManifest(manifestPath));
+	// names are relative, the directory can move
+	QFile manifestFile(manifestPath);
+	QVERIFY(manifestFile.open(QIODevice::ReadOnly | QIODevice::Text));
+	QCOMPARE(manifestFile.readAll(), QByteArray("UDSTMAN 1\nbase_004.cobs\nbase_005.cobs\nbase_006.cobs\n"));
+	manifestFile.close();
+	QVERIFY(CaptureStream::readManifest(manifestPath, readList));
+	QCOMPARE(readList, segmentList);
+
+	// rewritten as segments come and go, never appended to
+	QVERIFY(CaptureStream::writeManifest(manifestPath, segmentList.mid(1)));
+	QVERIFY(CaptureStream::readManifest(manifestPath, readList));
+	QCOMPARE(readList, segmentList.mid(1));
+
+	QFile captureFile(dir.filePath("base_004.cobs"));
+	QVERIFY(captureFile.open(QIODevice::WriteOnly));
+	QVERIFY(captureFile.write("UDSTCAP1") == 8);
+	captureFile.close();
+	QVERIFY(!CaptureStream::isManifest(captureFile.fileName()));
+	QVERIFY(!CaptureStream::readManifest(captureFile.fileName(), readList));
+}
+
+void TestCaptureStream::streamOverSegments_data(void)
+{
+	QTest::addColumn<bool>("isCompressed");
+
+	QTest::newRow("plain") << false;
+	QTest::newRow("compressed") << true;
+}
+
+void TestCaptureStream::streamOverSegments(void)
+{
+	QFETCH(bool, isCompressed);
+	const QString manifestPath = writeSegments(isCompressed ? "streamCompressed" : "streamPlain", isCompressed);
+	CaptureStream stream;
+	CanMsg msg;
+	uint64_t numOfMsg = 0;
+
+	QVERIFY(!manifestPath.isEmpty());
+	QVERIFY2(stream.open(manifestPath), qPrintable(stream.errorString()));
+	QCOMPARE(stream.getSegmentList().size(), numOfSegments);
+	QCOMPARE(stream.getNumOfFrames(), (uint64_t)this->msgVec.size());
+	QCOMPARE(stream.getFirstTimestamp(), this->msgVec.front().timestamp);
+	while(stream.next(msg) && !QTest::currentTestFailed()) {
+		QVERIFY(numOfMsg < this->msgVec.size());
+		QCOMPARE(msgStr(msg), msgStr(this->msgVec[numOfMsg]));
+		++numOfMsg;
+		QCOMPARE(stream.getFrame(), numOfMsg);
+	}
+	QCOMPARE(numOfMsg, (uint64_t)this->msgVec.size());
+	QCOMPARE(stream.getNumOfBadRecords(), (uint64_t)0);
+
+	QVERIFY(stream.rewind());
+	QVERIFY(stream.next(msg));
+	QCOMPARE(msgStr(msg), msgStr(this->msgVec.front()));
+}
+
+void TestCaptureStream::seekAcrossSegments_data(void)
+{
+	QTest::addColumn<bool>("isCompressed");
+
+	QTest::newRow("plain") << false;
+	QTest::newRow("compressed") << true;
+}
+
+/// Seeks to segment edges, block edges and the gaps between segments, in no particular order.
+void TestCaptureStream::seekAcrossSegments(void)
+{
+	QFETCH(bool, isCompressed);
+	const QString manifestPath = writeSegments(isCompressed ? "seekCompressed" : "seekPlain", isCompressed);
+	const uint64_t lastFrame = this->msgVec.size() - 1;
+	const std::vector<uint64_t> frameVec = {
+		segmentFrames * 2, 0, lastFrame, segmentFrames - 1, segmentFrames, CaptureFormat::blockFrames,
+		CaptureFormat::blockFrames - 1, segmentFrames * 3 + 1, segmentFrames + CaptureFormat::blockFrames * 2 + 7, 1
+	};
+	CaptureStream stream;
+	CanMsg msg;
+
+	QVERIFY(!manifestPath.isEmpty());
+	QVERIFY2(stream.open(manifestPath), qPrintable(stream.errorString()));
+	for(uint64_t frame : frameVec) {
+		const CanMsg &expectedRef = this->msgVec[frame];
+		QVERIFY2(stream.seekFrame(frame), qPrintable(QString("frame %1").arg(frame)));
+		QCOMPARE(stream.getFrame(), frame);
+		QVERIFY(stream.next(msg));
+		QCOMPARE(msgStr(msg), msgStr(expectedRef));
+
+		QVERIFY2(stream.seekTimestamp(expectedRef.timestamp), qPrintable(QString("timestamp of frame %1").arg(frame)));
+		QCOMPARE(stream.getFrame(), frame);
+		QVERIFY(stream.next(msg));
+		QCOMPARE(msgStr(msg), msgStr(expectedRef));
+		// reading on goes over into the next segment
+		if(frame != lastFrame) {
+			QVERIFY(stream.next(msg));
+			QCOMPARE(msgStr(msg), msgStr(this->msgVec[frame + 1]));
+		}
+	}
+	// a timestamp between two segments lands on first frame of the later one
+	for(int i = 1; i < numOfSegments; ++i) {
+		const uint64_t frame = i * segmentFrames;
+		QVERIFY(stream.seekTimestamp(this->msgVec[frame - 1].timestamp + 1));
+		QCOMPARE(stream.getFrame(), frame);
+		QVERIFY(stream.next(msg));
+		QCOMPARE(msgStr(msg), msgStr(this->msgVec[frame]));
+	}
+	QVERIFY(stream.seekTimestamp(0));
+	QCOMPARE(stream.getFrame(), (uint64_t)0);
+	QVERIFY(!stream.seekFrame(lastFrame + 1));
+	QVERIFY(!stream.seekTimestamp(this->msgVec.back().timestamp + 1));
+	QVERIFY(stream.errorString().isEmpty());
+}
+
+/// Once counted, a segment is passed by on its frame count and last timestamp: a seek behind
+/// segments removed meanwhile still lands, a seek into one of them fails.
+void TestCaptureStream::seekPassesCountedSegments(void)
+{
+	const QString manifestPath = writeSegments("counted", false);
+	const uint64_t frame = segmentFrames * 2 + 5;
+	CaptureStream stream;
+	CanMsg msg;
+
+	QVERIFY(!manifestPath.isEmpty());
+	QVERIFY2(stream.open(manifestPath), qPrintable(stream.errorString()));
+	QCOMPARE(stream.getNumOfFrames(), (uint64_t)this->msgVec.size());
+	for(const QString &segmentRef : stream.getSegmentList().mid(0, 2)) {
+		QVERIFY(QFile::remove(segmentRef));
+		QVERIFY(QFile::remove(CaptureIndex::getPath(segmentRef)));
+	}
+
+	QVERIFY2(stream.seekFrame(frame), qPrintable(stream.errorString()));
+	QCOMPARE(stream.getFrame(), frame);
+	QVERIFY(stream.next(msg));
+	QCOMPARE(msgStr(msg), msgStr(this->msgVec[frame]));
+	QVERIFY2(stream.seekTimestamp(this->msgVec[frame].timestamp), qPrintable(stream.errorString()));
+	QCOMPARE(stream.getFrame(), frame);
+	QCOMPARE(stream.getNumOfFrames(), (uint64_t)this->msgVec.size());
+
+	QVERIFY(!stream.seekFrame(5));
+	QVERIFY(!stream.errorString().isEmpty());
+}
+
+/// CanLog rolls a capture over by size and keeps the newest segments. Whatever is left reads
+/// back through the manifest as the tail of what was logged.
+void TestCaptureStream::canLogRollsOver(void)
+{
+	const unsigned keep = 4;
+	const uint64_t numOfMsg = 160 * 256;
+	const QDir dir(this->tempDir.filePath("canlog"));
+	StageQueue<CanMsg, CanFrameRing> frameQueue(4096);
+	QStringList segmentList;
+	CaptureStream stream;
+	CanMsg msg;
+	uint64_t numOfRead = 0;
+
+	QVERIFY(QDir(this->tempDir.path()).mkpath("canlog"));
+	{
+		CanLog canLog(&frameQueue);
+		canLog.setFlush(4096, 1);
+		canLog.setRotation(64 * 1024, 0, keep);
+		canLog.open(dir.path());
+		for(uint64_t i = 0; i < numOfMsg; i += 256) {
+			for(uint64_t j = i; j < i + 256; ++j) {
+				QVERIFY(frameQueue.push(makeFrame(j)));
+			}
+			canLog.onFramesReady();
+			// writer thread counts bytes written, rotation goes by them
+			QThread::msleep(1);
+		}
+		canLog.close();
+	}
+
+	const QStringList manifestList = dir.entryList({ "*" + CaptureStream::manifestExt }, QDir::Files);
+	QCOMPARE(manifestList.size(), 1);
+	QVERIFY(CaptureStream::readManifest(dir.filePath(manifestList.front()), segmentList));
+	QCOMPARE(segmentList.size(), (int)keep);
+	const QString basePath = dir.filePath(QFileInfo(manifestList.front()).completeBaseName());
+	const unsigned lastSegment = QFileInfo(segmentList.back()).completeBaseName().section('_', -1).toUInt();
+	QVERIFY2(lastSegment >= keep, qPrintable(QString("%1 segments").arg(lastSegment + 1)));
+	for(unsigned segment = 0; segment <= lastSegment; ++segment) {
+		const QString segmentPath = QString("%1_%2.cobs").arg(basePath).arg(segment, 3, 10, QChar('0'));
+		const bool isKept = segment + keep > lastSegment;
+		QCOMPARE(QFile::exists(segmentPath), isKept);
+		QCOMPARE(QFile::exists(CaptureIndex::getPath(segmentPath)), isKept);
+		if(isKept) {
+			QCOMPARE(segmentList[segment + keep - 1 - lastSegment], segmentPath);
+		}
+	}
+
+	QVERIFY2(stream.open(dir.filePath(manifestList.front())), qPrintable(stream.errorString()));
+	const uint64_t numOfFrames = stream.getNumOfFrames();
+	QVERIFY(numOfFrames > 0 && numOfFrames < numOfMsg);
+	const uint64_t firstKept = numOfMsg - numOfFrames;
+	while(stream.next(msg) && !QTest::currentTestFailed()) {
+		QCOMPARE(msgStr(msg), msgStr(makeFrame(firstKept + numOfRead)));
+		++numOfRead;
+	}
+	QCOMPARE(numOfRead, numOfFrames);
+	QCOMPARE(stream.getNumOfBadRecords(), (uint64_t)0);
+}
+
+QTEST_GUILESS_MAIN(TestCaptureStream)
+
+#include "tst_capturestream.moc"
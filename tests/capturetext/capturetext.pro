@@ -0,0 +1,13 @@
+include(../tests.pri)
+
+# trc, candump and ASC logs read as captures, every frame field checked, plus read throughput.
+TARGET = tst_capturetext
+
+SOURCES += \
+    tst_capturetext.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/capturetext.cpp
+
+HEADERS += \
+    $$SRC_ROOT/logic/capture/capturetext.h
@@ -0,0 +1,440 @@
+#include <QByteArray>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cstdio>
+#include <vector>
+#include "capturetext.h"
+
+/// @brief Text logs of other tools read as captures: every frame field checked per format, lines
+/// that are no frames skipped and broken frame lines counted, plus read throughput per format.
+class TestCaptureText : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void detectFormat(void);
+	void trcLegacy(void);
+	void trcColumns(void);
+	void candump(void);
+	void ascHex(void);
+	void ascDecRelative(void);
+	void benchmarkRead_data(void);
+	void benchmarkRead(void);
+
+private:
+	static constexpr int benchmarkLines = 1000000;  //!< read in under a second meets the 1M lines/s target
+	QTemporaryDir tempDir;
+	int numOfFiles;
+	QString writeFile(const QByteArray &textRef);
+	bool readAll(const QByteArray &textRef, CaptureTextFormat format, std::vector<CanMsg> &msgVecRef, uint64_t &numOfBadRef);
+	static CanMsg makeMsg(uint64_t timestamp, uint8_t channel, uint32_t id, uint8_t flags, const QByteArray &hexDataRef);
+	static QByteArray msgStr(const CanMsg &msgRef);
+	static QByteArray benchmarkText(CaptureTextFormat format);
+};
+
+QString TestCaptureText::writeFile(const QByteArray &textRef)
+{
+	const QString filePath = this->tempDir.filePath(QString("log_%1.txt").arg(this->numOfFiles++));
+	QFile file(filePath);
+
+	if(!file.open(QIODevice::WriteOnly) || file.write(textRef) != textRef.size()) {
+		return QString();
+	}
+	return filePath;
+}
+
+/// Reads every frame of textRef, false when it does not open as format.
+bool TestCaptureText::readAll(const QByteArray &textRef, CaptureTextFormat format, std::vector<CanMsg> &msgVecRef, uint64_t &numOfBadRef)
+{
+	CaptureText captureText;
+	CanMsg msg;
+
+	if(!captureText.open(writeFile(textRef)) || captureText.getFormat() != format) {
+		return false;
+	}
+	msgVecRef.clear();
+	while(captureText.next(msg)) {
+		msgVecRef.push_back(msg);
+	}
+	numOfBadRef = captureText.getNumOfBadRecords();
+	return true;
+}
+
+CanMsg TestCaptureText::makeMsg(uint64_t timestamp, uint8_t channel, uint32_t id, uint8_t flags, const QByteArray &hexDataRef)
+{
+	const QByteArray data = QByteArray::fromHex(hexDataRef);
+	CanMsg msg = {};
+
+	msg.timestamp = timestamp;
+	msg.channel = channel;
+	msg.id = id;
+	msg.flags = flags;
+	msg.dataLength = (uint8_t)data.size();
+	memcpy(msg.data, data.constData(), data.size());
+	return msg;
+}
+
+/// Every field in one line, a mismatch shows which one differs.
+QByteArray TestCaptureText::msgStr(const CanMsg &msgRef)
+{
+	char str[64];
+
+	snprintf(
+		str,
+		sizeof(str),
+		"%llu ch%u %X fl%02X len%u ",
+		(unsigned long long)msgRef.timestamp,
+		msgRef.channel,
+		msgRef.id,
+		msgRef.flags,
+		msgRef.dataLength
+	);
+	return QByteArray(str) + QByteArray(reinterpret_cast<const char *>(msgRef.data), msgRef.dataLength).toHex();
+}
+
+void TestCaptureText::initTestCase(void)
+{
+	QVERIFY(this->tempDir.isValid());
+	this->numOfFiles = 0;
+}
+
+void TestCaptureText::detectFormat(void)
+{
+	QCOMPARE(CaptureText::detect(";$FILEVERSION=2.1\n", 18), CaptureTextFormat::Trc);
+	QCOMPARE(CaptureText::detect("\n\n(1436509052.249713) vcan0 123#11\n", 35), CaptureTextFormat::Candump);
+	QCOMPARE(CaptureText::detect("date Mon May 5 07:10:00.000 pm 2025\n", 36), CaptureTextFormat::Asc);
+	QCOMPARE(CaptureText::detect("base hex  timestamps absolute\n", 30), CaptureTextFormat::Asc);
+	QCOMPARE(CaptureText::detect("// version 13.0.0\n", 18), CaptureTextFormat::Asc);
+	// a .cobs capture holds zero bytes, a parenthesis without a frame is no candump line
+	QCOMPARE(CaptureText::detect("(abc\0def", 8), CaptureTextFormat::Unknown);
+	QCOMPARE(CaptureText::detect("(1436509052.249713) started\n", 28), CaptureTextFormat::Unknown);
+	QCOMPARE(CaptureText::detect("hello\n", 6), CaptureTextFormat::Unknown);
+
+	CaptureText captureText;
+	QVERIFY(!captureText.open(writeFile("hello\n")));
+	QVERIFY(!captureText.errorString().isEmpty());
+}
+
+void TestCaptureText::trcLegacy(void)
+{
+	std::vector<CanMsg> msgVec;
+	uint64_t numOfBad = 0;
+
+	// 1.1 with CRLF line ends: warning line skipped, short data line is bad
+	QVERIFY(readAll(
+		";$FILEVERSION=1.1\r\n"
+		";$STARTTIME=43000.5\r\n"
+		";   Message Number\r\n"
+		";   |         Time Offset (ms)\r\n"
+		"     1)      1059.9  Rx         0300  8  00 00 00 00 04 00 00 00\r\n"
+		"     2)      1283.2  Tx     18EFC034  8  01 02 03 04 05 06 07 08\r\n"
+		"     3)      1300.0  Rx         0100  4  RTR\r\n"
+		"     4)      1400.0  Warng  FFFFFFFF  4  00 00 00 08  BUSHEAVY\r\n"
+		"     5)      1500.1  Rx         0200  8  01 02\r\n"
+		"     6)      1600.25 Rx         0201  1  7F\r\n",
+		CaptureTextFormat::Trc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)4);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(1059900, 0, 0x300, 0, "0000000004000000")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(1283200, 0, 0x18EFC034, CanMsgFlagExtended | CanMsgFlagTx, "0102030405060708")));
+	QCOMPARE(msgStr(msgVec[2]), msgStr(makeMsg(1300000, 0, 0x100, CanMsgFlagRtr, "")));
+	QCOMPARE(msgStr(msgVec[3]), msgStr(makeMsg(1600250, 0, 0x201, 0, "7F")));
+	QCOMPARE(numOfBad, (uint64_t)1);
+
+	// 1.0 has no version line and no direction
+	QVERIFY(readAll(
+		";##########################################################################\n"
+		";   Start time: 12.03.2024 10:00:00.000\n"
+		"     1)       100.0  0300  2  AA BB\n",
+		CaptureTextFormat::Trc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)1);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(100000, 0, 0x300, 0, "AABB")));
+
+	// 1.3 adds the bus and a reserved column, 8 id digits mark 29 bit ids even when the value is small
+	QVERIFY(readAll(
+		";$FILEVERSION=1.3\n"
+		"     1)       100.123 1  Rx        0401 -  3    11 22 33\n"
+		"     2)       200.000 2  Tx    00000401 -  0\n",
+		CaptureTextFormat::Trc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)2);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(100123, 0, 0x401, 0, "112233")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(200000, 1, 0x401, CanMsgFlagExtended | CanMsgFlagTx, "")));
+	QCOMPARE(numOfBad, (uint64_t)0);
+}
+
+void TestCaptureText::trcColumns(void)
+{
+	std::vector<CanMsg> msgVec;
+	uint64_t numOfBad = 0;
+
+	// 2.1 as written by PCAN-View: decimal DLC instead of length, FD types, status and error lines,
+	// offsets in milliseconds
+	QVERIFY(readAll(
+		";$FILEVERSION=2.1\n"
+		";$STARTTIME=45000.4166666667\n"
+		";$COLUMNS=N,O,T,B,I,d,R,L,D\n"
+		";\n"
+		"      1        12.345 DT 1      0123 Rx -  8    01 02 03 04 05 06 07 08\n"
+		"      2        13.000 FB 2  1ABCDEF0 Tx -  9    00 11 22 33 44 55 66 77 88 99 AA BB\n"
+		"      3        14.500 RR 1      0456 Rx -  4\n"
+		"      4        15.000 ST 1      Rx  00000004\n"
+		"      5        16.000 FE 1      0789 Rx -  2    AA BB\n"
+		"      6        17.000 BI 1      078A Rx -  15   " + QByteArray(64, 'x').replace("x", "5A ") + "\n"
+		"      7        18.000 DT 1      0123 Rx -  8    01 02\n"
+		"      8        19.000 ER 1      Rx  00 00 00 00 00\n"
+		"      9        20.000 FD 1      0124 Rx -  12   " + QByteArray(24, 'x').replace("x", "00 ") + "\n"
+		"     10        21.000 DT 1      0125 Rx -  G    00\n",
+		CaptureTextFormat::Trc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)6);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(12345, 0, 0x123, 0, "0102030405060708")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(13000, 1, 0x1ABCDEF0, CanMsgFlagExtended | CanMsgFlagFd | CanMsgFlagBrs | CanMsgFlagTx, "00112233445566778899AABB")));
+	QCOMPARE(msgStr(msgVec[2]), msgStr(makeMsg(14500, 0, 0x456, CanMsgFlagRtr, "")));
+	QCOMPARE(msgStr(msgVec[3]), msgStr(makeMsg(16000, 0, 0x789, CanMsgFlagFd | CanMsgFlagEsi, "AABB")));
+	QCOMPARE(msgStr(msgVec[4]), msgStr(makeMsg(17000, 0, 0x78A, CanMsgFlagFd | CanMsgFlagBrs | CanMsgFlagEsi, QByteArray(64, 'x').replace("x", "5A"))));
+	QCOMPARE(msgStr(msgVec[5]), msgStr(makeMsg(20000, 0, 0x124, CanMsgFlagFd, QByteArray(48, '0'))));
+	// short data and a DLC that is no number
+	QCOMPARE(numOfBad, (uint64_t)2);
+
+	// 2.0 has no $COLUMNS line, columns are fixed and give the length, not the DLC
+	QVERIFY(readAll(
+		";$FILEVERSION=2.0\n"
+		"      1         1.500 DT     0123 Rx 3  01 02 03\n"
+		"      2         2.000 FD     0124 Tx 12 00 01 02 03 04 05 06 07 08 09 0A 0B\n",
+		CaptureTextFormat::Trc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)2);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(1500, 0, 0x123, 0, "010203")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(2000, 0, 0x124, CanMsgFlagFd | CanMsgFlagTx, "000102030405060708090A0B")));
+	QCOMPARE(numOfBad, (uint64_t)0);
+
+	// columns in another order, without bus and direction
+	QVERIFY(readAll(
+		";$FILEVERSION=2.1\n"
+		";$COLUMNS=N,I,O,T,L,D\n"
+		"      1  0321     3.250 DT 2    AB CD\n",
+		CaptureTextFormat::Trc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)1);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(3250, 0, 0x321, 0, "ABCD")));
+}
+
+void TestCaptureText::candump(void)
+{
+	CaptureText captureText;
+	std::vector<CanMsg> msgVec;
+	uint64_t numOfBad = 0;
+	CanMsg msg;
+	const QByteArray text =
+		"(1436509052.249713) vcan0 123#11223344\n"
+		"(1436509052.250000) vcan0 12345678#DEADBEEF\n"
+		"(1436509052.300000) can1 123##311223344AABBCCDD\n"
+		"(1436509052.400000) vcan0 321#R\n"
+		"(1436509052.500000) vcan0 20000080#0000000000000000\n"
+		"(1436509052.600000) vcan0 7FF#0102 T\n"
+		"(1436509052.700000) vcan0 123#1G\n"
+		"(1436509052.800000) can1 124##10102 R\n"
+		"(1436509052.900000) vcan0 125#0102030405060708_C\n"
+		"(1436509053) vcan0 126#\n"
+		"(1436509053.1) vcan0 127#010203040506070809\n";
+
+	// remote, error frame, direction, FD flags, DLC suffix; bad hex and too long classic data
+	QVERIFY(readAll(text, CaptureTextFormat::Candump, msgVec, numOfBad));
+	QCOMPARE(msgVec.size(), (size_t)8);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(1436509052249713ULL, 0, 0x123, 0, "11223344")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(1436509052250000ULL, 0, 0x12345678, CanMsgFlagExtended, "DEADBEEF")));
+	QCOMPARE(msgStr(msgVec[2]), msgStr(makeMsg(1436509052300000ULL, 1, 0x123, CanMsgFlagFd | CanMsgFlagBrs | CanMsgFlagEsi, "11223344AABBCCDD")));
+	QCOMPARE(msgStr(msgVec[3]), msgStr(makeMsg(1436509052400000ULL, 0, 0x321, CanMsgFlagRtr, "")));
+	QCOMPARE(msgStr(msgVec[4]), msgStr(makeMsg(1436509052600000ULL, 0, 0x7FF, CanMsgFlagTx, "0102")));
+	QCOMPARE(msgStr(msgVec[5]), msgStr(makeMsg(1436509052800000ULL, 1, 0x124, CanMsgFlagFd | CanMsgFlagBrs, "0102")));
+	QCOMPARE(msgStr(msgVec[6]), msgStr(makeMsg(1436509052900000ULL, 0, 0x125, 0, "0102030405060708")));
+	QCOMPARE(msgStr(msgVec[7]), msgStr(makeMsg(1436509053000000ULL, 0, 0x126, 0, "")));
+	QCOMPARE(numOfBad, (uint64_t)2);
+
+	// rewind reads it all again, interfaces numbered anew
+	QVERIFY(captureText.open(writeFile(text)));
+	while(captureText.next(msg)) {
+	}
+	QVERIFY(captureText.rewind());
+	QVERIFY(captureText.next(msg));
+	QCOMPARE(msgStr(msg), msgStr(msgVec[0]));
+	for(size_t i = 1; i < msgVec.size(); ++i) {
+		QVERIFY(captureText.next(msg));
+	}
+	QVERIFY(!captureText.next(msg));
+	QCOMPARE(captureText.getNumOfBadRecords(), (uint64_t)2);
+}
+
+void TestCaptureText::ascHex(void)
+{
+	std::vector<CanMsg> msgVec;
+	uint64_t numOfBad = 0;
+
+	// events, error frames and statistics skipped, CANFD with and without a symbolic name
+	QVERIFY(readAll(
+		"date Mon May 5 07:10:00.000 pm 2025\n"
+		"base hex  timestamps absolute\n"
+		"internal events logged\n"
+		"// version 13.0.0\n"
+		"Begin Triggerblock Mon May 5 07:10:00.000 pm 2025\n"
+		"   0.000000 Start of measurement\n"
+		"   0.012345 1  123             Rx   d 8 01 02 03 04 05 06 07 08  Length = 0 BitCount = 0 ID = 291\n"
+		"   0.020000 2  1ABCDEF0x       Tx   d 2 AA BB\n"
+		"   0.030000 1  456             Rx   r\n"
+		"   0.040000 1  ErrorFrame\n"
+		"   0.050000 CANFD   1 Rx        7E8                                   1 0 9 12 00 11 22 33 44 55 66 77 88 99 AA BB   0 0 0 0 0 0\n"
+		"   0.060000 CANFD   2 Tx   1FFFFFFFx  EngineData                      1 1 a 16 " + QByteArray(16, 'x').replace("x", "A5 ") + "\n"
+		"   0.070000 1  124             Rx   d 8 01 02\n"
+		"   0.075000 CANFD   1 Rx        7E9                                   0 0 2 2 01\n"
+		"   0.080000 1  Statistic: D 0 R 0 XD 0 XR 0 E 0 O 0 B 0.00%\n"
+		"   0.090000 1  125             Rx   d F 01 02 03 04 05 06 07 08\n"
+		"End TriggerBlock\n",
+		CaptureTextFormat::Asc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)6);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(12345, 0, 0x123, 0, "0102030405060708")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(20000, 1, 0x1ABCDEF0, CanMsgFlagExtended | CanMsgFlagTx, "AABB")));
+	QCOMPARE(msgStr(msgVec[2]), msgStr(makeMsg(30000, 0, 0x456, CanMsgFlagRtr, "")));
+	QCOMPARE(msgStr(msgVec[3]), msgStr(makeMsg(50000, 0, 0x7E8, CanMsgFlagFd | CanMsgFlagBrs, "00112233445566778899AABB")));
+	QCOMPARE(msgStr(msgVec[4]), msgStr(makeMsg(60000, 1, 0x1FFFFFFF, CanMsgFlagExtended | CanMsgFlagFd | CanMsgFlagBrs | CanMsgFlagEsi | CanMsgFlagTx, QByteArray(16, 'x').replace("x", "A5"))));
+	// classic DLC above 8 still carries 8 bytes
+	QCOMPARE(msgStr(msgVec[5]), msgStr(makeMsg(90000, 0, 0x125, 0, "0102030405060708")));
+	// short classic and short FD data
+	QCOMPARE(numOfBad, (uint64_t)2);
+}
+
+void TestCaptureText::ascDecRelative(void)
+{
+	std::vector<CanMsg> msgVec;
+	uint64_t numOfBad = 0;
+
+	// every line counts towards the relative timestamp, frame or not
+	QVERIFY(readAll(
+		"date Mon May 5 07:10:00.000 pm 2025\n"
+		"base dec  timestamps relative\n"
+		"Begin Triggerblock Mon May 5 07:10:00.000 pm 2025\n"
+		"   0.001000 1  291             Rx   d 3 1 2 255\n"
+		"   0.002500 2  2000x           Tx   d 1 16\n"
+		"   0.000500 1  Statistic: D 0 R 0 XD 0 XR 0 E 0 O 0 B 0.00%\n"
+		"   0.000500 CANFD   1 Rx        256  Diag                             0 1 9 12 0 1 2 3 4 5 6 7 8 9 10 11\n"
+		"   0.001000 1  292             Rx   d 2 1 256\n"
+		"   0.001000 1  293             Rx   d 1 7\n"
+		"End TriggerBlock\n",
+		CaptureTextFormat::Asc,
+		msgVec,
+		numOfBad
+	));
+	QCOMPARE(msgVec.size(), (size_t)4);
+	QCOMPARE(msgStr(msgVec[0]), msgStr(makeMsg(1000, 0, 291, 0, "0102FF")));
+	QCOMPARE(msgStr(msgVec[1]), msgStr(makeMsg(3500, 1, 2000, CanMsgFlagExtended | CanMsgFlagTx, "10")));
+	QCOMPARE(msgStr(msgVec[2]), msgStr(makeMsg(4500, 0, 256, CanMsgFlagFd | CanMsgFlagEsi, "000102030405060708090A0B")));
+	QCOMPARE(msgStr(msgVec[3]), msgStr(makeMsg(6500, 0, 293, 0, "07")));
+	// data byte above 255
+	QCOMPARE(numOfBad, (uint64_t)1);
+}
+
+/// benchmarkLines classic frames of 8 bytes in format, as the tools write them.
+QByteArray TestCaptureText::benchmarkText(CaptureTextFormat format)
+{
+	QByteArray text;
+	char line[128];
+
+	switch(format) {
+	case CaptureTextFormat::Trc:
+		text = ";$FILEVERSION=2.1\n;$COLUMNS=N,O,T,B,I,d,R,L,D\n";
+		break;
+	case CaptureTextFormat::Asc:
+		text = "date Mon May 5 07:10:00.000 pm 2025\nbase hex  timestamps absolute\nBegin Triggerblock\n";
+		break;
+	default:
+		break;
+	}
+	text.reserve(benchmarkLines * 80);
+	for(int i = 0; i < benchmarkLines; ++i) {
+		const unsigned id = 0x100 + i % 0x600;
+		const unsigned b = i % 0xF8;  // b + 7 stays a byte
+		int size = 0;
+
+		switch(format) {
+		case CaptureTextFormat::Trc:
+			size = snprintf(
+				line,
+				sizeof(line),
+				"%7d %13.3f DT 1      %04X Rx -  8    %02X %02X %02X %02X %02X %02X %02X %02X\n",
+				i + 1, i * 0.25, id, b, b + 1, b + 2, b + 3, b + 4, b + 5, b + 6, b + 7
+			);
+			break;
+		case CaptureTextFormat::Candump:
+			size = snprintf(
+				line,
+				sizeof(line),
+				"(%d.%06d) vcan0 %03X#%02X%02X%02X%02X%02X%02X%02X%02X\n",
+				1746472200 + i / 4000, (i % 4000) * 250, id, b, b + 1, b + 2, b + 3, b + 4, b + 5, b + 6, b + 7
+			);
+			break;
+		default:
+			size = snprintf(
+				line,
+				sizeof(line),
+				"%11.6f 1  %-15X Rx   d 8 %02X %02X %02X %02X %02X %02X %02X %02X  Length = 0 BitCount = 0\n",
+				i * 0.00025, id, b, b + 1, b + 2, b + 3, b + 4, b + 5, b + 6, b + 7
+			);
+			break;
+		}
+		text.append(line, size);
+	}
+	return text;
+}
+
+void TestCaptureText::benchmarkRead_data(void)
+{
+	QTest::addColumn<int>("format");
+
+	QTest::newRow("trc") << (int)CaptureTextFormat::Trc;
+	QTest::newRow("candump") << (int)CaptureTextFormat::Candump;
+	QTest::newRow("asc") << (int)CaptureTextFormat::Asc;
+}
+
+/// Whole read path, chunked file reads included.
+void TestCaptureText::benchmarkRead(void)
+{
+	QFETCH(int, format);
+	const QString filePath = writeFile(benchmarkText((CaptureTextFormat)format));
+	CaptureText captureText;
+	CanMsg msg;
+	int numOfMsg = 0;
+
+	QVERIFY(captureText.open(filePath));
+	QBENCHMARK {
+		QVERIFY(captureText.rewind());
+		numOfMsg = 0;
+		while(captureText.next(msg)) {
+			++numOfMsg;
+		}
+	}
+	QCOMPARE(numOfMsg, benchmarkLines);
+	QCOMPARE(captureText.getNumOfBadRecords(), (uint64_t)0);
+	captureText.close();
+	QFile::remove(filePath);
+}
+
+QTEST_GUILESS_MAIN(TestCaptureText)
+
+#include "tst_capturetext.moc"
@@ -0,0 +1,42 @@
+include(../tests.pri)
+
+# Offline decode in chunks on several workers, byte for byte against the decode on one thread.
+TARGET = tst_offlinedecode
+QT += xml
+
+SOURCES += \
+    tst_offlinedecode.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/capturefile.cpp \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/capture/captureindex.cpp \
+    $$SRC_ROOT/logic/capture/capturereader.cpp \
+    $$SRC_ROOT/logic/capture/capturerepair.cpp \
+    $$SRC_ROOT/logic/capture/capturestream.cpp \
+    $$SRC_ROOT/logic/capture/capturetext.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/isotp/isotp.cpp \
+    $$SRC_ROOT/logic/uds/uds.cpp \
+    $$SRC_ROOT/logic/uds/gen/uds_def.cpp \
+    $$SRC_ROOT/logic/can.cpp \
+    $$SRC_ROOT/logic/config.cpp \
+    $$SRC_ROOT/logic/offlinedecoder.cpp \
+    $$SRC_ROOT/logic/packetdecoder.cpp \
+    $$SRC_ROOT/logic/rotation.cpp \
+    $$SRC_ROOT/logic/rxspill.cpp \
+    $$SRC_ROOT/logic/timestamp.cpp \
+    $$SRC_ROOT/logic/traceuds.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    ../testcapture.h
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/uds/uds.h \
+    $$SRC_ROOT/logic/can.h \
+    $$SRC_ROOT/logic/config.h \
+    $$SRC_ROOT/logic/offlinedecoder.h \
+    $$SRC_ROOT/logic/traceuds.h
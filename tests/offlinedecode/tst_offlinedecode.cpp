@@ -0,0 +1,205 @@
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <random>
+#include <vector>
+#include "offlinedecoder.h"
+#include "testcapture.h"
+#include "traceuds.h"
+
+/// @brief Offline decode in chunks on several workers against the same capture decoded on one thread.
+class TestOfflineDecode : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void serialDecodesEveryTransfer(void);
+	void chunkedMatchesSerial_data(void);
+	void chunkedMatchesSerial(void);
+
+private:
+	static constexpr uint32_t reqCanId = 0x7E0;
+	static constexpr uint32_t respCanId = 0x7E8;
+	static constexpr uint64_t createdUs = 1746472200000000ULL;  //!< 2025-05-05 19:10:00 UTC
+	static constexpr int numOfExchanges = 4000;
+	QTemporaryDir tempDir;
+	QString capturePath;
+	uint64_t numOfFrames;
+	uint64_t numOfPackets;   //!< transfers the capture completes
+	int numOfRuns;
+	static void appendTransfer(
+		std::vector<CanMsg> &msgVecRef,
+		std::mt19937 &randomRef,
+		uint32_t id,
+		uint32_t flowId,
+		const std::vector<uint8_t> &payloadRef,
+		bool isCut
+	);
+	static void appendFrame(std::vector<CanMsg> &msgVecRef, std::mt19937 &randomRef, uint32_t id, const std::vector<uint8_t> &dataRef);
+	bool decode(int numOfWorkers, uint64_t minChunkFrames, QByteArray &jsonRef, QByteArray &htmlRef, OfflineDecoder &decoderRef);
+	static QByteArray readFile(const QString &filePathRef);
+};
+
+/// Frame of id, with frames of other ids before it now and then, so transfers stretch over more frames.
+void TestOfflineDecode::appendFrame(std::vector<CanMsg> &msgVecRef, std::mt19937 &randomRef, uint32_t id, const std::vector<uint8_t> &dataRef)
+{
+	while(randomRef() % 4 == 0) {
+		const std::vector<uint8_t> noise = { (uint8_t)randomRef(), (uint8_t)randomRef(), 0x10, 0x21 };
+		msgVecRef.push_back(TestCapture::makeMsg(0x100 + randomRef() % 0x100, noise, msgVecRef.size() * 1000));
+	}
+	msgVecRef.push_back(TestCapture::makeMsg(id, dataRef, msgVecRef.size() * 1000));
+}
+
+/// ISO-TP transfer of payload on id, peer answers first frames with a flow control on flowId.
+/// A cut transfer lacks its last consecutive frame.
+void TestOfflineDecode::appendTransfer(
+	std::vector<CanMsg> &msgVecRef,
+	std::mt19937 &randomRef,
+	uint32_t id,
+	uint32_t flowId,
+	const std::vector<uint8_t> &payloadRef,
+	bool isCut
+)
+{
+	if(payloadRef.size() <= 7) {
+		std::vector<uint8_t> data = { (uint8_t)payloadRef.size() };
+		data.insert(data.end(), payloadRef.begin(), payloadRef.end());
+		appendFrame(msgVecRef, randomRef, id, data);
+		return;
+	}
+	std::vector<uint8_t> data = { (uint8_t)(0x10 | payloadRef.size() >> 8), (uint8_t)payloadRef.size() };
+	data.insert(data.end(), payloadRef.begin(), payloadRef.begin() + 6);
+	appendFrame(msgVecRef, randomRef, id, data);
+	appendFrame(msgVecRef, randomRef, flowId, { 0x30, 0x00, 0x00 });
+	uint8_t sn = 1;
+	for(size_t pos = 6; pos < payloadRef.size(); pos += 7, sn = (sn + 1) & 0x0F) {
+		data = { (uint8_t)(0x20 | sn) };
+		data.insert(data.end(), payloadRef.begin() + pos, payloadRef.begin() + qMin(pos + 7, payloadRef.size()));
+		if(isCut && pos + 7 >= payloadRef.size()) {
+			return;
+		}
+		appendFrame(msgVecRef, randomRef, id, data);
+	}
+}
+
+QByteArray TestOfflineDecode::readFile(const QString &filePathRef)
+{
+	QFile file(filePathRef);
+
+	if(!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+	return file.readAll();
+}
+
+bool TestOfflineDecode::decode(int numOfWorkers, uint64_t minChunkFrames, QByteArray &jsonRef, QByteArray &htmlRef, OfflineDecoder &decoderRef)
+{
+	const QString basePath = this->tempDir.filePath(QString("trace_%1").arg(this->numOfRuns++));
+	TraceUds traceUds(nullptr);
+
+	decoderRef.setIds(reqCanId, respCanId);
+	decoderRef.setWorkers(numOfWorkers);
+	decoderRef.setMinChunkFrames(minChunkFrames);
+	traceUds.openBase(basePath);
+	const bool isOk = decoderRef.run(this->capturePath, traceUds);
+	traceUds.close();
+	jsonRef = readFile(basePath + ".json");
+	htmlRef = readFile(basePath + ".html");
+	return isOk;
+}
+
+void TestOfflineDecode::initTestCase(void)
+{
+	std::mt19937 random(7);
+	std::vector<CanMsg> msgVec;
+
+	this->numOfRuns = 0;
+	this->numOfPackets = 0;
+	// ReadDataByIdentifier answered with single frames up to long multi frame responses,
+	// WriteDataByIdentifier sent as multi frame requests. Now and then a transfer is cut short,
+	// the next start frame on its side drops it.
+	for(int i = 0; i < numOfExchanges; ++i) {
+		const uint8_t didHigh = (uint8_t)(0xF1 + i % 3);
+		const uint8_t didLow = (uint8_t)(random() % 0x100);
+		const bool isCut = i % 53 == 0;
+		std::vector<uint8_t> req;
+		std::vector<uint8_t> resp;
+
+		if(i % 3 == 0) {
+			req = { 0x2E, didHigh, didLow };
+			for(size_t n = 5 + random() % 60; n > 0; --n) {
+				req.push_back((uint8_t)random());
+			}
+			resp = { 0x6E, didHigh, didLow };
+		} else {
+			req = { 0x22, didHigh, didLow };
+			resp = { 0x62, didHigh, didLow };
+			for(size_t n = random() % 200; n > 0; --n) {
+				resp.push_back((uint8_t)random());
+			}
+		}
+		appendTransfer(msgVec, random, reqCanId, respCanId, req, isCut && req.size() > 7);
+		appendTransfer(msgVec, random, respCanId, reqCanId, resp, isCut && resp.size() > 7);
+		this->numOfPackets += (isCut && req.size() > 7 ? 0 : 1) + (isCut && resp.size() > 7 ? 0 : 1);
+	}
+	this->numOfFrames = msgVec.size();
+	this->capturePath = this->tempDir.filePath("capture.cobs");
+	QVERIFY(TestCapture::write(this->capturePath, msgVec, createdUs));
+}
+
+void TestOfflineDecode::serialDecodesEveryTransfer(void)
+{
+	OfflineDecoder decoder;
+	QByteArray json;
+	QByteArray html;
+
+	QVERIFY(decode(1, OfflineDecoder::defaultMinChunkFrames, json, html, decoder));
+	QCOMPARE(decoder.getNumOfWorkers(), 1);
+	QCOMPARE(decoder.getNumOfFrames(), this->numOfFrames);
+	QCOMPARE(decoder.getNumOfPackets(), this->numOfPackets);
+	QCOMPARE(decoder.getNumOfBadRecords(), (uint64_t)0);
+	// packets are traced at capture time, not at the time they were decoded
+	const QString createdStr = QDateTime::fromMSecsSinceEpoch(createdUs / 1000).toString("yyyyMMdd_HH");
+	QVERIFY(json.contains(createdStr.toUtf8()));
+	QVERIFY(json.endsWith("]}\n"));
+	QVERIFY(html.endsWith("</html>\n\n"));
+}
+
+void TestOfflineDecode::chunkedMatchesSerial_data(void)
+{
+	QTest::addColumn<int>("numOfWorkers");
+	QTest::addColumn<qulonglong>("minChunkFrames");
+
+	// chunks of a few hundred to a few thousand frames, transfers span up to about 40 frames
+	QTest::newRow("2 workers") << 2 << (qulonglong)1000;
+	QTest::newRow("4 workers") << 4 << (qulonglong)500;
+	QTest::newRow("8 workers") << 8 << (qulonglong)100;
+	QTest::newRow("3 workers, odd chunks") << 3 << (qulonglong)997;
+}
+
+void TestOfflineDecode::chunkedMatchesSerial(void)
+{
+	QFETCH(int, numOfWorkers);
+	QFETCH(qulonglong, minChunkFrames);
+	OfflineDecoder serialDecoder;
+	OfflineDecoder chunkedDecoder;
+	QByteArray serialJson;
+	QByteArray serialHtml;
+	QByteArray chunkedJson;
+	QByteArray chunkedHtml;
+
+	QVERIFY(decode(1, minChunkFrames, serialJson, serialHtml, serialDecoder));
+	QVERIFY(decode(numOfWorkers, minChunkFrames, chunkedJson, chunkedHtml, chunkedDecoder));
+	QCOMPARE(chunkedDecoder.getNumOfWorkers(), numOfWorkers);
+	QCOMPARE(chunkedDecoder.getNumOfFrames(), serialDecoder.getNumOfFrames());
+	QCOMPARE(chunkedDecoder.getNumOfPackets(), serialDecoder.getNumOfPackets());
+	QCOMPARE(chunkedDecoder.getNumOfBadRecords(), serialDecoder.getNumOfBadRecords());
+	QVERIFY(chunkedJson == serialJson);
+	QVERIFY(chunkedHtml == serialHtml);
+}
+
+QTEST_GUILESS_MAIN(TestOfflineDecode)
+
+#include "tst_offlinedecode.moc"
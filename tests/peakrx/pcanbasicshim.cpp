@@ -0,0 +1,284 @@
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <cstring>
+#ifndef Q_OS_WIN32
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+#include "pcanbasicshim.h"
+
+namespace
+{
+	struct ScriptEntry {
+		TPCANStatus readResult;
+		bool isFd;
+		uint32_t id;
+		uint8_t dlc;
+		uint8_t dataLength;
+	};
+
+	QMutex mutex;
+	QQueue<ScriptEntry> script;
+	uint64_t reads = 0;
+	uint64_t emptyReads = 0;
+	uint64_t timestampUs = 0;
+	bool isInit = false;
+	bool isRxEventBroken = false;
+#ifdef Q_OS_WIN32
+	HANDLE rxEventHandle = NULL;
+#else
+	int rxEventFd = -1;
+#endif
+
+	// callers hold mutex
+	void setRxEvent(void)
+	{
+#ifdef Q_OS_WIN32
+		if(rxEventHandle != NULL) {
+			SetEvent(rxEventHandle);
+		}
+#else
+		if(rxEventFd >= 0) {
+			uint64_t one = 1;
+			ssize_t ret = ::write(rxEventFd, &one, sizeof(one));
+			(void)ret;
+		}
+#endif
+	}
+
+	void clearRxEvent(void)
+	{
+#ifdef Q_OS_WIN32
+		if(rxEventHandle != NULL) {
+			ResetEvent(rxEventHandle);
+		}
+#else
+		if(rxEventFd >= 0) {
+			uint64_t value = 0;
+			ssize_t ret = ::read(rxEventFd, &value, sizeof(value));
+			(void)ret;
+		}
+#endif
+	}
+
+	void queueEntry(const ScriptEntry &entryRef)
+	{
+		QMutexLocker locker(&mutex);
+		script.enqueue(entryRef);
+		setRxEvent();
+	}
+
+	/// Pops next entry, false when script is empty and the read has to return PCAN_ERROR_QRCVEMPTY.
+	bool takeEntry(ScriptEntry &entryRef)
+	{
+		QMutexLocker locker(&mutex);
+		++reads;
+		// any read takes the signal, entries left behind wait for the next queued one
+		clearRxEvent();
+		if(script.isEmpty()) {
+			++emptyReads;
+			return false;
+		}
+		entryRef = script.dequeue();
+		timestampUs += 100;
+		return true;
+	}
+
+	TPCANStatus initialize(void)
+	{
+		QMutexLocker locker(&mutex);
+		if(isInit) {
+			return PCAN_ERROR_INITIALIZE;
+		}
+		isInit = true;
+#ifndef Q_OS_WIN32
+		rxEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if(!script.isEmpty()) {
+			setRxEvent();
+		}
+#endif
+		return PCAN_ERROR_OK;
+	}
+} // namespace
+
+namespace PcanShim
+{
+	void reset(void)
+	{
+		QMutexLocker locker(&mutex);
+		script.clear();
+		reads = 0;
+		emptyReads = 0;
+		timestampUs = 0;
+		isRxEventBroken = false;
+		clearRxEvent();
+	}
+
+	void queueFrame(uint32_t id, uint8_t dataLength)
+	{
+		queueEntry({PCAN_ERROR_OK, false, id, dataLength, dataLength});
+	}
+
+	void queueFdFrame(uint32_t id, uint8_t dlc)
+	{
+		static const uint8_t dlcToLength[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+		queueEntry({PCAN_ERROR_OK, true, id, dlc, dlcToLength[dlc & 0x0F]});
+	}
+
+	void queueStatus(TPCANStatus readResult)
+	{
+		queueEntry({readResult, false, 0, 0, 0});
+	}
+
+	void setRxEventBroken(bool isBroken)
+	{
+		QMutexLocker locker(&mutex);
+		isRxEventBroken = isBroken;
+	}
+
+	uint64_t getReads(void)
+	{
+		QMutexLocker locker(&mutex);
+		return reads;
+	}
+
+	uint64_t getEmptyReads(void)
+	{
+		QMutexLocker locker(&mutex);
+		return emptyReads;
+	}
+
+	bool isInitialized(void)
+	{
+		QMutexLocker locker(&mutex);
+		return isInit;
+	}
+} // namespace PcanShim
+
+TPCANStatus __stdcall CAN_Initialize(TPCANHandle Channel, TPCANBaudrate Btr0Btr1, TPCANType HwType, DWORD IOPort, WORD Interrupt)
+{
+	(void)Channel;
+	(void)Btr0Btr1;
+	(void)HwType;
+	(void)IOPort;
+	(void)Interrupt;
+	return initialize();
+}
+
+TPCANStatus __stdcall CAN_InitializeFD(TPCANHandle Channel, TPCANBitrateFD BitrateFD)
+{
+	(void)Channel;
+	(void)BitrateFD;
+	return initialize();
+}
+
+TPCANStatus __stdcall CAN_Uninitialize(TPCANHandle Channel)
+{
+	QMutexLocker locker(&mutex);
+	(void)Channel;
+	if(!isInit) {
+		return PCAN_ERROR_INITIALIZE;
+	}
+	isInit = false;
+#ifdef Q_OS_WIN32
+	rxEventHandle = NULL;
+#else
+	if(rxEventFd >= 0) {
+		::close(rxEventFd);
+		rxEventFd = -1;
+	}
+#endif
+	return PCAN_ERROR_OK;
+}
+
+TPCANStatus __stdcall CAN_Read(TPCANHandle Channel, TPCANMsg *MessageBuffer, TPCANTimestamp *TimestampBuffer)
+{
+	ScriptEntry entry;
+
+	(void)Channel;
+	if(!takeEntry(entry)) {
+		return PCAN_ERROR_QRCVEMPTY;
+	}
+	if(entry.readResult != PCAN_ERROR_OK) {
+		return entry.readResult;
+	}
+	MessageBuffer->ID = entry.id;
+	MessageBuffer->MSGTYPE = PCAN_MESSAGE_STANDARD;
+	MessageBuffer->LEN = entry.dataLength;
+	for(uint8_t i = 0; i < entry.dataLength; ++i) {
+		MessageBuffer->DATA[i] = (BYTE)(entry.id + i);
+	}
+	if(TimestampBuffer != nullptr) {
+		TimestampBuffer->micros = (WORD)(timestampUs % 1000);
+		TimestampBuffer->millis = (DWORD)(timestampUs / 1000);
+		TimestampBuffer->millis_overflow = 0;
+	}
+	return PCAN_ERROR_OK;
+}
+
+TPCANStatus __stdcall CAN_ReadFD(TPCANHandle Channel, TPCANMsgFD *MessageBuffer, TPCANTimestampFD *TimestampBuffer)
+{
+	ScriptEntry entry;
+
+	(void)Channel;
+	if(!takeEntry(entry)) {
+		return PCAN_ERROR_QRCVEMPTY;
+	}
+	if(entry.readResult != PCAN_ERROR_OK) {
+		return entry.readResult;
+	}
+	MessageBuffer->ID = entry.id;
+	MessageBuffer->MSGTYPE = entry.isFd ? (PCAN_MESSAGE_FD | PCAN_MESSAGE_BRS) : PCAN_MESSAGE_STANDARD;
+	MessageBuffer->DLC = entry.dlc;
+	for(uint8_t i = 0; i < entry.dataLength; ++i) {
+		MessageBuffer->DATA[i] = (BYTE)(entry.id + i);
+	}
+	if(TimestampBuffer != nullptr) {
+		*TimestampBuffer = timestampUs;
+	}
+	return PCAN_ERROR_OK;
+}
+
+TPCANStatus __stdcall CAN_GetValue(TPCANHandle Channel, TPCANParameter Parameter, void *Buffer, DWORD BufferLength)
+{
+	QMutexLocker locker(&mutex);
+	(void)Channel;
+#ifndef Q_OS_WIN32
+	if(Parameter == PCAN_RECEIVE_EVENT && BufferLength >= sizeof(int)) {
+		int fd = rxEventFd;
+		if(isRxEventBroken) {
+			// an fd that was valid once, ppoll reports it ready without blocking
+			fd = eventfd(0, EFD_CLOEXEC);
+			::close(fd);
+		}
+		memcpy(Buffer, &fd, sizeof(fd));
+		return PCAN_ERROR_OK;
+	}
+#else
+	(void)Buffer;
+	(void)BufferLength;
+#endif
+	(void)Parameter;
+	return PCAN_ERROR_ILLPARAMTYPE;
+}
+
+TPCANStatus __stdcall CAN_SetValue(TPCANHandle Channel, TPCANParameter Parameter, void *Buffer, DWORD BufferLength)
+{
+	QMutexLocker locker(&mutex);
+	(void)Channel;
+#ifdef Q_OS_WIN32
+	if(Parameter == PCAN_RECEIVE_EVENT && BufferLength >= sizeof(HANDLE)) {
+		memcpy(&rxEventHandle, Buffer, sizeof(HANDLE));
+		if(!script.isEmpty()) {
+			setRxEvent();
+		}
+		return PCAN_ERROR_OK;
+	}
+#else
+	(void)Buffer;
+	(void)BufferLength;
+#endif
+	(void)Parameter;
+	return PCAN_ERROR_ILLPARAMTYPE;
+}
@@ -0,0 +1,43 @@
+/**
+ * @defgroup pcanbasicshim_h
+ * @{
+ * @file pcanbasicshim.h
+ * @brief Stand-in for libpcanbasic, so PEAK backends run without hardware.
+ * Implements the CAN_* calls the backends use. Reads are served from a script of
+ * frames and status results. Receive event is set when an entry is queued and cleared
+ * by the next read, like an auto-reset event. A backend that waits while entries are
+ * left sleeps into its wait timeout, so tests can tell.
+ */
+#ifndef PCANBASICSHIM_H
+#define PCANBASICSHIM_H
+
+#include <QtGlobal>
+#include <cstdint>
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#endif
+#include "PCANBasic.h"
+
+namespace PcanShim
+{
+	/// @brief Empties the script, clears counters and makes the receive event usable again.
+	void reset(void);
+	/// @brief Classic frame, payload bytes count up from id.
+	void queueFrame(uint32_t id, uint8_t dataLength = 8);
+	/// @brief FD frame with given DLC code.
+	void queueFdFrame(uint32_t id, uint8_t dlc);
+	/// @brief A read returning readResult without a frame, e.g. bus status or queue overrun.
+	void queueStatus(TPCANStatus readResult);
+	/// @brief Receive event handed out by CAN_GetValue is a closed fd, Linux only.
+	void setRxEventBroken(bool isBroken);
+
+	/// @brief CAN_Read and CAN_ReadFD calls since reset.
+	uint64_t getReads(void);
+	/// @brief Reads that found the script empty since reset.
+	uint64_t getEmptyReads(void);
+	bool isInitialized(void);
+} // namespace PcanShim
+
+#endif // PCANBASICSHIM_H
+
+/// @}
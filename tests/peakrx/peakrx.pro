@@ -0,0 +1,34 @@
+include(../tests.pri)
+
+# PeakStdCan and PeakFdCan against pcanbasicshim instead of libpcanbasic,
+# runs without hardware or PEAK driver module.
+TARGET = tst_peakrx
+QT += xml
+
+SOURCES += \
+    pcanbasicshim.cpp \
+    tst_peakrx.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/peak/peakbasiccan.cpp \
+    $$SRC_ROOT/logic/peak/peakfdcan.cpp \
+    $$SRC_ROOT/logic/peak/peakstdcan.cpp \
+    $$SRC_ROOT/logic/can.cpp \
+    $$SRC_ROOT/logic/config.cpp \
+    $$SRC_ROOT/logic/rxspill.cpp \
+    $$SRC_ROOT/logic/timestamp.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    pcanbasicshim.h
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/peak/peakbasiccan.h \
+    $$SRC_ROOT/logic/peak/peakfdcan.h \
+    $$SRC_ROOT/logic/peak/peakstdcan.h \
+    $$SRC_ROOT/logic/can.h \
+    $$SRC_ROOT/logic/config.h
@@ -0,0 +1,222 @@
+#include <QElapsedTimer>
+#include <QThread>
+#include <QVector>
+#include <QtTest>
+#include <memory>
+#include <stdexcept>
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+#include "config.h"
+#include "pcanbasicshim.h"
+#include "peakfdcan.h"
+#include "peakstdcan.h"
+
+/// @brief PEAK rx thread against pcanbasicshim: idle cost, wake up latency and burst draining.
+class TestPeakRx : public QObject
+{
+	Q_OBJECT
+private slots:
+	void init(void);
+	void cleanup(void);
+	void idleRxSleeps(void);
+	void frameWakesRx(void);
+	void disconnectWakesRx(void);
+	void statusKeepsBurstGoing(void);
+	void fdStatusKeepsBurstGoing(void);
+	void brokenRxEventFailsConnect(void);
+
+private:
+	/// rx waits at most this long for the receive event while idle, see Can::getRxWaitUs
+	static const int idleWaitMs = 100;
+	std::unique_ptr<Can> canPtr;
+	ConfigStd configStd;
+	ConfigFd configFd;
+	static int64_t getCpuUs(void);
+	size_t popFor(size_t numOfMsg, int timeoutMs, QVector<CanMsg> &msgVectRef);
+};
+
+int64_t TestPeakRx::getCpuUs(void)
+{
+#ifdef Q_OS_WIN32
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	const uint64_t kernel100Ns = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	const uint64_t user100Ns = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (int64_t)((kernel100Ns + user100Ns) / 10);
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return
+		(int64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+		usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+}
+
+/// Pops from rx queue until numOfMsg frames arrived or timeout passed, returns number popped.
+size_t TestPeakRx::popFor(size_t numOfMsg, int timeoutMs, QVector<CanMsg> &msgVectRef)
+{
+	QElapsedTimer timer;
+	CanMsg msg;
+
+	timer.start();
+	while((size_t)msgVectRef.size() < numOfMsg && timer.elapsed() < timeoutMs) {
+		if(this->canPtr->popRx(&msg, 1) == 1) {
+			msgVectRef.append(msg);
+		} else {
+			QThread::usleep(100);
+		}
+	}
+	return msgVectRef.size();
+}
+
+void TestPeakRx::init(void)
+{
+	PcanShim::reset();
+}
+
+void TestPeakRx::cleanup(void)
+{
+	if(this->canPtr != nullptr && this->canPtr->isConnected()) {
+		this->canPtr->disconnect();
+	}
+	this->canPtr.reset();
+	QVERIFY(!PcanShim::isInitialized());
+}
+
+void TestPeakRx::idleRxSleeps(void)
+{
+	const int idleMs = 500;
+	QElapsedTimer timer;
+
+	this->canPtr.reset(new PeakStdCan());
+	this->canPtr->connect(&this->configStd);
+	QThread::msleep(20);
+
+	const uint64_t readsBefore = PcanShim::getReads();
+	const int64_t cpuBeforeUs = getCpuUs();
+	timer.start();
+	QThread::msleep(idleMs);
+	const uint64_t reads = PcanShim::getReads() - readsBefore;
+	const int64_t cpuUs = getCpuUs() - cpuBeforeUs;
+	const int64_t wallUs = timer.nsecsElapsed() / 1000;
+
+	// one read per wait timeout, a polling rx reads thousands of times
+	QVERIFY2(reads <= (uint64_t)(idleMs / idleWaitMs + 2), qPrintable(QString("%1 reads while idle").arg(reads)));
+	QVERIFY2(cpuUs * 20 < wallUs, qPrintable(QString("%1 us cpu in %2 us").arg(cpuUs).arg(wallUs)));
+}
+
+void TestPeakRx::frameWakesRx(void)
+{
+	QVector<CanMsg> msgVect;
+	QElapsedTimer timer;
+
+	this->canPtr.reset(new PeakStdCan());
+	this->canPtr->connect(&this->configStd);
+	QThread::msleep(20);
+
+	for(uint32_t i = 0; i < 5; ++i) {
+		timer.start();
+		PcanShim::queueFrame(0x700 + i);
+		QCOMPARE(popFor(i + 1, 1000, msgVect), (size_t)(i + 1));
+		// frame came with the receive event, not with the wait timeout
+		QVERIFY2(timer.elapsed() < idleWaitMs / 2, qPrintable(QString("frame took %1 ms").arg(timer.elapsed())));
+		QCOMPARE(msgVect.last().id, 0x700 + i);
+		QThread::msleep(10);
+	}
+}
+
+void TestPeakRx::disconnectWakesRx(void)
+{
+	QElapsedTimer timer;
+
+	this->canPtr.reset(new PeakStdCan());
+	this->canPtr->connect(&this->configStd);
+	QThread::msleep(20);
+
+	timer.start();
+	this->canPtr->disconnect();
+	QVERIFY2(timer.elapsed() < idleWaitMs / 2, qPrintable(QString("disconnect took %1 ms").arg(timer.elapsed())));
+	QVERIFY(!this->canPtr->isConnected());
+}
+
+void TestPeakRx::statusKeepsBurstGoing(void)
+{
+	QVector<CanMsg> msgVect;
+	QElapsedTimer timer;
+
+	for(uint32_t i = 0; i < 10; ++i) {
+		PcanShim::queueFrame(0x100 + i);
+	}
+	PcanShim::queueStatus(PCAN_ERROR_QOVERRUN);
+	PcanShim::queueStatus(PCAN_ERROR_BUSWARNING);
+	for(uint32_t i = 10; i < 20; ++i) {
+		PcanShim::queueFrame(0x100 + i);
+	}
+
+	timer.start();
+	this->canPtr.reset(new PeakStdCan());
+	this->canPtr->connect(&this->configStd);
+	QCOMPARE(popFor(20, 1000, msgVect), (size_t)20);
+	// frames behind a status result were read in the same burst, not after a wait timeout
+	QVERIFY2(timer.elapsed() < idleWaitMs / 2, qPrintable(QString("burst took %1 ms").arg(timer.elapsed())));
+	for(int i = 0; i < msgVect.size(); ++i) {
+		QCOMPARE(msgVect[i].id, (uint32_t)(0x100 + i));
+		QCOMPARE(msgVect[i].dataLength, (uint8_t)8);
+		QCOMPARE(msgVect[i].data[7], (uint8_t)(0x100 + i + 7));
+	}
+	QCOMPARE(this->canPtr->rxStats.driverOverruns.get(), (uint64_t)1);
+	QCOMPARE(this->canPtr->rxStats.framesRead.get(), (uint64_t)20);
+}
+
+void TestPeakRx::fdStatusKeepsBurstGoing(void)
+{
+	QVector<CanMsg> msgVect;
+	QElapsedTimer timer;
+
+	for(uint32_t i = 0; i < 10; ++i) {
+		PcanShim::queueFdFrame(0x200 + i, 15);
+	}
+	PcanShim::queueStatus(PCAN_ERROR_QOVERRUN);
+	for(uint32_t i = 10; i < 20; ++i) {
+		PcanShim::queueFdFrame(0x200 + i, 15);
+	}
+
+	timer.start();
+	this->canPtr.reset(new PeakFdCan());
+	this->canPtr->connect(&this->configFd);
+	QCOMPARE(popFor(20, 1000, msgVect), (size_t)20);
+	QVERIFY2(timer.elapsed() < idleWaitMs / 2, qPrintable(QString("burst took %1 ms").arg(timer.elapsed())));
+	for(int i = 0; i < msgVect.size(); ++i) {
+		QCOMPARE(msgVect[i].id, (uint32_t)(0x200 + i));
+		QCOMPARE(msgVect[i].dataLength, (uint8_t)64);
+		QCOMPARE(msgVect[i].data[63], (uint8_t)(0x200 + i + 63));
+	}
+	QCOMPARE(this->canPtr->rxStats.driverOverruns.get(), (uint64_t)1);
+}
+
+void TestPeakRx::brokenRxEventFailsConnect(void)
+{
+#ifdef Q_OS_WIN32
+	QSKIP("Receive event is a handle created by the backend on Windows");
+#else
+	bool isThrown = false;
+
+	PcanShim::setRxEventBroken(true);
+	this->canPtr.reset(new PeakStdCan());
+	try {
+		this->canPtr->connect(&this->configStd);
+	} catch(const std::runtime_error &) {
+		isThrown = true;
+	}
+	QVERIFY(isThrown);
+	QVERIFY(!this->canPtr->isConnected());
+	QVERIFY(!PcanShim::isInitialized());
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestPeakRx)
+
+#include "tst_peakrx.moc"
@@ -0,0 +1,38 @@
+include(../tests.pri)
+
+# ReplayCan over a generated capture, which frames come out and when.
+TARGET = tst_replaycan
+QT += xml
+
+SOURCES += \
+    tst_replaycan.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/capturefile.cpp \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/capture/captureindex.cpp \
+    $$SRC_ROOT/logic/capture/capturereader.cpp \
+    $$SRC_ROOT/logic/capture/capturestream.cpp \
+    $$SRC_ROOT/logic/capture/capturetext.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/isotp/isotp.cpp \
+    $$SRC_ROOT/logic/uds/uds.cpp \
+    $$SRC_ROOT/logic/uds/gen/uds_def.cpp \
+    $$SRC_ROOT/logic/can.cpp \
+    $$SRC_ROOT/logic/config.cpp \
+    $$SRC_ROOT/logic/packetdecoder.cpp \
+    $$SRC_ROOT/logic/replaycan.cpp \
+    $$SRC_ROOT/logic/rxspill.cpp \
+    $$SRC_ROOT/logic/timestamp.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    ../testcapture.h
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/uds/uds.h \
+    $$SRC_ROOT/logic/can.h \
+    $$SRC_ROOT/logic/config.h \
+    $$SRC_ROOT/logic/replaycan.h
@@ -0,0 +1,471 @@
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVector>
+#include <QtTest>
+#include <memory>
+#include <vector>
+#include "config.h"
+#include "replaycan.h"
+#include "testcapture.h"
+
+/// @brief ReplayCan over generated captures: window and id filter decide which frames come out,
+/// transport requests where replay goes on and with which timestamps.
+class TestReplayCan : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void init(void);
+	void cleanup(void);
+	void window_data(void);
+	void window(void);
+	void pauseResume(void);
+	void stepFrame_data(void);
+	void stepFrame(void);
+	void stepPacket(void);
+	void seek_data(void);
+	void seek(void);
+	void loop(void);
+
+private:
+	static constexpr uint64_t startUs = 1746472200000000ULL;
+	static constexpr uint64_t createdUs = 1746472200000000ULL;
+	static constexpr uint64_t numOfMsg = CaptureFormat::blockFrames * 2 + 1808;  //!< 10000, a few blocks
+	static constexpr uint64_t frameUs = 1000;  //!< startMs and endMs count frames as well
+	static constexpr uint64_t udsGapUs = 10 * 1000 * 1000;  //!< after first frame of uds capture, replay pauses in it
+	static constexpr uint32_t reqCanId = 0x7E0;
+	static constexpr uint32_t respCanId = 0x7E8;
+	static const uint32_t idArr[4];
+	QTemporaryDir tempDir;
+	QString capturePath;
+	QString udsPath;         //!< UDS exchanges between frames of other ids
+	std::unique_ptr<ReplayCan> canPtr;
+	std::unique_ptr<ConfigReplay> configPtr;
+	static CanMsg makeFrame(uint64_t frame);
+	/// @brief Frame number a replayed frame carries in its data.
+	static uint64_t getFrame(const CanMsg &msgRef);
+	/// @brief Pops until replay ended by itself and queue is empty, false on timeout.
+	bool popToEnd(QVector<CanMsg> &msgVectRef, int timeoutMs = 10000);
+	/// @brief Frame numbers of msgVect joined, a mismatch shows where they part.
+	static QString frameStr(const QVector<CanMsg> &msgVectRef);
+	static QString frameStr(const QVector<uint64_t> &frameVectRef);
+	/// @brief Pops at least minNumOfMsg frames, then until no frame came for quietMs. False on timeout.
+	bool popSettled(QVector<CanMsg> &msgVectRef, int minNumOfMsg = 0, int quietMs = 100);
+	/// @brief Connects slowed down and pauses once the first frame came, msgVect gets those sent.
+	bool connectPaused(QVector<CanMsg> &msgVectRef);
+	/// @brief Frame numbers of the uds capture, taken from timestamps.
+	static QString udsStr(const QVector<CanMsg> &msgVectRef);
+};
+
+const uint32_t TestReplayCan::idArr[4] = { 0x100, 0x200, 0x2A0, 0x300 };
+
+CanMsg TestReplayCan::makeFrame(uint64_t frame)
+{
+	const std::vector<uint8_t> data = { (uint8_t)frame, (uint8_t)(frame >> 8), (uint8_t)(frame >> 16), 0x55 };
+
+	return TestCapture::makeMsg(idArr[frame % 4], data, startUs + frame * frameUs);
+}
+
+uint64_t TestReplayCan::getFrame(const CanMsg &msgRef)
+{
+	return msgRef.data[0] | ((uint64_t)msgRef.data[1] << 8) | ((uint64_t)msgRef.data[2] << 16);
+}
+
+bool TestReplayCan::popToEnd(QVector<CanMsg> &msgVectRef, int timeoutMs)
+{
+	QElapsedTimer timer;
+	CanMsg msg;
+
+	timer.start();
+	while(timer.elapsed() < timeoutMs) {
+		if(this->canPtr->popRx(&msg, 1) == 1) {
+			msgVectRef.append(msg);
+		} else if(!this->canPtr->isConnected()) {
+			// last frames were queued before replay disconnected
+			while(this->canPtr->popRx(&msg, 1) == 1) {
+				msgVectRef.append(msg);
+			}
+			return true;
+		} else {
+			QThread::usleep(100);
+		}
+	}
+	return false;
+}
+
+bool TestReplayCan::popSettled(QVector<CanMsg> &msgVectRef, int minNumOfMsg, int quietMs)
+{
+	const int minSize = msgVectRef.size() + minNumOfMsg;
+	QElapsedTimer timer;
+	QElapsedTimer quietTimer;
+	CanMsg msg;
+
+	timer.start();
+	quietTimer.start();
+	while(timer.elapsed() < 10000) {
+		if(this->canPtr->popRx(&msg, 1) == 1) {
+			msgVectRef.append(msg);
+			quietTimer.start();
+		} else if(msgVectRef.size() >= minSize && quietTimer.elapsed() >= quietMs) {
+			return true;
+		} else {
+			QThread::usleep(100);
+		}
+	}
+	return false;
+}
+
+/// First frame is sent as soon as replay starts. At a tenth of recorded speed frames of the test
+/// captures are 10 ms apart or more after it, pause comes in a few frames.
+bool TestReplayCan::connectPaused(QVector<CanMsg> &msgVectRef)
+{
+	this->configPtr->setSpeedPct("10");
+	this->canPtr->connect(this->configPtr.get());
+	if(!popSettled(msgVectRef, 1, 0)) {
+		return false;
+	}
+	this->canPtr->pause();
+	return popSettled(msgVectRef);
+}
+
+QString TestReplayCan::udsStr(const QVector<CanMsg> &msgVectRef)
+{
+	QVector<uint64_t> frameVect;
+
+	for(const CanMsg &msgRef : msgVectRef) {
+		frameVect.append(msgRef.timestamp < startUs + udsGapUs ? 0 : (msgRef.timestamp - startUs - udsGapUs) / frameUs);
+	}
+	return frameStr(frameVect);
+}
+
+QString TestReplayCan::frameStr(const QVector<CanMsg> &msgVectRef)
+{
+	QVector<uint64_t> frameVect;
+
+	for(const CanMsg &msgRef : msgVectRef) {
+		frameVect.append(getFrame(msgRef));
+	}
+	return frameStr(frameVect);
+}
+
+/// Runs of consecutive frames are written first-last, so a long replay stays readable.
+QString TestReplayCan::frameStr(const QVector<uint64_t> &frameVectRef)
+{
+	QString str;
+
+	for(int i = 0; i < frameVectRef.size(); ++i) {
+		int last = i;
+		while(last + 1 < frameVectRef.size() && frameVectRef[last + 1] == frameVectRef[last] + 1) {
+			++last;
+		}
+		str += (str.isEmpty() ? "" : " ") + QString::number(frameVectRef[i]);
+		if(last != i) {
+			str += "-" + QString::number(frameVectRef[last]);
+		}
+		i = last;
+	}
+	return str;
+}
+
+void TestReplayCan::initTestCase(void)
+{
+	std::vector<CanMsg> msgVec;
+
+	QVERIFY(this->tempDir.isValid());
+	for(uint64_t i = 0; i < numOfMsg; ++i) {
+		msgVec.push_back(makeFrame(i));
+	}
+	this->capturePath = this->tempDir.filePath("replay.cobs");
+	QVERIFY(TestCapture::write(this->capturePath, msgVec, createdUs));
+
+	// request, multi frame response with flow control, request, other ids in between
+	const std::vector<std::vector<uint8_t>> udsDataVec = {
+		{ 0x00 },
+		{ 0x03, 0x22, 0xF1, 0x90 },
+		{ 0x01 },
+		{ 0x10, 0x14, 0x62, 0xF1, 0x90, 0x57, 0x30, 0x4C },
+		{ 0x30, 0x00, 0x00 },
+		{ 0x02 },
+		{ 0x21, 0x30, 0x30, 0x30, 0x30, 0x34, 0x33, 0x4D },
+		{ 0x22, 0x42, 0x35, 0x34, 0x31, 0x33, 0x32, 0x36 },
+		{ 0x03 },
+		{ 0x02, 0x3E, 0x00 },
+		{ 0x04 }
+	};
+	const std::vector<uint32_t> udsIdVec = { 0x100, reqCanId, 0x100, respCanId, reqCanId, 0x100, respCanId, respCanId, 0x100, reqCanId, 0x100 };
+	msgVec.clear();
+	for(size_t i = 0; i < udsDataVec.size(); ++i) {
+		msgVec.push_back(TestCapture::makeMsg(udsIdVec[i], udsDataVec[i], startUs + (i == 0 ? 0 : udsGapUs + i * frameUs)));
+	}
+	this->udsPath = this->tempDir.filePath("uds.cobs");
+	QVERIFY(TestCapture::write(this->udsPath, msgVec, createdUs));
+}
+
+void TestReplayCan::init(void)
+{
+	this->configPtr.reset(new ConfigReplay());
+	this->configPtr->setDev(this->capturePath);
+	this->configPtr->setSpeedPct("0");
+	this->canPtr.reset(new ReplayCan());
+}
+
+void TestReplayCan::cleanup(void)
+{
+	if(this->canPtr != nullptr && this->canPtr->isConnected()) {
+		this->canPtr->disconnect();
+	}
+	this->canPtr.reset();
+	this->configPtr.reset();
+}
+
+void TestReplayCan::window_data(void)
+{
+	QTest::addColumn<QString>("startMs");
+	QTest::addColumn<QString>("startFrame");
+	QTest::addColumn<QString>("endMs");
+	QTest::addColumn<QString>("endFrame");
+	QTest::addColumn<QString>("idAllow");
+	QTest::addColumn<QString>("idDeny");
+	QTest::addColumn<qulonglong>("firstFrame");  //!< first frame replayed if its id is
+	QTest::addColumn<qulonglong>("endFrameNum"); //!< frame replay stops before
+	QTest::addColumn<QVector<uint32_t>>("idVect"); //!< ids replayed
+
+	const QVector<uint32_t> allIds = { 0x100, 0x200, 0x2A0, 0x300 };
+	const qulonglong blockFrames = CaptureFormat::blockFrames;
+
+	QTest::newRow("whole capture") << "0" << "0" << "0" << "0" << "" << "" << 0ULL << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("startMs") << "2500" << "0" << "0" << "0" << "" << "" << 2500ULL << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("startMs at a block edge") << QString::number(blockFrames * 2) << "0" << "0" << "0" << "" << "" << blockFrames * 2 << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("startFrame") << "0" << QString::number(blockFrames + 1) << "0" << "0" << "" << "" << blockFrames + 1 << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("startMs wins") << "100" << "5000" << "0" << "0" << "" << "" << 100ULL << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("endMs") << "0" << "0" << "3000" << "0" << "" << "" << 0ULL << 3000ULL << allIds;
+	QTest::newRow("endFrame") << "0" << "0" << "0" << QString::number(blockFrames) << "" << "" << 0ULL << blockFrames << allIds;
+	QTest::newRow("endMs wins") << "0" << "0" << "200" << "9000" << "" << "" << 0ULL << 200ULL << allIds;
+	QTest::newRow("ms window") << "1000" << "0" << "2000" << "0" << "" << "" << 1000ULL << 2000ULL << allIds;
+	QTest::newRow("frame window over blocks") << "0" << QString::number(blockFrames - 1) << "0" << QString::number(blockFrames * 2 + 1) << "" << "" << blockFrames - 1 << blockFrames * 2 + 1 << allIds;
+	QTest::newRow("last frame only") << "0" << QString::number(numOfMsg - 1) << "0" << "0" << "" << "" << (qulonglong)(numOfMsg - 1) << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("start past end") << QString::number(numOfMsg * 2) << "0" << "0" << "0" << "" << "" << (qulonglong)numOfMsg << (qulonglong)numOfMsg << allIds;
+	QTest::newRow("ends before it starts") << "500" << "0" << "400" << "0" << "" << "" << 500ULL << 500ULL << allIds;
+	QTest::newRow("idAllow") << "0" << "0" << "0" << "0" << "100,300" << "" << 0ULL << (qulonglong)numOfMsg << QVector<uint32_t>({ 0x100, 0x300 });
+	QTest::newRow("idDeny") << "0" << "0" << "0" << "0" << "" << "200" << 0ULL << (qulonglong)numOfMsg << QVector<uint32_t>({ 0x100, 0x2A0, 0x300 });
+	QTest::newRow("idDeny wins over idAllow") << "0" << "0" << "0" << "0" << "100,200" << "200" << 0ULL << (qulonglong)numOfMsg << QVector<uint32_t>({ 0x100 });
+	QTest::newRow("id lists spaced and cased") << "0" << "0" << "0" << "0" << " 2a0 , 100,,100" << " 7DF" << 0ULL << (qulonglong)numOfMsg << QVector<uint32_t>({ 0x100, 0x2A0 });
+	QTest::newRow("idAllow of no frame") << "0" << "0" << "0" << "0" << "7E0" << "" << 0ULL << (qulonglong)numOfMsg << QVector<uint32_t>();
+	QTest::newRow("window and ids") << "1234" << "0" << "0" << "6001" << "2A0,300" << "300" << 1234ULL << 6001ULL << QVector<uint32_t>({ 0x2A0 });
+}
+
+/// Frames come out in capture order with their recorded timestamps, exactly those in the window
+/// whose id passes.
+void TestReplayCan::window(void)
+{
+	QFETCH(QString, startMs);
+	QFETCH(QString, startFrame);
+	QFETCH(QString, endMs);
+	QFETCH(QString, endFrame);
+	QFETCH(QString, idAllow);
+	QFETCH(QString, idDeny);
+	QFETCH(qulonglong, firstFrame);
+	QFETCH(qulonglong, endFrameNum);
+	QFETCH(QVector<uint32_t>, idVect);
+	QVector<uint64_t> expectedVect;
+	QVector<CanMsg> msgVect;
+
+	for(uint64_t frame = firstFrame; frame < endFrameNum; ++frame) {
+		if(idVect.contains(idArr[frame % 4])) {
+			expectedVect.append(frame);
+		}
+	}
+	this->configPtr->setStartMs(startMs);
+	this->configPtr->setStartFrame(startFrame);
+	this->configPtr->setEndMs(endMs);
+	this->configPtr->setEndFrame(endFrame);
+	this->configPtr->setIdAllow(idAllow);
+	this->configPtr->setIdDeny(idDeny);
+	this->canPtr->connect(this->configPtr.get());
+	QVERIFY(popToEnd(msgVect));
+
+	QCOMPARE(frameStr(msgVect), frameStr(expectedVect));
+	for(int i = 0; i < msgVect.size(); ++i) {
+		const CanMsg expected = makeFrame(getFrame(msgVect[i]));
+		QCOMPARE(msgVect[i].id, expected.id);
+		QCOMPARE(msgVect[i].timestamp, expected.timestamp);
+	}
+}
+
+/// Nothing is sent while paused, resume goes on with the next frame, timestamps stay as recorded.
+void TestReplayCan::pauseResume(void)
+{
+	QVector<CanMsg> msgVect;
+	QVector<CanMsg> pausedVect;
+
+	QVERIFY(connectPaused(msgVect));
+	QCOMPARE(frameStr(msgVect), QString(msgVect.size() == 1 ? "0" : "0-%1").arg(msgVect.size() - 1));
+	QThread::msleep(200);
+	QVERIFY(popSettled(pausedVect));
+	QVERIFY(pausedVect.isEmpty());
+	QVERIFY(this->canPtr->isConnected());
+
+	this->canPtr->resume();
+	QThread::msleep(100);
+	this->canPtr->pause();
+	QVERIFY(popSettled(pausedVect, 1));
+	msgVect += pausedVect;
+	QCOMPARE(frameStr(msgVect), QString("0-%1").arg(msgVect.size() - 1));
+	for(int i = 0; i < msgVect.size(); ++i) {
+		QCOMPARE(msgVect[i].timestamp, makeFrame(i).timestamp);
+	}
+}
+
+void TestReplayCan::stepFrame_data(void)
+{
+	QTest::addColumn<QString>("idAllow");
+
+	QTest::newRow("all ids") << "";
+	QTest::newRow("ids left out are stepped over") << "2A0";
+}
+
+/// Every step sends the next frame replayed and nothing more.
+void TestReplayCan::stepFrame(void)
+{
+	QFETCH(QString, idAllow);
+	QVector<CanMsg> msgVect;
+
+	this->configPtr->setIdAllow(idAllow);
+	QVERIFY(connectPaused(msgVect));
+	uint64_t frame = getFrame(msgVect.last());
+	for(int i = 0; i < 5 && !QTest::currentTestFailed(); ++i) {
+		QVector<CanMsg> stepVect;
+
+		do {
+			++frame;
+		} while(!idAllow.isEmpty() && idArr[frame % 4] != 0x2A0);
+		this->canPtr->stepFrame();
+		QVERIFY(popSettled(stepVect, 1));
+		QCOMPARE(frameStr(stepVect), QString::number(frame));
+		QCOMPARE(stepVect[0].timestamp, makeFrame(frame).timestamp);
+	}
+	QVERIFY(this->canPtr->isConnected());
+}
+
+/// A packet step sends frames of any id up to the frame completing the next request or response,
+/// a step past the last packet replays to the end.
+void TestReplayCan::stepPacket(void)
+{
+	const QStringList stepStrList = { "1", "2-7", "8-9", "10" };
+	QVector<CanMsg> msgVect;
+
+	this->configPtr->setDev(this->udsPath);
+	QVERIFY(connectPaused(msgVect));
+	QCOMPARE(udsStr(msgVect), QString("0"));
+	for(const QString &stepStrRef : stepStrList) {
+		QVector<CanMsg> stepVect;
+
+		this->canPtr->stepPacket(reqCanId, respCanId);
+		QVERIFY(popSettled(stepVect, 1));
+		QCOMPARE(udsStr(stepVect), stepStrRef);
+	}
+	QVERIFY(popToEnd(msgVect));
+	QVERIFY(!this->canPtr->isConnected());
+}
+
+void TestReplayCan::seek_data(void)
+{
+	QTest::addColumn<QString>("startMs");
+	QTest::addColumn<QString>("startFrame");
+	QTest::addColumn<QString>("endMs");
+	QTest::addColumn<qulonglong>("seekMs");
+	QTest::addColumn<qlonglong>("seekFrame");  //!< frame replay goes on with, -1 when it ends
+
+	const qulonglong blockFrames = CaptureFormat::blockFrames;
+
+	QTest::newRow("forward") << "0" << "0" << "0" << 5000ULL << 5000LL;
+	QTest::newRow("back to start") << "0" << "0" << "0" << 0ULL << 0LL;
+	QTest::newRow("into a later block") << "0" << "0" << "0" << blockFrames * 2 + 5 << (qlonglong)(blockFrames * 2 + 5);
+	QTest::newRow("within window") << "2000" << "0" << "0" << 2500ULL << 2500LL;
+	QTest::newRow("before window start") << "2000" << "0" << "0" << 500ULL << 2000LL;
+	QTest::newRow("before window start frame") << "0" << "3001" << "0" << 500ULL << 3001LL;
+	QTest::newRow("to window start frame") << "0" << "3001" << "0" << 3001ULL << 3001LL;
+	QTest::newRow("past window end") << "0" << "0" << "3000" << 4000ULL << -1LL;
+	QTest::newRow("past capture end") << "0" << "0" << "0" << (qulonglong)numOfMsg * 2 << -1LL;
+}
+
+/// Paused replay stays paused at the seek position. The frame after the seek gets the timestamp of
+/// the last frame sent, those after it go on at recorded spacing.
+void TestReplayCan::seek(void)
+{
+	QFETCH(QString, startMs);
+	QFETCH(QString, startFrame);
+	QFETCH(QString, endMs);
+	QFETCH(qulonglong, seekMs);
+	QFETCH(qlonglong, seekFrame);
+	QVector<CanMsg> msgVect;
+	QVector<CanMsg> stepVect;
+
+	this->configPtr->setStartMs(startMs);
+	this->configPtr->setStartFrame(startFrame);
+	this->configPtr->setEndMs(endMs);
+	QVERIFY(connectPaused(msgVect));
+	const uint64_t lastUs = msgVect.last().timestamp;
+	this->canPtr->seek(seekMs);
+	this->canPtr->stepFrame();
+	if(seekFrame < 0) {
+		QVERIFY(popToEnd(stepVect));
+		QVERIFY(stepVect.isEmpty());
+		QVERIFY(!this->canPtr->isConnected());
+		return;
+	}
+	QVERIFY(popSettled(stepVect, 1));
+	QCOMPARE(frameStr(stepVect), QString::number(seekFrame));
+	QCOMPARE(stepVect[0].timestamp, lastUs);
+
+	this->canPtr->stepFrame();
+	QVERIFY(popSettled(stepVect, 1));
+	QCOMPARE(frameStr(stepVect), QString("%1-%2").arg(seekFrame).arg(seekFrame + 1));
+	QCOMPARE(stepVect[1].timestamp, lastUs + frameUs);
+	QVERIFY(this->canPtr->isConnected());
+}
+
+/// Looping replays the window over and over, timestamps keep going forward across loops. Loop
+/// switched off while replaying ends replay at the window end.
+void TestReplayCan::loop(void)
+{
+	const uint64_t windowFrames = 10;
+	QVector<CanMsg> msgVect;
+	QElapsedTimer timer;
+
+	this->configPtr->setStartMs("1000");
+	this->configPtr->setEndMs(QString::number(1000 + windowFrames));
+	this->configPtr->setLoop("on");
+	this->configPtr->setSpeedPct("100");
+	this->canPtr->connect(this->configPtr.get());
+	timer.start();
+	while(msgVect.size() < (int)windowFrames * 3 + 5 && timer.elapsed() < 10000) {
+		CanMsg msg;
+
+		if(this->canPtr->popRx(&msg, 1) == 1) {
+			msgVect.append(msg);
+		} else {
+			QThread::usleep(100);
+		}
+	}
+	this->canPtr->setLoop(false);
+	QVERIFY(popToEnd(msgVect));
+	QVERIFY(!this->canPtr->isConnected());
+
+	QCOMPARE(msgVect.size() % (int)windowFrames, 0);
+	QVERIFY(msgVect.size() >= (int)windowFrames * 4);
+	for(int i = 0; i < msgVect.size() && !QTest::currentTestFailed(); ++i) {
+		QCOMPARE(getFrame(msgVect[i]), 1000 + i % windowFrames);
+		if(i == 0) {
+			QCOMPARE(msgVect[i].timestamp, makeFrame(1000).timestamp);
+		} else {
+			// frame after a loop goes on from the last one sent
+			QCOMPARE(msgVect[i].timestamp - msgVect[i - 1].timestamp, i % windowFrames == 0 ? 0 : frameUs);
+		}
+	}
+}
+
+QTEST_GUILESS_MAIN(TestReplayCan)
+
+#include "tst_replaycan.moc"
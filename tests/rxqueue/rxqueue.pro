@@ -0,0 +1,23 @@
+include(../tests.pri)
+
+# Rx queue policies of Can, driven by a backend that pushes frames queued by the test.
+TARGET = tst_rxqueue
+QT += xml
+
+SOURCES += \
+    tst_rxqueue.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/can.cpp \
+    $$SRC_ROOT/logic/config.cpp \
+    $$SRC_ROOT/logic/rxspill.cpp \
+    $$SRC_ROOT/logic/timestamp.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/can.h \
+    $$SRC_ROOT/logic/config.h
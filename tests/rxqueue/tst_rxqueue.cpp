@@ -0,0 +1,282 @@
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QtTest>
+#include <atomic>
+#include <memory>
+#include "can.h"
+#include "config.h"
+#include "rxspill.h"
+
+/// @brief Backend whose rx thread pushes frames queued by the test, a burst at a time as a driver would.
+/// Frame ids count up from 0 over the whole connection, so order and losses are easy to see.
+class ScriptCan : public Can
+{
+public:
+	ScriptCan(void) :
+		Can(nullptr),
+		nextId(0),
+		numOfQueued(0),
+		isEndOfInput(false)
+	{
+	}
+
+	void connect(const void *configPtr) override {
+		(void)configPtr;
+		startRxThread();
+	}
+
+	void disconnect(void) override {
+		stopRxThread();
+	}
+
+	void queueFrames(size_t numOfMsg) {
+		QMutexLocker locker(&this->mutex);
+		this->numOfQueued += numOfMsg;
+	}
+
+	/// @brief Once queued frames are pushed, rx ends itself as replay does at end of file.
+	void endInput(void) {
+		this->isEndOfInput.store(true);
+	}
+
+	/// @brief True when rx thread pushed everything queued so far.
+	bool isInputDone(void) {
+		QMutexLocker locker(&this->mutex);
+		return this->numOfQueued == 0;
+	}
+
+private:
+	QMutex mutex;
+	uint32_t nextId;
+	size_t numOfQueued;
+	std::atomic<bool> isEndOfInput;
+
+	void rx(void) override {
+		size_t numOfMsg = 0;
+		{
+			QMutexLocker locker(&this->mutex);
+			numOfMsg = this->numOfQueued < rxBurstSize ? this->numOfQueued : rxBurstSize;
+		}
+		if(numOfMsg == 0) {
+			if(this->isEndOfInput.load()) {
+				drainRxSpill();
+				if(this->isRxRunning.load()) {
+					disconnect();
+				}
+				return;
+			}
+			QThread::usleep(100);
+			return;
+		}
+		for(size_t i = 0; i < numOfMsg; ++i) {
+			this->rxBurstArr[i] = {};
+			this->rxBurstArr[i].id = this->nextId++;
+			this->rxBurstArr[i].dataLength = 8;
+		}
+		pushRx(this->rxBurstArr, numOfMsg);
+		notifyRx();
+		QMutexLocker locker(&this->mutex);
+		this->numOfQueued -= numOfMsg;
+	}
+};
+
+class TestRxQueue : public QObject
+{
+	Q_OBJECT
+private slots:
+	void init(void);
+	void cleanup(void);
+	void blockWaitsForConsumer(void);
+	void dropNewestKeepsQueued(void);
+	void dropOldestNeverWaits(void);
+	void dropOldestKeepsNewestWhileDraining(void);
+	void spillIsLossless(void);
+	void spillDrainsAtEndOfInput(void);
+	void benchmarkSpill(void);
+
+private:
+	static constexpr size_t queueSize = 64;
+	std::unique_ptr<ScriptCan> canPtr;
+	void connect(const QString &policyRef);
+	size_t popFor(size_t numOfMsg, int timeoutMs, QVector<CanMsg> &msgVectRef);
+	static bool isOrdered(const QVector<CanMsg> &msgVectRef, uint32_t firstId);
+};
+
+void TestRxQueue::init(void)
+{
+	this->canPtr.reset(new ScriptCan());
+}
+
+void TestRxQueue::cleanup(void)
+{
+	if(this->canPtr->isConnected()) {
+		this->canPtr->disconnect();
+	}
+	this->canPtr.reset();
+}
+
+void TestRxQueue::connect(const QString &policyRef)
+{
+	ConfigGeneric config;
+
+	config.setRxQueuePolicy(policyRef);
+	config.setRxQueueSize(QString::number(queueSize));
+	this->canPtr->configure(config);
+	this->canPtr->connect(nullptr);
+}
+
+/// Pops from rx queue until numOfMsg frames arrived or timeout passed, returns number popped.
+size_t TestRxQueue::popFor(size_t numOfMsg, int timeoutMs, QVector<CanMsg> &msgVectRef)
+{
+	QElapsedTimer timer;
+	CanMsg msg;
+
+	timer.start();
+	while((size_t)msgVectRef.size() < numOfMsg && timer.elapsed() < timeoutMs) {
+		if(this->canPtr->popRx(&msg, 1) == 1) {
+			msgVectRef.append(msg);
+		} else {
+			QThread::usleep(100);
+		}
+	}
+	return msgVectRef.size();
+}
+
+bool TestRxQueue::isOrdered(const QVector<CanMsg> &msgVectRef, uint32_t firstId)
+{
+	for(int i = 0; i < msgVectRef.size(); ++i) {
+		if(msgVectRef[i].id != firstId + (uint32_t)i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestRxQueue::blockWaitsForConsumer(void)
+{
+	QVector<CanMsg> msgVect;
+
+	connect(RxQueuePolicyType::Block);
+	this->canPtr->queueFrames(200);
+	QThread::msleep(50);
+	QCOMPARE(this->canPtr->rxQueue.size(), queueSize);
+	QVERIFY(!this->canPtr->isInputDone());
+
+	QCOMPARE(popFor(200, 1000, msgVect), (size_t)200);
+	QVERIFY(isOrdered(msgVect, 0));
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)0);
+}
+
+void TestRxQueue::dropNewestKeepsQueued(void)
+{
+	QVector<CanMsg> msgVect;
+
+	connect(RxQueuePolicyType::DropNewest);
+	this->canPtr->queueFrames(200);
+	QTRY_VERIFY_WITH_TIMEOUT(this->canPtr->isInputDone(), 1000);
+
+	QCOMPARE(popFor(200, 50, msgVect), queueSize);
+	QVERIFY(isOrdered(msgVect, 0));
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)(200 - queueSize));
+}
+
+void TestRxQueue::dropOldestNeverWaits(void)
+{
+	QVector<CanMsg> msgVect;
+
+	connect(RxQueuePolicyType::DropOldest);
+	// consumer is stalled, rx thread still gets rid of every frame at once
+	this->canPtr->queueFrames(200);
+	QTRY_VERIFY_WITH_TIMEOUT(this->canPtr->isInputDone(), 1000);
+
+	// newest queueSize frames are what is left of the stall
+	QCOMPARE(popFor(200, 200, msgVect), queueSize);
+	QVERIFY(isOrdered(msgVect, 200 - queueSize));
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)(200 - queueSize));
+
+	// what comes after it is kept as it is
+	msgVect.clear();
+	this->canPtr->queueFrames(10);
+	QCOMPARE(popFor(10, 1000, msgVect), (size_t)10);
+	QVERIFY(isOrdered(msgVect, 200));
+	QCOMPARE(this->canPtr->rxStats.framesRead.get(), (uint64_t)210);
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)(200 - queueSize));
+}
+
+void TestRxQueue::dropOldestKeepsNewestWhileDraining(void)
+{
+	QVector<CanMsg> msgVect;
+	CanMsg msg;
+
+	connect(RxQueuePolicyType::DropOldest);
+	this->canPtr->queueFrames(100);
+	QTRY_VERIFY_WITH_TIMEOUT(this->canPtr->isInputDone(), 1000);
+	// consumer reads a little, then more arrives than fits
+	QCOMPARE(this->canPtr->popRx(&msg, 1), (size_t)1);
+	QCOMPARE(msg.id, (uint32_t)(100 - queueSize));
+	this->canPtr->queueFrames(100);
+	QTRY_VERIFY_WITH_TIMEOUT(this->canPtr->isInputDone(), 1000);
+
+	QCOMPARE(popFor(200, 200, msgVect), queueSize);
+	QVERIFY(isOrdered(msgVect, 200 - queueSize));
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)(200 - 1 - queueSize));
+}
+
+void TestRxQueue::spillIsLossless(void)
+{
+	QVector<CanMsg> msgVect;
+
+	connect(RxQueuePolicyType::Spill);
+	this->canPtr->queueFrames(1000);
+	QTRY_VERIFY_WITH_TIMEOUT(this->canPtr->isInputDone(), 1000);
+	QVERIFY(this->canPtr->rxStats.framesSpilled.get() >= 1000 - queueSize);
+
+	QCOMPARE(popFor(1000, 2000, msgVect), (size_t)1000);
+	QVERIFY(isOrdered(msgVect, 0));
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)0);
+}
+
+void TestRxQueue::spillDrainsAtEndOfInput(void)
+{
+	QVector<CanMsg> msgVect;
+
+	connect(RxQueuePolicyType::Spill);
+	this->canPtr->queueFrames(1000);
+	this->canPtr->endInput();
+	// input ends while most of it is still spilled
+	QThread::msleep(20);
+
+	QCOMPARE(popFor(1000, 2000, msgVect), (size_t)1000);
+	QVERIFY(isOrdered(msgVect, 0));
+	QTRY_VERIFY_WITH_TIMEOUT(!this->canPtr->isConnected(), 1000);
+	QCOMPARE(this->canPtr->rxStats.framesDropped.get(), (uint64_t)0);
+}
+
+void TestRxQueue::benchmarkSpill(void)
+{
+	const size_t numOfMsg = 64 * 16384;
+	RxSpill spill;
+	CanMsg msgArr[64] = {};
+	size_t numOfRead = 0;
+
+	for(size_t i = 0; i < 64; ++i) {
+		msgArr[i].dataLength = 8;
+	}
+	// write and read back in bursts, as rx thread does under a stalled decoder
+	QBENCHMARK {
+		numOfRead = 0;
+		for(size_t i = 0; i < numOfMsg; i += 64) {
+			spill.write(msgArr, 64);
+		}
+		while(spill.read(msgArr, 64) != 0) {
+			numOfRead += 64;
+		}
+	}
+	QCOMPARE(numOfRead, numOfMsg);
+}
+
+QTEST_GUILESS_MAIN(TestRxQueue)
+
+#include "tst_rxqueue.moc"
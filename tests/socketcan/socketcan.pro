@@ -0,0 +1,25 @@
+include(../tests.pri)
+
+# SocketCan against vcan0, skipped when the interface is not up or not on Linux.
+TARGET = tst_socketcan
+QT += xml
+
+SOURCES += \
+    tst_socketcan.cpp
+
+SOURCES += \
+    $$SRC_ROOT/logic/capture/captureformat.cpp \
+    $$SRC_ROOT/logic/cmd/cmddef.cpp \
+    $$SRC_ROOT/logic/cobs/cobs.c \
+    $$SRC_ROOT/logic/socketcan/socketcan.cpp \
+    $$SRC_ROOT/logic/can.cpp \
+    $$SRC_ROOT/logic/config.cpp \
+    $$SRC_ROOT/logic/rxspill.cpp \
+    $$SRC_ROOT/logic/timestamp.cpp \
+    $$SRC_ROOT/logic/util.cpp
+
+HEADERS += \
+    $$SRC_ROOT/logic/cmd/cmddef.h \
+    $$SRC_ROOT/logic/socketcan/socketcan.h \
+    $$SRC_ROOT/logic/can.h \
+    $$SRC_ROOT/logic/config.h
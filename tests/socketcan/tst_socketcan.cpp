@@ -0,0 +1,195 @@
+#include <QElapsedTimer>
+#include <QThread>
+#include <QVector>
+#include <QtTest>
+#include <memory>
+#ifdef Q_OS_LINUX
+#include <cstring>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#endif
+#include "config.h"
+#include "socketcan.h"
+
+/// @brief SocketCan rx thread against vcan0: frame kinds and timestamps from one clock.
+/// Needs `ip link add dev vcan0 type vcan && ip link set up vcan0`, skipped otherwise.
+class TestSocketCan : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase(void);
+	void cleanupTestCase(void);
+	void init(void);
+	void cleanup(void);
+	void frameKinds(void);
+	void timestampsFromOneClock(void);
+
+private:
+	static const char *const dev;
+	std::unique_ptr<SocketCan> canPtr;
+	ConfigSocket configSocket;
+	int txFd = -1;
+	bool send(uint32_t canId, uint8_t len, bool isFd, uint8_t fdFlags = 0);
+	size_t popFor(size_t numOfMsg, int timeoutMs, QVector<CanMsg> &msgVectRef);
+};
+
+const char *const TestSocketCan::dev = "vcan0";
+
+/// Payload counts up from the id, so no two frames carry the same data.
+bool TestSocketCan::send(uint32_t canId, uint8_t len, bool isFd, uint8_t fdFlags)
+{
+#ifdef Q_OS_LINUX
+	struct canfd_frame frame;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.can_id = canId;
+	frame.len = len;
+	frame.flags = fdFlags;
+	for(uint8_t i = 0; i < len; ++i) {
+		frame.data[i] = (uint8_t)(canId + i);
+	}
+	const size_t size = isFd ? CANFD_MTU : CAN_MTU;
+	return ::write(this->txFd, &frame, size) == (ssize_t)size;
+#else
+	(void)canId;
+	(void)len;
+	(void)isFd;
+	(void)fdFlags;
+	return false;
+#endif
+}
+
+/// Pops from rx queue until numOfMsg frames arrived or timeout passed, returns number popped.
+size_t TestSocketCan::popFor(size_t numOfMsg, int timeoutMs, QVector<CanMsg> &msgVectRef)
+{
+	QElapsedTimer timer;
+	CanMsg msg;
+
+	timer.start();
+	while((size_t)msgVectRef.size() < numOfMsg && timer.elapsed() < timeoutMs) {
+		if(this->canPtr->popRx(&msg, 1) == 1) {
+			msgVectRef.append(msg);
+		} else {
+			QThread::usleep(100);
+		}
+	}
+	return msgVectRef.size();
+}
+
+void TestSocketCan::initTestCase(void)
+{
+#ifdef Q_OS_LINUX
+	struct sockaddr_can addr;
+	int enable = 1;
+
+	if(if_nametoindex(dev) == 0) {
+		QSKIP("vcan0 is not up");
+	}
+	this->txFd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+	QVERIFY(this->txFd >= 0);
+	QVERIFY(::setsockopt(this->txFd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) == 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = (int)if_nametoindex(dev);
+	QVERIFY(::bind(this->txFd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+	this->configSocket.setDev(dev);
+#else
+	QSKIP("SocketCAN is only available on Linux");
+#endif
+}
+
+void TestSocketCan::cleanupTestCase(void)
+{
+#ifdef Q_OS_LINUX
+	if(this->txFd >= 0) {
+		::close(this->txFd);
+	}
+#endif
+}
+
+void TestSocketCan::init(void)
+{
+	this->canPtr.reset(new SocketCan());
+	this->canPtr->connect(&this->configSocket);
+	QVERIFY(this->canPtr->isConnected());
+	QThread::msleep(20);
+}
+
+void TestSocketCan::cleanup(void)
+{
+	if(this->canPtr != nullptr && this->canPtr->isConnected()) {
+		this->canPtr->disconnect();
+	}
+	this->canPtr.reset();
+}
+
+void TestSocketCan::frameKinds(void)
+{
+#ifdef Q_OS_LINUX
+	QVector<CanMsg> msgVect;
+
+	QVERIFY(send(0x123, 8, false));
+	QVERIFY(send(0x18DAF110 | CAN_EFF_FLAG, 3, false));
+	QVERIFY(send(0x7DF | CAN_RTR_FLAG, 0, false));
+	QVERIFY(send(0x700, 64, true, CANFD_BRS));
+	QVERIFY(send(0x1FFFFFFF | CAN_EFF_FLAG, 12, true, CANFD_ESI));
+	QCOMPARE(popFor(5, 1000, msgVect), (size_t)5);
+
+	// sent from this host, every frame comes back as local loopback
+	QCOMPARE(msgVect[0].id, (uint32_t)0x123);
+	QCOMPARE(msgVect[0].flags, (uint8_t)CanMsgFlagTx);
+	QCOMPARE(msgVect[0].dataLength, (uint8_t)8);
+	QCOMPARE(msgVect[0].data[7], (uint8_t)(0x123 + 7));
+	QCOMPARE(msgVect[1].id, (uint32_t)0x18DAF110);
+	QCOMPARE(msgVect[1].flags, (uint8_t)(CanMsgFlagExtended | CanMsgFlagTx));
+	QCOMPARE(msgVect[1].dataLength, (uint8_t)3);
+	QCOMPARE(msgVect[2].id, (uint32_t)0x7DF);
+	QCOMPARE(msgVect[2].flags, (uint8_t)(CanMsgFlagRtr | CanMsgFlagTx));
+	QCOMPARE(msgVect[2].dataLength, (uint8_t)0);
+	QCOMPARE(msgVect[3].id, (uint32_t)0x700);
+	QCOMPARE(msgVect[3].flags, (uint8_t)(CanMsgFlagFd | CanMsgFlagBrs | CanMsgFlagTx));
+	QCOMPARE(msgVect[3].dataLength, (uint8_t)64);
+	QCOMPARE(msgVect[3].data[63], (uint8_t)(0x700 + 63));
+	QCOMPARE(msgVect[4].id, (uint32_t)0x1FFFFFFF);
+	QCOMPARE(msgVect[4].flags, (uint8_t)(CanMsgFlagFd | CanMsgFlagEsi | CanMsgFlagExtended | CanMsgFlagTx));
+	QCOMPARE(msgVect[4].dataLength, (uint8_t)12);
+#endif
+}
+
+/// Frames go out in small bursts with pauses between them. Stamps from one clock never go
+/// back and no step between two frames is longer than the time between the sends.
+void TestSocketCan::timestampsFromOneClock(void)
+{
+	const uint32_t numOfBursts = 50;
+	const uint32_t burstFrames = 20;
+	QVector<CanMsg> msgVect;
+	QElapsedTimer timer;
+
+	timer.start();
+	for(uint32_t i = 0; i < numOfBursts; ++i) {
+		for(uint32_t j = 0; j < burstFrames; ++j) {
+			QVERIFY(send(0x100 + j, 8, (j & 1) != 0));
+		}
+		QThread::msleep(2);
+	}
+	const int64_t sendUs = timer.nsecsElapsed() / 1000;
+	QCOMPARE(popFor(numOfBursts * burstFrames, 2000, msgVect), (size_t)(numOfBursts * burstFrames));
+
+	for(int i = 1; i < msgVect.size(); ++i) {
+		QVERIFY2(
+			msgVect[i].timestamp >= msgVect[i - 1].timestamp,
+			qPrintable(QString("frame %1 at %2 us, one before at %3 us").arg(i).arg(msgVect[i].timestamp).arg(msgVect[i - 1].timestamp))
+		);
+	}
+	const uint64_t spanUs = msgVect.last().timestamp - msgVect.first().timestamp;
+	QVERIFY2(spanUs <= (uint64_t)sendUs, qPrintable(QString("%1 us of frames sent in %2 us").arg(spanUs).arg(sendUs)));
+	// 2 ms pauses are seen, frames were not all stamped when rx read them
+	QVERIFY2(spanUs >= (numOfBursts - 1) * 2000, qPrintable(QString("%1 us of frames").arg(spanUs)));
+}
+
+QTEST_GUILESS_MAIN(TestSocketCan)
+
+#include "tst_socketcan.moc"
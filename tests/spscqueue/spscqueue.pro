@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+# SpscQueue and FrameRing, plus a benchmark against the mutex queue they replaced.
+TARGET = tst_spscqueue
+
+SOURCES += \
+    tst_spscqueue.cpp
+
+HEADERS += \
+    $$SRC_ROOT/logic/canmsg.h \
+    $$SRC_ROOT/logic/framering.h \
+    $$SRC_ROOT/logic/spscqueue.h
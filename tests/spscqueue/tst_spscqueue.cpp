@@ -0,0 +1,298 @@
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QtTest>
+#include "canmsg.h"
+#include "framering.h"
+#include "spscqueue.h"
+
+/// @brief Mutex guarded queue the rx path used before SpscQueue, kept as benchmark baseline.
+/// Every frame takes the lock once on each side, as enqueue and dequeue did.
+template <typename T>
+class ThreadSafeQueue {
+public:
+	explicit ThreadSafeQueue(size_t capacity) {
+		(void)capacity;
+	}
+
+	size_t pushN(const T *valuePtr, size_t count) {
+		for(size_t i = 0; i < count; ++i) {
+			QMutexLocker locker(&this->mutex);
+			this->queue.enqueue(valuePtr[i]);
+		}
+		return count;
+	}
+
+	size_t tryPopN(T *valuePtr, size_t maxCount) {
+		size_t count = 0;
+		for(; count < maxCount; ++count) {
+			QMutexLocker locker(&this->mutex);
+			if(this->queue.isEmpty()) {
+				break;
+			}
+			valuePtr[count] = this->queue.dequeue();
+		}
+		return count;
+	}
+
+private:
+	QQueue<T> queue;
+	QMutex mutex;
+};
+
+class TestSpscQueue : public QObject
+{
+	Q_OBJECT
+private slots:
+	void spscQueueKeepsOrderAcrossWrap(void);
+	void spscQueueFullRejects(void);
+	void frameRingKeepsFrames(void);
+	void frameRingFullRejects(void);
+	void twoThreadsKeepOrder(void);
+	void benchmarkThreadSafeQueue(void);
+	void benchmarkSpscQueue(void);
+	void benchmarkFrameRing(void);
+
+private:
+	static constexpr size_t queueCapacity = 16384; //!< as Can::rxQueueCapacity
+	static constexpr size_t burstSize = 64;        //!< as Can::rxBurstSize and the decoder pop batch
+	static constexpr size_t benchmarkFrames = 1000000;
+	static CanMsg makeMsg(size_t seq, uint8_t dataLength);
+	static bool isMsgOk(const CanMsg &msgRef, size_t seq, uint8_t dataLength);
+	template <typename Queue>
+	static bool handoff(Queue &queueRef, size_t numOfMsg, bool isMixedLength);
+};
+
+CanMsg TestSpscQueue::makeMsg(size_t seq, uint8_t dataLength)
+{
+	CanMsg msg = {};
+
+	msg.id = (uint32_t)seq;
+	msg.dataLength = dataLength;
+	for(uint8_t i = 0; i < dataLength; ++i) {
+		msg.data[i] = (uint8_t)(seq + i);
+	}
+	msg.timestamp = seq * 100;
+	msg.flags = dataLength > 8 ? CanMsgFlagFd : 0;
+	msg.channel = (uint8_t)(seq & 0x03);
+	return msg;
+}
+
+bool TestSpscQueue::isMsgOk(const CanMsg &msgRef, size_t seq, uint8_t dataLength)
+{
+	if(msgRef.id != (uint32_t)seq || msgRef.dataLength != dataLength || msgRef.timestamp != seq * 100) {
+		return false;
+	}
+	if(msgRef.channel != (uint8_t)(seq & 0x03)) {
+		return false;
+	}
+	for(uint8_t i = 0; i < dataLength; ++i) {
+		if(msgRef.data[i] != (uint8_t)(seq + i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Producer thread pushes numOfMsg frames in bursts, this thread pops them in batches.
+/// Returns true when every frame came out once and in order.
+template <typename Queue>
+bool TestSpscQueue::handoff(Queue &queueRef, size_t numOfMsg, bool isMixedLength)
+{
+	// 0 to 64 bytes in steps of 8, FD frames make FrameRing wrap at odd places
+	auto getDataLength = [isMixedLength](size_t seq) {
+		return (uint8_t)(isMixedLength ? (seq % 9) * 8 : 8);
+	};
+	QThread *producerPtr = QThread::create([&queueRef, numOfMsg, getDataLength]() {
+		CanMsg burstArr[burstSize];
+		size_t numOfPushed = 0;
+		while(numOfPushed < numOfMsg) {
+			const size_t numOfBurst = qMin(burstSize, numOfMsg - numOfPushed);
+			for(size_t i = 0; i < numOfBurst; ++i) {
+				burstArr[i] = makeMsg(numOfPushed + i, getDataLength(numOfPushed + i));
+			}
+			size_t numOfDone = 0;
+			while(numOfDone < numOfBurst) {
+				numOfDone += queueRef.pushN(burstArr + numOfDone, numOfBurst - numOfDone);
+				if(numOfDone < numOfBurst) {
+					QThread::yieldCurrentThread();
+				}
+			}
+			numOfPushed += numOfBurst;
+		}
+	});
+	CanMsg popArr[burstSize];
+	size_t numOfPopped = 0;
+	bool isOrdered = true;
+
+	producerPtr->start();
+	while(numOfPopped < numOfMsg) {
+		const size_t numOfBatch = queueRef.tryPopN(popArr, burstSize);
+		if(numOfBatch == 0) {
+			QThread::yieldCurrentThread();
+			continue;
+		}
+		for(size_t i = 0; i < numOfBatch; ++i) {
+			isOrdered = isOrdered && isMsgOk(popArr[i], numOfPopped + i, getDataLength(numOfPopped + i));
+		}
+		numOfPopped += numOfBatch;
+	}
+	producerPtr->wait();
+	delete producerPtr;
+	return isOrdered && queueRef.tryPopN(popArr, burstSize) == 0;
+}
+
+void TestSpscQueue::spscQueueKeepsOrderAcrossWrap(void)
+{
+	SpscQueue<uint32_t> queue(5);
+	uint32_t valueArr[3];
+	uint32_t nextPushed = 0;
+	uint32_t nextPopped = 0;
+
+	QCOMPARE(queue.capacity(), (size_t)8);
+	// chunks of 3 never line up with capacity 8, so indexes wrap mid chunk
+	for(int round = 0; round < 1000; ++round) {
+		for(uint32_t i = 0; i < 3; ++i) {
+			valueArr[i] = nextPushed + i;
+		}
+		QCOMPARE(queue.pushN(valueArr, 3), (size_t)3);
+		nextPushed += 3;
+		QCOMPARE(queue.size(), (size_t)(nextPushed - nextPopped));
+		const size_t numOfPopped = queue.tryPopN(valueArr, round % 2 == 0 ? 2 : 3);
+		for(size_t i = 0; i < numOfPopped; ++i) {
+			QCOMPARE(valueArr[i], nextPopped++);
+		}
+		if(queue.size() > 4) {
+			QCOMPARE(queue.tryPopN(valueArr, 3), (size_t)3);
+			nextPopped += 3;
+		}
+	}
+	while(queue.tryPop(valueArr[0])) {
+		QCOMPARE(valueArr[0], nextPopped++);
+	}
+	QCOMPARE(nextPopped, nextPushed);
+	QVERIFY(queue.isEmpty());
+}
+
+void TestSpscQueue::spscQueueFullRejects(void)
+{
+	SpscQueue<uint32_t> queue(8);
+	uint32_t valueArr[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	uint32_t value = 0;
+
+	QCOMPARE(queue.pushN(valueArr, 10), (size_t)8);
+	QVERIFY(!queue.push(valueArr[8]));
+	QVERIFY(queue.tryPop(value));
+	QCOMPARE(value, (uint32_t)0);
+	QVERIFY(queue.push(valueArr[8]));
+	for(uint32_t i = 1; i <= 8; ++i) {
+		QVERIFY(queue.tryPop(value));
+		QCOMPARE(value, i);
+	}
+	QVERIFY(!queue.tryPop(value));
+}
+
+void TestSpscQueue::frameRingKeepsFrames(void)
+{
+	FrameRing<CanMsg> ring(8);
+	const uint8_t dataLengthArr[] = {0, 3, 8, 12, 64, 1, 48, 8};
+	CanMsg msg;
+	size_t nextPushed = 0;
+	size_t nextPopped = 0;
+
+	QCOMPARE(ring.capacity(), (size_t)8);
+	// 8 classic frames of 3 words, rounded up to 32 words
+	QCOMPARE(ring.capacityBytes(), (size_t)256);
+	for(int round = 0; round < 500; ++round) {
+		for(int i = 0; i < 2; ++i) {
+			const uint8_t dataLength = dataLengthArr[nextPushed % sizeof(dataLengthArr)];
+			if(!ring.push(makeMsg(nextPushed, dataLength))) {
+				break;
+			}
+			++nextPushed;
+		}
+		QCOMPARE(ring.size(), nextPushed - nextPopped);
+		if(ring.tryPop(msg)) {
+			QVERIFY(isMsgOk(msg, nextPopped, dataLengthArr[nextPopped % sizeof(dataLengthArr)]));
+			++nextPopped;
+		}
+	}
+	while(ring.tryPop(msg)) {
+		QVERIFY(isMsgOk(msg, nextPopped, dataLengthArr[nextPopped % sizeof(dataLengthArr)]));
+		++nextPopped;
+	}
+	QCOMPARE(nextPopped, nextPushed);
+	QVERIFY(nextPushed > 500);
+	QVERIFY(ring.isEmpty());
+}
+
+void TestSpscQueue::frameRingFullRejects(void)
+{
+	FrameRing<CanMsg> ring(8);
+	CanMsg msg;
+	size_t numOfPushed = 0;
+
+	// 64 byte frame takes 80 bytes, ring is sized for classic frames of 24 bytes
+	while(ring.push(makeMsg(numOfPushed, 64))) {
+		++numOfPushed;
+	}
+	QCOMPARE(numOfPushed, ring.capacityBytes() / 80);
+	QCOMPARE(ring.size(), numOfPushed);
+	// what did not fit left nothing behind, the ring still holds exactly what it took
+	QVERIFY(ring.tryPop(msg));
+	QVERIFY(isMsgOk(msg, 0, 64));
+	QVERIFY(ring.push(makeMsg(numOfPushed, 64)));
+	for(size_t i = 1; i <= numOfPushed; ++i) {
+		QVERIFY(ring.tryPop(msg));
+		QVERIFY(isMsgOk(msg, i, 64));
+	}
+	QVERIFY(!ring.tryPop(msg));
+}
+
+void TestSpscQueue::twoThreadsKeepOrder(void)
+{
+	SpscQueue<CanMsg> queue(64);
+	FrameRing<CanMsg> ring(64);
+
+	// small capacity keeps both sides running into full and empty all the time
+	QVERIFY(handoff(queue, 200000, false));
+	QVERIFY(handoff(ring, 200000, true));
+}
+
+void TestSpscQueue::benchmarkThreadSafeQueue(void)
+{
+	ThreadSafeQueue<CanMsg> queue(queueCapacity);
+	bool isOk = true;
+
+	QBENCHMARK {
+		isOk = handoff(queue, benchmarkFrames, false) && isOk;
+	}
+	QVERIFY(isOk);
+}
+
+void TestSpscQueue::benchmarkSpscQueue(void)
+{
+	SpscQueue<CanMsg> queue(queueCapacity);
+	bool isOk = true;
+
+	QBENCHMARK {
+		isOk = handoff(queue, benchmarkFrames, false) && isOk;
+	}
+	QVERIFY(isOk);
+}
+
+void TestSpscQueue::benchmarkFrameRing(void)
+{
+	FrameRing<CanMsg> ring(queueCapacity);
+	bool isOk = true;
+
+	QBENCHMARK {
+		isOk = handoff(ring, benchmarkFrames, false) && isOk;
+	}
+	QVERIFY(isOk);
+}
+
+QTEST_GUILESS_MAIN(TestSpscQueue)
+
+#include "tst_spscqueue.moc"
@@ -0,0 +1,106 @@
+/**
+ * @defgroup testcapture_h
+ * @{
+ * @file testcapture.h
+ * @brief Writes .cobs captures for tests, laid out as CanLog lays them out: header, frame
+ * records and a block index record after every blockFrames frames and on close, or compressed
+ * block records only. No .idx is written, readers build it on demand.
+ */
+#ifndef TESTCAPTURE_H
+#define TESTCAPTURE_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "captureformat.h"
+
+namespace TestCapture
+{
+	inline bool write(const QString &pathRef, const std::vector<CanMsg> &msgVecRef, uint64_t createdUs)
+	{
+		QFile file(pathRef);
+		QByteArray bfr;
+		uint8_t record[CaptureFormat::maxRecordSize];
+		uint8_t encoded[CaptureFormat::maxEncodedRecordSize];
+		CaptureBlockIndex blockIndex = {};
+
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return false;
+		}
+		bfr.resize((qsizetype)CaptureFormat::fileHeaderSize);
+		CaptureFormat::writeFileHeader(reinterpret_cast<uint8_t *>(bfr.data()), createdUs);
+		for(size_t i = 0; i <= msgVecRef.size(); ++i) {
+			const bool isEnd = i == msgVecRef.size();
+			if(blockIndex.numOfFrames == CaptureFormat::blockFrames || (isEnd && blockIndex.numOfFrames != 0)) {
+				const size_t recordSize = CaptureFormat::encodeBlockIndex(blockIndex, record);
+				bfr.append(reinterpret_cast<const char *>(encoded), CaptureFormat::encodeRecord(record, recordSize, encoded));
+				blockIndex.firstFrame += blockIndex.numOfFrames;
+				blockIndex.numOfFrames = 0;
+			}
+			if(isEnd) {
+				break;
+			}
+			if(blockIndex.numOfFrames == 0) {
+				blockIndex.blockOffset = bfr.size();
+				blockIndex.firstTimestamp = msgVecRef[i].timestamp;
+			}
+			const size_t recordSize = CaptureFormat::encodeFrame(msgVecRef[i], record);
+			bfr.append(reinterpret_cast<const char *>(encoded), CaptureFormat::encodeRecord(record, recordSize, encoded));
+			blockIndex.lastTimestamp = msgVecRef[i].timestamp;
+			++blockIndex.numOfFrames;
+		}
+		return file.write(bfr) == bfr.size();
+	}
+
+	/// @brief As write, with compressed block records of blockFrames frames each, as CanLog packs them.
+	inline bool writeCompressed(const QString &pathRef, const std::vector<CanMsg> &msgVecRef, uint64_t createdUs, uint32_t blockFrames)
+	{
+		QFile file(pathRef);
+		QByteArray bfr;
+		QByteArray blockBfr;
+		uint8_t record[CaptureFormat::maxRecordSize];
+		CaptureBlockIndex blockIndex = {};
+
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return false;
+		}
+		bfr.resize((qsizetype)CaptureFormat::fileHeaderSize);
+		CaptureFormat::writeFileHeader(reinterpret_cast<uint8_t *>(bfr.data()), createdUs, CaptureFormat::fileFlagCompressed);
+		for(size_t i = 0; i < msgVecRef.size(); ++i) {
+			if(blockIndex.numOfFrames == 0) {
+				blockBfr.fill(0, CaptureFormat::compressedHeaderSize);
+				blockIndex.firstTimestamp = msgVecRef[i].timestamp;
+			}
+			const size_t recordSize = CaptureFormat::encodeFrame(msgVecRef[i], record);
+			blockBfr.append(reinterpret_cast<const char *>(record), recordSize);
+			blockIndex.lastTimestamp = msgVecRef[i].timestamp;
+			++blockIndex.numOfFrames;
+			if(blockIndex.numOfFrames == blockFrames || i + 1 == msgVecRef.size()) {
+				const uint32_t uncompressedSize = blockBfr.size() - CaptureFormat::compressedHeaderSize;
+				CaptureFormat::encodeCompressedHeader(blockIndex, uncompressedSize, reinterpret_cast<uint8_t *>(blockBfr.data()));
+				CaptureFormat::compressBlock(blockBfr.constData(), blockBfr.size(), bfr);
+				blockIndex.firstFrame += blockIndex.numOfFrames;
+				blockIndex.numOfFrames = 0;
+			}
+		}
+		return file.write(bfr) == bfr.size();
+	}
+
+	/// @brief Classic frame of up to 8 bytes.
+	inline CanMsg makeMsg(uint32_t id, const std::vector<uint8_t> &dataRef, uint64_t timestamp)
+	{
+		CanMsg msg = {};
+
+		msg.id = id;
+		msg.dataLength = (uint8_t)dataRef.size();
+		for(size_t i = 0; i < dataRef.size(); ++i) {
+			msg.data[i] = dataRef[i];
+		}
+		msg.timestamp = timestamp;
+		return msg;
+	}
+} // namespace TestCapture
+
+#endif // TESTCAPTURE_H
+
+/// @}
@@ -0,0 +1,23 @@
+# Settings shared by all test projects. Sources under test are taken
+# from the application tree, nothing is built as a library.
+QT += core testlib
+QT -= gui
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+SRC_ROOT = $$PWD/..
+
+# helpers shared by tests, testcapture.h for one
+INCLUDEPATH += $$PWD
+INCLUDEPATH += $$SRC_ROOT/logic
+INCLUDEPATH += $$SRC_ROOT/logic/capture
+INCLUDEPATH += $$SRC_ROOT/logic/cmd
+INCLUDEPATH += $$SRC_ROOT/logic/cobs
+INCLUDEPATH += $$SRC_ROOT/logic/isotp
+win32 {
+    INCLUDEPATH += $$SRC_ROOT/drivers/peak-win-V4.10.1.968
+}
+INCLUDEPATH += $$SRC_ROOT/logic/peak
+INCLUDEPATH += $$SRC_ROOT/logic/socketcan
+INCLUDEPATH += $$SRC_ROOT/logic/uds
+INCLUDEPATH += $$SRC_ROOT/logic/uds/gen
@@ -0,0 +1,17 @@
+TEMPLATE = subdirs
+
+# Each test is a QtTest executable, run all with make check.
+SUBDIRS += \
+    bufferedwriter \
+    capturedecode \
+    captureexport \
+    captureindex \
+    capturerepair \
+    capturestream \
+    capturetext \
+    offlinedecode \
+    peakrx \
+    replaycan \
+    rxqueue \
+    socketcan \
+    spscqueue
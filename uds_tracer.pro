@@ -21,6 +21,16 @@ SOURCES += \
 SOURCES += \
     tracertabform/tracertabform.cpp
 
+SOURCES += \
+    logic/capture/capturefile.cpp \
+    logic/capture/captureformat.cpp \
+    logic/capture/captureexport.cpp \
+    logic/capture/captureindex.cpp \
+    logic/capture/capturereader.cpp \
+    logic/capture/capturerepair.cpp \
+    logic/capture/capturestream.cpp \
+    logic/capture/capturetext.cpp
+
 SOURCES += \
     logic/cmd/cmdcancfg.cpp \
     logic/cmd/cmd.cpp \
@@ -38,14 +48,25 @@ SOURCES += \
     logic/peak/peakfdcan.cpp \
     logic/peak/peakstdcan.cpp
 
+SOURCES += \
+    logic/socketcan/socketcan.cpp
+
 SOURCES += \
     logic/uds/uds.cpp \
     logic/uds/gen/uds_def.cpp
 
 SOURCES += \
+    logic/bufferedwriter.cpp \
     logic/can.cpp \
+    logic/canlog.cpp \
     logic/cli.cpp \
     logic/config.cpp \
+    logic/decoder.cpp \
+    logic/offlinedecoder.cpp \
+    logic/packetdecoder.cpp \
+    logic/rotation.cpp \
+    logic/rxspill.cpp \
+    logic/timestamp.cpp \
     logic/util.cpp
 
 
@@ -57,10 +78,12 @@ INCLUDEPATH += $$PWD/cantabform
 win32 {
     INCLUDEPATH += $$PWD/drivers/peak-win-V4.10.1.968
 }
+INCLUDEPATH += $$PWD/logic/capture
 INCLUDEPATH += $$PWD/logic/cmd
 INCLUDEPATH += $$PWD/logic/cobs
 INCLUDEPATH += $$PWD/logic/isotp
 INCLUDEPATH += $$PWD/logic/peak
+INCLUDEPATH += $$PWD/logic/socketcan
 INCLUDEPATH += $$PWD/logic/uds
 INCLUDEPATH += $$PWD/logic/uds/gen
 INCLUDEPATH += $$PWD/logic/
@@ -80,6 +103,16 @@ win32 {
         drivers/peak-win-V4.10.1.968/stdafx.h
 }
 
+HEADERS += \
+    logic/capture/capturefile.h \
+    logic/capture/captureformat.h \
+    logic/capture/captureexport.h \
+    logic/capture/captureindex.h \
+    logic/capture/capturereader.h \
+    logic/capture/capturerepair.h \
+    logic/capture/capturestream.h \
+    logic/capture/capturetext.h
+
 HEADERS += \
     logic/cmd/cmddef.h \
     logic/cmd/cmd.h
@@ -97,14 +130,29 @@ HEADERS += \
     logic/peak/peakfdcan.h \
     logic/peak/peakstdcan.h
 
+HEADERS += \
+    logic/socketcan/socketcan.h
+
 HEADERS += \
     logic/uds/uds.h \
     logic/uds/gen/uds_def.h
 
 HEADERS += \
+    logic/bufferedwriter.h \
     logic/can.h \
+    logic/canlog.h \
+    logic/canmsg.h \
     logic/config.h \
     logic/cli.h \
+    logic/decoder.h \
+    logic/framering.h \
+    logic/offlinedecoder.h \
+    logic/packetdecoder.h \
+    logic/rotation.h \
+    logic/rxspill.h \
+    logic/spscqueue.h \
+    logic/stats.h \
+    logic/timestamp.h \
     logic/util.h
 
 HEADERS += \